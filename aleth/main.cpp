@@ -21,7 +21,9 @@
 #include <libethashseal/GenesisInfo.h>
 #include <libethcore/Common.h>
 #include <libethcore/KeyManager.h>
+#include <libethereum/ChainArchive.h>
 #include <libethereum/SnapshotImporter.h>
+#include <libethereum/SnapshotProducer.h>
 #include <libethereum/SnapshotStorage.h>
 #include <libevm/VMFactory.h>
 #include <libwebthree/WebThree.h>
@@ -29,6 +31,7 @@
 #include <libweb3jsonrpc/AccountHolder.h>
 #include <libweb3jsonrpc/Eth.h>
 #include <libweb3jsonrpc/ModularServer.h>
+#include <libweb3jsonrpc/HttpServer.h>
 #include <libweb3jsonrpc/IpcServer.h>
 #include <libweb3jsonrpc/Net.h>
 #include <libweb3jsonrpc/Web3.h>
@@ -76,14 +79,16 @@ enum class OperationMode
     Node,
     Import,
     ImportSnapshot,
-    Export
+    Export,
+    ExportSnapshot
 };
 
 enum class Format
 {
     Binary,
     Hex,
-    Human
+    Human,
+    Archive
 };
 
 void stopSealingAfterXBlocks(eth::Client* _c, unsigned _start, unsigned& io_mining)
@@ -130,6 +135,11 @@ int main(int argc, char** argv)
     Format exportFormat = Format::Binary;
 
     bool ipc = true;
+    unsigned rpcBatchConcurrency = 4;
+    unsigned short httpPort = 0;
+    string httpAddress = "127.0.0.1";
+    string httpCorsDomain;
+    unsigned short metricsPort = 0;
 
     string jsonAdmin;
     ChainParams chainParams;
@@ -214,6 +224,18 @@ int main(int argc, char** argv)
     addClientOption("ipcpath", po::value<string>()->value_name("<path>"),
         "Set .ipc socket path (default: data directory)");
     addClientOption("no-ipc", "Disable IPC server");
+    addClientOption("rpc-batch-concurrency", po::value<unsigned>()->value_name("<n>"),
+        "Execute at most <n> read-only calls of a JSON-RPC batch request in parallel, 0 to execute "
+        "them one by one (default: 4)");
+    addClientOption("http-port", po::value<unsigned short>()->value_name("<port>"),
+        "Serve the eth, net and web3 JSON-RPC APIs over HTTP and WebSocket on <port> (default: "
+        "off)");
+    addClientOption("http-address", po::value<string>()->value_name("<ip>"),
+        "Listen for HTTP and WebSocket connections on <ip> (default: 127.0.0.1)");
+    addClientOption("http-cors", po::value<string>()->value_name("<domain>"),
+        "Allow cross-origin HTTP requests from <domain> (default: none)");
+    addClientOption("metrics-port", po::value<unsigned short>()->value_name("<port>"),
+        "Serve metrics in the Prometheus text format on 127.0.0.1:<port> (default: off)");
     addClientOption("admin", po::value<string>()->value_name("<password>"),
         "Specify admin session key for JSON-RPC (default: auto-generated and printed at "
         "start-up)");
@@ -303,7 +325,9 @@ int main(int argc, char** argv)
     po::options_description importExportMode("IMPORT/EXPORT MODES", c_lineWidth);
     auto addImportExportOption = importExportMode.add_options();
     addImportExportOption(
-        "import,I", po::value<string>()->value_name("<file>"), "Import blocks from file");
+        "import,I", po::value<string>()->value_name("<file>"),
+        "Import blocks from file, or from the directory of an archive written with --format "
+        "archive");
     addImportExportOption(
         "export,E", po::value<string>()->value_name("<file>"), "Export blocks to file");
     addImportExportOption("from", po::value<string>()->value_name("<n>"),
@@ -314,7 +338,9 @@ int main(int argc, char** argv)
     addImportExportOption("only", po::value<string>()->value_name("<n>"),
         "Equivalent to --export-from n --export-to n");
     addImportExportOption(
-        "format", po::value<string>()->value_name("<binary/hex/human>"), "Set export format");
+        "format", po::value<string>()->value_name("<binary/hex/human/archive>"),
+        "Set export format; archive writes compressed segment files into the directory given to "
+        "--export");
     addImportExportOption("dont-check",
         "Prevent checking some block aspects. Faster importing, but to apply only when the data is "
         "known to be valid");
@@ -322,7 +348,12 @@ int main(int argc, char** argv)
         po::value<string>(&snapshotPath)->value_name("<path>"),
         "Download Parity Warp Sync snapshot data to the specified path");
     addImportExportOption("import-snapshot", po::value<string>()->value_name("<path>"),
-        "Import blockchain and state data from the Parity Warp Sync snapshot\n");
+        "Import blockchain and state data from the Parity Warp Sync snapshot");
+    addImportExportOption("export-snapshot",
+        po::value<string>()->value_name("<path>")->implicit_value(""),
+        "Export Parity Warp Sync snapshot of the state at block --to (default: latest) to the "
+        "specified path. Without a path the snapshot is written to the database directory, from "
+        "where it is served to the peers\n");
 
     std::string const logChannels =
         "block blockhdr bq chain client debug discov error ethcap exec host impolite info net "
@@ -472,6 +503,25 @@ int main(int argc, char** argv)
         setDataDir(vm["data-dir"].as<string>());
     if (vm.count("ipcpath"))
         setIpcPath(vm["ipcpath"].as<string>());
+    if (vm.count("rpc-batch-concurrency"))
+        rpcBatchConcurrency = vm["rpc-batch-concurrency"].as<unsigned>();
+    if (vm.count("http-port"))
+        httpPort = vm["http-port"].as<unsigned short>();
+    if (vm.count("http-address"))
+    {
+        httpAddress = vm["http-address"].as<string>();
+        boost::system::error_code ec;
+        boost::asio::ip::make_address(httpAddress, ec);
+        if (ec)
+        {
+            cerr << "Bad --http-address option: " << httpAddress << "\n";
+            return AlethErrors::BadAddressOption;
+        }
+    }
+    if (vm.count("http-cors"))
+        httpCorsDomain = vm["http-cors"].as<string>();
+    if (vm.count("metrics-port"))
+        metricsPort = vm["metrics-port"].as<unsigned short>();
     if (vm.count("config"))
     {
         try
@@ -575,6 +625,11 @@ int main(int argc, char** argv)
         mode = OperationMode::Export;
         filename = vm["export"].as<string>();
     }
+    if (vm.count("export-snapshot"))
+    {
+        mode = OperationMode::ExportSnapshot;
+        filename = vm["export-snapshot"].as<string>();
+    }
     if (vm.count("password"))
         passwordsToNote.push_back(vm["password"].as<string>());
     if (vm.count("master"))
@@ -593,6 +648,8 @@ int main(int argc, char** argv)
             exportFormat = Format::Hex;
         else if (m == "human")
             exportFormat = Format::Human;
+        else if (m == "archive")
+            exportFormat = Format::Archive;
         else
         {
             cerr << "Bad " << "--format" << " option: " << m << "\n";
@@ -778,6 +835,32 @@ int main(int argc, char** argv)
         }
     };
 
+    auto printArchiveProgress = [](unsigned _done, unsigned _total) {
+        static chrono::steady_clock::time_point lastReport;
+        auto const now = chrono::steady_clock::now();
+        if (now - lastReport >= chrono::seconds(10) || _done == _total)
+        {
+            cout << _done << " of " << _total << " blocks done\n";
+            lastReport = now;
+        }
+    };
+
+    if (mode == OperationMode::Export && exportFormat == Format::Archive)
+    {
+        try
+        {
+            ChainArchive().exportBlocks(web3.ethereum()->blockChain(), toNumber(exportFrom),
+                toNumber(exportTo), filename, printArchiveProgress);
+            cout << "Blocks written to " << filename << "\n";
+        }
+        catch (...)
+        {
+            cerr << "Error during exporting the blocks: " << boost::current_exception_diagnostic_information() << endl;
+            return AlethErrors::ChainArchiveExportFailure;
+        }
+        return AlethErrors::Success;
+    }
+
     if (mode == OperationMode::Export)
     {
         ofstream fout(filename, std::ofstream::binary);
@@ -798,6 +881,48 @@ int main(int argc, char** argv)
         return AlethErrors::Success;
     }
 
+    if (mode == OperationMode::ExportSnapshot)
+    {
+        try
+        {
+            BlockChain const& bc = web3.ethereum()->blockChain();
+            fs::path const snapshotDir = filename.empty() ?
+                                             importedSnapshotPath(db::databasePath(), bc.genesisHash()) :
+                                             fs::path(filename);
+            SnapshotProducer producer(web3.ethereum()->stateDB());
+            producer.produce(bc, bc.numberHash(toNumber(exportTo)), snapshotDir);
+            cout << "Snapshot written to " << snapshotDir.string() << "\n";
+        }
+        catch (...)
+        {
+            cerr << "Error during exporting the snapshot: " << boost::current_exception_diagnostic_information() << endl;
+            return AlethErrors::SnapshotExportFailure;
+        }
+        return AlethErrors::Success;
+    }
+
+    if (mode == OperationMode::Import && fs::is_directory(filename))
+    {
+        chrono::steady_clock::time_point const t = chrono::steady_clock::now();
+        unsigned imported = 0;
+        try
+        {
+            imported = ChainArchive().importBlocks(web3.ethereum()->blockChain(), filename,
+                [&](VerifiedBlocks const& _blocks) {
+                    return get<1>(web3.ethereum()->importVerifiedBlocks(_blocks));
+                },
+                !safeImport, printArchiveProgress);
+        }
+        catch (...)
+        {
+            cerr << "Error during importing the blocks: " << boost::current_exception_diagnostic_information() << endl;
+            return AlethErrors::ChainArchiveImportFailure;
+        }
+        double e = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - t).count() / 1000.0;
+        cout << imported << " imported in " << e << " seconds at " << (round(imported * 10 / e) / 10) << " blocks/s (#" << web3.ethereum()->number() << ")\n";
+        return AlethErrors::Success;
+    }
+
     if (mode == OperationMode::Import)
     {
         ifstream fin(filename, std::ifstream::binary);
@@ -902,7 +1027,10 @@ int main(int argc, char** argv)
             SnapshotImporter importer(*stateImporter, *blockChainImporter);
 
             auto snapshotStorage(createSnapshotStorage(filename));
-            importer.import(*snapshotStorage, web3.ethereum()->blockChain().genesisHash());
+            h256 const genesisHash = web3.ethereum()->blockChain().genesisHash();
+            // interrupted import is resumed from the last imported state chunk
+            importer.import(*snapshotStorage, genesisHash,
+                snapshotImportProgressPath(db::databasePath(), genesisHash));
             // continue with regular sync from the snapshot block
         }
         catch (...)
@@ -943,6 +1071,7 @@ int main(int argc, char** argv)
     unique_ptr<rpc::SessionManager> sessionManager;
     unique_ptr<SimpleAccountHolder> accountHolder;
     unique_ptr<ModularServer<>> jsonrpcIpcServer;
+    unique_ptr<ModularServer<>> jsonrpcHttpServer;
 
 
     AddressHash allowedDestinations;
@@ -985,6 +1114,7 @@ int main(int argc, char** argv)
         sessionManager.reset(new rpc::SessionManager());
         accountHolder.reset(new SimpleAccountHolder([&](){ return web3.ethereum(); }, getAccountPassword, keyManager, authenticator));
         auto ethFace = new rpc::Eth(*web3.ethereum(), *accountHolder.get());
+        auto debugFace = new rpc::Debug(*web3.ethereum(), *sessionManager.get());
         rpc::TestFace* testEth = nullptr;
         if (testingMode)
             testEth = new rpc::Test(*web3.ethereum());
@@ -994,9 +1124,16 @@ int main(int argc, char** argv)
             new rpc::Web3(web3.clientVersion()), new rpc::Personal(keyManager, *accountHolder, *web3.ethereum()),
             new rpc::AdminEth(*web3.ethereum(), *gasPricer.get(), keyManager, *sessionManager.get()),
             new rpc::AdminNet(web3, *sessionManager.get()),
-            new rpc::Debug(*web3.ethereum()),
+            debugFace,
             testEth
         ));
+        if (rpcBatchConcurrency > 0)
+            jsonrpcIpcServer->enableParallelBatches(max(thread::hardware_concurrency(), 1u),
+                rpcBatchConcurrency, rpc::BatchRequestHandler::clientHead(*web3.ethereum()));
+        auto streamingMethods = ethFace->streamingMethods();
+        for (auto& method : debugFace->streamingMethods())
+            streamingMethods.insert(move(method));
+        jsonrpcIpcServer->enableStreamingMethods(move(streamingMethods));
         auto ipcConnector = new IpcServer("geth");
         jsonrpcIpcServer->addConnector(ipcConnector);
         ipcConnector->StartListening();
@@ -1009,6 +1146,36 @@ int main(int argc, char** argv)
         cout << "JSONRPC Admin Session Key: " << jsonAdmin << "\n";
     }
 
+    if (httpPort)
+    {
+        // only the APIs not needing an admin session are exposed to the network
+        using PublicServer = ModularServer<rpc::EthFace, rpc::NetFace, rpc::Web3Face>;
+
+        if (!accountHolder)
+            accountHolder.reset(new SimpleAccountHolder([&](){ return web3.ethereum(); }, getAccountPassword, keyManager, authenticator));
+        auto publicEthFace = new rpc::Eth(*web3.ethereum(), *accountHolder);
+        jsonrpcHttpServer.reset(new PublicServer(
+            publicEthFace, new rpc::Net(web3), new rpc::Web3(web3.clientVersion())));
+        if (rpcBatchConcurrency > 0)
+            jsonrpcHttpServer->enableParallelBatches(max(thread::hardware_concurrency(), 1u),
+                rpcBatchConcurrency, rpc::BatchRequestHandler::clientHead(*web3.ethereum()));
+        jsonrpcHttpServer->enableStreamingMethods(publicEthFace->streamingMethods());
+        auto httpConnector = new HttpServer(httpAddress, httpPort, web3.ethereum(), httpCorsDomain,
+            max(thread::hardware_concurrency(), 1u));
+        jsonrpcHttpServer->addConnector(httpConnector);
+        if (!httpConnector->StartListening())
+            cerr << "Failed to start the HTTP server on " << httpAddress << ":" << httpPort << "\n";
+    }
+
+    unique_ptr<HttpServer> metricsServer;
+    if (metricsPort)
+    {
+        metricsServer.reset(new HttpServer("127.0.0.1", metricsPort, nullptr, {}, 1));
+        metricsServer->enableMetrics(true);
+        if (!metricsServer->StartListening())
+            cerr << "Failed to start the metrics server on port " << metricsPort << "\n";
+    }
+
     if (web3.isNetworkStarted())
     {
         for (auto const& p: preferredNodes)
@@ -1037,6 +1204,8 @@ int main(int argc, char** argv)
 
     if (jsonrpcIpcServer.get())
         jsonrpcIpcServer->StopListening();
+    if (metricsServer)
+        metricsServer->StopListening();
 
     if (web3.isNetworkStarted())
     {
@@ -13,6 +13,7 @@ macro(configure_project)
     option(MINIUPNPC "Build with UPnP support" OFF)
     option(FASTCTEST "Enable fast ctest" OFF)
     option(ROCKSDB "Build with rocksdb as optional database implementation" OFF)
+    set(LOG_MAX_VERBOSITY 4 CACHE STRING "Most verbose log messages compiled in, 0 (errors) to 4 (trace)")
 
     if(MINIUPNPC)
         message(WARNING
@@ -30,6 +31,9 @@ macro(configure_project)
         add_definitions(-DETH_FATDB)
     endif ()
 
+    # The log messages above LOG_MAX_VERBOSITY cost nothing at run time.
+    add_definitions(-DETH_LOG_MAX_VERBOSITY=${LOG_MAX_VERBOSITY})
+
     # CI Builds should provide (for user builds this is totally optional)
     # -DBUILD_NUMBER - A number to identify the current build with. Becomes TWEAK component of project version.
     # -DVERSION_SUFFIX - A string to append to the end of the version string where applicable.
@@ -62,6 +66,7 @@ macro(print_config)
     message("-- FATDB            Full database exploring                  ${FATDB}")
     message("-- ROCKSDB          RocksDB as optional DB implementation    ${ROCKSDB}")
     message("-- MINIUPNPC        -                                        ${MINIUPNPC}")
+    message("-- LOG_MAX_VERBOSITY Most verbose log messages compiled in   ${LOG_MAX_VERBOSITY}")
     message("------------------------------------------------------------- components")
     message("-- TESTS            Build tests                              ${TESTS}")
     message("-- TOOLS            Build tools                              ${TOOLS}")
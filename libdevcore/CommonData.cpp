@@ -8,21 +8,58 @@
 
 #include "Exceptions.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ETH_HEX_SSE2 1
+#endif
+
 using namespace std;
 using namespace dev;
 
 namespace
 {
-int fromHexChar(char _i) noexcept
+char const c_hexDigits[] = "0123456789abcdef";
+
+/// Hex digit values, 0xff for characters that are not hex digits. Built at compile time, so that
+/// it can be used during static initialisation.
+struct HexValues
+{
+	constexpr HexValues(): values()
+	{
+		for (auto& v: values)
+			v = 0xff;
+		for (int i = 0; i < 10; ++i)
+			values['0' + i] = i;
+		for (int i = 0; i < 6; ++i)
+			values['a' + i] = values['A' + i] = 10 + i;
+	}
+	uint8_t values[256];
+};
+constexpr HexValues c_hexValues;
+
+#if ETH_HEX_SSE2
+/// Converts nibbles to hex digits.
+inline __m128i hexDigits(__m128i _nibbles)
+{
+	__m128i const letters = _mm_and_si128(_mm_cmpgt_epi8(_nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+	return _mm_add_epi8(_mm_add_epi8(_nibbles, _mm_set1_epi8('0')), letters);
+}
+
+/// Converts hex digits to their values. @returns false if one of the characters isn't a hex digit.
+inline bool hexValues(__m128i _digits, __m128i& o_values)
 {
-	if (_i >= '0' && _i <= '9')
-		return _i - '0';
-	if (_i >= 'a' && _i <= 'f')
-		return _i - 'a' + 10;
-	if (_i >= 'A' && _i <= 'F')
-		return _i - 'A' + 10;
-	return -1;
+	// out of range characters wrap around and are caught by the unsigned comparison
+	__m128i const decimal = _mm_sub_epi8(_digits, _mm_set1_epi8('0'));
+	__m128i const isDecimal = _mm_cmpeq_epi8(_mm_min_epu8(decimal, _mm_set1_epi8(9)), decimal);
+	__m128i const letter = _mm_sub_epi8(_mm_or_si128(_digits, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+	__m128i const isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+	if (_mm_movemask_epi8(_mm_or_si128(isDecimal, isLetter)) != 0xffff)
+		return false;
+	o_values = _mm_or_si128(_mm_and_si128(isDecimal, decimal),
+		_mm_and_si128(isLetter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+	return true;
 }
+#endif
 }
 
 bool dev::isHex(string const& _s) noexcept
@@ -30,7 +67,7 @@ bool dev::isHex(string const& _s) noexcept
 	auto it = _s.begin();
 	if (_s.compare(0, 2, "0x") == 0)
 		it += 2;
-	return std::all_of(it, _s.end(), [](char c){ return fromHexChar(c) != -1; });
+	return std::all_of(it, _s.end(), [](char c){ return c_hexValues.values[static_cast<uint8_t>(c)] != 0xff; });
 }
 
 std::string dev::escaped(std::string const& _s, bool _all)
@@ -62,32 +99,114 @@ std::string dev::escaped(std::string const& _s, bool _all)
 }
 
 
+void dev::encodeHex(byte const* _data, size_t _size, char* o_hex) noexcept
+{
+#if ETH_HEX_SSE2
+	for (; _size >= 16; _size -= 16, _data += 16, o_hex += 32)
+	{
+		__m128i const in = _mm_loadu_si128(reinterpret_cast<__m128i const*>(_data));
+		__m128i const mask = _mm_set1_epi8(0x0f);
+		__m128i const high = hexDigits(_mm_and_si128(_mm_srli_epi16(in, 4), mask));
+		__m128i const low = hexDigits(_mm_and_si128(in, mask));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(o_hex), _mm_unpacklo_epi8(high, low));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(o_hex + 16), _mm_unpackhi_epi8(high, low));
+	}
+#endif
+	for (; _size; --_size, ++_data)
+	{
+		*o_hex++ = c_hexDigits[*_data >> 4];
+		*o_hex++ = c_hexDigits[*_data & 0x0f];
+	}
+}
+
+bool dev::decodeHex(char const* _hex, size_t _size, byte* o_data) noexcept
+{
+#if ETH_HEX_SSE2
+	for (; _size >= 8; _size -= 8, _hex += 16, o_data += 8)
+	{
+		__m128i values;
+		if (!hexValues(_mm_loadu_si128(reinterpret_cast<__m128i const*>(_hex)), values))
+			return false;
+		// every 16 bit lane holds the high nibble in its low byte and the low nibble in its high byte
+		__m128i const bytes = _mm_and_si128(
+			_mm_or_si128(_mm_slli_epi16(values, 4), _mm_srli_epi16(values, 8)), _mm_set1_epi16(0xff));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(o_data), _mm_packus_epi16(bytes, bytes));
+	}
+#endif
+	for (; _size; --_size, _hex += 2)
+	{
+		uint8_t const h = c_hexValues.values[static_cast<uint8_t>(_hex[0])];
+		uint8_t const l = c_hexValues.values[static_cast<uint8_t>(_hex[1])];
+		if ((h | l) == 0xff)
+			return false;
+		*o_data++ = static_cast<byte>(h << 4 | l);
+	}
+	return true;
+}
+
+void dev::appendHex(std::string& o_out, bytesConstRef _data)
+{
+	size_t const offset = o_out.size();
+	o_out.resize(offset + _data.size() * 2);
+	if (!_data.empty())
+		encodeHex(_data.data(), _data.size(), &o_out[offset]);
+}
+
+namespace
+{
+string compactHex(u256 const& _val, unsigned _min, string const& _prefix)
+{
+	if (_val > numeric_limits<uint64_t>::max())
+	{
+		bytes const compact = toCompactBigEndian(_val, _min);
+		return toHex(compact.begin(), compact.end(), _prefix);
+	}
+
+	// values of stack items and gas fit into 64 bits, write them without going through bytes
+	uint64_t v = static_cast<uint64_t>(_val);
+	unsigned size = 0;
+	for (uint64_t i = v; i; i >>= 8)
+		++size;
+	size = max(size, _min);
+	string ret(_prefix.size() + size * 2, '0');
+	ret.replace(0, _prefix.size(), _prefix);
+	for (size_t i = ret.size(); v; v >>= 4)
+		ret[--i] = c_hexDigits[v & 0x0f];
+	return ret;
+}
+}
+
+string dev::toCompactHex(u256 const& _val, unsigned _min)
+{
+	return compactHex(_val, _min, {});
+}
+
+string dev::toCompactHexPrefixed(u256 const& _val, unsigned _min)
+{
+	return compactHex(_val, _min, "0x");
+}
+
 bytes dev::fromHex(std::string const& _s, WhenError _throw)
 {
 	unsigned s = (_s.size() >= 2 && _s[0] == '0' && _s[1] == 'x') ? 2 : 0;
-	std::vector<uint8_t> ret;
-	ret.reserve((_s.size() - s + 1) / 2);
+	bytes ret((_s.size() - s + 1) / 2);
+	byte* out = ret.data();
 
 	if (_s.size() % 2)
 	{
-		int h = fromHexChar(_s[s++]);
-		if (h != -1)
-			ret.push_back(h);
+		uint8_t h = c_hexValues.values[static_cast<uint8_t>(_s[s++])];
+		if (h != 0xff)
+			*out++ = h;
 		else if (_throw == WhenError::Throw)
 			BOOST_THROW_EXCEPTION(BadHexCharacter());
 		else
 			return bytes();
 	}
-	for (unsigned i = s; i < _s.size(); i += 2)
+	if (!decodeHex(_s.data() + s, (_s.size() - s) / 2, out))
 	{
-		int h = fromHexChar(_s[i]);
-		int l = fromHexChar(_s[i + 1]);
-		if (h != -1 && l != -1)
-			ret.push_back((byte)(h * 16 + l));
-		else if (_throw == WhenError::Throw)
+		if (_throw == WhenError::Throw)
 			BOOST_THROW_EXCEPTION(BadHexCharacter());
-		else
-			return bytes();
+		return bytes();
 	}
 	return ret;
 }
@@ -25,21 +25,53 @@ enum class WhenError
 	Throw = 1,
 };
 
+/// Writes the hex digits of @a _size bytes at @a _data to @a o_hex, which must have room for
+/// 2 * @a _size characters.
+void encodeHex(byte const* _data, size_t _size, char* o_hex) noexcept;
+
+/// Decodes 2 * @a _size hex digits at @a _hex into @a _size bytes at @a o_data.
+/// @returns false if one of the characters is not a hex digit, @a o_data is then undefined.
+bool decodeHex(char const* _hex, size_t _size, byte* o_data) noexcept;
+
+/// Appends the hex string of @a _data to @a o_out.
+void appendHex(std::string& o_out, bytesConstRef _data);
+
+/// true if the bytes between two iterators of type @a Iterator are contiguous in memory.
+template <class Iterator>
+using IsContiguousIterator = std::integral_constant<bool,
+	std::is_pointer<Iterator>::value || std::is_same<Iterator, bytes::iterator>::value ||
+		std::is_same<Iterator, bytes::const_iterator>::value ||
+		std::is_same<Iterator, std::string::iterator>::value ||
+		std::is_same<Iterator, std::string::const_iterator>::value>;
+
+template <class Iterator>
+void toHex(Iterator _it, Iterator _end, char* o_hex, std::true_type /* contiguous */)
+{
+	if (_it != _end)
+		encodeHex(reinterpret_cast<byte const*>(&*_it), std::distance(_it, _end), o_hex);
+}
+
+template <class Iterator>
+void toHex(Iterator _it, Iterator _end, char* o_hex, std::false_type /* contiguous */)
+{
+	static char const* hexdigits = "0123456789abcdef";
+	for (; _it != _end; _it++)
+	{
+		*o_hex++ = hexdigits[(*_it >> 4) & 0x0f];
+		*o_hex++ = hexdigits[*_it & 0x0f];
+	}
+}
+
 template <class Iterator>
 std::string toHex(Iterator _it, Iterator _end, std::string const& _prefix)
 {
 	typedef std::iterator_traits<Iterator> traits;
 	static_assert(sizeof(typename traits::value_type) == 1, "toHex needs byte-sized element type");
 
-	static char const* hexdigits = "0123456789abcdef";
 	size_t off = _prefix.size();
 	std::string hex(std::distance(_it, _end)*2 + off, '0');
 	hex.replace(0, off, _prefix);
-	for (; _it != _end; _it++)
-	{
-		hex[off++] = hexdigits[(*_it >> 4) & 0x0f];
-		hex[off++] = hexdigits[*_it & 0x0f];
-	}
+	toHex(_it, _end, &hex[off], IsContiguousIterator<Iterator>());
 	return hex;
 }
 
@@ -162,15 +194,11 @@ inline std::string toCompactBigEndianString(T _val, unsigned _min = 0)
 	return ret;
 }
 
-inline std::string toCompactHex(u256 _val, unsigned _min = 0)
-{
-	return toHex(toCompactBigEndian(_val, _min));
-}
+/// @returns the hex of the bytes of toCompactBigEndian(@a _val, @a _min).
+std::string toCompactHex(u256 const& _val, unsigned _min = 0);
 
-inline std::string toCompactHexPrefixed(u256 _val, unsigned _min = 0)
-{
-	return toHexPrefixed(toCompactBigEndian(_val, _min));
-}
+/// @returns the hex of the bytes of toCompactBigEndian(@a _val, @a _min), prefixed with 0x.
+std::string toCompactHexPrefixed(u256 const& _val, unsigned _min = 0);
 
 // Algorithms for string and string-like collections.
 
@@ -10,6 +10,21 @@ using namespace std;
 namespace dev
 {
 
+string toJSQuantity(uint64_t _value)
+{
+	char digits[16];
+	char* begin = digits + sizeof(digits);
+	do
+	{
+		*--begin = "0123456789abcdef"[_value & 0xf];
+		_value >>= 4;
+	} while (_value);
+	string res(digits + sizeof(digits) - begin + 2, 'x');
+	res[0] = '0';
+	memcpy(&res[2], begin, digits + sizeof(digits) - begin);
+	return res;
+}
+
 bytes jsToBytes(string const& _s, OnFailed _f)
 {
 	try
@@ -21,12 +21,22 @@ template <unsigned S> std::string toJS(FixedHash<S> const& _h)
 	return toHexPrefixed(_h.ref());
 }
 
+/// @returns "0x" followed by the hex digits of @a _value without leading zeros, "0x0" for zero.
+std::string toJSQuantity(uint64_t _value);
+
 template <unsigned N> std::string toJS(boost::multiprecision::number<boost::multiprecision::cpp_int_backend<N, N, boost::multiprecision::unsigned_magnitude, boost::multiprecision::unchecked, void>> const& _n)
 {
-	std::string h = toHex(toCompactBigEndian(_n, 1));
+	// most quantities are small, don't go through the full width of the number for them
+	if (_n <= std::numeric_limits<uint64_t>::max())
+		return toJSQuantity(static_cast<uint64_t>(_n));
+	bytes const compact = toCompactBigEndian(_n, 1);
+	std::string res(compact.size() * 2 + 2, '0');
+	res[1] = 'x';
+	encodeHex(compact.data(), compact.size(), &res[2]);
 	// remove first 0, if it is necessary;
-	std::string res = h[0] != '0' ? h : h.substr(1);
-	return "0x" + res;
+	if (res[2] == '0')
+		res.erase(2, 1);
+	return res;
 }
 
 inline std::string toJS(bytes const& _n, std::size_t _padding = 0)
@@ -34,9 +44,11 @@ inline std::string toJS(bytes const& _n, std::size_t _padding = 0)
     if (_n.empty())
         return {};
 
-    bytes n = _n;
-    n.resize(std::max<unsigned>(n.size(), _padding));
-    return toHexPrefixed(n);
+    // padding appends zero bytes
+    std::string res = toHexPrefixed(_n);
+    if (_padding > _n.size())
+        res.append((_padding - _n.size()) * 2, '0');
+    return res;
 }
 
 template<unsigned T> std::string toJS(SecureFixedHash<T> const& _i)
@@ -46,7 +58,21 @@ template<unsigned T> std::string toJS(SecureFixedHash<T> const& _i)
 	return stream.str();
 }
 
-template<typename T> std::string toJS(T const& _i)
+/// true for the integral types streamed as numbers, whose hex can be written without a stream.
+template <typename T>
+using IsJSQuantity = std::integral_constant<bool, std::is_integral<T>::value &&
+	!std::is_same<T, bool>::value && !std::is_same<T, char>::value &&
+	!std::is_same<T, signed char>::value && !std::is_same<T, unsigned char>::value &&
+	!std::is_same<T, wchar_t>::value && !std::is_same<T, char16_t>::value &&
+	!std::is_same<T, char32_t>::value>;
+
+template<typename T> typename std::enable_if<IsJSQuantity<T>::value, std::string>::type toJS(T const& _i)
+{
+	// negative numbers are written in two's complement, like the stream does
+	return toJSQuantity(static_cast<typename std::make_unsigned<T>::type>(_i));
+}
+
+template<typename T> typename std::enable_if<!IsJSQuantity<T>::value, std::string>::type toJS(T const& _i)
 {
 	std::stringstream stream;
 	stream << "0x" << std::hex << _i;
@@ -71,6 +97,10 @@ std::string fromRaw(h256 _n);
 
 template <unsigned N> FixedHash<N> jsToFixed(std::string const& _s)
 {
+	// the usual case of a hash of the full length is decoded in place
+	FixedHash<N> ret;
+	if (_s.size() == 2 + N * 2 && _s[0] == '0' && _s[1] == 'x' && decodeHex(_s.data() + 2, N, ret.data()))
+		return ret;
 	if (_s.substr(0, 2) == "0x")
 		// Hex
 		return FixedHash<N>(_s.substr(2 + std::max<unsigned>(N * 2, _s.size() - 2) - N * 2));
@@ -0,0 +1,50 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Value wrapper whose copies share the data until one of them is modified.
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace dev
+{
+/// Holds a value of type T that is shared between copies of the holder. Copying is O(1), the value
+/// is copied by the first mutable access made while it is shared.
+///
+/// Thread Safety
+/// Distinct Objects: Safe, including copies sharing the same value.
+/// Shared objects: Unsafe.
+template <class T>
+class CopyOnWrite
+{
+public:
+    CopyOnWrite() : m_value(std::make_shared<T>()) {}
+    CopyOnWrite(T _value) : m_value(std::make_shared<T>(std::move(_value))) {}
+
+    T const& get() const { return *m_value; }
+    T const& operator*() const { return *m_value; }
+    T const* operator->() const { return m_value.get(); }
+
+    /// @returns the value for modification, detaching it from other copies first.
+    /// The reference must not be used to modify the value after the holder is copied.
+    T& mut()
+    {
+        if (m_value.use_count() > 1)
+            m_value = std::make_shared<T>(*m_value);
+        else
+            // other holders might have just released the value, see their reads before writing
+            std::atomic_thread_fence(std::memory_order_acquire);
+        return *m_value;
+    }
+
+    /// Replaces the value with an empty one without copying the shared data.
+    void reset() { m_value = std::make_shared<T>(); }
+
+private:
+    std::shared_ptr<T> m_value;
+};
+
+}  // namespace dev
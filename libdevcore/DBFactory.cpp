@@ -20,6 +20,8 @@ namespace po = boost::program_options;
 
 auto g_kind = DatabaseKind::LevelDB;
 fs::path g_dbPath;
+unsigned g_statePruningHistory = 0;
+unsigned g_stateSnapshotLayers = 0;
 
 /// A helper type to build the table of DB implementations.
 ///
@@ -90,6 +92,26 @@ fs::path databasePath()
     return g_dbPath.empty() ? getDataDir() : g_dbPath;
 }
 
+unsigned statePruningHistory()
+{
+    return g_statePruningHistory;
+}
+
+void setStatePruningHistory(unsigned _history)
+{
+    g_statePruningHistory = _history;
+}
+
+unsigned stateSnapshotLayers()
+{
+    return g_stateSnapshotLayers;
+}
+
+void setStateSnapshotLayers(unsigned _layers)
+{
+    g_stateSnapshotLayers = _layers;
+}
+
 po::options_description databaseProgramOptions(unsigned _lineLength)
 {
     // It must be a static object because boost expects const char*.
@@ -118,7 +140,18 @@ po::options_description databaseProgramOptions(unsigned _lineLength)
             ->value_name("<path>")
             ->default_value(getDataDir().string())
             ->notifier(setDatabasePath),
-        "Database path (for non-memory database options)\n");
+        "Database path (for non-memory database options)");
+
+    add("prune-state",
+        po::value<unsigned>()->value_name("<n>")->notifier(setStatePruningHistory),
+        "Keep only the states of the last <n> blocks in the state database. The state database "
+        "has to be created with this option, re-run with --kill or --rebuild to recreate it "
+        "(default: keep all states)");
+
+    add("state-snapshot",
+        po::value<unsigned>()->value_name("<n>")->notifier(setStateSnapshotLayers),
+        "Keep a flat snapshot of the state for reading accounts and storage without the state "
+        "trie, with the changes of the last <n> blocks held in memory (default: disabled)\n");
 
     return opts;
 }
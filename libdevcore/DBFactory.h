@@ -34,6 +34,16 @@ void setDatabaseKindByName(std::string const& _name);
 void setDatabaseKind(DatabaseKind _kind);
 boost::filesystem::path databasePath();
 
+/// Number of the most recent blocks whose states are kept in the state database, 0 to keep the
+/// states of all blocks.
+unsigned statePruningHistory();
+void setStatePruningHistory(unsigned _history);
+
+/// Number of the most recent blocks whose state changes the flat state snapshot holds in memory,
+/// 0 to disable the snapshot.
+unsigned stateSnapshotLayers();
+void setStateSnapshotLayers(unsigned _layers);
+
 class DBFactory
 {
 public:
@@ -0,0 +1,113 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Parallel processing of a range of numbers with the results consumed in order.
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dev
+{
+/// Calls @a _f for the numbers from @a _from to @a _to on @a _threads threads and passes the
+/// results to @a _sink in the order of the numbers, on the calling thread. At most two results
+/// per thread are held waiting for the sink. An exception thrown by @a _f stops the threads and
+/// is rethrown after the results before it have been passed on.
+template <class Result>
+void forEachInOrder(unsigned _from, unsigned _to, unsigned _threads,
+    std::function<Result(unsigned)> const& _f, std::function<void(unsigned, Result&)> const& _sink)
+{
+    unsigned const count = _to - _from + 1;
+    unsigned const window = 2 * _threads;
+
+    std::mutex x;
+    std::condition_variable changed;
+    std::map<unsigned, Result> ready;
+    unsigned next = 0;
+    unsigned consumed = 0;
+    bool stop = false;
+    // the index of the first number whose call of _f has thrown, the results of the numbers
+    // before it are still passed to the sink
+    unsigned failed = count;
+    std::exception_ptr error;
+
+    auto const work = [&]() {
+        while (true)
+        {
+            std::unique_lock<std::mutex> l(x);
+            changed.wait(l, [&]() { return stop || next >= count || next < consumed + window; });
+            if (stop || next >= count)
+                return;
+            unsigned const i = next++;
+            l.unlock();
+
+            try
+            {
+                Result result = _f(_from + i);
+                l.lock();
+                ready.emplace(i, std::move(result));
+            }
+            catch (...)
+            {
+                l.lock();
+                if (i < failed)
+                {
+                    failed = i;
+                    error = std::current_exception();
+                }
+                stop = true;
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    auto const joinWorkers = [&]() {
+        {
+            std::lock_guard<std::mutex> l(x);
+            stop = true;
+        }
+        changed.notify_all();
+        for (auto& worker : workers)
+            worker.join();
+        workers.clear();
+    };
+    for (unsigned i = 0; i < std::min(_threads, count); ++i)
+        workers.emplace_back(work);
+
+    try
+    {
+        for (unsigned i = 0; i < count; ++i)
+        {
+            std::unique_lock<std::mutex> l(x);
+            changed.wait(l, [&]() { return i >= failed || ready.count(i); });
+            auto const it = ready.find(i);
+            if (it == ready.end())
+                break;
+            Result result = std::move(it->second);
+            ready.erase(it);
+            consumed = i + 1;
+            l.unlock();
+            changed.notify_all();
+
+            _sink(_from + i, result);
+        }
+    }
+    catch (...)
+    {
+        joinWorkers();
+        throw;
+    }
+    joinWorkers();
+    if (error)
+        std::rethrow_exception(error);
+}
+}  // namespace dev
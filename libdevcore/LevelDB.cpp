@@ -3,6 +3,7 @@
 // Licensed under the GNU General Public License, Version 3.
 #include "LevelDB.h"
 #include "Assertions.h"
+#include "Metrics.h"
 
 namespace dev
 {
@@ -15,6 +16,26 @@ inline leveldb::Slice toLDBSlice(Slice _slice)
     return leveldb::Slice(_slice.data(), _slice.size());
 }
 
+struct Latencies
+{
+    MetricHistogram& read;
+    MetricHistogram& write;
+    MetricHistogram& commit;
+};
+
+MetricHistogram& latency(char const* _operation)
+{
+    return MetricsRegistry::instance().histogram("aleth_db_operation_seconds",
+        "Latency of database operations.",
+        std::string("backend=\"leveldb\",operation=\"") + _operation + "\"");
+}
+
+Latencies const& latencies()
+{
+    static Latencies const s_latencies{latency("read"), latency("write"), latency("commit")};
+    return s_latencies;
+}
+
 DatabaseStatus toDatabaseStatus(leveldb::Status const& _status)
 {
     if (_status.ok())
@@ -102,7 +123,8 @@ std::string LevelDB::lookup(Slice _key) const
 {
     leveldb::Slice const key(_key.data(), _key.size());
     std::string value;
-    auto const status = m_db->Get(m_readOptions, key, &value);
+    auto const status =
+        timed(latencies().read, [&] { return m_db->Get(m_readOptions, key, &value); });
     if (status.IsNotFound())
         return std::string();
 
@@ -114,7 +136,8 @@ bool LevelDB::exists(Slice _key) const
 {
     std::string value;
     leveldb::Slice const key(_key.data(), _key.size());
-    auto const status = m_db->Get(m_readOptions, key, &value);
+    auto const status =
+        timed(latencies().read, [&] { return m_db->Get(m_readOptions, key, &value); });
     if (status.IsNotFound())
         return false;
 
@@ -126,14 +149,16 @@ void LevelDB::insert(Slice _key, Slice _value)
 {
     leveldb::Slice const key(_key.data(), _key.size());
     leveldb::Slice const value(_value.data(), _value.size());
-    auto const status = m_db->Put(m_writeOptions, key, value);
+    auto const status =
+        timed(latencies().write, [&] { return m_db->Put(m_writeOptions, key, value); });
     checkStatus(status);
 }
 
 void LevelDB::kill(Slice _key)
 {
     leveldb::Slice const key(_key.data(), _key.size());
-    auto const status = m_db->Delete(m_writeOptions, key);
+    auto const status =
+        timed(latencies().write, [&] { return m_db->Delete(m_writeOptions, key); });
     checkStatus(status);
 }
 
@@ -154,7 +179,8 @@ void LevelDB::commit(std::unique_ptr<WriteBatchFace> _batch)
         BOOST_THROW_EXCEPTION(
             DatabaseError() << errinfo_comment("Invalid batch type passed to LevelDB::commit"));
     }
-    auto const status = m_db->Write(m_writeOptions, &batchPtr->writeBatch());
+    auto const status = timed(latencies().commit,
+        [&] { return m_db->Write(m_writeOptions, &batchPtr->writeBatch()); });
     checkStatus(status);
 }
 
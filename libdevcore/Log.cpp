@@ -2,6 +2,8 @@
 // Copyright 2013-2019 Aleth Authors.
 // Licensed under the GNU General Public License, Version 3.
 #include "Log.h"
+#include "Guards.h"
+#include "PerThreadQueue.h"
 
 #ifdef __APPLE__
 #include <pthread.h>
@@ -17,14 +19,12 @@
 #include <boost/log/support/date_time.hpp>
 #include <boost/log/utility/exception_handler.hpp>
 
+#include <condition_variable>
+
 #if defined(NDEBUG)
 #include <boost/log/sinks/async_frontend.hpp>
-template <class T>
-using log_sink = boost::log::sinks::asynchronous_sink<T>;
 #else
 #include <boost/log/sinks/sync_frontend.hpp>
-template <class T>
-using log_sink = boost::log::sinks::synchronous_sink<T>;
 #endif
 
 namespace dev
@@ -47,6 +47,9 @@ struct ThreadLocalLogName
 
 ThreadLocalLogName g_logThreadName("main");
 
+/// The name of the thread as set in the system, empty until read.
+thread_local std::string t_threadName;
+
 auto const g_timestampFormatter =
     (boost::log::expressions::stream
         << EthViolet << boost::log::expressions::format_date_time(timestamp, "%m-%d %H:%M:%S")
@@ -89,15 +92,156 @@ void formatter(boost::log::record_view const& _rec, boost::log::formatting_ostre
 }
 
 std::atomic<bool> g_vmTraceEnabled{false};
+
+/// The number of records a thread can queue before its records are dropped.
+size_t const c_logQueueCapacity = 4096;
+
+/// How long the writing thread sleeps at most when there are no records, as a producer may miss
+/// waking it up.
+std::chrono::milliseconds const c_logQueueIdleWait{50};
+
+std::atomic<uint64_t> g_droppedLogRecords{0};
+
+/// Set when the last queued record has been taken, so that the backend flushes the stream.
+std::atomic<bool> g_logQueueDrained{true};
+
+/// The filters of setupLogging(), for the checks before a record is built.
+std::atomic<int> g_logVerbosity{VerbosityTrace};
+std::atomic<bool> g_logChannelsFiltered{false};
+std::shared_ptr<LoggingOptions const> g_logChannelFilter;
+
+/**
+ * @brief Queueing strategy of the asynchronous sink with a ring buffer per logging thread, so
+ * that the logging threads don't contend with each other nor with the writing thread.
+ * A thread whose buffer is full drops its records, see droppedLogRecords().
+ */
+class PerThreadLogQueue
+{
+protected:
+    PerThreadLogQueue() = default;
+
+    template <class ArgsT>
+    explicit PerThreadLogQueue(ArgsT const&)
+    {}
+
+    void enqueue(boost::log::record_view const& _rec) { try_enqueue(_rec); }
+
+    bool try_enqueue(boost::log::record_view const& _rec)
+    {
+        if (!m_queue.push(_rec))
+        {
+            ++g_droppedLogRecords;
+            return false;
+        }
+        if (m_waiting.load())
+        {
+            Guard l(x_wake);
+            m_wake.notify_one();
+        }
+        return true;
+    }
+
+    bool try_dequeue_ready(boost::log::record_view& o_rec) { return pop(o_rec); }
+
+    bool try_dequeue(boost::log::record_view& o_rec) { return pop(o_rec); }
+
+    bool dequeue_ready(boost::log::record_view& o_rec)
+    {
+        while (true)
+        {
+            m_waiting = true;
+            if (pop(o_rec))
+            {
+                m_waiting = false;
+                return true;
+            }
+
+            UniqueGuard l(x_wake);
+            m_wake.wait_for(l, c_logQueueIdleWait);
+            m_waiting = false;
+            if (m_interrupted)
+            {
+                m_interrupted = false;
+                return false;
+            }
+        }
+    }
+
+    void interrupt_dequeue()
+    {
+        Guard l(x_wake);
+        m_interrupted = true;
+        m_wake.notify_one();
+    }
+
+private:
+    bool pop(boost::log::record_view& o_rec)
+    {
+        bool const popped = m_queue.pop(o_rec);
+        g_logQueueDrained = !popped || m_queue.empty();
+        return popped;
+    }
+
+    PerThreadQueue<boost::log::record_view> m_queue{c_logQueueCapacity};
+
+    Mutex x_wake;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_waiting{false};
+    bool m_interrupted = false;
+};
+
+/// Flushes the stream when the queue of the asynchronous sink is drained rather than after each
+/// record.
+class DrainFlushingBackend : public boost::log::sinks::text_ostream_backend
+{
+public:
+    void consume(boost::log::record_view const& _rec, string_type const& _formattedMessage)
+    {
+        boost::log::sinks::text_ostream_backend::consume(_rec, _formattedMessage);
+        if (g_logQueueDrained)
+            flush();
+    }
+};
+
+#if defined(NDEBUG)
+using LogSink = boost::log::sinks::asynchronous_sink<DrainFlushingBackend, PerThreadLogQueue>;
+#else
+using LogSink = boost::log::sinks::synchronous_sink<boost::log::sinks::text_ostream_backend>;
+#endif
 }  // namespace
 
+std::atomic<unsigned> g_logFilterGeneration{1};
+
+bool isLogEnabled(int _severity, char const* _channel)
+{
+    if (_severity > g_logVerbosity.load(std::memory_order_relaxed))
+        return false;
+    if (!g_logChannelsFiltered.load(std::memory_order_relaxed))
+        return true;
+
+    auto const filter = std::atomic_load(&g_logChannelFilter);
+    std::string const channel{_channel};
+    return (filter->includeChannels.empty() || contains(filter->includeChannels, channel)) &&
+           !contains(filter->excludeChannels, channel);
+}
+
+uint64_t droppedLogRecords()
+{
+    return g_droppedLogRecords;
+}
+
 std::string getThreadName()
 {
 #if defined(__GLIBC__) || defined(__APPLE__)
-    char buffer[128];
-    pthread_getname_np(pthread_self(), buffer, 127);
-    buffer[127] = 0;
-    return buffer;
+    // Read for every log record, so cached
+    if (t_threadName.empty())
+    {
+        char buffer[128];
+        pthread_getname_np(pthread_self(), buffer, 127);
+        buffer[127] = 0;
+        t_threadName = buffer;
+    }
+    return t_threadName;
 #else
     return g_logThreadName.m_name.get() ? *g_logThreadName.m_name.get() : "<unknown>";
 #endif
@@ -105,6 +249,7 @@ std::string getThreadName()
 
 void setThreadName(std::string const& _n)
 {
+    t_threadName.clear();
 #if defined(__GLIBC__)
     pthread_setname_np(pthread_self(), _n.c_str());
 #elif defined(__APPLE__)
@@ -116,12 +261,14 @@ void setThreadName(std::string const& _n)
 
 void setupLogging(LoggingOptions const& _options)
 {
-    auto sink = boost::make_shared<log_sink<boost::log::sinks::text_ostream_backend>>();
+    auto sink = boost::make_shared<LogSink>();
 
     boost::shared_ptr<std::ostream> stream{&std::cout, boost::null_deleter{}};
     sink->locked_backend()->add_stream(stream);
+#if !defined(NDEBUG)
     // Enable auto-flushing after each log record written
     sink->locked_backend()->auto_flush(true);
+#endif
 
     sink->set_filter([_options](boost::log::attribute_value_set const& _set) {
         if (_set[severity] > _options.verbosity)
@@ -148,6 +295,12 @@ void setupLogging(LoggingOptions const& _options)
     }));
 
     g_vmTraceEnabled = _options.vmTrace;
+
+    g_logVerbosity = _options.verbosity;
+    std::atomic_store(&g_logChannelFilter, std::make_shared<LoggingOptions const>(_options));
+    g_logChannelsFiltered =
+        !_options.includeChannels.empty() || !_options.excludeChannels.empty();
+    ++g_logFilterGeneration;
 }
 
 bool isVmTraceEnabled()
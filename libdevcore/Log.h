@@ -7,6 +7,7 @@
 #include "CommonIO.h"
 #include "FixedHash.h"
 #include "Terminal.h"
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -47,8 +48,6 @@ void setThreadName(std::string const& _n);
 /// Set the current thread's log name.
 std::string getThreadName();
 
-#define LOG BOOST_LOG
-
 enum Verbosity
 {
     VerbositySilent = -1,
@@ -59,40 +58,134 @@ enum Verbosity
     VerbosityTrace = 4,
 };
 
+/// The messages more verbose than this are compiled out.
+#ifndef ETH_LOG_MAX_VERBOSITY
+#define ETH_LOG_MAX_VERBOSITY 4  // VerbosityTrace
+#endif
+
+/// Incremented whenever setupLogging() changes the filters.
+extern std::atomic<unsigned> g_logFilterGeneration;
+
+/// @returns false if the messages of severity @a _severity to channel @a _channel are filtered
+/// out. Doesn't lock, so that the logging macros check it before building a record.
+bool isLogEnabled(int _severity, char const* _channel);
+
+// Simple non-thread-safe logger with fixed severity and channel for each message
+// For better formatting it is recommended to limit channel name to max 6 characters.
+class Logger : public boost::log::sources::severity_channel_logger<>
+{
+public:
+    Logger(int _severity, std::string const& _channel)
+      : severity_channel_logger(
+            boost::log::keywords::severity = _severity, boost::log::keywords::channel = _channel),
+        m_severity(_severity),
+        m_channel(_channel)
+    {}
+
+    Logger(Logger const& _other)
+      : severity_channel_logger(_other), m_severity(_other.m_severity), m_channel(_other.m_channel)
+    {}
+
+    Logger& operator=(Logger const& _other)
+    {
+        severity_channel_logger::operator=(_other);
+        m_severity = _other.m_severity;
+        m_channel = _other.m_channel;
+        m_filterGeneration = 0;
+        return *this;
+    }
+
+    /// @returns false if the messages of this logger are filtered out.
+    bool enabled() const
+    {
+        if (m_severity > ETH_LOG_MAX_VERBOSITY)
+            return false;
+        // Loggers are shared by threads in places, hence the atomics.
+        unsigned const generation = g_logFilterGeneration.load(std::memory_order_relaxed);
+        if (m_filterGeneration.load(std::memory_order_relaxed) != generation)
+        {
+            m_enabled.store(isLogEnabled(m_severity, m_channel.c_str()), std::memory_order_relaxed);
+            m_filterGeneration.store(generation, std::memory_order_relaxed);
+        }
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+private:
+    int m_severity;
+    std::string m_channel;
+    /// Whether the messages pass the filters of generation m_filterGeneration.
+    mutable std::atomic<bool> m_enabled{true};
+    mutable std::atomic<unsigned> m_filterGeneration{0};
+};
+
+inline Logger createLogger(int _severity, std::string const& _channel)
+{
+    return Logger(_severity, _channel);
+}
+
+inline bool isLogEnabled(Logger const& _logger)
+{
+    return _logger.enabled();
+}
+
+/// The thread-safe global loggers are checked by the macros using them.
+template <class L>
+inline bool isLogEnabled(L const&)
+{
+    return true;
+}
+
+/// Opens a record for @a LOGGER unless @a ENABLED is false, in which case neither the record is
+/// built nor the streamed expressions are evaluated. A loop rather than an if, like BOOST_LOG, so
+/// that an else following the message binds as expected.
+#define DEV_LOG_IF(ENABLED, LOGGER)                                            \
+    for (bool devLogEnabled = (ENABLED); devLogEnabled; devLogEnabled = false) \
+    BOOST_LOG(LOGGER)
+
+#define LOG(LOGGER) DEV_LOG_IF(dev::isLogEnabled(LOGGER), LOGGER)
+
+/// LOG() for the thread-safe global loggers, whose severity and channel are given.
+#define DEV_GLOBAL_LOG(SEVERITY, CHANNEL, LOGGER)                                          \
+    DEV_LOG_IF((SEVERITY) <= ETH_LOG_MAX_VERBOSITY && dev::isLogEnabled(SEVERITY, CHANNEL), \
+        LOGGER)
+
 // Simple cout-like stream objects for accessing common log channels.
 // Thread-safe
 BOOST_LOG_INLINE_GLOBAL_LOGGER_CTOR_ARGS(g_errorLogger,
     boost::log::sources::severity_channel_logger_mt<>,
     (boost::log::keywords::severity = VerbosityError)(boost::log::keywords::channel = "error"))
-#define cerror LOG(dev::g_errorLogger::get())
+#define cerror DEV_GLOBAL_LOG(dev::VerbosityError, "error", dev::g_errorLogger::get())
 
 BOOST_LOG_INLINE_GLOBAL_LOGGER_CTOR_ARGS(g_warnLogger,
     boost::log::sources::severity_channel_logger_mt<>,
     (boost::log::keywords::severity = VerbosityWarning)(boost::log::keywords::channel = "warn"))
-#define cwarn LOG(dev::g_warnLogger::get())
+#define cwarn DEV_GLOBAL_LOG(dev::VerbosityWarning, "warn", dev::g_warnLogger::get())
 
 BOOST_LOG_INLINE_GLOBAL_LOGGER_CTOR_ARGS(g_noteLogger,
     boost::log::sources::severity_channel_logger_mt<>,
     (boost::log::keywords::severity = VerbosityInfo)(boost::log::keywords::channel = "info"))
-#define cnote LOG(dev::g_noteLogger::get())
+#define cnote DEV_GLOBAL_LOG(dev::VerbosityInfo, "info", dev::g_noteLogger::get())
 
 BOOST_LOG_INLINE_GLOBAL_LOGGER_CTOR_ARGS(g_debugLogger,
     boost::log::sources::severity_channel_logger_mt<>,
     (boost::log::keywords::severity = VerbosityDebug)(boost::log::keywords::channel = "debug"))
-#define cdebug LOG(dev::g_debugLogger::get())
+#define cdebug DEV_GLOBAL_LOG(dev::VerbosityDebug, "debug", dev::g_debugLogger::get())
 
 BOOST_LOG_INLINE_GLOBAL_LOGGER_CTOR_ARGS(g_traceLogger,
     boost::log::sources::severity_channel_logger_mt<>,
     (boost::log::keywords::severity = VerbosityTrace)(boost::log::keywords::channel = "trace"))
-#define ctrace LOG(dev::g_traceLogger::get())
+#define ctrace DEV_GLOBAL_LOG(dev::VerbosityTrace, "trace", dev::g_traceLogger::get())
 
 // Simple macro to log to any channel a message without creating a logger object
 // e.g. clog(VerbosityInfo, "channel") << "message";
 // Thread-safe
 BOOST_LOG_INLINE_GLOBAL_LOGGER_DEFAULT(
     g_clogLogger, boost::log::sources::severity_channel_logger_mt<>)
-#define clog(SEVERITY, CHANNEL)                            \
-    BOOST_LOG_STREAM_WITH_PARAMS(dev::g_clogLogger::get(), \
+#define clog(SEVERITY, CHANNEL)                                                           \
+    for (bool devLogEnabled =                                                             \
+             (SEVERITY) <= ETH_LOG_MAX_VERBOSITY && dev::isLogEnabled(SEVERITY, CHANNEL); \
+         devLogEnabled; devLogEnabled = false)                                            \
+    BOOST_LOG_STREAM_WITH_PARAMS(dev::g_clogLogger::get(),                                \
         (boost::log::keywords::severity = SEVERITY)(boost::log::keywords::channel = CHANNEL))
 
 
@@ -109,14 +202,9 @@ void setupLogging(LoggingOptions const& _options);
 
 bool isVmTraceEnabled();
 
-// Simple non-thread-safe logger with fixed severity and channel for each message
-// For better formatting it is recommended to limit channel name to max 6 characters.
-using Logger = boost::log::sources::severity_channel_logger<>;
-inline Logger createLogger(int _severity, std::string const& _channel)
-{
-    return Logger(
-        boost::log::keywords::severity = _severity, boost::log::keywords::channel = _channel);
-}
+/// @returns the number of messages dropped because the queue of the thread logging them was
+/// full.
+uint64_t droppedLogRecords();
 
 // Below overloads for both const and non-const references are needed, because without overload for
 // non-const reference generic operator<<(formatting_ostream& _strm, T& _value) will be preferred by
@@ -10,12 +10,14 @@ namespace db
 
 void MemoryDBWriteBatch::insert(Slice _key, Slice _value)
 {
+    m_killed.erase(_key.toString());
     m_batch[_key.toString()] = _value.toString();
 }
 
 void MemoryDBWriteBatch::kill(Slice _key)
 {
     m_batch.erase(_key.toString());
+    m_killed.insert(_key.toString());
 }
 
 std::string MemoryDB::lookup(Slice _key) const
@@ -65,6 +67,8 @@ void MemoryDB::commit(std::unique_ptr<WriteBatchFace> _batch)
     }
     auto const& batch = batchPtr->writeBatch();
     Guard lock(m_mutex);
+    for (auto const& key : batchPtr->killed())
+        m_db.erase(key);
     for (auto& e : batch)
     {
         m_db[e.first] = e.second;
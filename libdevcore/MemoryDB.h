@@ -8,6 +8,8 @@
 #include "Guards.h"
 #include "db.h"
 
+#include <unordered_set>
+
 namespace dev
 {
 namespace db
@@ -19,10 +21,13 @@ public:
     void kill(Slice _key) override;
 
     std::unordered_map<std::string, std::string>& writeBatch() { return m_batch; }
+    /// The keys to delete from the database, which the batch doesn't insert.
+    std::unordered_set<std::string> const& killed() const { return m_killed; }
     size_t size() { return m_batch.size(); }
 
 private:
     std::unordered_map<std::string, std::string> m_batch;
+    std::unordered_set<std::string> m_killed;
 };
 
 class MemoryDB : public DatabaseFace
@@ -0,0 +1,231 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "Metrics.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <sstream>
+
+namespace dev
+{
+namespace
+{
+unsigned highestBit(uint64_t _value)
+{
+    unsigned ret = 0;
+    while (_value >>= 1)
+        ++ret;
+    return ret;
+}
+
+std::string seriesName(std::string const& _name, std::string const& _labels)
+{
+    return _labels.empty() ? _name : _name + "{" + _labels + "}";
+}
+
+std::string withLabel(std::string const& _labels, std::string const& _label)
+{
+    return _labels.empty() ? _label : _labels + "," + _label;
+}
+
+std::string formatValue(double _value)
+{
+    std::ostringstream out;
+    out.precision(9);
+    out << _value;
+    return out.str();
+}
+
+struct Quantile
+{
+    char const* label;
+    double value;
+};
+Quantile const c_quantiles[] = {{"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}};
+
+std::string quantileLabels(std::string const& _labels, Quantile const& _q)
+{
+    return withLabel(_labels, std::string("quantile=\"") + _q.label + "\"");
+}
+}  // namespace
+
+unsigned MetricHistogram::bucket(uint64_t _value)
+{
+    if (_value < c_subBuckets)
+        return static_cast<unsigned>(_value);
+    unsigned const shift = highestBit(_value) - c_subBucketBits;
+    return (shift + 1) * c_subBuckets + static_cast<unsigned>((_value >> shift) & (c_subBuckets - 1));
+}
+
+uint64_t MetricHistogram::bucketUpperBound(unsigned _index)
+{
+    if (_index < c_subBuckets)
+        return _index;
+    unsigned const shift = _index / c_subBuckets - 1;
+    uint64_t const lower = uint64_t(c_subBuckets + _index % c_subBuckets) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+}
+
+double MetricHistogram::quantileSeconds(double _q) const
+{
+    // The buckets are read one by one while others may record, so the total is taken from them.
+    std::array<uint64_t, c_buckets> counts;
+    uint64_t total = 0;
+    for (unsigned i = 0; i < c_buckets; ++i)
+        total += counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+    if (!total)
+        return 0;
+
+    uint64_t const rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(_q * total)));
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < c_buckets; ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return bucketUpperBound(i) / 1e6;
+    }
+    return bucketUpperBound(c_buckets - 1) / 1e6;
+}
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry s_registry;
+    return s_registry;
+}
+
+MetricsRegistry::Family& MetricsRegistry::family(
+    std::string const& _name, std::string const& _help, Type _type)
+{
+    auto it = m_families.find(_name);
+    if (it == m_families.end())
+    {
+        it = m_families.emplace(_name, Family()).first;
+        it->second.type = _type;
+        it->second.help = _help;
+    }
+    assert(it->second.type == _type);
+    return it->second;
+}
+
+MetricCounter& MetricsRegistry::counter(
+    std::string const& _name, std::string const& _help, std::string const& _labels)
+{
+    Guard l(x_families);
+    auto& metric = family(_name, _help, Type::Counter).counters[_labels];
+    if (!metric)
+        metric.reset(new MetricCounter);
+    return *metric;
+}
+
+MetricGauge& MetricsRegistry::gauge(
+    std::string const& _name, std::string const& _help, std::string const& _labels)
+{
+    Guard l(x_families);
+    auto& metric = family(_name, _help, Type::Gauge).gauges[_labels];
+    if (!metric)
+        metric.reset(new MetricGauge);
+    return *metric;
+}
+
+MetricHistogram& MetricsRegistry::histogram(
+    std::string const& _name, std::string const& _help, std::string const& _labels)
+{
+    Guard l(x_families);
+    auto& metric = family(_name, _help, Type::Histogram).histograms[_labels];
+    if (!metric)
+        metric.reset(new MetricHistogram);
+    return *metric;
+}
+
+void MetricsRegistry::addCollector(void const* _owner, std::function<void()> _collect)
+{
+    Guard l(x_collectors);
+    m_collectors.emplace_back(_owner, std::move(_collect));
+}
+
+void MetricsRegistry::removeCollector(void const* _owner)
+{
+    Guard l(x_collectors);
+    m_collectors.erase(std::remove_if(m_collectors.begin(), m_collectors.end(),
+                           [&](std::pair<void const*, std::function<void()>> const& _c) {
+                               return _c.first == _owner;
+                           }),
+        m_collectors.end());
+}
+
+void MetricsRegistry::collect()
+{
+    Guard l(x_collectors);
+    for (auto const& c : m_collectors)
+        c.second();
+}
+
+std::string MetricsRegistry::exposition()
+{
+    collect();
+
+    std::ostringstream out;
+    Guard l(x_families);
+    for (auto const& f : m_families)
+    {
+        std::string const& name = f.first;
+        Family const& family = f.second;
+        out << "# HELP " << name << " " << family.help << "\n";
+        switch (family.type)
+        {
+        case Type::Counter:
+            out << "# TYPE " << name << " counter\n";
+            for (auto const& c : family.counters)
+                out << seriesName(name, c.first) << " " << c.second->value() << "\n";
+            break;
+        case Type::Gauge:
+            out << "# TYPE " << name << " gauge\n";
+            for (auto const& g : family.gauges)
+                out << seriesName(name, g.first) << " " << g.second->value() << "\n";
+            break;
+        case Type::Histogram:
+            out << "# TYPE " << name << " summary\n";
+            for (auto const& h : family.histograms)
+            {
+                for (auto const& q : c_quantiles)
+                    out << seriesName(name, quantileLabels(h.first, q)) << " "
+                        << formatValue(h.second->quantileSeconds(q.value)) << "\n";
+                out << seriesName(name + "_sum", h.first) << " "
+                    << formatValue(h.second->sumSeconds()) << "\n";
+                out << seriesName(name + "_count", h.first) << " " << h.second->count() << "\n";
+            }
+            break;
+        }
+    }
+    return out.str();
+}
+
+std::vector<std::pair<std::string, double>> MetricsRegistry::values()
+{
+    collect();
+
+    std::vector<std::pair<std::string, double>> ret;
+    Guard l(x_families);
+    for (auto const& f : m_families)
+    {
+        std::string const& name = f.first;
+        for (auto const& c : f.second.counters)
+            ret.emplace_back(seriesName(name, c.first), c.second->value());
+        for (auto const& g : f.second.gauges)
+            ret.emplace_back(seriesName(name, g.first), g.second->value());
+        for (auto const& h : f.second.histograms)
+        {
+            for (auto const& q : c_quantiles)
+                ret.emplace_back(
+                    seriesName(name, quantileLabels(h.first, q)), h.second->quantileSeconds(q.value));
+            ret.emplace_back(seriesName(name + "_sum", h.first), h.second->sumSeconds());
+            ret.emplace_back(seriesName(name + "_count", h.first), h.second->count());
+        }
+    }
+    return ret;
+}
+
+}  // namespace dev
@@ -0,0 +1,181 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Process-wide counters, gauges and latency histograms, exported in the Prometheus text format.
+#pragma once
+
+#include "Guards.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dev
+{
+/// Monotonically increasing count of events.
+class MetricCounter
+{
+public:
+    void inc(uint64_t _n = 1) { m_value.fetch_add(_n, std::memory_order_relaxed); }
+    uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> m_value{0};
+};
+
+/// Value which goes up and down, like a queue size.
+class MetricGauge
+{
+public:
+    void set(int64_t _value) { m_value.store(_value, std::memory_order_relaxed); }
+    void inc(int64_t _n = 1) { m_value.fetch_add(_n, std::memory_order_relaxed); }
+    void dec(int64_t _n = 1) { m_value.fetch_sub(_n, std::memory_order_relaxed); }
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value{0};
+};
+
+/**
+ * @brief Distribution of durations, recorded in microseconds without locking.
+ * The buckets are log-linear like those of HdrHistogram: each power of two is split into
+ * c_subBuckets buckets, so that a quantile read from them is off by at most 1/c_subBuckets.
+ */
+class MetricHistogram
+{
+public:
+    void record(uint64_t _microseconds)
+    {
+        m_buckets[bucket(_microseconds)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(_microseconds, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void recordSeconds(double _seconds)
+    {
+        record(_seconds > 0 ? static_cast<uint64_t>(_seconds * 1e6) : 0);
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    double sumSeconds() const { return m_sum.load(std::memory_order_relaxed) / 1e6; }
+
+    /// @returns the upper bound of the bucket holding the @a _q quantile, in seconds, or 0 if
+    /// nothing has been recorded.
+    double quantileSeconds(double _q) const;
+
+    /// @returns the index of the bucket of @a _value.
+    static unsigned bucket(uint64_t _value);
+    /// @returns the largest value which goes into the bucket @a _index.
+    static uint64_t bucketUpperBound(unsigned _index);
+
+    static unsigned const c_subBucketBits = 3;
+    static unsigned const c_subBuckets = 1 << c_subBucketBits;
+    static unsigned const c_buckets = (64 - c_subBucketBits + 1) * c_subBuckets;
+
+private:
+    std::array<std::atomic<uint64_t>, c_buckets> m_buckets{};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_count{0};
+};
+
+/// Records the time from its construction to its destruction into a histogram.
+class ScopedMetricTimer
+{
+public:
+    explicit ScopedMetricTimer(MetricHistogram& _histogram)
+      : m_histogram(_histogram), m_start(std::chrono::steady_clock::now())
+    {}
+    ~ScopedMetricTimer()
+    {
+        m_histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_start)
+                               .count());
+    }
+
+    ScopedMetricTimer(ScopedMetricTimer const&) = delete;
+    ScopedMetricTimer& operator=(ScopedMetricTimer const&) = delete;
+
+private:
+    MetricHistogram& m_histogram;
+    std::chrono::steady_clock::time_point const m_start;
+};
+
+/// Runs @a _f and records how long it took into @a _histogram.
+/// @returns what @a _f returns.
+template <class F>
+auto timed(MetricHistogram& _histogram, F&& _f) -> decltype(_f())
+{
+    ScopedMetricTimer const timer(_histogram);
+    return _f();
+}
+
+/**
+ * @brief The metrics of the process, by name and labels.
+ *
+ * The metrics are created on first request and live until the process exits, so the references
+ * returned can be kept and updated without going through the registry again. Labels are given
+ * in the exposition syntax, e.g. `stage="execution"`.
+ * Values which are cheaper to read on demand than to keep up to date, like queue sizes, are set
+ * by collectors run before each export.
+ */
+class MetricsRegistry
+{
+public:
+    static MetricsRegistry& instance();
+
+    MetricCounter& counter(
+        std::string const& _name, std::string const& _help, std::string const& _labels = {});
+    MetricGauge& gauge(
+        std::string const& _name, std::string const& _help, std::string const& _labels = {});
+    MetricHistogram& histogram(
+        std::string const& _name, std::string const& _help, std::string const& _labels = {});
+
+    /// Adds @a _collect to the functions run before each export, on behalf of @a _owner.
+    void addCollector(void const* _owner, std::function<void()> _collect);
+    /// Removes the collectors of @a _owner. No collector of it runs any more when this returns.
+    void removeCollector(void const* _owner);
+
+    /// @returns all metrics in the Prometheus text exposition format. Histograms are exported as
+    /// summaries.
+    std::string exposition();
+
+    /// @returns the current value of every exported series, by its name with labels.
+    std::vector<std::pair<std::string, double>> values();
+
+private:
+    enum class Type
+    {
+        Counter,
+        Gauge,
+        Histogram
+    };
+
+    struct Family
+    {
+        Type type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<MetricCounter>> counters;
+        std::map<std::string, std::unique_ptr<MetricGauge>> gauges;
+        std::map<std::string, std::unique_ptr<MetricHistogram>> histograms;
+    };
+
+    Family& family(std::string const& _name, std::string const& _help, Type _type);
+    void collect();
+
+    Mutex x_collectors;
+    std::vector<std::pair<void const*, std::function<void()>>> m_collectors;
+
+    Mutex x_families;
+    std::map<std::string, Family> m_families;
+};
+
+}  // namespace dev
@@ -1,6 +1,7 @@
 // Aleth: Ethereum C++ client, tools and libraries.
 // Copyright 2014-2019 Aleth Authors.
 // Licensed under the GNU General Public License, Version 3.
+#include <algorithm>
 #include <thread>
 #include <libdevcore/db.h>
 #include <libdevcore/Common.h>
@@ -27,11 +28,36 @@ inline db::Slice toSlice(bytes const& _b)
     return db::Slice(reinterpret_cast<char const*>(&_b[0]), _b.size());
 }
 
+/// Suffixes of the keys of the records kept next to the nodes, which are keyed by their hash only.
+byte const c_refCountSuffix = 254;
+byte const c_journalSuffix = 253;
+byte const c_eraSuffix = 252;
+
+/// Present in a reference counted disk DB.
+char const* const c_refCountingKey = "refCounting";
+
+inline bytes suffixedKey(h256 const& _h, byte _suffix)
+{
+    bytes b = _h.asBytes();
+    b.push_back(_suffix);
+    return b;
+}
+
 }  // namespace
 
 OverlayDB::~OverlayDB() = default;
 
 void OverlayDB::commit()
+{
+    commit(0, nullptr);
+}
+
+void OverlayDB::commit(uint64_t _era, h256 const& _id)
+{
+    commit(_era, &_id);
+}
+
+void OverlayDB::commit(uint64_t _era, h256 const* _id)
 {
     if (m_db)
     {
@@ -41,19 +67,31 @@ void OverlayDB::commit()
         DEV_READ_GUARDED(x_this)
 #endif
         {
-            for (auto const& i: m_main)
+            // references added to the nodes in the disk DB
+            std::unordered_map<h256, unsigned> inserted;
+            for (auto const& i: *m_main)
             {
                 if (i.second.second)
-                    writeBatch->insert(toSlice(i.first), toSlice(i.second.first));
+                {
+                    if (m_refCounting)
+                        inserted[i.first] = i.second.second;
+                    else
+                        writeBatch->insert(toSlice(i.first), toSlice(i.second.first));
+                }
 //              cnote << i.first << "#" << m_main[i.first].second;
             }
-            for (auto const& i: m_aux)
+            for (auto const& i: *m_aux)
                 if (i.second.second)
                 {
                     bytes b = i.first.asBytes();
                     b.push_back(255);   // for aux
                     writeBatch->insert(toSlice(b), toSlice(i.second.first));
                 }
+
+            if (m_refCounting && _id)
+                journal(*writeBatch, _era, *_id, inserted);
+            else if (m_refCounting)
+                settle(*writeBatch, inserted);
         }
 
         for (unsigned i = 0; i < 10; ++i)
@@ -79,12 +117,169 @@ void OverlayDB::commit()
         DEV_WRITE_GUARDED(x_this)
 #endif
         {
-            m_aux.clear();
-            m_main.clear();
+            m_aux.reset();
+            m_main.reset();
         }
+        m_killed.clear();
     }
 }
 
+void OverlayDB::journal(db::WriteBatchFace& _batch, uint64_t _era, h256 const& _id,
+    std::unordered_map<h256, unsigned> const& _inserted) const
+{
+    for (auto const& i : _inserted)
+    {
+        _batch.insert(toSlice(i.first), toSlice(m_main->at(i.first).first));
+        bytes const count = rlp(refCount(i.first) + i.second);
+        _batch.insert(toSlice(suffixedKey(i.first, c_refCountSuffix)), toSlice(count));
+    }
+
+    // Committing under the same id again adds to its journal, the references of the earlier
+    // commits are undone or kept with these.
+    std::unordered_map<h256, unsigned> added = _inserted;
+    std::unordered_map<h256, unsigned> removed = m_killed;
+    bytes const journalKey = suffixedKey(_id, c_journalSuffix);
+    std::string const previous = m_db->lookup(toSlice(journalKey));
+    if (!previous.empty())
+    {
+        RLP const entry(previous);
+        for (auto const& reference : entry[0])
+            added[reference[0].toHash<h256>()] += reference[1].toInt<unsigned>();
+        for (auto const& reference : entry[1])
+            removed[reference[0].toHash<h256>()] += reference[1].toInt<unsigned>();
+    }
+
+    RLPStream entry(2);
+    entry.appendList(added.size());
+    for (auto const& i : added)
+        entry.appendList(2) << i.first << i.second;
+    entry.appendList(removed.size());
+    for (auto const& i : removed)
+        entry.appendList(2) << i.first << i.second;
+    _batch.insert(toSlice(journalKey), toSlice(entry.out()));
+
+    bytes const eraKey = suffixedKey(h256(_era), c_eraSuffix);
+    h256s ids;
+    std::string const eraIds = m_db->lookup(toSlice(eraKey));
+    if (!eraIds.empty())
+        ids = RLP(eraIds).toVector<h256>();
+    if (std::find(ids.begin(), ids.end(), _id) == ids.end())
+    {
+        ids.push_back(_id);
+        _batch.insert(toSlice(eraKey), toSlice(rlp(ids)));
+    }
+}
+
+void OverlayDB::settle(
+    db::WriteBatchFace& _batch, std::unordered_map<h256, unsigned> const& _inserted) const
+{
+    std::unordered_map<h256, int64_t> changes;
+    for (auto const& i : _inserted)
+        changes[i.first] += i.second;
+    for (auto const& i : m_killed)
+        changes[i.first] -= i.second;
+
+    for (auto const& i : changes)
+    {
+        int64_t const previous = refCount(i.first);
+        // nodes written without being counted, like the empty trie, are never deleted
+        if (!previous && !_inserted.count(i.first))
+            continue;
+
+        int64_t const count = previous + i.second;
+        bytes const countKey = suffixedKey(i.first, c_refCountSuffix);
+        if (count > 0)
+        {
+            if (_inserted.count(i.first))
+                _batch.insert(toSlice(i.first), toSlice(m_main->at(i.first).first));
+            _batch.insert(toSlice(countKey), toSlice(rlp(static_cast<unsigned>(count))));
+        }
+        else
+        {
+            _batch.kill(toSlice(i.first));
+            _batch.kill(toSlice(countKey));
+            if (m_nodeCache)
+                m_nodeCache->remove(i.first);
+        }
+    }
+}
+
+void OverlayDB::setRefCounting(bool _refCounting)
+{
+    if (m_db)
+    {
+        bool const counted = m_db->exists(db::Slice(c_refCountingKey));
+        if (_refCounting && !counted)
+        {
+            bool empty = true;
+            m_db->forEach([&](db::Slice, db::Slice) { return empty = false; });
+            if (!empty)
+                BOOST_THROW_EXCEPTION(RefCountingMismatch());
+            m_db->insert(db::Slice(c_refCountingKey), db::Slice("1"));
+        }
+        else if (!_refCounting && counted)
+            BOOST_THROW_EXCEPTION(RefCountingMismatch());
+    }
+    m_refCounting = _refCounting;
+}
+
+unsigned OverlayDB::refCount(h256 const& _h) const
+{
+    std::string const count = m_db->lookup(toSlice(suffixedKey(_h, c_refCountSuffix)));
+    return count.empty() ? 0 : RLP(count).toInt<unsigned>();
+}
+
+unsigned OverlayDB::markCanonical(uint64_t _era, h256 const& _canonicalId)
+{
+    if (!m_db || !m_refCounting)
+        return 0;
+
+    bytes const eraKey = suffixedKey(h256(_era), c_eraSuffix);
+    std::string const eraIds = m_db->lookup(toSlice(eraKey));
+    if (eraIds.empty())
+        return 0;
+
+    auto writeBatch = m_db->createWriteBatch();
+
+    // The canonical commit keeps the references it added, the others are undone.
+    std::unordered_map<h256, unsigned> removed;
+    for (auto const& id : RLP(eraIds).toVector<h256>())
+    {
+        bytes const journalKey = suffixedKey(id, c_journalSuffix);
+        std::string const entry = m_db->lookup(toSlice(journalKey));
+        if (entry.empty())
+            continue;
+        for (auto const& reference : RLP(entry)[id == _canonicalId ? 1 : 0])
+            removed[reference[0].toHash<h256>()] += reference[1].toInt<unsigned>();
+        writeBatch->kill(toSlice(journalKey));
+    }
+
+    unsigned deleted = 0;
+    for (auto const& i : removed)
+    {
+        bytes const countKey = suffixedKey(i.first, c_refCountSuffix);
+        std::string const countRlp = m_db->lookup(toSlice(countKey));
+        // nodes written without being counted, like the empty trie, are never deleted
+        if (countRlp.empty())
+            continue;
+
+        unsigned const count = RLP(countRlp).toInt<unsigned>();
+        if (count > i.second)
+            writeBatch->insert(toSlice(countKey), toSlice(rlp(count - i.second)));
+        else
+        {
+            writeBatch->kill(toSlice(i.first));
+            writeBatch->kill(toSlice(countKey));
+            if (m_nodeCache)
+                m_nodeCache->remove(i.first);
+            ++deleted;
+        }
+    }
+    writeBatch->kill(toSlice(eraKey));
+    m_db->commit(std::move(writeBatch));
+    return deleted;
+}
+
 bytes OverlayDB::lookupAux(h256 const& _h) const
 {
     bytes ret = StateCacheDB::lookupAux(_h);
@@ -105,7 +300,8 @@ void OverlayDB::rollback()
 #if DEV_GUARDED_DB
     WriteGuard l(x_this);
 #endif
-    m_main.clear();
+    m_main.reset();
+    m_killed.clear();
 }
 
 std::string OverlayDB::lookup(h256 const& _h) const
@@ -114,6 +310,8 @@ std::string OverlayDB::lookup(h256 const& _h) const
     if (!ret.empty() || !m_db)
         return ret;
 
+    if (m_nodeCache && m_nodeCache->find(_h, ret))
+        return ret;
     return m_db->lookup(toSlice(_h));
 }
 
@@ -128,6 +326,10 @@ void OverlayDB::kill(h256 const& _h)
 {
     if (!StateCacheDB::kill(_h))
     {
+        // a reference to a node in the disk DB
+        if (m_refCounting)
+            ++m_killed[_h];
+
         if (m_db)
         {
             if (!m_db->exists(toSlice(_h)))
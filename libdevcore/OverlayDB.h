@@ -7,11 +7,14 @@
 #include <memory>
 #include <libdevcore/db.h>
 #include <libdevcore/Common.h>
+#include <libdevcore/Exceptions.h>
 #include <libdevcore/Log.h>
 #include <libdevcore/StateCacheDB.h>
+#include <libdevcore/TrieNodeCache.h>
 
 namespace dev
 {
+DEV_SIMPLE_EXCEPTION(RefCountingMismatch);
 
 class OverlayDB: public StateCacheDB
 {
@@ -32,9 +35,34 @@ public:
     OverlayDB(OverlayDB&&) = default;
     OverlayDB& operator=(OverlayDB&&) = default;
 
+    /// Writes the overlay to the disk DB. With reference counting, the references the commit
+    /// removes are dropped right away, as there is no journal to settle later.
     void commit();
+    /// Like commit(), and with reference counting records the references to the nodes added and
+    /// removed by the commit in the journal of era @a _era, under @a _id. A commit under an id
+    /// which has a journal adds to it.
+    void commit(uint64_t _era, h256 const& _id);
 	void rollback();
 
+    /// Switches on the persistent reference counting of the nodes in the disk DB, which
+    /// markCanonical() needs for deleting them. A disk DB has to be reference counted from its
+    /// creation on, so throws RefCountingMismatch if @a _refCounting is true for a DB with nodes
+    /// which are not counted, or false for a DB which is.
+    void setRefCounting(bool _refCounting);
+    bool refCounting() const { return m_refCounting; }
+
+    /// Settles the journal of era @a _era once the commit @a _canonicalId is final: the
+    /// references it removed are dropped, as well as those the other commits of the era added.
+    /// The nodes left without references are deleted from the disk DB.
+    /// @returns the number of nodes deleted.
+    unsigned markCanonical(uint64_t _era, h256 const& _canonicalId);
+
+    /// Makes lookup() read the nodes missing from the overlay from @a _cache before the disk DB,
+    /// and markCanonical() drop the nodes it deletes from @a _cache. The copies of this OverlayDB
+    /// share the cache.
+    void setNodeCache(std::shared_ptr<TrieNodeCache> _cache) { m_nodeCache = std::move(_cache); }
+    std::shared_ptr<TrieNodeCache> const& nodeCache() const { return m_nodeCache; }
+
 	std::string lookup(h256 const& _h) const;
 	bool exists(h256 const& _h) const;
 	void kill(h256 const& _h);
@@ -44,7 +72,24 @@ public:
 private:
 	using StateCacheDB::clear;
 
+    void commit(uint64_t _era, h256 const* _id);
+    /// Writes to @a _batch the nodes @a _inserted with their increased reference counts, and the
+    /// journal of @a _id recording them and m_killed.
+    void journal(db::WriteBatchFace& _batch, uint64_t _era, h256 const& _id,
+        std::unordered_map<h256, unsigned> const& _inserted) const;
+    /// Writes to @a _batch the nodes @a _inserted with the reference counts changed by them and
+    /// m_killed, deleting the nodes left without references.
+    void settle(
+        db::WriteBatchFace& _batch, std::unordered_map<h256, unsigned> const& _inserted) const;
+    unsigned refCount(h256 const& _h) const;
+
     std::shared_ptr<db::DatabaseFace> m_db;
+    std::shared_ptr<TrieNodeCache> m_nodeCache;
+
+    bool m_refCounting = false;
+    /// References removed from the nodes in the disk DB since the last commit, when reference
+    /// counting.
+    std::unordered_map<h256, unsigned> m_killed;
 };
 
 }
@@ -0,0 +1,181 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Queue of many producer threads and one consumer made of a ring buffer per producer.
+#pragma once
+
+#include "Guards.h"
+#include "RingBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace dev
+{
+/**
+ * @brief Bounded queue which any thread pushes to and one thread at a time pops from. Each
+ * producing thread has its own ring buffer, so producers don't contend with each other nor with
+ * the consumer. The consumer merges the buffers by the sequence numbers the values get as they
+ * are pushed. The order across threads is approximate: a value may be pushed after a value with
+ * a later sequence number has already been popped.
+ * A thread whose buffer is full drops its values, see dropped().
+ */
+template <class T>
+class PerThreadQueue
+{
+public:
+    /// @param _capacity number of values a thread can push before its values are dropped
+    explicit PerThreadQueue(size_t _capacity) : m_id(++s_lastId), m_capacity(_capacity) {}
+
+    PerThreadQueue(PerThreadQueue const&) = delete;
+    PerThreadQueue& operator=(PerThreadQueue const&) = delete;
+
+    /// @returns false if the buffer of the calling thread is full, the value is dropped then.
+    bool push(T _value)
+    {
+        Entry entry{m_lastSequence.fetch_add(1, std::memory_order_relaxed), std::move(_value)};
+        if (!threadRing().buffer.push(std::move(entry)))
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /// Takes the oldest value of all threads.
+    /// @returns false if all buffers are empty.
+    bool pop(T& o_value)
+    {
+        Guard l(x_consumer);
+        if (m_readVersion != m_ringsVersion.load())
+        {
+            Guard l2(x_rings);
+            m_readRings = m_rings;
+            m_readVersion = m_ringsVersion;
+        }
+
+        Ring* oldest = nullptr;
+        uint64_t oldestSequence = 0;
+        for (auto const& ring : m_readRings)
+            if (Entry const* entry = ring->buffer.front())
+                if (!oldest || entry->sequence < oldestSequence)
+                {
+                    oldest = ring.get();
+                    oldestSequence = entry->sequence;
+                }
+
+        if (!oldest)
+        {
+            dropClosedRings();
+            return false;
+        }
+
+        Entry entry;
+        oldest->buffer.pop(entry);
+        o_value = std::move(entry.value);
+        return true;
+    }
+
+    /// @returns true if all buffers are empty. Called by the consumer only.
+    bool empty() const
+    {
+        Guard l(x_consumer);
+        return std::all_of(m_readRings.begin(), m_readRings.end(),
+            [](std::shared_ptr<Ring> const& _ring) { return _ring->buffer.empty(); });
+    }
+
+    /// @returns the number of values dropped because the buffer of the pushing thread was full.
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /// @returns the number of buffers, those of the threads which have exited are released when
+    /// they are empty.
+    size_t threadCount() const
+    {
+        Guard l(x_rings);
+        return m_rings.size();
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t sequence = 0;
+        T value;
+    };
+
+    struct Ring
+    {
+        explicit Ring(size_t _capacity) : buffer(_capacity) {}
+
+        SpscRingBuffer<Entry> buffer;
+        /// Set when the thread has exited.
+        std::atomic<bool> closed{false};
+    };
+
+    /// The rings of the current thread, by queue.
+    struct ThreadRings
+    {
+        ~ThreadRings()
+        {
+            for (auto const& ring : rings)
+                ring.second->closed = true;
+        }
+
+        std::vector<std::pair<unsigned, std::shared_ptr<Ring>>> rings;
+    };
+
+    Ring& threadRing()
+    {
+        thread_local ThreadRings t_rings;
+        for (auto const& ring : t_rings.rings)
+            if (ring.first == m_id)
+                return *ring.second;
+
+        auto ring = std::make_shared<Ring>(m_capacity);
+        {
+            Guard l(x_rings);
+            m_rings.push_back(ring);
+            ++m_ringsVersion;
+        }
+        t_rings.rings.emplace_back(m_id, ring);
+        return *ring;
+    }
+
+    void dropClosedRings()
+    {
+        Guard l(x_rings);
+        auto const closed = std::remove_if(m_rings.begin(), m_rings.end(),
+            [](std::shared_ptr<Ring> const& _ring) { return _ring->closed && _ring->buffer.empty(); });
+        if (closed != m_rings.end())
+        {
+            m_rings.erase(closed, m_rings.end());
+            ++m_ringsVersion;
+        }
+    }
+
+    /// Distinguishes the rings of the queues in the thread's ThreadRings, ids are not reused.
+    static std::atomic<unsigned> s_lastId;
+    unsigned const m_id;
+    size_t const m_capacity;
+
+    std::atomic<uint64_t> m_lastSequence{0};
+    std::atomic<uint64_t> m_dropped{0};
+
+    mutable Mutex x_rings;
+    std::vector<std::shared_ptr<Ring>> m_rings;
+    std::atomic<unsigned> m_ringsVersion{0};
+
+    /// The rings as seen by the consumer.
+    mutable Mutex x_consumer;
+    std::vector<std::shared_ptr<Ring>> m_readRings;
+    unsigned m_readVersion = 0;
+};
+
+template <class T>
+std::atomic<unsigned> PerThreadQueue<T>::s_lastId{0};
+
+}  // namespace dev
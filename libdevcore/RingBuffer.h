@@ -0,0 +1,88 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Fixed-size lock-free queue between one producer and one consumer thread.
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace dev
+{
+/**
+ * @brief Bounded FIFO queue which one thread pushes to and another pops from without locking.
+ * The capacity is rounded up to a power of two; push() fails when the queue is full.
+ */
+template <class T>
+class SpscRingBuffer
+{
+public:
+    explicit SpscRingBuffer(size_t _capacity) : m_slots(roundUp(_capacity)), m_mask(m_slots.size() - 1) {}
+
+    SpscRingBuffer(SpscRingBuffer const&) = delete;
+    SpscRingBuffer& operator=(SpscRingBuffer const&) = delete;
+
+    /// Called by the producer only.
+    /// @returns false if the queue is full.
+    bool push(T _value)
+    {
+        size_t const tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == m_slots.size())
+            return false;
+        m_slots[tail & m_mask] = std::move(_value);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Called by the consumer only.
+    /// @returns the oldest value or nullptr if the queue is empty. The pointer is valid until the
+    /// next pop().
+    T* front()
+    {
+        size_t const head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+            return nullptr;
+        return &m_slots[head & m_mask];
+    }
+
+    /// Called by the consumer only, removes the oldest value into @a o_value.
+    /// @returns false if the queue is empty.
+    bool pop(T& o_value)
+    {
+        T* value = front();
+        if (!value)
+            return false;
+        o_value = std::move(*value);
+        *value = T();
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return m_slots.size(); }
+
+private:
+    static size_t roundUp(size_t _capacity)
+    {
+        size_t ret = 1;
+        while (ret < _capacity)
+            ret <<= 1;
+        return ret;
+    }
+
+    std::vector<T> m_slots;
+    size_t const m_mask;
+    /// The index of the next value to pop, written by the consumer.
+    alignas(64) std::atomic<size_t> m_head{0};
+    /// The index of the next value to push, written by the producer.
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+}  // namespace dev
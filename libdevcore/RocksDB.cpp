@@ -4,6 +4,7 @@
 
 #include "RocksDB.h"
 #include "Assertions.h"
+#include "Metrics.h"
 
 namespace dev
 {
@@ -15,6 +16,26 @@ namespace
 using errinfo_rocksdbStatusCode = boost::error_info<struct tag_rocksdbStatusCode, rocksdb::Status::Code>;
 using errinfo_rocksdbStatusSubCode = boost::error_info<struct tag_rocksdbStatusSubCode, rocksdb::Status::SubCode>;
 
+struct Latencies
+{
+    MetricHistogram& read;
+    MetricHistogram& write;
+    MetricHistogram& commit;
+};
+
+MetricHistogram& latency(char const* _operation)
+{
+    return MetricsRegistry::instance().histogram("aleth_db_operation_seconds",
+        "Latency of database operations.",
+        std::string("backend=\"rocksdb\",operation=\"") + _operation + "\"");
+}
+
+Latencies const& latencies()
+{
+    static Latencies const s_latencies{latency("read"), latency("write"), latency("commit")};
+    return s_latencies;
+}
+
 DatabaseStatus toDatabaseStatus(rocksdb::Status const& _status)
 {
     switch (_status.code())
@@ -116,7 +137,8 @@ std::string RocksDB::lookup(Slice _key) const
 {
     rocksdb::Slice const key(_key.data(), _key.size());
     std::string value;
-    auto const status = m_db->Get(m_readOptions, key, &value);
+    auto const status =
+        timed(latencies().read, [&] { return m_db->Get(m_readOptions, key, &value); });
     if (status.IsNotFound())
         return std::string();
 
@@ -131,7 +153,8 @@ bool RocksDB::exists(Slice _key) const
     if (!m_db->KeyMayExist(m_readOptions, key, &value, nullptr))
         return false;
 
-    auto const status = m_db->Get(m_readOptions, key, &value);
+    auto const status =
+        timed(latencies().read, [&] { return m_db->Get(m_readOptions, key, &value); });
     if (status.IsNotFound())
         return false;
 
@@ -143,14 +166,16 @@ void RocksDB::insert(Slice _key, Slice _value)
 {
     rocksdb::Slice const key(_key.data(), _key.size());
     rocksdb::Slice const value(_value.data(), _value.size());
-    auto const status = m_db->Put(m_writeOptions, key, value);
+    auto const status =
+        timed(latencies().write, [&] { return m_db->Put(m_writeOptions, key, value); });
     checkStatus(status);
 }
 
 void RocksDB::kill(Slice _key)
 {
     rocksdb::Slice const key(_key.data(), _key.size());
-    auto const status = m_db->Delete(m_writeOptions, key);
+    auto const status =
+        timed(latencies().write, [&] { return m_db->Delete(m_writeOptions, key); });
     checkStatus(status);
 }
 
@@ -168,7 +193,8 @@ void RocksDB::commit(std::unique_ptr<WriteBatchFace> _batch)
     if (!batchPtr)
         BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("Invalid batch type passed to rocksdb::commit"));
 
-    auto const status = m_db->Write(m_writeOptions, &batchPtr->writeBatch());
+    auto const status = timed(latencies().commit,
+        [&] { return m_db->Write(m_writeOptions, &batchPtr->writeBatch()); });
     checkStatus(status);
 }
 
@@ -16,7 +16,7 @@ std::unordered_map<h256, std::string> StateCacheDB::get() const
     ReadGuard l(x_this);
 #endif
     std::unordered_map<h256, std::string> ret;
-    for (auto const& i: m_main)
+    for (auto const& i: *m_main)
         if (!m_enforceRefs || i.second.second > 0)
             ret.insert(make_pair(i.first, i.second.first));
     return ret;
@@ -40,8 +40,8 @@ std::string StateCacheDB::lookup(h256 const& _h) const
 #if DEV_GUARDED_DB
     ReadGuard l(x_this);
 #endif
-    auto it = m_main.find(_h);
-    if (it != m_main.end())
+    auto it = m_main->find(_h);
+    if (it != m_main->end())
     {
         if (!m_enforceRefs || it->second.second > 0)
             return it->second.first;
@@ -56,8 +56,8 @@ bool StateCacheDB::exists(h256 const& _h) const
 #if DEV_GUARDED_DB
     ReadGuard l(x_this);
 #endif
-    auto it = m_main.find(_h);
-    if (it != m_main.end() && (!m_enforceRefs || it->second.second > 0))
+    auto it = m_main->find(_h);
+    if (it != m_main->end() && (!m_enforceRefs || it->second.second > 0))
         return true;
     return false;
 }
@@ -67,14 +67,15 @@ void StateCacheDB::insert(h256 const& _h, bytesConstRef _v)
 #if DEV_GUARDED_DB
     WriteGuard l(x_this);
 #endif
-    auto it = m_main.find(_h);
-    if (it != m_main.end())
+    auto& main = m_main.mut();
+    auto it = main.find(_h);
+    if (it != main.end())
     {
         it->second.first = _v.toString();
         it->second.second++;
     }
     else
-        m_main[_h] = make_pair(_v.toString(), 1);
+        main[_h] = make_pair(_v.toString(), 1);
 }
 
 bool StateCacheDB::kill(h256 const& _h)
@@ -82,13 +83,11 @@ bool StateCacheDB::kill(h256 const& _h)
 #if DEV_GUARDED_DB
     ReadGuard l(x_this);
 #endif
-    if (m_main.count(_h))
+    auto it = m_main->find(_h);
+    if (it != m_main->end() && it->second.second > 0)
     {
-        if (m_main[_h].second > 0)
-        {
-            m_main[_h].second--;
-            return true;
-        }
+        m_main.mut()[_h].second--;
+        return true;
     }
     return false;
 }
@@ -98,8 +97,8 @@ bytes StateCacheDB::lookupAux(h256 const& _h) const
 #if DEV_GUARDED_DB
     ReadGuard l(x_this);
 #endif
-    auto it = m_aux.find(_h);
-    if (it != m_aux.end() && (!m_enforceRefs || it->second.second))
+    auto it = m_aux->find(_h);
+    if (it != m_aux->end() && (!m_enforceRefs || it->second.second))
         return it->second.first;
     return bytes();
 }
@@ -109,7 +108,7 @@ void StateCacheDB::removeAux(h256 const& _h)
 #if DEV_GUARDED_DB
     WriteGuard l(x_this);
 #endif
-    m_aux[_h].second = false;
+    m_aux.mut()[_h].second = false;
 }
 
 void StateCacheDB::insertAux(h256 const& _h, bytesConstRef _v)
@@ -117,7 +116,7 @@ void StateCacheDB::insertAux(h256 const& _h, bytesConstRef _v)
 #if DEV_GUARDED_DB
     WriteGuard l(x_this);
 #endif
-    m_aux[_h] = make_pair(_v.toBytes(), true);
+    m_aux.mut()[_h] = make_pair(_v.toBytes(), true);
 }
 
 void StateCacheDB::purge()
@@ -126,18 +125,20 @@ void StateCacheDB::purge()
     WriteGuard l(x_this);
 #endif
     // purge m_main
-    for (auto it = m_main.begin(); it != m_main.end(); )
+    auto& main = m_main.mut();
+    for (auto it = main.begin(); it != main.end(); )
         if (it->second.second)
             ++it;
         else
-            it = m_main.erase(it);
+            it = main.erase(it);
 
     // purge m_aux
-    for (auto it = m_aux.begin(); it != m_aux.end(); )
+    auto& aux = m_aux.mut();
+    for (auto it = aux.begin(); it != aux.end(); )
         if (it->second.second)
             ++it;
         else
-            it = m_aux.erase(it);
+            it = aux.erase(it);
 }
 
 h256Hash StateCacheDB::keys() const
@@ -146,7 +147,7 @@ h256Hash StateCacheDB::keys() const
     ReadGuard l(x_this);
 #endif
     h256Hash ret;
-    for (auto const& i: m_main)
+    for (auto const& i: *m_main)
         if (i.second.second)
             ret.insert(i.first);
     return ret;
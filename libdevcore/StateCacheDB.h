@@ -4,6 +4,7 @@
 #pragma once
 
 #include "Common.h"
+#include "CopyOnWrite.h"
 #include "Log.h"
 #include "RLP.h"
 
@@ -23,8 +24,8 @@ public:
 
     void clear()
     {
-        m_main.clear();
-        m_aux.clear();
+        m_main.reset();
+        m_aux.reset();
     }  // WARNING !!!! didn't originally clear m_refCount!!!
     std::unordered_map<h256, std::string> get() const;
 
@@ -44,8 +45,9 @@ protected:
 #if DEV_GUARDED_DB
     mutable SharedMutex x_this;
 #endif
-    std::unordered_map<h256, std::pair<std::string, unsigned>> m_main;
-    std::unordered_map<h256, std::pair<bytes, bool>> m_aux;
+    // copies of the DB share the nodes until one of them is modified
+    CopyOnWrite<std::unordered_map<h256, std::pair<std::string, unsigned>>> m_main;
+    CopyOnWrite<std::unordered_map<h256, std::pair<bytes, bool>>> m_aux;
 
     mutable bool m_enforceRefs = false;
 };
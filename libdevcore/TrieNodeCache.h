@@ -0,0 +1,114 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Thread-safe cache of the trie nodes read ahead of their use from the disk database.
+#pragma once
+
+#include "FixedHash.h"
+#include "Guards.h"
+#include "LruCache.h"
+#include "Metrics.h"
+
+#include <algorithm>
+#include <array>
+#include <memory>
+
+namespace dev
+{
+/**
+ * @brief Bounded cache of the trie nodes of the disk database, by hash, which OverlayDB consults
+ * before reading the disk database. It is filled from other threads which walk the paths a
+ * block is going to touch, see eth::TriePrefetcher.
+ * The entries are spread over shards locked separately; a full shard drops its least recently
+ * used entry.
+ */
+class TrieNodeCache
+{
+public:
+    /// Creates a cache of at most @a _capacity nodes.
+    explicit TrieNodeCache(size_t _capacity = c_defaultCapacity)
+    {
+        for (auto& s : m_shards)
+            s.cache.reset(new LruCache<h256, std::string>(std::max<size_t>(1, _capacity / c_shards)));
+    }
+
+    void insert(h256 const& _hash, std::string const& _node)
+    {
+        Shard& s = shard(_hash);
+        Guard l(s.x_cache);
+        s.cache->insert(_hash, _node);
+    }
+
+    /// Reads the node @a _hash into @a o_node.
+    /// @returns false if it isn't cached.
+    bool find(h256 const& _hash, std::string& o_node)
+    {
+        Shard& s = shard(_hash);
+        Guard l(s.x_cache);
+        if (std::string const* node = s.cache->find(_hash))
+        {
+            o_node = *node;
+            m_hits.inc();
+            return true;
+        }
+        m_misses.inc();
+        return false;
+    }
+
+    bool contains(h256 const& _hash)
+    {
+        Shard& s = shard(_hash);
+        Guard l(s.x_cache);
+        return s.cache->contains(_hash);
+    }
+
+    void remove(h256 const& _hash)
+    {
+        Shard& s = shard(_hash);
+        Guard l(s.x_cache);
+        s.cache->remove(_hash);
+    }
+
+    void clear()
+    {
+        for (auto& s : m_shards)
+        {
+            Guard l(s.x_cache);
+            s.cache->clear();
+        }
+    }
+
+    size_t size()
+    {
+        size_t ret = 0;
+        for (auto& s : m_shards)
+        {
+            Guard l(s.x_cache);
+            ret += s.cache->size();
+        }
+        return ret;
+    }
+
+    static size_t const c_defaultCapacity = 262144;
+
+private:
+    static size_t const c_shards = 16;
+
+    struct Shard
+    {
+        Mutex x_cache;
+        std::unique_ptr<LruCache<h256, std::string>> cache;
+    };
+
+    Shard& shard(h256 const& _hash) { return m_shards[_hash[0] % c_shards]; }
+
+    std::array<Shard, c_shards> m_shards;
+    MetricCounter& m_hits = MetricsRegistry::instance().counter(
+        "aleth_cache_lookups_total", "Lookups of caches.", "cache=\"trie_node\",result=\"hit\"");
+    MetricCounter& m_misses = MetricsRegistry::instance().counter(
+        "aleth_cache_lookups_total", "Lookups of caches.", "cache=\"trie_node\",result=\"miss\"");
+};
+
+}  // namespace dev
@@ -0,0 +1,204 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+#include "WriteBehindDB.h"
+#include "Log.h"
+#include "MemoryDB.h"
+
+#include <algorithm>
+
+namespace dev
+{
+namespace db
+{
+WriteQueue::WriteQueue(unsigned _maxQueued)
+  : m_maxQueued(std::max(_maxQueued, 1u)), m_thread([this]() { run(); })
+{}
+
+WriteQueue::~WriteQueue()
+{
+    {
+        Guard l(x_queue);
+        m_stop = true;
+    }
+    m_changed.notify_all();
+    m_thread.join();
+}
+
+void WriteQueue::flush()
+{
+    UniqueGuard l(x_queue);
+    m_changed.wait(l, [&]() { return m_queue.empty() && !m_writing; });
+    if (m_error)
+        std::rethrow_exception(m_error);
+}
+
+void WriteQueue::push(std::function<void()> _write)
+{
+    {
+        UniqueGuard l(x_queue);
+        m_changed.wait(l, [&]() { return m_error || m_queue.size() < m_maxQueued; });
+        if (m_error)
+            std::rethrow_exception(m_error);
+        m_queue.push_back(std::move(_write));
+    }
+    m_changed.notify_all();
+}
+
+void WriteQueue::run()
+{
+    while (true)
+    {
+        std::function<void()> write;
+        {
+            UniqueGuard l(x_queue);
+            m_changed.wait(l, [&]() { return m_stop || !m_queue.empty(); });
+            if (m_queue.empty())
+                return;
+            write = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_writing = true;
+        }
+        m_changed.notify_all();
+
+        std::exception_ptr error;
+        try
+        {
+            write();
+        }
+        catch (...)
+        {
+            cwarn << "Error writing to database: "
+                  << boost::current_exception_diagnostic_information();
+            error = std::current_exception();
+        }
+
+        {
+            Guard l(x_queue);
+            m_writing = false;
+            if (error)
+            {
+                // the writes after a failed one would leave the databases in a state they
+                // can't be in otherwise
+                m_error = error;
+                m_queue.clear();
+            }
+        }
+        m_changed.notify_all();
+    }
+}
+
+WriteBehindDB::WriteBehindDB(std::unique_ptr<DatabaseFace> _db, std::shared_ptr<WriteQueue> _queue)
+  : m_db(std::move(_db)), m_queue(std::move(_queue))
+{}
+
+WriteBehindDB::~WriteBehindDB()
+{
+    // the queued writes refer to this
+    try
+    {
+        m_queue->flush();
+    }
+    catch (...)
+    {
+    }
+}
+
+std::string WriteBehindDB::lookup(Slice _key) const
+{
+    {
+        Guard l(x_pending);
+        auto const it = m_pending.find(_key.toString());
+        if (it != m_pending.end())
+            return it->second.killed ? std::string() : it->second.value;
+    }
+    return m_db->lookup(_key);
+}
+
+bool WriteBehindDB::exists(Slice _key) const
+{
+    {
+        Guard l(x_pending);
+        auto const it = m_pending.find(_key.toString());
+        if (it != m_pending.end())
+            return !it->second.killed;
+    }
+    return m_db->exists(_key);
+}
+
+void WriteBehindDB::insert(Slice _key, Slice _value)
+{
+    auto batch = createWriteBatch();
+    batch->insert(_key, _value);
+    commit(std::move(batch));
+}
+
+void WriteBehindDB::kill(Slice _key)
+{
+    auto batch = createWriteBatch();
+    batch->kill(_key);
+    commit(std::move(batch));
+}
+
+std::unique_ptr<WriteBatchFace> WriteBehindDB::createWriteBatch() const
+{
+    return std::unique_ptr<WriteBatchFace>(new MemoryDBWriteBatch);
+}
+
+void WriteBehindDB::commit(std::unique_ptr<WriteBatchFace> _batch)
+{
+    if (!_batch)
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment("Cannot commit null batch"));
+    if (!dynamic_cast<MemoryDBWriteBatch*>(_batch.get()))
+        BOOST_THROW_EXCEPTION(DatabaseError() << errinfo_comment(
+                                  "Invalid batch type passed to WriteBehindDB::commit"));
+    std::shared_ptr<MemoryDBWriteBatch> const batch{
+        static_cast<MemoryDBWriteBatch*>(_batch.release())};
+
+    uint64_t number = 0;
+    {
+        Guard l(x_pending);
+        number = ++m_lastCommit;
+        for (auto const& key : batch->killed())
+            m_pending[key] = Pending{number, true, {}};
+        for (auto const& record : batch->writeBatch())
+            m_pending[record.first] = Pending{number, false, record.second};
+    }
+
+    m_queue->push([this, batch, number]() {
+        auto dbBatch = m_db->createWriteBatch();
+        for (auto const& key : batch->killed())
+            dbBatch->kill(Slice(key.data(), key.size()));
+        for (auto const& record : batch->writeBatch())
+            dbBatch->insert(Slice(record.first.data(), record.first.size()),
+                Slice(record.second.data(), record.second.size()));
+        m_db->commit(std::move(dbBatch));
+
+        // the records committed again since are still pending
+        Guard l(x_pending);
+        auto const forget = [&](std::string const& _key) {
+            auto const it = m_pending.find(_key);
+            if (it != m_pending.end() && it->second.commit == number)
+                m_pending.erase(it);
+        };
+        for (auto const& key : batch->killed())
+            forget(key);
+        for (auto const& record : batch->writeBatch())
+            forget(record.first);
+    });
+}
+
+void WriteBehindDB::forEach(std::function<bool(Slice, Slice)> _f) const
+{
+    m_queue->flush();
+    m_db->forEach(std::move(_f));
+}
+
+std::unique_ptr<DatabaseFace> WriteBehindDB::release()
+{
+    m_queue->flush();
+    return std::move(m_db);
+}
+
+}  // namespace db
+}  // namespace dev
@@ -0,0 +1,111 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Databases whose writes are made on a background thread.
+#pragma once
+
+#include "Guards.h"
+#include "db.h"
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace dev
+{
+namespace db
+{
+/**
+ * @brief Thread making the writes of the WriteBehindDBs sharing it, one after another in the order
+ * they are committed in. Whatever the databases hold after an interruption is therefore what they
+ * would hold had the writes been made by the committing thread.
+ * A failed write stops the queue, the writes after it are dropped and the error is rethrown to
+ * the next commit or flush().
+ */
+class WriteQueue
+{
+public:
+    /// @param _maxQueued number of writes waiting for the thread, past which a commit waits
+    explicit WriteQueue(unsigned _maxQueued);
+    /// Makes the writes still queued.
+    ~WriteQueue();
+
+    WriteQueue(WriteQueue const&) = delete;
+    WriteQueue& operator=(WriteQueue const&) = delete;
+
+    /// Waits until the writes committed so far have been made.
+    void flush();
+
+private:
+    friend class WriteBehindDB;
+
+    void push(std::function<void()> _write);
+    void run();
+
+    unsigned const m_maxQueued;
+
+    Mutex x_queue;
+    std::condition_variable m_changed;
+    std::deque<std::function<void()>> m_queue;
+    bool m_writing = false;
+    bool m_stop = false;
+    std::exception_ptr m_error;
+
+    std::thread m_thread;
+};
+
+/**
+ * @brief Database whose committed batches are written to the wrapped database by a WriteQueue, so
+ * that the committing thread goes on while they are written. The records of the batches in the
+ * queue are read from memory until they are written.
+ */
+class WriteBehindDB : public DatabaseFace
+{
+public:
+    WriteBehindDB(std::unique_ptr<DatabaseFace> _db, std::shared_ptr<WriteQueue> _queue);
+    /// Waits for the writes in the queue.
+    ~WriteBehindDB();
+
+    std::string lookup(Slice _key) const override;
+    bool exists(Slice _key) const override;
+    void insert(Slice _key, Slice _value) override;
+    void kill(Slice _key) override;
+
+    std::unique_ptr<WriteBatchFace> createWriteBatch() const override;
+    /// Queues the batch, waits if the queue is full.
+    void commit(std::unique_ptr<WriteBatchFace> _batch) override;
+
+    /// Waits for the writes in the queue before iterating the wrapped database.
+    void forEach(std::function<bool(Slice, Slice)> _f) const override;
+
+    /// Waits for the writes in the queue.
+    /// @returns the wrapped database, which this can't be used without afterwards.
+    std::unique_ptr<DatabaseFace> release();
+
+private:
+    /// A record of a batch in the queue.
+    struct Pending
+    {
+        /// The number of the commit of the batch, the record is forgotten once it is written.
+        uint64_t commit;
+        bool killed;
+        std::string value;
+    };
+
+    std::unique_ptr<DatabaseFace> m_db;
+    std::shared_ptr<WriteQueue> m_queue;
+
+    mutable Mutex x_pending;
+    std::unordered_map<std::string, Pending> m_pending;
+    uint64_t m_lastCommit = 0;
+};
+
+}  // namespace db
+}  // namespace dev
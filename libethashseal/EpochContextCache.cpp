@@ -0,0 +1,153 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "EpochContextCache.h"
+
+#include <libdevcore/Log.h>
+
+namespace dev
+{
+namespace eth
+{
+EpochContextCache::EpochContextCache(size_t _capacity) : m_contexts(std::max<size_t>(1, _capacity))
+{}
+
+EpochContextCache::~EpochContextCache()
+{
+    {
+        UniqueGuard l(x_queue);
+        m_stopping = true;
+    }
+    m_queueChanged.notify_all();
+    if (m_worker.joinable())
+        m_worker.join();
+}
+
+EpochContextCache& EpochContextCache::instance()
+{
+    static EpochContextCache s_cache;
+    return s_cache;
+}
+
+EpochContextCache::ContextPtr EpochContextCache::context(int _epoch)
+{
+    Future future;
+    std::promise<ContextPtr> promise;
+    bool building = false;
+    {
+        Guard l(x_contexts);
+        if (auto const* cached = m_contexts.find(_epoch))
+            future = *cached;
+        else
+        {
+            future = promise.get_future().share();
+            m_contexts.insert(_epoch, future);
+            building = true;
+        }
+    }
+
+    // A context still being prewarmed counts as a hit, its build started before it was needed.
+    if (building)
+    {
+        m_misses.inc();
+        fulfil(_epoch, promise);
+    }
+    else
+        m_hits.inc();
+    return future.get();
+}
+
+void EpochContextCache::prewarm(int _epoch)
+{
+    std::promise<ContextPtr> promise;
+    {
+        Guard l(x_contexts);
+        if (m_contexts.contains(_epoch))
+            return;
+        m_contexts.insert(_epoch, promise.get_future().share());
+    }
+
+    {
+        UniqueGuard l(x_queue);
+        if (!m_worker.joinable())
+            m_worker = std::thread([this]() {
+                setThreadName("ethash");
+                work();
+            });
+        m_queue.push_back(Task{_epoch, std::move(promise)});
+    }
+    m_queueChanged.notify_all();
+}
+
+void EpochContextCache::noteBlock(int64_t _number)
+{
+    int64_t const epoch = _number / ethash::epoch_length;
+    if (_number % ethash::epoch_length >= ethash::epoch_length - c_prewarmDistance)
+        prewarm(static_cast<int>(epoch + 1));
+}
+
+bool EpochContextCache::contains(int _epoch) const
+{
+    Guard l(x_contexts);
+    return m_contexts.contains(_epoch);
+}
+
+void EpochContextCache::wait()
+{
+    UniqueGuard l(x_queue);
+    m_queueChanged.wait(l, [this] { return m_queue.empty() && !m_running; });
+}
+
+EpochContextCache::ContextPtr EpochContextCache::build(int _epoch)
+{
+    ethash::epoch_context_ptr context = ethash::create_epoch_context(_epoch);
+    if (!context)
+        BOOST_THROW_EXCEPTION(EpochContextAllocationFailed());
+    return ContextPtr(std::move(context));
+}
+
+void EpochContextCache::fulfil(int _epoch, std::promise<ContextPtr>& _promise)
+{
+    try
+    {
+        _promise.set_value(timed(m_buildTime, [_epoch]() { return build(_epoch); }));
+        clog(VerbosityDebug, "ethash") << "Built the context of epoch " << _epoch;
+    }
+    catch (...)
+    {
+        {
+            Guard l(x_contexts);
+            m_contexts.remove(_epoch);
+        }
+        _promise.set_exception(std::current_exception());
+    }
+}
+
+void EpochContextCache::work()
+{
+    while (true)
+    {
+        Task task;
+        {
+            UniqueGuard l(x_queue);
+            m_queueChanged.wait(l, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping)
+                return;
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_running = true;
+        }
+
+        fulfil(task.epoch, task.promise);
+
+        {
+            UniqueGuard l(x_queue);
+            m_running = false;
+        }
+        m_queueChanged.notify_all();
+    }
+}
+
+}  // namespace eth
+}  // namespace dev
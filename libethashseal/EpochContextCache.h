@@ -0,0 +1,112 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// The Ethash epoch contexts used to verify seals, built ahead of the epoch boundaries.
+#pragma once
+
+#include <libdevcore/Exceptions.h>
+#include <libdevcore/Guards.h>
+#include <libdevcore/LruCache.h>
+#include <libdevcore/Metrics.h>
+
+#include <ethash/ethash.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <thread>
+
+namespace dev
+{
+namespace eth
+{
+DEV_SIMPLE_EXCEPTION(EpochContextAllocationFailed);
+
+/**
+ * @brief Keeps the light caches of the recent epochs, for verifying the seals of blocks.
+ *
+ * Building the context of an epoch takes seconds. Instead of building it on the thread which
+ * verifies the first block of the epoch, noteBlock() has it built on a background thread while
+ * the chain approaches the epoch boundary. Verifying the blocks of the BlockQueue out of order,
+ * as well as uncles and reorganisations across a boundary, needs the contexts of more than one
+ * epoch, so the last few contexts used are kept.
+ * Threads asking for a context which is being built wait for that build instead of starting
+ * their own.
+ */
+class EpochContextCache
+{
+public:
+    using ContextPtr = std::shared_ptr<ethash::epoch_context const>;
+
+    /// Creates a cache keeping @a _capacity contexts. The background thread is started with the
+    /// first prewarm().
+    explicit EpochContextCache(size_t _capacity = c_defaultCapacity);
+    ~EpochContextCache();
+
+    EpochContextCache(EpochContextCache const&) = delete;
+    EpochContextCache& operator=(EpochContextCache const&) = delete;
+
+    /// The cache the seals of the Ethash seal engine are verified with.
+    static EpochContextCache& instance();
+
+    /// @returns the context of @a _epoch, building it on the calling thread if it's neither
+    /// cached nor being built.
+    /// @throws EpochContextAllocationFailed if there is not enough memory for the light cache.
+    ContextPtr context(int _epoch);
+
+    /// Queues building the context of @a _epoch on the background thread unless it is cached.
+    void prewarm(int _epoch);
+
+    /// Prewarms the context of the next epoch if the block @a _number is among the last
+    /// c_prewarmDistance blocks of its epoch.
+    void noteBlock(int64_t _number);
+
+    /// @returns true if the context of @a _epoch is cached or being built.
+    bool contains(int _epoch) const;
+
+    /// Waits until the queued contexts are built.
+    void wait();
+
+    /// The current epoch, the next one which is prewarmed, and the previous one for uncles and
+    /// reorganisations. The light cache of an epoch takes tens of megabytes.
+    static size_t const c_defaultCapacity = 3;
+    /// About an hour of blocks on the main network, a few seconds when syncing.
+    static int const c_prewarmDistance = 1000;
+
+private:
+    using Future = std::shared_future<ContextPtr>;
+
+    struct Task
+    {
+        int epoch;
+        std::promise<ContextPtr> promise;
+    };
+
+    static ContextPtr build(int _epoch);
+    /// Builds the context of @a _epoch into @a _promise, dropping it from the cache on failure.
+    void fulfil(int _epoch, std::promise<ContextPtr>& _promise);
+    void work();
+
+    mutable Mutex x_contexts;
+    LruCache<int, Future> m_contexts;
+
+    Mutex x_queue;
+    std::condition_variable m_queueChanged;
+    std::deque<Task> m_queue;
+    bool m_running = false;
+    bool m_stopping = false;
+    std::thread m_worker;
+
+    MetricCounter& m_hits = MetricsRegistry::instance().counter(
+        "aleth_cache_lookups_total", "Lookups of caches.", "cache=\"ethash_epoch\",result=\"hit\"");
+    MetricCounter& m_misses = MetricsRegistry::instance().counter(
+        "aleth_cache_lookups_total", "Lookups of caches.", "cache=\"ethash_epoch\",result=\"miss\"");
+    MetricHistogram& m_buildTime = MetricsRegistry::instance().histogram(
+        "aleth_ethash_epoch_context_build_seconds", "Duration of building Ethash epoch contexts.");
+};
+
+}  // namespace eth
+}  // namespace dev
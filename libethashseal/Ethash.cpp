@@ -2,6 +2,7 @@
 // Copyright 2014-2019 Aleth Authors.
 // Licensed under the GNU General Public License, Version 3.
 #include "Ethash.h"
+#include "EpochContextCache.h"
 #include "EthashCPUMiner.h"
 
 #include <libethcore/ChainOperationParams.h>
@@ -80,12 +81,16 @@ void Ethash::verify(Strictness _s, BlockHeader const& _bi, BlockHeader const& _p
             BOOST_THROW_EXCEPTION(InvalidDifficulty() << RequirementError((bigint)expected, (bigint)difficulty));
     }
 
+    if (_s == CheckEverything)
+        EpochContextCache::instance().noteBlock(_bi.number());
+
     // check it hashes according to proof of work or that it's the genesis block.
     if (_s == CheckEverything && _bi.parentHash() && !verifySeal(_bi))
     {
+        auto const context = EpochContextCache::instance().context(
+            ethash::get_epoch_number(static_cast<int>(_bi.number())));
         ethash::result result =
-            ethash::hash(ethash::get_global_epoch_context(ethash::get_epoch_number(_bi.number())),
-                toEthash(_bi.hash(WithoutSeal)), toEthash(nonce(_bi)));
+            ethash::hash(*context, toEthash(_bi.hash(WithoutSeal)), toEthash(nonce(_bi)));
 
         h256 mix{result.mix_hash.bytes, h256::ConstructFromPointer};
         h256 final{result.final_hash.bytes, h256::ConstructFromPointer};
@@ -152,9 +157,9 @@ bool Ethash::verifySeal(BlockHeader const& _blockHeader) const
     Nonce const n = nonce(_blockHeader);
     h256 const m = mixHash(_blockHeader);
 
-    auto& context =
-        ethash::get_global_epoch_context(ethash::get_epoch_number(_blockHeader.number()));
-    return ethash::verify(context, toEthash(h), toEthash(m), toEthash(n), toEthash(b));
+    auto const context = EpochContextCache::instance().context(
+        ethash::get_epoch_number(static_cast<int>(_blockHeader.number())));
+    return ethash::verify(*context, toEthash(h), toEthash(m), toEthash(n), toEthash(b));
 }
 
 void Ethash::generateSeal(BlockHeader const& _bi)
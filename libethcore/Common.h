@@ -243,7 +243,10 @@ enum AlethErrors
     BadRlp,
     RlpDataNotAList,
     UnsupportedJsonType,
-    InvalidJson
+    InvalidJson,
+    SnapshotExportFailure,
+    ChainArchiveExportFailure,
+    ChainArchiveImportFailure
 };
 }
 }
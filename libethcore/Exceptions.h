@@ -88,6 +88,7 @@ DEV_SIMPLE_EXCEPTION(StateTrieReconstructionFailed);
 DEV_SIMPLE_EXCEPTION(InvalidStateChunkData);
 DEV_SIMPLE_EXCEPTION(InvalidBlockChunkData);
 DEV_SIMPLE_EXCEPTION(AccountAlreadyImported);
+DEV_SIMPLE_EXCEPTION(InvalidSnapshotImportProgress);
 DEV_SIMPLE_EXCEPTION(InvalidWarpStatusPacket);
 DEV_SIMPLE_EXCEPTION(FailedToDownloadManifest);
 DEV_SIMPLE_EXCEPTION(FailedToDownloadDaoForkBlockHeader);
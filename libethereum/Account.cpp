@@ -4,10 +4,9 @@
 
 
 #include "Account.h"
-#include "SecureTrieDB.h"
 #include "ValidationSchemes.h"
+#include <libdevcore/CommonIO.h>
 #include <libdevcore/JsonUtils.h>
-#include <libdevcore/OverlayDB.h>
 #include <libethcore/ChainOperationParams.h>
 
 using namespace std;
@@ -38,20 +37,6 @@ void Account::resetCode()
     m_version = 0;
 }
 
-u256 Account::originalStorageValue(u256 const& _key, OverlayDB const& _db) const
-{
-    auto it = m_storageOriginal.find(_key);
-    if (it != m_storageOriginal.end())
-        return it->second;
-
-    // Not in the original values cache - go to the DB.
-    SecureTrieDB<h256, OverlayDB> const memdb(const_cast<OverlayDB*>(&_db), m_storageRoot);
-    std::string const payload = memdb.at(_key);
-    auto const value = payload.size() ? RLP(payload).toInt<u256>() : 0;
-    m_storageOriginal[_key] = value;
-    return value;
-}
-
 namespace js = json_spirit;
 
 // TODO move AccountMaskObj to libtesteth (it is used only in test logic)
@@ -14,8 +14,6 @@
 
 namespace dev
 {
-class OverlayDB;
-
 namespace eth
 {
 
@@ -65,7 +63,8 @@ public:
         m_balance(_balance),
         m_storageRoot(_contractRoot),
         m_codeHash(_codeHash),
-        m_version(_version)
+        m_version(_version),
+        m_hadStorageOrCode(_contractRoot != EmptyTrie || _codeHash != EmptySHA3)
     {
         assert(_contractRoot);
     }
@@ -122,18 +121,39 @@ public:
 
     /// @returns account's storage value corresponding to the @_key
     /// taking into account overlayed modifications
-    u256 storageValue(u256 const& _key, OverlayDB const& _db) const
+    /// @param _lookup  returns the value of @_key at baseRoot(), called if it isn't cached
+    template <class Lookup>
+    u256 storageValue(u256 const& _key, Lookup const& _lookup) const
     {
         auto mit = m_storageOverlay.find(_key);
         if (mit != m_storageOverlay.end())
             return mit->second;
 
-        return originalStorageValue(_key, _db);
+        return originalStorageValue(_key, _lookup);
     }
 
     /// @returns account's original storage value corresponding to the @_key
     /// not taking into account overlayed modifications
-    u256 originalStorageValue(u256 const& _key, OverlayDB const& _db) const;
+    /// @param _lookup  returns the value of @_key at baseRoot(), called if it isn't cached
+    template <class Lookup>
+    u256 originalStorageValue(u256 const& _key, Lookup const& _lookup) const
+    {
+        auto it = m_storageOriginal.find(_key);
+        if (it != m_storageOriginal.end())
+            return it->second;
+
+        u256 const value = _lookup();
+        m_storageOriginal[_key] = value;
+        return value;
+    }
+
+    /// Adds to the cache of unmodified storage items the ones cached by @a _account, which must
+    /// have the same base storage root.
+    void cacheOriginalStorage(Account const& _account) const
+    {
+        assert(m_storageRoot == _account.m_storageRoot);
+        m_storageOriginal.insert(_account.m_storageOriginal.begin(), _account.m_storageOriginal.end());
+    }
 
     /// @returns the storage overlay as a simple hash map.
     std::unordered_map<u256, u256> const& storageOverlay() const { return m_storageOverlay; }
@@ -165,6 +185,13 @@ public:
 
     bool hasNewCode() const { return m_hasNewCode; }
 
+    /// @returns true if the account was constructed with storage or code, like the accounts
+    /// loaded from the state trie, or was created over such an account.
+    bool hadStorageOrCode() const { return m_hadStorageOrCode; }
+
+    /// Note that the account is created over one which had storage or code.
+    void noteReplacedStorageOrCode() { m_hadStorageOrCode = true; }
+
     /// Sets the code of the account. Used by "create" messages.
     void setCode(bytes&& _code, u256 const& _version);
 
@@ -214,6 +241,9 @@ private:
     /// Account's version
     u256 m_version = 0;
 
+    /// True if the account had storage or code in the state it was loaded from.
+    bool m_hadStorageOrCode = false;
+
     /// The map with is overlaid onto whatever storage is implied by the m_storageRoot in the trie.
     mutable std::unordered_map<u256, u256> m_storageOverlay;
 
@@ -9,6 +9,7 @@
 #include "Executive.h"
 #include "ExtVM.h"
 #include "GenesisInfo.h"
+#include "ImportPerformanceLogger.h"
 #include "TransactionQueue.h"
 #include <libdevcore/Assertions.h>
 #include <libdevcore/CommonIO.h>
@@ -100,9 +101,9 @@ Block& Block::operator=(Block const& _s)
 
 void Block::resetCurrent(int64_t _timestamp)
 {
-    m_transactions.clear();
-    m_receipts.clear();
-    m_transactionSet.clear();
+    m_transactions.reset();
+    m_receipts.reset();
+    m_transactionSet.reset();
     m_currentBlock = BlockHeader();
     m_currentBlock.setAuthor(m_author);
     m_currentBlock.setTimestamp(max(m_previousBlock.timestamp() + 1, _timestamp));
@@ -132,6 +133,10 @@ void Block::noteChain(BlockChain const& _bc)
     {
         m_state.noteAccountStartNonce(_bc.chainParams().accountStartNonce);
         m_precommit.noteAccountStartNonce(_bc.chainParams().accountStartNonce);
+        m_state.setSnapshot(_bc.stateSnapshot());
+        m_precommit.setSnapshot(_bc.stateSnapshot());
+        m_state.setPrefetcher(_bc.triePrefetcher());
+        m_precommit.setPrefetcher(_bc.triePrefetcher());
         m_sealEngine = _bc.sealEngine();
     }
 }
@@ -175,10 +180,12 @@ void Block::populateFromChain(BlockChain const& _bc, h256 const& _h)
 
     RLP blockRLP{blockBytes};
     auto const& txListRLP = blockRLP[1];
+    auto& transactions = m_transactions.mut();
+    auto& transactionSet = m_transactionSet.mut();
     for (auto const& txRLP : txListRLP)
     {
-        m_transactions.push_back(Transaction{txRLP.data(), CheckTransaction::None});
-        m_transactionSet.insert(m_transactions.back().sha3());
+        transactions.push_back(Transaction{txRLP.data(), CheckTransaction::None});
+        transactionSet.insert(transactions.back().sha3());
     }
     m_receipts = _bc.receipts(_h).receipts;
 
@@ -282,7 +289,7 @@ pair<TransactionReceipts, bool> Block::sync(BlockChain const& _bc, TransactionQu
     // TRANSACTIONS
     pair<TransactionReceipts, bool> ret;
 
-    Transactions transactions = _tq.topTransactions(c_maxSyncTransactions, m_transactionSet);
+    Transactions transactions = _tq.topTransactions(c_maxSyncTransactions, *m_transactionSet);
     ret.second = (transactions.size() == c_maxSyncTransactions);  // say there's more to the caller
                                                                   // if we hit the limit
 
@@ -293,7 +300,7 @@ pair<TransactionReceipts, bool> Block::sync(BlockChain const& _bc, TransactionQu
     {
         goodTxs = 0;
         for (auto const& t : transactions)
-            if (!m_transactionSet.count(t.sha3()))
+            if (!m_transactionSet->count(t.sha3()))
             {
                 try
                 {
@@ -301,7 +308,7 @@ pair<TransactionReceipts, bool> Block::sync(BlockChain const& _bc, TransactionQu
                     {
 //						Timer t;
                         execute(_bc.lastBlockHashes(), t);
-                        ret.first.push_back(m_receipts.back());
+                        ret.first.push_back(m_receipts->back());
                         ++goodTxs;
 //						cnote << "TX took:" << t.elapsed() * 1000;
                     }
@@ -379,9 +386,12 @@ pair<TransactionReceipts, bool> Block::sync(BlockChain const& _bc, TransactionQu
     return ret;
 }
 
-u256 Block::enactOn(VerifiedBlockRef const& _block, BlockChain const& _bc)
+u256 Block::enactOn(
+    VerifiedBlockRef const& _block, BlockChain const& _bc, ImportPerformanceLogger* _performanceLogger)
 {
     noteChain(_bc);
+    // The storage read by imported blocks is what the prefetcher reads ahead for the next ones.
+    m_state.setReportStorageReads(true);
 
 #if ETH_TIMED_ENACTMENTS
     Timer t;
@@ -418,7 +428,7 @@ u256 Block::enactOn(VerifiedBlockRef const& _block, BlockChain const& _bc)
 #endif
 
     m_previousBlock = biParent;
-    auto ret = enact(_block, _bc);
+    auto ret = enact(_block, _bc, _performanceLogger);
 
 #if ETH_TIMED_ENACTMENTS
     enactment = t.elapsed();
@@ -429,7 +439,8 @@ u256 Block::enactOn(VerifiedBlockRef const& _block, BlockChain const& _bc)
     return ret;
 }
 
-u256 Block::enact(VerifiedBlockRef const& _block, BlockChain const& _bc)
+u256 Block::enact(
+    VerifiedBlockRef const& _block, BlockChain const& _bc, ImportPerformanceLogger* _performanceLogger)
 {
     noteChain(_bc);
 
@@ -454,15 +465,21 @@ u256 Block::enact(VerifiedBlockRef const& _block, BlockChain const& _bc)
 
     vector<bytes> receipts;
 
+    std::unique_ptr<OpcodeTimer> opcodeTimer;
+    if (_performanceLogger && ImportProfiler::instance().opcodeProfiling())
+        opcodeTimer.reset(new OpcodeTimer(ImportProfiler::instance()));
+
     // All ok with the block generally. Play back the transactions now...
     unsigned i = 0;
     DEV_TIMED_ABOVE("txExec", 500)
         for (Transaction const& tr: _block.transactions)
         {
+            double const start = _performanceLogger ? _performanceLogger->elapsed() : 0;
             try
             {
 //				cnote << "Enacting transaction: " << tr.nonce() << tr.from() << state().transactionsFrom(tr.from()) << tr.value();
-                execute(_bc.lastBlockHashes(), tr);
+                execute(_bc.lastBlockHashes(), tr, Permanence::Committed,
+                    opcodeTimer ? opcodeTimer->onOp() : OnOpFunc());
 //				cnote << "Now: " << tr.from() << state().transactionsFrom(tr.from());
 //				cnote << m_state;
             }
@@ -471,9 +488,14 @@ u256 Block::enact(VerifiedBlockRef const& _block, BlockChain const& _bc)
                 ex << errinfo_transactionIndex(i);
                 throw;
             }
+            if (opcodeTimer)
+                opcodeTimer->pause();
+            if (_performanceLogger)
+                _performanceLogger->addSpan(ImportPart::Transaction,
+                    "transaction " + toString(i), start, _performanceLogger->elapsed() - start);
 
             RLPStream receiptRLP;
-            m_receipts.back().streamRLP(receiptRLP);
+            m_receipts->back().streamRLP(receiptRLP);
             receipts.push_back(receiptRLP.out());
             ++i;
         }
@@ -601,8 +623,12 @@ u256 Block::enact(VerifiedBlockRef const& _block, BlockChain const& _bc)
 
     // Commit all cached state changes to the state trie.
     bool removeEmptyAccounts = m_currentBlock.number() >= _bc.chainParams().EIP158ForkBlock; // TODO: use EVMSchedule
+    double const commitStart = _performanceLogger ? _performanceLogger->elapsed() : 0;
     DEV_TIMED_ABOVE("commit", 500)
         m_state.commit(removeEmptyAccounts ? State::CommitBehaviour::RemoveEmptyAccounts : State::CommitBehaviour::KeepEmptyAccounts);
+    if (_performanceLogger)
+        _performanceLogger->addSpan(
+            ImportPart::StateCommit, {}, commitStart, _performanceLogger->elapsed() - commitStart);
 
     // Hash the state trie and check against the state_root hash in m_currentBlock.
     if (m_currentBlock.stateRoot() != m_previousBlock.stateRoot() && m_currentBlock.stateRoot() != rootHash())
@@ -639,9 +665,9 @@ ExecutionResult Block::execute(
     if (_p == Permanence::Committed)
     {
         // Add to the user-originated transactions that we've executed.
-        m_transactions.push_back(_t);
-        m_receipts.push_back(resultReceipt.second);
-        m_transactionSet.insert(_t.sha3());
+        m_transactions.mut().push_back(_t);
+        m_receipts.mut().push_back(resultReceipt.second);
+        m_transactionSet.mut().insert(_t.sha3());
     }
 
     return resultReceipt.first;
@@ -742,9 +768,9 @@ void Block::commitToSeal(BlockChain const& _bc, bytes const& _extraData)
     BytesMap receiptsMap;
 
     RLPStream txs;
-    txs.appendList(m_transactions.size());
+    txs.appendList(m_transactions->size());
 
-    for (unsigned i = 0; i < m_transactions.size(); ++i)
+    for (unsigned i = 0; i < m_transactions->size(); ++i)
     {
         RLPStream k;
         k << i;
@@ -754,7 +780,7 @@ void Block::commitToSeal(BlockChain const& _bc, bytes const& _extraData)
         receiptsMap.insert(std::make_pair(k.out(), receiptrlp.out()));
 
         RLPStream txrlp;
-        m_transactions[i].streamRLP(txrlp);
+        (*m_transactions)[i].streamRLP(txrlp);
         transactionsMap.insert(std::make_pair(k.out(), txrlp.out()));
 
         txs.appendRaw(txrlp.out());
@@ -830,7 +856,7 @@ bool Block::sealBlock(bytesConstRef _header)
 
 h256 Block::stateRootBeforeTx(unsigned _i) const
 {
-    _i = min<unsigned>(_i, m_transactions.size());
+    _i = min<unsigned>(_i, m_transactions->size());
     try
     {
         return (_i > 0 ? receipt(_i - 1).stateRoot() : m_previousBlock.stateRoot());
@@ -844,7 +870,7 @@ h256 Block::stateRootBeforeTx(unsigned _i) const
 LogBloom Block::logBloom() const
 {
     LogBloom ret;
-    for (TransactionReceipt const& i: m_receipts)
+    for (TransactionReceipt const& i: *m_receipts)
         ret |= i.bloom();
     return ret;
 }
@@ -866,7 +892,9 @@ void Block::cleanup()
         throw;
     }
 
-    m_state.db().commit();	// TODO: State API for this?
+    // Journalled under the block, so that the states of old blocks can be pruned
+    m_state.db().commit(static_cast<uint64_t>(m_currentBlock.number()), m_currentBlock.hash());
+    m_state.updateSnapshot();
 
     LOG(m_logger) << "Committed: stateRoot " << m_currentBlock.stateRoot() << " = " << rootHash()
                   << " = " << toHex(asBytes(db().lookup(rootHash())));
@@ -8,6 +8,7 @@
 #include <array>
 #include <unordered_map>
 #include <libdevcore/Common.h>
+#include <libdevcore/CopyOnWrite.h>
 #include <libdevcore/RLP.h>
 #include <libdevcore/TrieDB.h>
 #include <libdevcore/OverlayDB.h>
@@ -34,6 +35,7 @@ class State;
 class TransactionQueue;
 struct VerifiedBlockRef;
 class LastBlockHashesFace;
+class ImportPerformanceLogger;
 
 DEV_SIMPLE_EXCEPTION(ChainOperationWithUnknownBlockChain);
 DEV_SIMPLE_EXCEPTION(InvalidOperationOnSealedBlock);
@@ -158,13 +160,13 @@ public:
     u256 gasLimitRemaining() const { return m_currentBlock.gasLimit() - gasUsed(); }
 
     /// Get the list of pending transactions.
-    Transactions const& pending() const { return m_transactions; }
+    Transactions const& pending() const { return *m_transactions; }
 
     /// Get the list of hashes of pending transactions.
-    h256Hash const& pendingHashes() const { return m_transactionSet; }
+    h256Hash const& pendingHashes() const { return *m_transactionSet; }
 
     /// Get the transaction receipt for the transaction of the given index.
-    TransactionReceipt const& receipt(unsigned _i) const { return m_receipts.at(_i); }
+    TransactionReceipt const& receipt(unsigned _i) const { return m_receipts->at(_i); }
 
     /// Get the list of pending transactions.
     LogEntries const& log(unsigned _i) const { return receipt(_i).log(); }
@@ -202,8 +204,11 @@ public:
     bool sync(BlockChain const& _bc, h256 const& _blockHash, BlockHeader const& _bi = BlockHeader());
 
     /// Execute all transactions within a given block.
+    /// The executions of the transactions and the state commit are recorded into
+    /// @a _performanceLogger if it isn't null.
     /// @returns the additional total difficulty.
-    u256 enactOn(VerifiedBlockRef const& _block, BlockChain const& _bc);
+    u256 enactOn(VerifiedBlockRef const& _block, BlockChain const& _bc,
+        ImportPerformanceLogger* _performanceLogger = nullptr);
 
     /// Returns back to a pristine state after having done a playback.
     void cleanup();
@@ -258,13 +263,14 @@ private:
 
     /// Execute the given block, assuming it corresponds to m_currentBlock.
     /// Throws on failure.
-    u256 enact(VerifiedBlockRef const& _block, BlockChain const& _bc);
+    u256 enact(VerifiedBlockRef const& _block, BlockChain const& _bc,
+        ImportPerformanceLogger* _performanceLogger = nullptr);
 
     /// Finalise the block, applying the earned rewards.
     void applyRewards(std::vector<BlockHeader> const& _uncleBlockHeaders, u256 const& _blockReward);
 
     /// @returns gas used by transactions thus far executed.
-    u256 gasUsed() const { return m_receipts.size() ? m_receipts.back().cumulativeGasUsed() : 0; }
+    u256 gasUsed() const { return m_receipts->size() ? m_receipts->back().cumulativeGasUsed() : 0; }
 
     /// Performs irregular modifications right after initialization, e.g. to implement a hard fork.
     void performIrregularModifications();
@@ -273,9 +279,10 @@ private:
     void updateBlockhashContract();
 
     State m_state;								///< Our state tree, as an OverlayDB DB.
-    Transactions m_transactions;				///< The current list of transactions that we've included in the state.
-    TransactionReceipts m_receipts;				///< The corresponding list of transaction receipts.
-    h256Hash m_transactionSet;					///< The set of transaction hashes that we've included in the state.
+    // pending lists are shared with the copies of the block until one of them executes a transaction
+    CopyOnWrite<Transactions> m_transactions;	///< The current list of transactions that we've included in the state.
+    CopyOnWrite<TransactionReceipts> m_receipts;	///< The corresponding list of transaction receipts.
+    CopyOnWrite<h256Hash> m_transactionSet;		///< The set of transaction hashes that we've included in the state.
     State m_precommit;							///< State at the point immediately prior to rewards.
 
     BlockHeader m_previousBlock;				///< The previous block's information.
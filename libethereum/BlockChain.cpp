@@ -7,14 +7,19 @@
 #include "Block.h"
 #include "GenesisInfo.h"
 #include "ImportPerformanceLogger.h"
+#include "SenderCache.h"
 #include "State.h"
+#include "StateSnapshot.h"
+#include "TriePrefetcher.h"
 #include <libdevcore/Assertions.h>
 #include <libdevcore/Common.h>
 #include <libdevcore/DBFactory.h>
 #include <libdevcore/FileSystem.h>
 #include <libdevcore/FixedHash.h>
+#include <libdevcore/ForEachInOrder.h>
 #include <libdevcore/RLP.h>
 #include <libdevcore/TrieHash.h>
+#include <libdevcore/WriteBehindDB.h>
 #include <libethcore/BlockHeader.h>
 #include <libethcore/Exceptions.h>
 #include <libethereum/DatabasePaths.h>
@@ -33,6 +38,13 @@ namespace
 {
 std::string const c_chainStart{"chainStart"};
 db::Slice const c_sliceChainStart{c_chainStart};
+std::string const c_rebuildTarget{"rebuildTarget"};
+db::Slice const c_sliceRebuildTarget{c_rebuildTarget};
+std::string const c_lastPrunedNumber{"lastPrunedNumber"};
+db::Slice const c_sliceLastPrunedNumber{c_lastPrunedNumber};
+
+/// Writes of a rebuild waiting for the background thread, each block makes three to five.
+unsigned const c_rebuildQueuedWrites = 16;
 }
 
 std::ostream& dev::eth::operator<<(std::ostream& _out, BlockChain const& _bc)
@@ -152,6 +164,9 @@ static const unsigned c_maxCacheSize = 1024 * 1024 * 64;
 /// Min size, below which we don't bother flushing it.
 static const unsigned c_minCacheSize = 1024 * 1024 * 32;
 
+/// Number of blocks whose state is prefetched ahead of the block being imported.
+static const unsigned c_prefetchBlocksAhead = 2;
+
 
 BlockChain::BlockChain(ChainParams const& _p, fs::path const& _dbPath, WithExisting _we, ProgressCallback const& _pc):
     m_lastBlockHashes(new LastBlockHashes(*this))
@@ -305,6 +320,17 @@ bool BlockChain::open(fs::path const& _path, WithExisting _we)
     // database because the extras database format may have changed
     m_lastBlockNumber = info(m_lastBlockHash).number();
 
+    string const lastPrunedNumber = m_extrasDB->lookup(c_sliceLastPrunedNumber);
+    m_lastPrunedNumber = lastPrunedNumber.empty() ? 0 : RLP(lastPrunedNumber).toInt<unsigned>();
+
+    if (db::stateSnapshotLayers() && !m_stateSnapshot)
+        m_stateSnapshot = make_shared<StateSnapshot>(
+            db::isDiskDatabase() ? m_dbPaths->stateSnapshotPath() : fs::path(),
+            db::stateSnapshotLayers());
+
+    if (!m_triePrefetcher)
+        m_triePrefetcher = make_shared<TriePrefetcher>();
+
     LOG(m_loggerInfo) << "Opened blockchain database. Latest block hash: " << currentHash()
                       << (!rebuildNeeded ? "(rebuild not needed)" : "*** REBUILD NEEDED ***");
     return rebuildNeeded;
@@ -327,6 +353,14 @@ void BlockChain::close()
 {
     ctrace << "Closing blockchain DB";
     // Not thread safe...
+    if (m_stateSnapshot)
+    {
+        // The diff layers are kept in memory only
+        m_stateSnapshot->flatten(info().stateRoot());
+        m_stateSnapshot.reset();
+    }
+    if (m_triePrefetcher)
+        m_triePrefetcher->clear();
     m_extrasDB.reset();
     m_blocksDB.reset();
     DEV_WRITE_GUARDED(x_lastBlockHash)
@@ -359,34 +393,56 @@ void BlockChain::rebuild(
     if (!m_dbPaths || m_dbPaths->rootPath() != _path)
         m_dbPaths = make_unique<DatabasePaths>(_path, m_genesisHash);
 
-    unsigned const originalNumber = m_lastBlockNumber;
-
     ///////////////////////////////
     // - KILL ALL STATE/CHAIN
     // - REINSERT ALL BLOCKS
     ///////////////////////////////
 
-    // Keep extras DB around, but under a temp name
+    // Keep extras DB around, but under a temp name. It is still there if a rebuild was
+    // interrupted, in which case the blocks are read from it again.
     m_extrasDB.reset();
-    LOG(m_loggerInfo) << "Renaming extras path " << m_dbPaths->extrasPath() << " to "
-                      << m_dbPaths->extrasTemporaryPath();
     if (fs::exists(m_dbPaths->extrasTemporaryPath()))
+        LOG(m_loggerInfo) << "Found extras path " << m_dbPaths->extrasTemporaryPath()
+                          << " of an interrupted rebuild";
+    else
     {
-        LOG(m_loggerError)
-            << "Temporary extras path " << m_dbPaths->extrasTemporaryPath()
-            << " already exists (this usually happens because an in-progress rebuild was "
-               "prematurely terminated).";
-        LOG(m_loggerError) << "Please re-run Aleth the --kill option to delete all databases. This "
-                              "will remove all chain data and require you to resync from genesis.";
-        BOOST_THROW_EXCEPTION(DatabaseExists());
-    }
-    fs::rename(m_dbPaths->extrasPath(), m_dbPaths->extrasTemporaryPath());
+        LOG(m_loggerInfo) << "Renaming extras path " << m_dbPaths->extrasPath() << " to "
+                          << m_dbPaths->extrasTemporaryPath();
+        fs::rename(m_dbPaths->extrasPath(), m_dbPaths->extrasTemporaryPath());
+    }
     std::unique_ptr<db::DatabaseFace> oldExtrasDB{
         db::DBFactory::create(m_dbPaths->extrasTemporaryPath())};
     m_extrasDB = db::DBFactory::create(m_dbPaths->extrasPath());
 
-    // Open a fresh state DB
-    Block s = genesisBlock(State::openDB(m_dbPaths->rootPath(), m_genesisHash, WithExisting::Kill));
+    // The new extras DB of an interrupted rebuild holds the number of the last block to reimport,
+    // and its best block is the last one reimported, with the state committed. Anything else in
+    // the extras path is started over.
+    string const rebuildTarget = m_extrasDB->lookup(c_sliceRebuildTarget);
+    bool const resume = !rebuildTarget.empty();
+    unsigned originalNumber = 0;
+    if (resume)
+        originalNumber = RLP(rebuildTarget).toInt<unsigned>();
+    else
+    {
+        m_extrasDB.reset();
+        fs::remove_all(m_dbPaths->extrasPath());
+        m_extrasDB = db::DBFactory::create(m_dbPaths->extrasPath());
+
+        string const originalBest = oldExtrasDB->lookup(db::Slice("best"));
+        if (!originalBest.empty())
+            originalNumber = info(h256(originalBest, h256::FromBinary)).number();
+    }
+
+    // The state and extras of a block are written on a background thread while the next block
+    // executes. The writes are made in the order of their commits, so the best block is never
+    // written before its state and an interrupted rebuild resumes from a complete state.
+    auto const writeQueue = make_shared<db::WriteQueue>(c_rebuildQueuedWrites);
+    auto* const extrasWriteBehind = new db::WriteBehindDB(std::move(m_extrasDB), writeQueue);
+    m_extrasDB.reset(extrasWriteBehind);
+
+    // Open the state DB, a fresh one unless resuming
+    Block s = genesisBlock(State::openDB(m_dbPaths->rootPath(), m_genesisHash,
+        resume ? WithExisting::Trust : WithExisting::Kill, writeQueue));
 
     // Clear all memos ready for replay.
     m_details.clear();
@@ -398,77 +454,133 @@ void BlockChain::rebuild(
     m_lastBlockHashes->clear();
     m_lastBlockHash = genesisHash();
     m_lastBlockNumber = 0;
+    m_lastPrunedNumber = 0;
 
-    m_details[m_lastBlockHash].totalDifficulty = s.info().difficulty();
+    if (resume)
+    {
+        string const best = m_extrasDB->lookup(db::Slice("best"));
+        if (!best.empty())
+        {
+            m_lastBlockHash = h256(best, h256::FromBinary);
+            m_lastBlockNumber = info(m_lastBlockHash).number();
+        }
+        string const lastPrunedNumber = m_extrasDB->lookup(c_sliceLastPrunedNumber);
+        if (!lastPrunedNumber.empty())
+            m_lastPrunedNumber = RLP(lastPrunedNumber).toInt<unsigned>();
+        LOG(m_loggerInfo) << "Resuming the rebuild after block " << m_lastBlockNumber;
+    }
+    else
+    {
+        m_details[m_lastBlockHash].totalDifficulty = s.info().difficulty();
+
+        m_extrasDB->insert(toSlice(m_lastBlockHash, ExtraDetails),
+            (db::Slice)dev::ref(m_details[m_lastBlockHash].rlp()));
 
-    m_extrasDB->insert(toSlice(m_lastBlockHash, ExtraDetails),
-        (db::Slice)dev::ref(m_details[m_lastBlockHash].rlp()));
+        // Manually insert the genesis block details so that they're available during import of
+        // the first block.
+        auto const genesisDetails = BlockDetails{0 /* block number */, s.info().difficulty(),
+            h256{} /* parent */, {} /* children */, m_params.genesisBlock().size()};
+        m_details[m_genesisHash] = genesisDetails;
+        auto const genesisDetailsRlp = genesisDetails.rlp();
+        m_extrasDB->insert(
+            toSlice(m_genesisHash, ExtraDetails), (db::Slice)dev::ref(genesisDetailsRlp));
 
-    // Manually insert the genesis block details so that they're available during import of the
-    // first block.
-    auto const genesisDetails = BlockDetails{0 /* block number */, s.info().difficulty(),
-        h256{} /* parent */, {} /* children */, m_params.genesisBlock().size()};
-    m_details[m_genesisHash] = genesisDetails;
-    auto const genesisDetailsRlp = genesisDetails.rlp();
-    m_extrasDB->insert(
-        toSlice(m_genesisHash, ExtraDetails), (db::Slice)dev::ref(genesisDetailsRlp));
+        bytes const rebuildTargetRlp = rlp(originalNumber);
+        m_extrasDB->insert(c_sliceRebuildTarget, (db::Slice)dev::ref(rebuildTargetRlp));
+    }
 
-    LOG(m_loggerInfo) << "Rebuilding the extras and state databases by reimporting blocks 0 -> "
-                      << originalNumber << ", this will probably take a while";
+    LOG(m_loggerInfo) << "Rebuilding the extras and state databases by reimporting blocks "
+                      << m_lastBlockNumber << " -> " << originalNumber
+                      << ", this will probably take a while";
     h256 lastHash = m_lastBlockHash;
     Timer t;
     bool rebuildFailed = false;
     string exceptionInfo;
-    for (unsigned d = 1; d <= originalNumber; ++d)
+    try
     {
-        if (!(d % 1000))
-        {
-            LOG(m_loggerInfo) << "\n1000 blocks in " << t.elapsed()
-                              << "s = " << (1000.0 / t.elapsed()) << "b/s" << endl;
-            t.restart();
-        }
-        try
-        {
-            bytes b = block(queryExtras<BlockHash, uint64_t, ExtraBlockHash>(
-                d, m_blockHashes, x_blockHashes, NullBlockHash, oldExtrasDB.get())
-                                .value);
-
-            BlockHeader bi(&b);
+        // Blocks are read and go through the checks not depending on their parent on worker
+        // threads, ahead of their execution on this one.
+        std::function<VerifiedBlock(unsigned)> const readBlock = [&](unsigned _number) {
+            string const hashRlp =
+                oldExtrasDB->lookup(toSlice(static_cast<uint64_t>(_number), ExtraBlockHash));
+            if (hashRlp.empty())
+                BOOST_THROW_EXCEPTION(UnknownBlockNumber() << errinfo_comment(toString(_number)));
+            h256 const hash = BlockHash(RLP(hashRlp)).value;
+            string const data = m_blocksDB->lookup(toSlice(hash));
+            if (data.empty())
+                BOOST_THROW_EXCEPTION(UnknownBlockNumber() << errinfo_hash256(hash));
+
+            VerifiedBlock ret;
+            ret.blockData = asBytes(data);
+            ret.verified =
+                verifyBlock(&ret.blockData, m_onBad, ImportRequirements::OutOfOrderChecks);
+            return ret;
+        };
+
+        if (m_lastBlockNumber < originalNumber)
+            forEachInOrder<VerifiedBlock>(m_lastBlockNumber + 1, originalNumber,
+                max(thread::hardware_concurrency(), 1u), readBlock,
+                [&](unsigned _number, VerifiedBlock& _block) {
+                    if (!(_number % 1000))
+                    {
+                        LOG(m_loggerInfo) << "\n1000 blocks in " << t.elapsed()
+                                          << "s = " << (1000.0 / t.elapsed()) << "b/s" << endl;
+                        t.restart();
+                    }
+
+                    BlockHeader const& bi = _block.verified.info;
+                    if (bi.parentHash() != lastHash)
+                    {
+                        LOG(m_loggerError) << "DISJOINT CHAIN DETECTED; " << bi.hash() << "#"
+                                           << _number << " -> parent is" << bi.parentHash()
+                                           << "; expected" << lastHash << "#" << (_number - 1);
+                        BOOST_THROW_EXCEPTION(DisjointChain());
+                    }
+                    lastHash = bi.hash();
+                    import(_block.verified, s.db(), false);
+
+                    if (_progress)
+                        _progress(_number, originalNumber);
+                });
+    }
+    catch (...)
+    {
+        rebuildFailed = true;
+        exceptionInfo = boost::current_exception_diagnostic_information();
+    }
 
-            if (bi.parentHash() != lastHash)
-            {
-                LOG(m_loggerError)
-                    << "DISJOINT CHAIN DETECTED; " << bi.hash() << "#" << d << " -> parent is"
-                    << bi.parentHash() << "; expected" << lastHash << "#" << (d - 1);
-                BOOST_THROW_EXCEPTION(DisjointChain());
-            }
-            lastHash = bi.hash();
-            import(b, s.db(), 0);
-        }
-        catch (...)
+    // Waits for the writes in flight, the extras DB is written directly afterwards
+    try
+    {
+        m_extrasDB = extrasWriteBehind->release();
+    }
+    catch (...)
+    {
+        if (!rebuildFailed)
         {
             rebuildFailed = true;
             exceptionInfo = boost::current_exception_diagnostic_information();
-            break;
         }
-
-        if (_progress)
-            _progress(d, originalNumber);
     }
-    LOG(m_loggerInfo) << "Removing old extras database: " << m_dbPaths->extrasTemporaryPath();
-    oldExtrasDB.reset();
-    fs::remove_all(m_dbPaths->extrasTemporaryPath());
+
     if (!rebuildFailed)
     {
+        LOG(m_loggerInfo) << "Removing old extras database: " << m_dbPaths->extrasTemporaryPath();
+        oldExtrasDB.reset();
+        fs::remove_all(m_dbPaths->extrasTemporaryPath());
+        m_extrasDB->kill(c_sliceRebuildTarget);
+
         LOG(m_loggerInfo) << "Rebuild complete! Reimported " << originalNumber << " blocks!";
         writeFile(m_dbPaths->extrasMinorVersionPath(), rlp(c_databaseMinorVersion));
     }
     else
     {
-        LOG(m_loggerError) << "Rebuild failed with error: " << exceptionInfo;
+        LOG(m_loggerError) << "Rebuild failed after block " << m_lastBlockNumber
+                           << " with error: " << exceptionInfo;
         LOG(m_loggerError)
-            << "Please re-run Aleth with the --kill option to delete all databases. This will "
-               "remove all local chain data and require you to resync from genesis.";
+            << "Re-run Aleth to resume the rebuild, or with the --kill option to delete all "
+               "databases. The latter will remove all local chain data and require you to resync "
+               "from genesis.";
         BOOST_THROW_EXCEPTION(DatabaseRebuildFailed());
     }
 }
@@ -513,8 +625,19 @@ tuple<ImportRoute, h256s, unsigned> BlockChain::sync(
     Transactions goodTransactions;
     unsigned count = 0;
     h256s badBlockHashes;
-    for (VerifiedBlock const& block : _blocks)
+
+    // Read the state the next blocks touch while the ones before them execute.
+    auto const prefetch = [&](size_t _i) {
+        if (m_triePrefetcher && _i < _blocks.size())
+            m_triePrefetcher->prefetch(_stateDB, info().stateRoot(), _blocks[_i].verified);
+    };
+    for (size_t i = 0; i < c_prefetchBlocksAhead; ++i)
+        prefetch(i);
+
+    for (size_t i = 0; i < _blocks.size(); ++i)
     {
+        VerifiedBlock const& block = _blocks[i];
+        prefetch(i + c_prefetchBlocksAhead);
         do {
             try
             {
@@ -562,6 +685,8 @@ tuple<ImportRoute, h256s, unsigned> BlockChain::sync(
             }
         } while (false);
     }
+    if (m_triePrefetcher)
+        m_triePrefetcher->clear();
     return {ImportRoute{dead, fresh, goodTransactions}, badBlockHashes, count};
 }
 
@@ -751,7 +876,7 @@ ImportRoute BlockChain::import(VerifiedBlockRef const& _block, OverlayDB const&
     LOG(m_loggerDetail) << "Attempting import of block " << _block.info.hash() << " (#"
                         << _block.info.number() << ") ...";
 
-    performanceLogger.onStageFinished("preliminaryChecks");
+    performanceLogger.onStageFinished(ImportStage::Verify);
 
     BlockReceipts br;
     u256 td;
@@ -760,16 +885,18 @@ ImportRoute BlockChain::import(VerifiedBlockRef const& _block, OverlayDB const&
         // Check transactions are valid and that they result in a state equivalent to our state_root.
         // Get total difficulty increase and update state, checking it.
         Block s(*this, _db);
-        auto tdIncrease = s.enactOn(_block, *this);
+        auto tdIncrease = s.enactOn(_block, *this, &performanceLogger);
 
         for (unsigned i = 0; i < s.pending().size(); ++i)
             br.receipts.push_back(s.receipt(i));
 
+        performanceLogger.onStageFinished(ImportStage::Enact);
+
         s.cleanup();
 
         td = pd.totalDifficulty + tdIncrease;
 
-        performanceLogger.onStageFinished("enactment");
+        performanceLogger.onStageFinished(ImportStage::DbWrite);
     }
     catch (BadRoot& ex)
     {
@@ -787,7 +914,68 @@ ImportRoute BlockChain::import(VerifiedBlockRef const& _block, OverlayDB const&
 
     // All ok - insert into DB
     bytes const receipts = br.rlp();
-    return insertBlockAndExtras(_block, ref(receipts), td, performanceLogger);
+    ImportRoute ret = insertBlockAndExtras(_block, ref(receipts), td, performanceLogger);
+    pruneState(_db);
+    updateStateSnapshot(_db);
+    return ret;
+}
+
+void BlockChain::pruneState(OverlayDB const& _db)
+{
+    unsigned const history = db::statePruningHistory();
+    unsigned const head = number();
+    if (!history || !_db.refCounting() || head <= history)
+        return;
+
+    // Settling the journal of block n drops the state of block n - 1 that block n has changed.
+    if (m_stateSnapshot && m_stateSnapshot->generating() &&
+        head - history > m_stateSnapshotGenerationNumber)
+    {
+        LOG(m_loggerInfo) << "State snapshot generation outlasted the pruning history, restarting";
+        m_stateSnapshot->stopGeneration();
+    }
+    OverlayDB db = _db;
+    // so that the deleted nodes aren't read from the cache
+    if (m_triePrefetcher)
+    {
+        // A node read ahead while it is deleted would be put back into the cache after its
+        // removal. Prefetches are only queued by the imports, so none start while pruning.
+        if (head - history > m_lastPrunedNumber)
+            m_triePrefetcher->wait();
+        db.setNodeCache(m_triePrefetcher->cache());
+    }
+    unsigned deleted = 0;
+    unsigned const lastPrunedNumber = m_lastPrunedNumber;
+    for (unsigned n = lastPrunedNumber + 1; n <= head - history; ++n)
+    {
+        deleted += db.markCanonical(n, numberHash(n));
+        m_lastPrunedNumber = n;
+    }
+    if (m_lastPrunedNumber == lastPrunedNumber)
+        return;
+
+    // Settling the journals again after a crash before this is written does nothing, as they are
+    // deleted when settled.
+    bytes const lastPrunedNumberRlp = rlp(m_lastPrunedNumber);
+    m_extrasDB->insert(c_sliceLastPrunedNumber, (db::Slice)dev::ref(lastPrunedNumberRlp));
+    LOG(m_loggerDetail) << "Pruned " << deleted << " state nodes of blocks up to #"
+                        << m_lastPrunedNumber;
+}
+
+void BlockChain::updateStateSnapshot(OverlayDB const& _db)
+{
+    if (!m_stateSnapshot)
+        return;
+
+    BlockHeader const head = info();
+    if (m_stateSnapshot->contains(head.stateRoot()))
+        m_stateSnapshot->cap(head.stateRoot());
+    else
+    {
+        // First run, a crash, or a reorg to a branch the snapshot hasn't seen
+        m_stateSnapshot->startGeneration(_db, head.stateRoot());
+        m_stateSnapshotGenerationNumber = head.number();
+    }
 }
 
 ImportRoute BlockChain::insertWithoutParent(bytes const& _block, bytesConstRef _receipts, u256 const& _totalDifficulty)
@@ -842,8 +1030,6 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
         DEV_WRITE_GUARDED(x_details)
             m_details[_block.info.parentHash()].childHashes.push_back(_block.info.hash());
 
-        _performanceLogger.onStageFinished("collation");
-
         blocksWriteBatch->insert(toSlice(_block.info.hash()), db::Slice(_block.block));
         DEV_READ_GUARDED(x_details)
         extrasWriteBatch->insert(toSlice(_block.info.parentHash(), ExtraDetails),
@@ -862,7 +1048,7 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
 
         extrasWriteBatch->insert(toSlice(_block.info.hash(), ExtraReceipts), (db::Slice)_receipts);
 
-        _performanceLogger.onStageFinished("writing");
+        _performanceLogger.onStageFinished(ImportStage::Collation);
     }
     catch (Exception& ex)
     {
@@ -959,6 +1145,8 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
                             << _block.info.number() << ")";
     }
 
+    _performanceLogger.onStageFinished(ImportStage::Route);
+
     try
     {
         m_blocksDB->commit(std::move(blocksWriteBatch));
@@ -999,9 +1187,11 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
             }
         }
 
-    _performanceLogger.onStageFinished("checkBest");
+    _performanceLogger.onStageFinished(ImportStage::ExtrasWrite);
 
-    unsigned const gasPerSecond = static_cast<double>(_block.info.gasUsed()) / _performanceLogger.stageDuration("enactment");
+    double const enactment = _performanceLogger.stageDuration(ImportStage::Enact);
+    unsigned const gasPerSecond =
+        enactment > 0 ? static_cast<double>(_block.info.gasUsed()) / enactment : 0;
     _performanceLogger.onFinished({
         {"blockHash", "\""+ _block.info.hash().abridged() + "\""},
         {"blockNumber", toString(_block.info.number())},
@@ -1009,6 +1199,8 @@ ImportRoute BlockChain::insertBlockAndExtras(VerifiedBlockRef const& _block, byt
         {"transactions", toString(_block.transactions.size())},
         {"gasUsed", toString(_block.info.gasUsed())}
     });
+    ImportProfiler::instance().record(
+        _performanceLogger.trace(_block.info, _block.transactions.size()));
 
     if (!route.empty())
         noteCanonChanged();
@@ -1127,6 +1319,10 @@ void BlockChain::rewind(unsigned _newHead)
     {
         if (_newHead >= m_lastBlockNumber)
             return;
+        if (_newHead < m_lastPrunedNumber)
+            BOOST_THROW_EXCEPTION(StateAlreadyPruned() << errinfo_comment(
+                                      "state before block #" + toString(m_lastPrunedNumber) +
+                                      " is pruned"));
         clearCachesDuringChainReversion(_newHead + 1);
         m_lastBlockHash = numberHash(_newHead);
         m_lastBlockNumber = _newHead;
@@ -1597,7 +1793,9 @@ VerifiedBlockRef BlockChain::verifyBlock(bytesConstRef _block, std::function<voi
             bytesConstRef d = tr.data();
             try
             {
-                Transaction t(d, (_ir & ImportRequirements::TransactionSignatures) ? CheckTransaction::Everything : CheckTransaction::None);
+                Transaction t(d, (_ir & ImportRequirements::TransactionSignatures) ? CheckTransaction::Cheap : CheckTransaction::None);
+                if (_ir & ImportRequirements::TransactionSignatures)
+                    SenderCache::instance().setSender(t);
                 m_sealEngine->verifyTransaction(_ir, t, h, 0); // the gasUsed vs blockGasLimit is checked later in enact function
                 res.transactions.push_back(t);
             }
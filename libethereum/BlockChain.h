@@ -47,12 +47,15 @@ static const h256s NullH256s;
 class State;
 class Block;
 class ImportPerformanceLogger;
+class StateSnapshot;
+class TriePrefetcher;
 
 DEV_SIMPLE_EXCEPTION(AlreadyHaveBlock);
 DEV_SIMPLE_EXCEPTION(FutureTime);
 DEV_SIMPLE_EXCEPTION(TransientError);
 DEV_SIMPLE_EXCEPTION(FailedToWriteChainStart);
 DEV_SIMPLE_EXCEPTION(UnknownBlockNumber);
+DEV_SIMPLE_EXCEPTION(StateAlreadyPruned);
 
 // TODO: Move all this Genesis stuff into Genesis.h/.cpp
 std::unordered_map<Address, Account> const& genesisState();
@@ -233,10 +236,13 @@ public:
 
     /// Run through database and verify all blocks by reevaluating.
     /// Will call _progress with the progress in this operation first param done, second total.
+    /// The blocks are read and verified ahead of their execution on worker threads. An
+    /// interrupted rebuild continues after the last block it reimported when run again.
     void rebuild(boost::filesystem::path const& _path,
         ProgressCallback const& _progress = std::function<void(unsigned, unsigned)>());
 
     /// Alter the head of the chain to some prior block along it.
+    /// Throws StateAlreadyPruned if the state of the new head has been pruned.
     void rewind(unsigned _newHead);
 
     /// Rescue the database.
@@ -304,6 +310,13 @@ public:
 
     SealEngineFace* sealEngine() const { return m_sealEngine.get(); }
 
+    /// @returns the flat snapshot of the recent states, null unless enabled with
+    /// db::setStateSnapshotLayers().
+    std::shared_ptr<StateSnapshot> const& stateSnapshot() const { return m_stateSnapshot; }
+
+    /// @returns the reader of the state the blocks being imported are going to touch.
+    std::shared_ptr<TriePrefetcher> const& triePrefetcher() const { return m_triePrefetcher; }
+
     BlockHeader const& genesis() const;
 
     /// @returns first block number of the chain, non-zero when we have partial chain e.g. after snapshot import.
@@ -325,6 +338,12 @@ private:
 
     ImportRoute insertBlockAndExtras(VerifiedBlockRef const& _block, bytesConstRef _receipts, u256 const& _totalDifficulty, ImportPerformanceLogger& _performanceLogger);
     void checkBlockIsNew(VerifiedBlockRef const& _block) const;
+    /// Settles the state journals of the blocks which have fallen out of the pruning history,
+    /// deleting the state they don't share with the more recent blocks.
+    void pruneState(OverlayDB const& _db);
+    /// Moves the state snapshot to the head, starting its generation from @a _db if it doesn't
+    /// know the state of the head.
+    void updateStateSnapshot(OverlayDB const& _db);
     void checkBlockTimestamp(BlockHeader const& _header) const;
 
     template <class T, class K, unsigned N>
@@ -402,6 +421,16 @@ private:
     h256 m_lastBlockHash;
     unsigned m_lastBlockNumber = 0;
 
+    /// The last block number whose state journals have been settled, the states of the blocks
+    /// before it are pruned.
+    unsigned m_lastPrunedNumber = 0;
+
+    std::shared_ptr<StateSnapshot> m_stateSnapshot;
+    /// The number of the block whose state the snapshot is generated from.
+    unsigned m_stateSnapshotGenerationNumber = 0;
+
+    std::shared_ptr<TriePrefetcher> m_triePrefetcher;
+
     ChainParams m_params;
     std::shared_ptr<SealEngineFace> m_sealEngine;   // consider shared_ptr.
     mutable SharedMutex x_genesis;
@@ -483,6 +483,8 @@ void BlockChainSync::onPeerBlockHeaders(NodeID const& _peerID, RLP const& _r)
         LOG(m_loggerDetail) << "Peer " << _peerID << " does not have the blocks requested";
         m_host.capabilityHost().updateRating(_peerID, -1);
     }
+    unsigned usefulCount = 0;
+    unsigned duplicateCount = 0;
     for (unsigned i = 0; i < itemCount; i++)
     {
         BlockHeader info(_r[i].data(), HeaderData);
@@ -496,12 +498,14 @@ void BlockChainSync::onPeerBlockHeaders(NodeID const& _peerID, RLP const& _r)
         {
             LOG(m_logger) << "Skipping header " << blockNumber << " (already downloaded) from "
                           << _peerID;
+            ++duplicateCount;
             continue;
         }
         if (blockNumber <= m_lastImportedBlock && m_haveCommonHeader)
         {
             LOG(m_logger) << "Skipping header " << blockNumber << " (already imported) from "
                           << _peerID;
+            ++duplicateCount;
             continue;
         }
         if (blockNumber > m_highestBlock)
@@ -510,6 +514,7 @@ void BlockChainSync::onPeerBlockHeaders(NodeID const& _peerID, RLP const& _r)
         auto status = host().bq().blockStatus(info.hash());
         if (status == QueueStatus::Importing || status == QueueStatus::Ready || host().chain().isKnown(info.hash()))
         {
+            ++duplicateCount;
             m_haveCommonHeader = true;
             m_lastImportedBlock = (unsigned)info.number();
             m_lastImportedBlockHash = info.hash();
@@ -567,6 +572,7 @@ void BlockChainSync::onPeerBlockHeaders(NodeID const& _peerID, RLP const& _r)
             }
 
             mergeInto(m_headers, blockNumber, std::move(hdr));
+            ++usefulCount;
             if (headerId.transactionsRoot == EmptyTrie && headerId.uncles == EmptyListSHA3)
             {
                 //empty body, just mark as downloaded
@@ -581,6 +587,7 @@ void BlockChainSync::onPeerBlockHeaders(NodeID const& _peerID, RLP const& _r)
                 m_headerIdToNumber[headerId] = blockNumber;
         }
     }
+    m_host.capabilityHost().noteReceivedItems(_peerID, usefulCount, duplicateCount);
     collectBlocks();
     continueSync();
 }
@@ -617,6 +624,8 @@ void BlockChainSync::onPeerBlockBodies(NodeID const& _peerID, RLP const& _r)
         LOG(m_loggerDetail) << "Peer " << _peerID << " does not have the blocks requested";
         m_host.capabilityHost().updateRating(_peerID, -1);
     }
+    unsigned usefulCount = 0;
+    unsigned duplicateCount = 0;
     for (unsigned i = 0; i < itemCount; i++)
     {
         RLP body(_r[i]);
@@ -636,11 +645,14 @@ void BlockChainSync::onPeerBlockBodies(NodeID const& _peerID, RLP const& _r)
         {
             LOG(m_logger) << "Skipping already downloaded block body " << blockNumber << " from "
                           << _peerID;
+            ++duplicateCount;
             continue;
         }
         m_headerIdToNumber.erase(id);
         mergeInto(m_bodies, blockNumber, body.data().toBytes());
+        ++usefulCount;
     }
+    m_host.capabilityHost().noteReceivedItems(_peerID, usefulCount, duplicateCount);
     collectBlocks();
     continueSync();
 }
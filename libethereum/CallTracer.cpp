@@ -0,0 +1,119 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "CallTracer.h"
+#include "State.h"
+
+#include <libdevcore/CommonJS.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+
+void CallTreeTracer::enter(Instruction _op, Address const& _from, Address const& _to,
+    u256 const& _value, u256 const& _gas, bytesConstRef _input, State const&)
+{
+    auto& siblings = m_open.empty() ? m_root : m_open.back()->calls;
+    siblings.push_back(Call{_op, _from, _to, _value, _gas, 0, _input.toBytes(), {}, {}, {}});
+    m_open.push_back(&siblings.back());
+}
+
+void CallTreeTracer::exit(
+    u256 const& _gasUsed, bytesConstRef _output, TransactionException _exception)
+{
+    assert(!m_open.empty());
+    if (m_open.empty())
+        return;
+    Call& call = *m_open.back();
+    call.gasUsed = _gasUsed;
+    call.output = _output.toBytes();
+    call.exception = _exception;
+    m_open.pop_back();
+}
+
+Json::Value CallTreeTracer::jsonValue() const
+{
+    return m_root.empty() ? Json::Value{} : toJson(m_root.front());
+}
+
+Json::Value CallTreeTracer::toJson(Call const& _call)
+{
+    Json::Value ret{Json::objectValue};
+    ret["type"] = instructionInfo(_call.op).name;
+    ret["from"] = toJS(_call.from);
+    ret["to"] = toJS(_call.to);
+    ret["value"] = toJS(_call.value);
+    ret["gas"] = toJS(_call.gas);
+    ret["gasUsed"] = toJS(_call.gasUsed);
+    ret["input"] = toHexPrefixed(_call.input);
+    ret["output"] = toHexPrefixed(_call.output);
+    if (_call.exception != TransactionException::None)
+        ret["error"] = toString(_call.exception);
+    if (!_call.calls.empty())
+    {
+        Json::Value& calls = ret["calls"] = Json::Value{Json::arrayValue};
+        for (auto const& call : _call.calls)
+            calls.append(toJson(call));
+    }
+    return ret;
+}
+
+void PrestateTracer::enter(Instruction, Address const& _from, Address const& _to, u256 const&,
+    u256 const&, bytesConstRef, State const& _state)
+{
+    account(_from, _state);
+    account(_to, _state);
+}
+
+void PrestateTracer::accountAccess(Address const& _address, State const& _state)
+{
+    account(_address, _state);
+}
+
+void PrestateTracer::storageAccess(Address const& _address, u256 const& _key, State const& _state)
+{
+    Account& a = account(_address, _state);
+    if (a.exists && !a.storage.count(_key))
+        a.storage[_key] = _state.originalStorageValue(_address, _key);
+}
+
+PrestateTracer::Account& PrestateTracer::account(Address const& _address, State const& _state)
+{
+    auto const it = m_accounts.find(_address);
+    if (it != m_accounts.end())
+        return it->second;
+
+    // first access, before anything of the transaction can have changed the account
+    Account& a = m_accounts[_address];
+    a.exists = _state.addressInUse(_address);
+    if (a.exists)
+    {
+        a.balance = _state.balance(_address);
+        a.nonce = _state.getNonce(_address);
+        a.code = _state.code(_address);
+    }
+    return a;
+}
+
+Json::Value PrestateTracer::jsonValue() const
+{
+    Json::Value ret{Json::objectValue};
+    for (auto const& a : m_accounts)
+    {
+        if (!a.second.exists)
+            continue;
+        Json::Value account{Json::objectValue};
+        account["balance"] = toJS(a.second.balance);
+        account["nonce"] = static_cast<Json::UInt64>(a.second.nonce);
+        account["code"] = toHexPrefixed(a.second.code);
+        if (!a.second.storage.empty())
+        {
+            Json::Value& storage = account["storage"] = Json::Value{Json::objectValue};
+            for (auto const& slot : a.second.storage)
+                storage[toJS(h256{slot.first})] = toJS(h256{slot.second});
+        }
+        ret[toJS(a.first)] = account;
+    }
+    return ret;
+}
@@ -0,0 +1,120 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Tracers observing an execution at the boundaries of its calls instead of at every step.
+#pragma once
+
+#include "Transaction.h"
+
+#include <json/json.h>
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libevm/ExtVMFace.h>
+
+#include <map>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+class State;
+
+/// Observer of the message calls and contract creations of an execution and of the accounts and
+/// storage slots they access. Set with Executive::setTracer(), which passes it on to the nested
+/// calls. Unlike an OnOpFunc, it costs nothing per VM step.
+class CallTracer
+{
+public:
+    virtual ~CallTracer() = default;
+
+    /// Called when a call or creation starts, before the nonce of the sender is incremented and
+    /// any value is transferred. @a _op is the instruction making the call, CALL or CREATE for
+    /// the transaction itself. @a _from is the calling account and @a _to the account whose code
+    /// runs; for DELEGATECALL and CALLCODE that code runs in the context of @a _from. @a _gas is
+    /// the gas limit of the transaction for the outermost call and the gas given to the call
+    /// otherwise.
+    virtual void enter(Instruction _op, Address const& _from, Address const& _to,
+        u256 const& _value, u256 const& _gas, bytesConstRef _input, State const& _state) = 0;
+
+    /// Called when the call or creation entered last has finished.
+    virtual void exit(u256 const& _gasUsed, bytesConstRef _output, TransactionException _exception) = 0;
+
+    /// Called before an account is read or changed other than as the sender or recipient of a
+    /// call, e.g. by BALANCE or SELFDESTRUCT, or by the payment for the gas of the transaction.
+    virtual void accountAccess(Address const& _address, State const& _state) = 0;
+
+    /// Called before the storage slot @a _key of @a _address is read or written.
+    virtual void storageAccess(Address const& _address, u256 const& _key, State const& _state) = 0;
+};
+
+/// Records the tree of calls of a transaction with their sender, recipient, value, gas, input,
+/// output and error.
+class CallTreeTracer : public CallTracer
+{
+public:
+    void enter(Instruction _op, Address const& _from, Address const& _to, u256 const& _value,
+        u256 const& _gas, bytesConstRef _input, State const& _state) override;
+    void exit(u256 const& _gasUsed, bytesConstRef _output, TransactionException _exception) override;
+    void accountAccess(Address const&, State const&) override {}
+    void storageAccess(Address const&, u256 const&, State const&) override {}
+
+    /// @returns the outermost call with the nested ones in "calls", null before any call.
+    Json::Value jsonValue() const;
+
+private:
+    struct Call
+    {
+        Instruction op;
+        Address from;
+        Address to;
+        u256 value;
+        u256 gas;
+        u256 gasUsed;
+        bytes input;
+        bytes output;
+        TransactionException exception = TransactionException::None;
+        std::vector<Call> calls;
+    };
+
+    static Json::Value toJson(Call const& _call);
+
+    std::vector<Call> m_root;
+    /// The calls which have been entered and not exited yet, innermost last. A call is only
+    /// added to its parent when the calls before it are done, so these stay valid.
+    std::vector<Call*> m_open;
+};
+
+/// Records the state before a transaction of the accounts and storage slots the transaction
+/// touches. Accounts which don't exist before the transaction are left out.
+class PrestateTracer : public CallTracer
+{
+public:
+    void enter(Instruction _op, Address const& _from, Address const& _to, u256 const& _value,
+        u256 const& _gas, bytesConstRef _input, State const& _state) override;
+    void exit(u256 const&, bytesConstRef, TransactionException) override {}
+    void accountAccess(Address const& _address, State const& _state) override;
+    void storageAccess(Address const& _address, u256 const& _key, State const& _state) override;
+
+    /// @returns the accounts by address with their balance, nonce, code and storage.
+    Json::Value jsonValue() const;
+
+private:
+    struct Account
+    {
+        bool exists = false;
+        u256 balance;
+        u256 nonce;
+        bytes code;
+        std::map<u256, u256> storage;
+    };
+
+    Account& account(Address const& _address, State const& _state);
+
+    std::map<Address, Account> m_accounts;
+};
+
+}  // namespace eth
+}  // namespace dev
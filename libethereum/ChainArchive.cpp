@@ -0,0 +1,191 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "ChainArchive.h"
+#include "BlockChain.h"
+
+#include <libdevcore/CommonIO.h>
+#include <libdevcore/ForEachInOrder.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <snappy.h>
+
+#include <iomanip>
+#include <sstream>
+
+namespace fs = boost::filesystem;
+
+namespace dev
+{
+namespace eth
+{
+namespace
+{
+char const* const c_indexFileName = "index";
+
+struct Segment
+{
+    unsigned first;
+    unsigned count;
+    h256 hash;  ///< Hash of the compressed file.
+};
+
+/// The blocks of a segment ready to be imported.
+struct VerifiedSegment
+{
+    VerifiedBlocks blocks;
+    unsigned known = 0;
+};
+
+fs::path segmentPath(fs::path const& _dir, unsigned _first)
+{
+    std::ostringstream name;
+    name << std::setw(10) << std::setfill('0') << _first << ".blocks";
+    return _dir / name.str();
+}
+
+std::vector<Segment> readIndex(BlockChain const& _blockChain, fs::path const& _dir)
+{
+    bytes const index = contents(_dir / c_indexFileName);
+    if (index.empty())
+        BOOST_THROW_EXCEPTION(FailedToReadChainArchiveIndex());
+
+    RLP const rlp(index);
+    if (rlp[0].toInt<unsigned>() != c_chainArchiveVersion)
+        BOOST_THROW_EXCEPTION(UnsupportedChainArchiveVersion());
+    if (rlp[1].toHash<h256>() != _blockChain.genesisHash())
+        BOOST_THROW_EXCEPTION(ChainArchiveGenesisMismatch());
+
+    std::vector<Segment> segments;
+    for (auto const& segment : rlp[2])
+        segments.push_back(Segment{segment[0].toInt<unsigned>(), segment[1].toInt<unsigned>(),
+            segment[2].toHash<h256>()});
+    return segments;
+}
+}  // namespace
+
+void ChainArchive::exportBlocks(BlockChain const& _blockChain, unsigned _from, unsigned _to,
+    fs::path const& _dir, ChainArchiveProgress const& _progress) const
+{
+    fs::create_directories(_dir);
+    fs::remove(_dir / c_indexFileName);
+    if (_from > _to)
+        return;
+
+    unsigned const total = _to - _from + 1;
+    unsigned const segmentCount = (total + m_segmentBlocks - 1) / m_segmentBlocks;
+
+    std::function<Segment(unsigned)> const writeSegment = [&](unsigned _segment) {
+        Segment segment;
+        segment.first = _from + _segment * m_segmentBlocks;
+        segment.count = std::min(m_segmentBlocks, _to - segment.first + 1);
+
+        RLPStream blocks(segment.count);
+        for (unsigned i = segment.first; i < segment.first + segment.count; ++i)
+            blocks.appendRaw(_blockChain.block(_blockChain.numberHash(i)));
+
+        bytes const& uncompressed = blocks.out();
+        std::string compressed;
+        snappy::Compress(
+            reinterpret_cast<char const*>(uncompressed.data()), uncompressed.size(), &compressed);
+
+        segment.hash = sha3(compressed);
+        writeFile(segmentPath(_dir, segment.first), bytesConstRef(compressed));
+        return segment;
+    };
+
+    RLPStream segments(segmentCount);
+    unsigned done = 0;
+    forEachInOrder<Segment>(0, segmentCount - 1, m_threads, writeSegment,
+        [&](unsigned, Segment& _segment) {
+            segments.appendList(3) << _segment.first << _segment.count << _segment.hash;
+            done += _segment.count;
+            if (_progress)
+                _progress(done, total);
+        });
+
+    RLPStream index(3);
+    index << c_chainArchiveVersion << _blockChain.genesisHash();
+    index.appendRaw(segments.out());
+    writeFile(_dir / c_indexFileName, index.out());
+
+    LOG(m_logger) << "Exported " << total << " blocks in " << segmentCount << " segments to "
+                  << _dir.string();
+}
+
+unsigned ChainArchive::importBlocks(BlockChain const& _blockChain, fs::path const& _dir,
+    ChainArchiveImport const& _import, bool _checkSeals, ChainArchiveProgress const& _progress) const
+{
+    std::vector<Segment> const segments = readIndex(_blockChain, _dir);
+    if (segments.empty())
+        return 0;
+
+    unsigned total = 0;
+    for (auto const& segment : segments)
+        total += segment.count;
+
+    ImportRequirements::value const requirements =
+        _checkSeals ? ImportRequirements::OutOfOrderChecks :
+                      ImportRequirements::OutOfOrderChecks & ~ImportRequirements::ValidSeal &
+                          ~ImportRequirements::UncleSeals;
+
+    std::function<VerifiedSegment(unsigned)> const readSegment = [&](unsigned _segment) {
+        Segment const& segment = segments[_segment];
+        std::string const compressed = contentsString(segmentPath(_dir, segment.first));
+        if (sha3(compressed) != segment.hash)
+            BOOST_THROW_EXCEPTION(ChainArchiveSegmentCorrupted() << errinfo_hash256(segment.hash));
+
+        std::string uncompressed;
+        if (!snappy::Uncompress(compressed.data(), compressed.size(), &uncompressed))
+            BOOST_THROW_EXCEPTION(ChainArchiveSegmentCorrupted() << errinfo_hash256(segment.hash));
+
+        RLP const blocks(uncompressed);
+        if (!blocks.isList() || blocks.itemCount() != segment.count)
+            BOOST_THROW_EXCEPTION(ChainArchiveSegmentCorrupted() << errinfo_hash256(segment.hash));
+
+        VerifiedSegment ret;
+        ret.blocks.reserve(segment.count);
+        for (auto const& block : blocks)
+        {
+            bytesConstRef const data = block.data();
+            if (_blockChain.isKnown(BlockHeader::headerHashFromBlock(data)))
+            {
+                ++ret.known;
+                continue;
+            }
+
+            VerifiedBlock verified;
+            verified.blockData = data.toBytes();
+            verified.verified = _blockChain.verifyBlock(&verified.blockData, {}, requirements);
+            ret.blocks.push_back(std::move(verified));
+        }
+        return ret;
+    };
+
+    unsigned imported = 0;
+    unsigned done = 0;
+    forEachInOrder<VerifiedSegment>(0, segments.size() - 1, m_threads, readSegment,
+        [&](unsigned _segment, VerifiedSegment& _verified) {
+            if (!_verified.blocks.empty())
+            {
+                h256s const bad = _import(_verified.blocks);
+                if (!bad.empty())
+                    BOOST_THROW_EXCEPTION(ChainArchiveBadBlock() << errinfo_hash256(bad.front()));
+                imported += _verified.blocks.size();
+            }
+            done += segments[_segment].count;
+            if (_progress)
+                _progress(done, total);
+        });
+
+    LOG(m_logger) << "Imported " << imported << " blocks from " << _dir.string() << ", "
+                  << total - imported << " already known";
+    return imported;
+}
+
+}  // namespace eth
+}  // namespace dev
@@ -0,0 +1,81 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Export of the blocks of the chain into a directory of compressed segment files and import of
+/// such an archive, both processing the segments in parallel.
+#pragma once
+
+#include "VerifiedBlock.h"
+
+#include <libdevcore/Exceptions.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Log.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace dev
+{
+namespace eth
+{
+class BlockChain;
+
+DEV_SIMPLE_EXCEPTION(FailedToReadChainArchiveIndex);
+DEV_SIMPLE_EXCEPTION(UnsupportedChainArchiveVersion);
+DEV_SIMPLE_EXCEPTION(ChainArchiveGenesisMismatch);
+DEV_SIMPLE_EXCEPTION(ChainArchiveSegmentCorrupted);
+DEV_SIMPLE_EXCEPTION(ChainArchiveBadBlock);
+
+/// Version of the archive format, written into the index.
+unsigned const c_chainArchiveVersion = 1;
+
+/// Number of blocks in a segment file.
+unsigned const c_chainArchiveSegmentBlocks = 1024;
+
+/// Called with the number of blocks processed so far and the total number of blocks.
+using ChainArchiveProgress = std::function<void(unsigned _done, unsigned _total)>;
+
+/// Imports the verified blocks of a segment into the chain in order.
+/// @returns the hashes of the blocks which failed to import.
+using ChainArchiveImport = std::function<h256s(VerifiedBlocks const& _blocks)>;
+
+/// Archive of a range of blocks: a directory with the segment files, each holding the
+/// snappy-compressed RLP list of a run of consecutive blocks, and an "index" file listing the
+/// segments with the hashes of their files. The index is written last, so an interrupted export
+/// leaves no index behind.
+class ChainArchive
+{
+public:
+    explicit ChainArchive(unsigned _threads = std::thread::hardware_concurrency(),
+        unsigned _segmentBlocks = c_chainArchiveSegmentBlocks)
+      : m_threads(std::max(1u, _threads)), m_segmentBlocks(std::max(1u, _segmentBlocks))
+    {}
+
+    /// Writes the blocks @a _from to @a _to of the canonical chain of @a _blockChain into
+    /// @a _dir, compressing the segments in parallel.
+    void exportBlocks(BlockChain const& _blockChain, unsigned _from, unsigned _to,
+        boost::filesystem::path const& _dir, ChainArchiveProgress const& _progress = {}) const;
+
+    /// Reads the archive in @a _dir and passes its blocks unknown to @a _blockChain to @a _import.
+    /// The segments are read, decompressed and verified in parallel, a few segments ahead of the
+    /// one being imported; the seals are checked as well unless @a _checkSeals is false.
+    /// @returns the number of blocks passed to @a _import.
+    /// Throws ChainArchiveBadBlock if @a _import fails to import a block.
+    unsigned importBlocks(BlockChain const& _blockChain, boost::filesystem::path const& _dir,
+        ChainArchiveImport const& _import, bool _checkSeals = true,
+        ChainArchiveProgress const& _progress = {}) const;
+
+private:
+    unsigned const m_threads;
+    unsigned const m_segmentBlocks;
+
+    mutable Logger m_logger{createLogger(VerbosityInfo, "chain")};
+};
+
+}  // namespace eth
+}  // namespace dev
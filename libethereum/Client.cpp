@@ -10,6 +10,7 @@
 #include "TransactionQueue.h"
 #include <libdevcore/DBFactory.h>
 #include <libdevcore/Log.h>
+#include <libdevcore/Metrics.h>
 #include <libp2p/Host.h>
 #include <boost/filesystem.hpp>
 #include <chrono>
@@ -76,11 +77,51 @@ Client::Client(ChainParams const& _params, int _networkID, p2p::Host& _host,
 
 Client::~Client()
 {
+    MetricsRegistry::instance().removeCollector(this);
     m_signalled.notify_all(); // to wake up the thread from Client::doWork()
     stopWorking();
     terminate();
 }
 
+void Client::registerMetrics()
+{
+    auto& registry = MetricsRegistry::instance();
+    auto const blockQueueGauge = [&](char const* _state) -> MetricGauge& {
+        return registry.gauge("aleth_block_queue_blocks", "Blocks in the block queue by state.",
+            std::string("state=\"") + _state + "\"");
+    };
+    auto const transactionQueueGauge = [&](char const* _state) -> MetricGauge& {
+        return registry.gauge("aleth_transaction_queue_transactions",
+            "Transactions in the transaction queue by state.",
+            std::string("state=\"") + _state + "\"");
+    };
+    MetricGauge* const bq[] = {&blockQueueGauge("importing"), &blockQueueGauge("verified"),
+        &blockQueueGauge("verifying"), &blockQueueGauge("unverified"), &blockQueueGauge("future"),
+        &blockQueueGauge("unknown"), &blockQueueGauge("bad")};
+    MetricGauge* const tq[] = {&transactionQueueGauge("current"), &transactionQueueGauge("future"),
+        &transactionQueueGauge("unverified"), &transactionQueueGauge("dropped")};
+    MetricGauge& height = registry.gauge("aleth_chain_height", "Number of the best block.");
+
+    registry.addCollector(this, [=, &height]() {
+        BlockQueueStatus const b = m_bq.status();
+        bq[0]->set(b.importing);
+        bq[1]->set(b.verified);
+        bq[2]->set(b.verifying);
+        bq[3]->set(b.unverified);
+        bq[4]->set(b.future);
+        bq[5]->set(b.unknown);
+        bq[6]->set(b.bad);
+
+        TransactionQueue::Status const t = m_tq.status();
+        tq[0]->set(t.current);
+        tq[1]->set(t.future);
+        tq[2]->set(t.unverified);
+        tq[3]->set(t.dropped);
+
+        height.set(bc().number());
+    });
+}
+
 void Client::init(p2p::Host& _extNet, fs::path const& _dbPath,
     fs::path const& _snapshotDownloadPath, WithExisting _forceAction, u256 _networkId)
 {
@@ -114,6 +155,8 @@ void Client::init(p2p::Host& _extNet, fs::path const& _dbPath,
     if (_forceAction == WithExisting::Rescue)
         bc().rescue(m_stateDB);
 
+    registerMetrics();
+
     m_gp->update(bc());
 
     // create Ethereum capability only if we're not downloading the snapshot
@@ -154,6 +197,12 @@ tuple<ImportRoute, bool, unsigned> Client::syncQueue(unsigned _max)
     return bc().sync(m_bq, m_stateDB, _max);
 }
 
+tuple<ImportRoute, h256s, unsigned> Client::importVerifiedBlocks(VerifiedBlocks const& _blocks)
+{
+    stopWorking();
+    return bc().sync(_blocks, m_stateDB);
+}
+
 void Client::onBadBlock(Exception& _ex) const
 {
     // BAD BLOCK!!!
@@ -647,34 +696,48 @@ void Client::rejigSealing()
 
 void Client::noteChanged(h256Hash const& _filters)
 {
-    Guard l(x_filtersWatches);
-    if (_filters.size())
-        LOG(m_loggerWatch) << "noteChanged: " << filtersToString(_filters);
-    // accrue all changes left in each filter into the watches.
-    for (auto& w: m_watches)
-        if (_filters.count(w.second.id))
-        {
-            if (m_filters.count(w.second.id))
+    vector<pair<WatchCallback, LocalisedLogEntries>> notifications;
+    {
+        Guard l(x_filtersWatches);
+        if (_filters.size())
+            LOG(m_loggerWatch) << "noteChanged: " << filtersToString(_filters);
+        // accrue all changes left in each filter into the watches.
+        for (auto& w: m_watches)
+            if (_filters.count(w.second.id))
             {
-                LOG(m_loggerWatch) << "!!! " << w.first << " " << w.second.id.abridged();
-                w.second.changes += m_filters.at(w.second.id).changes;
-            }
-            else if (m_specialFilters.count(w.second.id))
-                for (h256 const& hash: m_specialFilters.at(w.second.id))
+                if (m_filters.count(w.second.id))
                 {
-                    LOG(m_loggerWatch)
-                        << "!!! " << w.first << " "
-                        << (w.second.id == PendingChangedFilter ?
-                                   "pending" :
-                                   w.second.id == ChainChangedFilter ? "chain" : "???");
-                    w.second.changes.push_back(LocalisedLogEntry(SpecialLogEntry, hash));
+                    LOG(m_loggerWatch) << "!!! " << w.first << " " << w.second.id.abridged();
+                    w.second.changes += m_filters.at(w.second.id).changes;
                 }
-        }
-    // clear the filters now.
-    for (auto& i: m_filters)
-        i.second.changes.clear();
-    for (auto& i: m_specialFilters)
-        i.second.clear();
+                else if (m_specialFilters.count(w.second.id))
+                    for (h256 const& hash: m_specialFilters.at(w.second.id))
+                    {
+                        LOG(m_loggerWatch)
+                            << "!!! " << w.first << " "
+                            << (w.second.id == PendingChangedFilter ?
+                                       "pending" :
+                                       w.second.id == ChainChangedFilter ? "chain" : "???");
+                        w.second.changes.push_back(LocalisedLogEntry(SpecialLogEntry, hash));
+                    }
+
+                // subscribed watches get the changes right away
+                if (w.second.onChange && !w.second.changes.empty())
+                {
+                    notifications.emplace_back(w.second.onChange, LocalisedLogEntries());
+                    swap(notifications.back().second, w.second.changes);
+                }
+            }
+        // clear the filters now.
+        for (auto& i: m_filters)
+            i.second.changes.clear();
+        for (auto& i: m_specialFilters)
+            i.second.clear();
+    }
+
+    // the callbacks may query the client, so they are called without the lock
+    for (auto const& notification : notifications)
+        notification.first(notification.second);
 }
 
 void Client::doWork(bool _doWait)
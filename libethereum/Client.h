@@ -121,6 +121,10 @@ public:
     /// Freeze worker thread and sync some of the block queue.
     std::tuple<ImportRoute, bool, unsigned> syncQueue(unsigned _max = 1);
 
+    /// Freeze worker thread and import the already verified blocks, bypassing the block queue.
+    /// @returns the same as BlockChain::sync().
+    std::tuple<ImportRoute, h256s, unsigned> importVerifiedBlocks(VerifiedBlocks const& _blocks);
+
     // Sealing stuff:
     // Note: "mining"/"miner" is deprecated. Use "sealing"/"sealer".
 
@@ -217,6 +221,9 @@ protected:
     void init(p2p::Host& _extNet, boost::filesystem::path const& _dbPath,
         boost::filesystem::path const& _snapshotPath, WithExisting _forceAction, u256 _networkId);
 
+    /// Exports the sizes of the queues and the chain height, see MetricsRegistry.
+    void registerMetrics();
+
     /// InterfaceStub methods
     BlockChain& bc() override { return m_bc; }
     BlockChain const& bc() const override { return m_bc; }
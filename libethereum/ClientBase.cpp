@@ -15,52 +15,122 @@ using namespace dev::eth;
 
 static const int64_t c_maxGasEstimate = 50000000;
 
+namespace
+{
+/// Snapshot pinned on this thread and the client it is pinned for.
+thread_local ClientBase const* t_pinnedClient = nullptr;
+thread_local HeadSnapshot const* t_pinnedSnapshot = nullptr;
+
+bool isOutOfGas(ExecutionResult const& _er)
+{
+    return _er.excepted == TransactionException::OutOfGas ||
+           _er.excepted == TransactionException::OutOfGasBase ||
+           _er.excepted == TransactionException::OutOfGasIntrinsic ||
+           _er.codeDeposit == CodeDeposit::Failed ||
+           _er.excepted == TransactionException::BadJumpDestination;
+}
+}  // namespace
+
 std::pair<u256, ExecutionResult> ClientBase::estimateGas(Address const& _from, u256 _value, Address _dest, bytes const& _data, int64_t _maxGas, u256 _gasPrice, BlockNumber _blockNumber, GasEstimationCallback const& _callback)
 {
     try
     {
-        int64_t upperBound = _maxGas;
-        if (upperBound == Invalid256 || upperBound > c_maxGasEstimate)
-            upperBound = c_maxGasEstimate;
-        int64_t lowerBound = Transaction::baseGasRequired(!_dest, &_data, EVMSchedule());
         Block bk = blockByNumber(_blockNumber);
-        u256 gasPrice = _gasPrice == Invalid256 ? gasBidPrice() : _gasPrice;
-        ExecutionResult er;
-        ExecutionResult lastGood;
-        bool good = false;
-        while (upperBound != lowerBound)
-        {
-            int64_t mid = (lowerBound + upperBound) / 2;
-            u256 n = bk.transactionsFrom(_from);
+        SealEngineFace const& sealEngine = *bc().sealEngine();
+        u256 const gasPrice = _gasPrice == Invalid256 ? gasBidPrice() : _gasPrice;
+        u256 const nonce = bk.transactionsFrom(_from);
+
+        // Every execution starts from a copy of this state, which keeps the accounts, storage and
+        // code read by the previous executions.
+        State const warmState(bk.state());
+        auto const execute = [&](int64_t _gas) {
             Transaction t;
             if (_dest)
-                t = Transaction(_value, gasPrice, mid, _dest, _data, n);
+                t = Transaction(_value, gasPrice, _gas, _dest, _data, nonce);
             else
-                t = Transaction(_value, gasPrice, mid, _data, n);
+                t = Transaction(_value, gasPrice, _gas, _data, nonce);
             t.forceSender(_from);
-            EnvInfo const env(bk.info(), bc().lastBlockHashes(), 0, mid);
-            State tempState(bk.state());
+            EnvInfo const env(
+                bk.info(), bc().lastBlockHashes(), 0, _gas, sealEngine.chainParams().chainID);
+            State tempState(warmState);
             tempState.addBalance(_from, (u256)(t.gas() * t.gasPrice() + t.value()));
-            er = tempState.execute(env, *bc().sealEngine(), t, Permanence::Reverted).first;
-            if (er.excepted == TransactionException::OutOfGas ||
-                er.excepted == TransactionException::OutOfGasBase ||
-                er.excepted == TransactionException::OutOfGasIntrinsic ||
-                er.codeDeposit == CodeDeposit::Failed ||
-                er.excepted == TransactionException::BadJumpDestination)
-                    lowerBound = lowerBound == mid ? upperBound : mid;
+            ExecutionResult const er =
+                tempState.execute(env, sealEngine, t, Permanence::Uncommitted).first;
+            warmState.warmUpCache(tempState);
+            return er;
+        };
+
+        // lowerBound is the highest gas known to be not enough, upperBound the lowest known to be
+        // enough
+        int64_t upperBound = _maxGas;
+        if (upperBound == Invalid256 || upperBound > c_maxGasEstimate)
+            upperBound = c_maxGasEstimate;
+        int64_t lowerBound =
+            Transaction::baseGasRequired(!_dest, &_data, sealEngine.evmSchedule(bk.info().number())) - 1;
+        auto const reportProgress = [&]() {
+            if (_callback)
+                _callback(GasEstimationProgress{lowerBound, upperBound});
+        };
+
+        // Execute once with the cap to learn the gas actually used; if it fails with the cap, it
+        // fails with any gas.
+        ExecutionResult lastGood = execute(upperBound);
+        if (isOutOfGas(lastGood))
+        {
+            lowerBound = upperBound;
+            reportProgress();
+            return make_pair(upperBound, lastGood);
+        }
+
+        // The refund is given only after execution, so the peak consumption is the used gas plus
+        // the refund, which is usually the exact answer. At most half of the peak is refunded, so
+        // a capped refund leaves the peak known only up to one. Less than the peak is not enough,
+        // unless the code depends on the gas left.
+        int64_t const used = static_cast<int64_t>(lastGood.gasUsed);
+        int64_t const refunded = static_cast<int64_t>(min<u256>(lastGood.gasRefunded, used));
+        int64_t const peak = used + refunded;
+        lowerBound = max(lowerBound, min(refunded == used ? peak - 1 : peak, upperBound) - 1);
+        auto const probe = [&](int64_t _gas) {
+            ExecutionResult const er = execute(_gas);
+            if (isOutOfGas(er))
+                lowerBound = _gas;
             else
             {
+                upperBound = _gas;
                 lastGood = er;
-                upperBound = upperBound == mid ? lowerBound : mid;
-                good = true;
             }
+            reportProgress();
+        };
+        reportProgress();
 
-            if (_callback)
-                _callback(GasEstimationProgress { lowerBound, upperBound });
+        if (peak > lowerBound && peak < upperBound)
+        {
+            probe(peak);
+            if (upperBound == peak)
+            {
+                if (peak - 1 > lowerBound)
+                    probe(peak - 1);
+            }
+            else
+            {
+                // Calls forward at most 63/64 of the remaining gas, so the transaction might need
+                // somewhat more than the peak; widen the window until an upper bound close to it
+                // is found.
+                for (int64_t step = max<int64_t>(peak / 63, 1);
+                     upperBound - lowerBound > step * 2; step *= 2)
+                {
+                    int64_t const gas = lowerBound + step;
+                    probe(gas);
+                    if (upperBound == gas)
+                        break;
+                }
+            }
         }
-        if (_callback)
-            _callback(GasEstimationProgress { lowerBound, upperBound });
-        return make_pair(upperBound, good ? lastGood : er);
+
+        while (upperBound - lowerBound > 1)
+            probe(lowerBound + (upperBound - lowerBound) / 2);
+
+        return make_pair(upperBound, lastGood);
     }
     catch (...)
     {
@@ -128,13 +198,14 @@ LocalisedLogEntries ClientBase::logs(unsigned _watchId) const
 LocalisedLogEntries ClientBase::logs(LogFilter const& _f) const
 {
     LocalisedLogEntries ret;
-    unsigned begin = min(bc().number() + 1, (unsigned)numberFromHash(_f.latest()));
-    unsigned end = min(bc().number(), min(begin, (unsigned)numberFromHash(_f.earliest())));
+    unsigned const head = number();
+    unsigned begin = min(head + 1, (unsigned)numberFromHash(_f.latest()));
+    unsigned end = min(head, min(begin, (unsigned)numberFromHash(_f.earliest())));
     
     // Handle pending transactions differently as they're not on the block chain.
-    if (begin > bc().number())
+    if (begin > head)
     {
-        Block temp = postSeal();
+        Block temp = pendingBlock();
         for (unsigned i = 0; i < temp.pending().size(); ++i)
         {
             // Might have a transaction that contains a matching log.
@@ -143,7 +214,7 @@ LocalisedLogEntries ClientBase::logs(LogFilter const& _f) const
             for (unsigned j = 0; j < le.size(); ++j)
                 ret.insert(ret.begin(), LocalisedLogEntry(le[j]));
         }
-        begin = bc().number();
+        begin = head;
     }
 
     // Handle reverted blocks
@@ -211,6 +282,8 @@ unsigned ClientBase::installWatch(LogFilter const& _f, Reaping _r)
             LOG(m_loggerWatch) << "FFF" << _f << h;
             m_filters.insert(make_pair(h, _f));
         }
+        else
+            ++m_filters.at(h).refCount;
     }
     return installWatch(h, _r);
 }
@@ -236,6 +309,22 @@ unsigned ClientBase::installWatch(h256 _h, Reaping _r)
     return ret;
 }
 
+unsigned ClientBase::installWatch(LogFilter const& _f, WatchCallback const& _onChange)
+{
+    unsigned const ret = installWatch(_f, Reaping::Manual);
+    Guard l(x_filtersWatches);
+    m_watches.at(ret).onChange = _onChange;
+    return ret;
+}
+
+unsigned ClientBase::installWatch(h256 _h, WatchCallback const& _onChange)
+{
+    unsigned const ret = installWatch(_h, Reaping::Manual);
+    Guard l(x_filtersWatches);
+    m_watches.at(ret).onChange = _onChange;
+    return ret;
+}
+
 bool ClientBase::uninstallWatch(unsigned _i)
 {
     LOG(m_loggerWatch) << "XXX" << _i;
@@ -290,7 +379,11 @@ LocalisedLogEntries ClientBase::checkWatch(unsigned _watchId)
 BlockHeader ClientBase::blockInfo(h256 _hash) const
 {
     if (_hash == PendingBlockHash)
+    {
+        if (auto const head = pinnedHead())
+            return head->pending.info();
         return preSeal().info();
+    }
     return BlockHeader(bc().block(_hash));
 }
 
@@ -402,26 +495,31 @@ unsigned ClientBase::uncleCount(h256 _blockHash) const
 
 unsigned ClientBase::number() const
 {
+    if (auto const head = pinnedHead())
+        return head->number;
     return bc().number();
 }
 
 h256s ClientBase::pendingHashes() const
 {
-    return h256s() + postSeal().pendingHashes();
+    return h256s() + pendingBlock().pendingHashes();
 }
 
 BlockHeader ClientBase::pendingInfo() const
 {
+    if (auto const head = pinnedHead())
+        return head->pending.info();
     return postSeal().info();
 }
 
 BlockDetails ClientBase::pendingDetails() const
 {
-    auto const pendingHeader = postSeal().info();
+    Block const pending = pendingBlock();
+    auto const pendingHeader = pending.info();
     auto const latestDetails = Interface::blockDetails(LatestBlock);
     return BlockDetails{static_cast<unsigned>(pendingHeader.number()),
         latestDetails.totalDifficulty + pendingHeader.difficulty(), pendingHeader.parentHash(),
-        h256s{} /* children */, postSeal().blockData().size()};
+        h256s{} /* children */, pending.blockData().size()};
 }
 
 Addresses ClientBase::addresses(BlockNumber _block) const
@@ -434,7 +532,7 @@ Addresses ClientBase::addresses(BlockNumber _block) const
 
 u256 ClientBase::gasLimitRemaining() const
 {
-    return postSeal().gasLimitRemaining();
+    return pendingBlock().gasLimitRemaining();
 }
 
 Address ClientBase::author() const
@@ -447,16 +545,20 @@ h256 ClientBase::hashFromNumber(BlockNumber _number) const
     if (_number == PendingBlock)
         return h256();
     if (_number == LatestBlock)
+    {
+        if (auto const head = pinnedHead())
+            return head->hash;
         return bc().currentHash();
+    }
     return bc().numberHash(_number);
 }
 
 BlockNumber ClientBase::numberFromHash(h256 _blockHash) const
 {
     if (_blockHash == PendingBlockHash)
-        return bc().number() + 1;
+        return number() + 1;
     else if (_blockHash == LatestBlockHash)
-        return bc().number();
+        return number();
     else if (_blockHash == EarliestBlockHash)
         return 0;
     return bc().number(_blockHash);
@@ -502,12 +604,46 @@ bool ClientBase::isKnownTransaction(h256 const& _blockHash, unsigned _i) const
 Block ClientBase::blockByNumber(BlockNumber _h) const
 {
     if (_h == PendingBlock)
-        return postSeal();
+        return pendingBlock();
     else if (_h == LatestBlock)
-        return block(bc().currentHash());
+        return block(hashFromNumber(LatestBlock));
     return block(bc().numberHash(_h));
 }
 
+shared_ptr<HeadSnapshot const> ClientBase::headSnapshot() const
+{
+    h256 const hash = bc().currentHash();
+    return make_shared<HeadSnapshot const>(HeadSnapshot{hash, bc().number(hash), postSeal()});
+}
+
+ClientBase::PinnedHead::PinnedHead(
+    ClientBase const& _client, shared_ptr<HeadSnapshot const> _snapshot)
+  : m_snapshot(move(_snapshot)),
+    m_previousClient(t_pinnedClient),
+    m_previousSnapshot(t_pinnedSnapshot)
+{
+    t_pinnedClient = &_client;
+    t_pinnedSnapshot = m_snapshot.get();
+}
+
+ClientBase::PinnedHead::~PinnedHead()
+{
+    t_pinnedClient = m_previousClient;
+    t_pinnedSnapshot = m_previousSnapshot;
+}
+
+HeadSnapshot const* ClientBase::pinnedHead() const
+{
+    return t_pinnedClient == this ? t_pinnedSnapshot : nullptr;
+}
+
+Block ClientBase::pendingBlock() const
+{
+    if (auto const head = pinnedHead())
+        return head->pending;
+    return postSeal();
+}
+
 int ClientBase::chainId() const
 {
 	return bc().chainParams().chainID;
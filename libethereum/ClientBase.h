@@ -45,6 +45,16 @@ struct ClientWatch
     LocalisedLogEntries changes;
 #endif
     mutable std::chrono::system_clock::time_point lastPoll = std::chrono::system_clock::now();
+    /// If set, the changes are passed to it instead of being accumulated.
+    WatchCallback onChange;
+};
+
+/// The head of the chain and the pending block on top of it, captured at one moment.
+struct HeadSnapshot
+{
+    h256 hash;
+    unsigned number;
+    Block pending;
 };
 
 class ClientBase: public Interface
@@ -80,6 +90,8 @@ public:
     /// Install, uninstall and query watches.
     unsigned installWatch(LogFilter const& _filter, Reaping _r = Reaping::Automatic) override;
     unsigned installWatch(h256 _filterId, Reaping _r = Reaping::Automatic) override;
+    unsigned installWatch(LogFilter const& _filter, WatchCallback const& _onChange) override;
+    unsigned installWatch(h256 _filterId, WatchCallback const& _onChange) override;
     bool uninstallWatch(unsigned _watchId) override;
     LocalisedLogEntries peekWatch(unsigned _watchId) const override;
     LocalisedLogEntries checkWatch(unsigned _watchId) override;
@@ -97,12 +109,12 @@ public:
     LocalisedTransactionReceipt localisedTransactionReceipt(h256 const& _transactionHash) const override;
     std::pair<h256, unsigned> transactionLocation(h256 const& _transactionHash) const override;
     Transactions transactions(h256 _blockHash) const override;
-    Transactions transactions(BlockNumber _block) const override { if (_block == PendingBlock) return postSeal().pending(); return transactions(hashFromNumber(_block)); }
+    Transactions transactions(BlockNumber _block) const override { if (_block == PendingBlock) return pendingBlock().pending(); return transactions(hashFromNumber(_block)); }
     TransactionHashes transactionHashes(h256 _blockHash) const override;
     BlockHeader uncle(h256 _blockHash, unsigned _i) const override;
     UncleHashes uncleHashes(h256 _blockHash) const override;
     unsigned transactionCount(h256 _blockHash) const override;
-    unsigned transactionCount(BlockNumber _block) const override { if (_block == PendingBlock) { auto p = postSeal().pending(); return p.size(); } return transactionCount(hashFromNumber(_block)); }
+    unsigned transactionCount(BlockNumber _block) const override { if (_block == PendingBlock) { auto p = pendingBlock().pending(); return p.size(); } return transactionCount(hashFromNumber(_block)); }
     unsigned uncleCount(h256 _blockHash) const override;
     unsigned number() const override;
     h256s pendingHashes() const override;
@@ -152,6 +164,23 @@ public:
 
     int chainId() const override;
 
+    /// @returns the current head of the chain and the pending block.
+    std::shared_ptr<HeadSnapshot const> headSnapshot() const;
+
+    /// While alive, LatestBlock and PendingBlock in the calls made to a client on the current
+    /// thread resolve to the snapshot given, instead of the head the client has at each call.
+    class PinnedHead
+    {
+    public:
+        PinnedHead(ClientBase const& _client, std::shared_ptr<HeadSnapshot const> _snapshot);
+        ~PinnedHead();
+
+    private:
+        std::shared_ptr<HeadSnapshot const> m_snapshot;
+        ClientBase const* m_previousClient;
+        HeadSnapshot const* m_previousSnapshot;
+    };
+
 protected:
     /// The interface that must be implemented in any class deriving this.
     /// {
@@ -163,6 +192,11 @@ protected:
     virtual void prepareForTransaction() = 0;
     /// }
 
+    /// @returns the snapshot pinned by PinnedHead on the current thread, or null.
+    HeadSnapshot const* pinnedHead() const;
+    /// @returns the pending block of the pinned snapshot, or postSeal() if there is none.
+    Block pendingBlock() const;
+
     // filters
     mutable Mutex x_filtersWatches;							///< Our lock.
     std::unordered_map<h256, InstalledFilter> m_filters;	///< The dictionary of filters that are active.
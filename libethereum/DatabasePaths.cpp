@@ -18,6 +18,7 @@ DatabasePaths::DatabasePaths(fs::path const& _rootPath, h256 const& _genesisHash
     m_rootPath = _rootPath;
     m_chainPath = m_rootPath / fs::path(toHex(_genesisHash.ref().cropped(0, 4)));
     m_statePath = m_chainPath / fs::path("state");
+    m_stateSnapshotPath = m_chainPath / fs::path("statesnapshot");
     m_blocksPath = m_chainPath / fs::path("blocks");
 
     auto const extrasRootPath = m_chainPath / fs::path(toString(c_databaseVersion));
@@ -41,6 +42,11 @@ fs::path const& DatabasePaths::statePath() const noexcept
     return m_statePath;
 }
 
+fs::path const& DatabasePaths::stateSnapshotPath() const noexcept
+{
+    return m_stateSnapshotPath;
+}
+
 fs::path const& DatabasePaths::blocksPath() const noexcept
 {
     return m_blocksPath;
@@ -19,6 +19,7 @@ public:
     boost::filesystem::path const& chainPath() const noexcept;
     boost::filesystem::path const& blocksPath() const noexcept;
     boost::filesystem::path const& statePath() const noexcept;
+    boost::filesystem::path const& stateSnapshotPath() const noexcept;
     boost::filesystem::path const& extrasPath() const noexcept;
     boost::filesystem::path const& extrasTemporaryPath() const noexcept;
     boost::filesystem::path const& extrasMinorVersionPath() const noexcept;
@@ -28,6 +29,7 @@ private:
     boost::filesystem::path m_chainPath;
     boost::filesystem::path m_blocksPath;
     boost::filesystem::path m_statePath;
+    boost::filesystem::path m_stateSnapshotPath;
     boost::filesystem::path m_extrasPath;
     boost::filesystem::path m_extrasTemporaryPath;
     boost::filesystem::path m_extrasMinorVersionPath;
@@ -599,9 +599,11 @@ void EthereumCapability::onTransactionImported(
             // if we already had the transaction, then don't bother sending it on.
             m_transactionsSent.insert(_h);
             m_host->updateRating(_nodeId, 0);
+            m_host->noteReceivedItems(_nodeId, 0, 1);
             break;
         case ImportResult::Success:
             m_host->updateRating(_nodeId, 100);
+            m_host->noteReceivedItems(_nodeId, 1, 0);
             break;
         default:;
         }
@@ -696,6 +698,7 @@ bool EthereumCapability::interpretCapabilityPacket(
                                       << " giving us block headers when we didn't ask for them.";
             else
             {
+                m_host->noteResponseLatency(_peerID, remotePeer.timeSinceAsk());
                 setIdle(_peerID);
                 m_peerObserver->onPeerBlockHeaders(_peerID, _r);
             }
@@ -729,6 +732,7 @@ bool EthereumCapability::interpretCapabilityPacket(
                     << "Peer " << _peerID << " giving us block bodies when we didn't ask for them.";
             else
             {
+                m_host->noteResponseLatency(_peerID, remotePeer.timeSinceAsk());
                 setIdle(_peerID);
                 m_peerObserver->onPeerBlockBodies(_peerID, _r);
             }
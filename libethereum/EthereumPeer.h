@@ -43,7 +43,17 @@ public:
 
     Asking asking() const { return m_asking; }
     bool isConversing() const { return m_asking != Asking::Nothing; }
-    void setAsking(Asking _asking) { m_asking = _asking; }
+    void setAsking(Asking _asking)
+    {
+        m_asking = _asking;
+        if (_asking != Asking::Nothing)
+            m_askTime = std::chrono::steady_clock::now();
+    }
+    /// @returns time passed since we asked the peer for something the last time.
+    std::chrono::steady_clock::duration timeSinceAsk() const
+    {
+        return std::chrono::steady_clock::now() - m_askTime;
+    }
 
     h256 latestHash() const { return m_latestHash; }
     void setLatestHash(h256 const& _hash) { m_latestHash = _hash; }
@@ -91,6 +101,8 @@ private:
     Asking m_asking = Asking::Nothing;
     /// When we asked for it. Allows a time out.
     time_t m_lastAsk = 0;
+    /// When we asked for it, used to measure response latency.
+    std::chrono::steady_clock::time_point m_askTime;
     /// Peer's protocol version.
     unsigned m_protocolVersion = 0;
     /// Peer's network id.
@@ -141,6 +141,11 @@ bool Executive::execute()
     // Pay...
     LOG(m_detailsLogger) << "Paying " << formatBalance(m_gasCost) << " from sender for gas ("
                          << m_t.gas() << " gas at " << formatBalance(m_t.gasPrice()) << ")";
+    if (m_tracer)
+    {
+        m_tracer->accountAccess(m_t.sender(), m_s);
+        m_tracer->accountAccess(m_envInfo.author(), m_s);
+    }
     m_s.subBalance(m_t.sender(), m_gasCost);
 
     assert(m_t.gas() >= (u256)m_baseGasRequired);
@@ -158,6 +163,17 @@ bool Executive::call(Address const& _receiveAddress, Address const& _senderAddre
 
 bool Executive::call(CallParameters const& _p, u256 const& _gasPrice, Address const& _origin)
 {
+    if (m_tracer)
+    {
+        // DELEGATECALL and CALLCODE run the code of codeAddress in the context of the calling
+        // contract, which is the receiveAddress of these calls.
+        bool const inCallersContext =
+            _p.op == Instruction::DELEGATECALL || _p.op == Instruction::CALLCODE;
+        m_tracer->enter(_p.op, inCallersContext ? _p.receiveAddress : _p.senderAddress,
+            inCallersContext ? _p.codeAddress : _p.receiveAddress, _p.valueTransfer,
+            m_t ? m_t.gas() : _p.gas, _p.data, m_s);
+    }
+
     // If external transaction.
     if (m_t)
     {
@@ -218,6 +234,7 @@ bool Executive::call(CallParameters const& _p, u256 const& _gasPrice, Address co
             m_ext = make_shared<ExtVM>(m_s, m_envInfo, m_sealEngine, _p.receiveAddress,
                 _p.senderAddress, _origin, _p.apparentValue, _gasPrice, _p.data, &c, codeHash,
                 version, m_depth, false, _p.staticCall);
+            m_ext->setTracer(m_tracer);
         }
     }
 
@@ -247,12 +264,17 @@ bool Executive::createWithAddressFromNonceAndSender(Address const& _sender, u256
 {
     u256 nonce = m_s.getNonce(_sender);
     m_newAddress = right160(sha3(rlpList(_sender, nonce)));
+    if (m_tracer)
+        m_tracer->enter(Instruction::CREATE, _sender, m_newAddress, _endowment,
+            m_t ? m_t.gas() : _gas, _init, m_s);
     return executeCreate(_sender, _endowment, _gasPrice, _gas, _init, _origin, _version);
 }
 
 bool Executive::create2Opcode(Address const& _sender, u256 const& _endowment, u256 const& _gasPrice, u256 const& _gas, bytesConstRef _init, Address const& _origin, u256 const& _salt)
 {
     m_newAddress = right160(sha3(bytes{0xff} +_sender.asBytes() + toBigEndian(_salt) + sha3(_init)));
+    if (m_tracer)
+        m_tracer->enter(Instruction::CREATE2, _sender, m_newAddress, _endowment, _gas, _init, m_s);
     // Contract will be created with the version equal to parent's version
     return executeCreate(
         _sender, _endowment, _gasPrice, _gas, _init, _origin, m_s.version(_sender));
@@ -297,9 +319,12 @@ bool Executive::executeCreate(Address const& _sender, u256 const& _endowment, u2
 
     // Schedule _init execution if not empty.
     if (!_init.empty())
+    {
         m_ext = make_shared<ExtVM>(m_s, m_envInfo, m_sealEngine, m_newAddress, _sender, _origin,
             _endowment, _gasPrice, bytesConstRef(), _init, sha3(_init), _version, m_depth, true,
             false);
+        m_ext->setTracer(m_tracer);
+    }
     else
         // code stays empty, but we set the version
         m_s.setCode(m_newAddress, {}, _version);
@@ -336,8 +361,9 @@ bool Executive::go(OnOpFunc const& _onOp)
 #endif
         try
         {
-            // Create VM instance. Force Interpreter if tracing requested.
-            auto vm = VMFactory::create();
+            // Create VM instance. The LegacyVM is forced for call tracers, they need the instruction
+            // of each call, which EVMC messages don't carry.
+            auto vm = m_tracer ? VMFactory::create(VMKind::Legacy) : VMFactory::create();
             if (m_isCreation)
             {
                 auto out = vm->exec(m_gas, *m_ext, _onOp);
@@ -459,6 +485,8 @@ bool Executive::finalize()
         m_res->newAddress = m_newAddress;
         m_res->gasRefunded = m_ext ? m_ext->sub.refunds : 0;
     }
+    if (m_tracer && m_t)
+        m_tracer->exit(gasUsed(), m_output, m_excepted);
     return (m_excepted == TransactionException::None);
 }
 
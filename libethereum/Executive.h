@@ -21,6 +21,7 @@ namespace eth
 class State;
 class Block;
 class BlockChain;
+class CallTracer;
 class ExtVM;
 class SealEngineFace;
 struct Manifest;
@@ -94,6 +95,8 @@ public:
     u256 gasUsed() const;
 
     owning_bytes_ref takeOutput() { return std::move(m_output); }
+    /// @returns the output of the call, or the revert data of a creation.
+    bytesConstRef output() const { return m_output; }
 
     /// Set up the executive for evaluating a bare CREATE (contract-creation) operation.
     /// @returns false iff go() must be called (and thus a VM execution in required).
@@ -128,6 +131,10 @@ public:
     /// Collect execution results in the result storage provided.
     void setResultRecipient(ExecutionResult& _res) { m_res = &_res; }
 
+    /// Report the calls of the execution and the state they access to @a _tracer, which has to
+    /// outlive the execution. Set before initialize() or call()/create().
+    void setTracer(CallTracer* _tracer) { m_tracer = _tracer; }
+
     /// Revert all changes made to the state by this execution.
     void revert();
 
@@ -149,6 +156,7 @@ private:
     std::shared_ptr<ExtVM> m_ext;		///< The VM externality object for the VM execution or null if no VM is required. shared_ptr used only to allow ExtVM forward reference. This field does *NOT* survive this object.
     owning_bytes_ref m_output;			///< Execution output.
     ExecutionResult* m_res = nullptr;	///< Optional storage for execution results.
+    CallTracer* m_tracer = nullptr;		///< Optional observer of the calls.
 
     unsigned m_depth = 0;				///< The context's call-depth.
     TransactionException m_excepted = TransactionException::None;	///< Details if the VM's execution resulted in an exception.
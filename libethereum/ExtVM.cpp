@@ -108,11 +108,14 @@ evmc_status_code transactionExceptionToEvmcStatusCode(TransactionException ex) n
 CallResult ExtVM::call(CallParameters& _p)
 {
     Executive e{m_s, envInfo(), m_sealEngine, depth + 1};
+    e.setTracer(m_tracer);
     if (!e.call(_p, gasPrice, origin))
     {
         go(depth, e, _p.onOp);
         e.accrueSubState(sub);
     }
+    if (m_tracer)
+        m_tracer->exit(_p.gas - e.gas(), e.output(), e.getException());
     _p.gas = e.gas();
 
     return {transactionExceptionToEvmcStatusCode(e.getException()), e.takeOutput()};
@@ -120,22 +123,30 @@ CallResult ExtVM::call(CallParameters& _p)
 
 size_t ExtVM::codeSizeAt(Address _a)
 {
+    if (m_tracer)
+        m_tracer->accountAccess(_a, m_s);
     return m_s.codeSize(_a);
 }
 
 h256 ExtVM::codeHashAt(Address _a)
 {
+    if (m_tracer)
+        m_tracer->accountAccess(_a, m_s);
     return exists(_a) ? m_s.codeHash(_a) : h256{};
 }
 
 void ExtVM::setStore(u256 _n, u256 _v)
 {
+    if (m_tracer)
+        m_tracer->storageAccess(myAddress, _n, m_s);
     m_s.setStorage(myAddress, _n, _v);
 }
 
 CreateResult ExtVM::create(u256 _endowment, u256& io_gas, bytesConstRef _code, Instruction _op, u256 _salt, OnOpFunc const& _onOp)
 {
     Executive e{m_s, envInfo(), m_sealEngine, depth + 1};
+    e.setTracer(m_tracer);
+    u256 const gas = io_gas;
     bool result = false;
     if (_op == Instruction::CREATE)
         result = e.createOpcode(myAddress, _endowment, gasPrice, io_gas, _code, origin);
@@ -150,12 +161,16 @@ CreateResult ExtVM::create(u256 _endowment, u256& io_gas, bytesConstRef _code, I
         go(depth, e, _onOp);
         e.accrueSubState(sub);
     }
+    if (m_tracer)
+        m_tracer->exit(gas - e.gas(), e.output(), e.getException());
     io_gas = e.gas();
     return {transactionExceptionToEvmcStatusCode(e.getException()), e.takeOutput(), e.newAddress()};
 }
 
 void ExtVM::selfdestruct(Address _a)
 {
+    if (m_tracer)
+        m_tracer->accountAccess(_a, m_s);
     // Why transfer is not used here? That caused a consensus issue before (see Quirk #2 in
     // http://martin.swende.se/blog/Ethereum_quirks_and_vulns.html). There is one test case
     // witnessing the current consensus
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "CallTracer.h"
 #include "Executive.h"
 #include "State.h"
 
@@ -43,7 +44,12 @@ public:
     }
 
     /// Read storage location.
-    u256 store(u256 _n) final { return m_s.storage(myAddress, _n); }
+    u256 store(u256 _n) final
+    {
+        if (m_tracer)
+            m_tracer->storageAccess(myAddress, _n, m_s);
+        return m_s.storage(myAddress, _n);
+    }
 
     /// Write a value in storage.
     void setStore(u256 _n, u256 _v) final;
@@ -55,7 +61,12 @@ public:
     }
 
     /// Read address's code.
-    bytes const& codeAt(Address _a) final { return m_s.code(_a); }
+    bytes const& codeAt(Address _a) final
+    {
+        if (m_tracer)
+            m_tracer->accountAccess(_a, m_s);
+        return m_s.code(_a);
+    }
 
     /// @returns the size of the code in  bytes at the given address.
     size_t codeSizeAt(Address _a) final;
@@ -70,11 +81,18 @@ public:
     CallResult call(CallParameters& _params) final;
 
     /// Read address's balance.
-    u256 balance(Address _a) final { return m_s.balance(_a); }
+    u256 balance(Address _a) final
+    {
+        if (m_tracer)
+            m_tracer->accountAccess(_a, m_s);
+        return m_s.balance(_a);
+    }
 
     /// Does the account exist?
     bool exists(Address _a) final
     {
+        if (m_tracer)
+            m_tracer->accountAccess(_a, m_s);
         if (evmSchedule().emptinessIsNonexistence())
             return m_s.accountNonemptyAndExisting(_a);
         else
@@ -89,6 +107,9 @@ public:
 
     State const& state() const { return m_s; }
 
+    /// Report the nested calls and the state accessed to @a _tracer, if not null.
+    void setTracer(CallTracer* _tracer) { m_tracer = _tracer; }
+
     /// Hash of a block if within the last 256 blocks, or h256() otherwise.
     h256 blockHash(u256 _number) final;
 
@@ -108,6 +129,7 @@ private:
     State& m_s;  ///< A reference to the base state.
     SealEngineFace const& m_sealEngine;
     EVMSchedule const& m_evmSchedule;
+    CallTracer* m_tracer = nullptr;
 };
 
 }
@@ -20,7 +20,7 @@ static std::string pairToString(std::pair<std::string const, ValueType> const& _
 
 }
 
-std::string ImportPerformanceLogger::constructReport(double _totalElapsed, std::unordered_map<std::string, std::string> const& _additionalValues)
+std::string ImportPerformanceLogger::constructReport(double _totalElapsed, std::unordered_map<std::string, std::string> const& _additionalValues) const
 {
 	static std::string const Separator = ", ";
 
@@ -32,9 +32,9 @@ std::string ImportPerformanceLogger::constructReport(double _totalElapsed, std::
 		result += Separator;
 	}
 
-	m_stages.emplace("total", _totalElapsed);
-	auto const keyValuesStages = m_stages | boost::adaptors::transformed(pairToString<double>);
-	result += boost::algorithm::join(keyValuesStages, Separator);
+	for (unsigned i = 0; i < c_importStages; ++i)
+		result += pairToString<double>({importStageName(static_cast<ImportStage>(i)), m_stages[i]}) + Separator;
+	result += pairToString<double>({"total", _totalElapsed});
 
 	return result;
 }
@@ -6,11 +6,18 @@
 /// Class for logging of importing a Block into BlockChain.
 #pragma once
 
+#include "ImportProfiler.h"
+
 #include <libdevcore/Common.h>
 #include <libdevcore/Log.h>
+#include <libdevcore/Metrics.h>
+#include <libethcore/BlockHeader.h>
 
+#include <array>
+#include <chrono>
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 namespace dev
 {
@@ -18,36 +25,73 @@ namespace dev
 namespace eth
 {
 
+/// Records the stages of the import of a block, see ImportProfiler.
 class ImportPerformanceLogger
 {
 public:
-	void onStageFinished(std::string const& _name)
+	ImportPerformanceLogger(): m_profiler(ImportProfiler::instance()) {}
+
+	void onStageFinished(ImportStage _stage)
+	{
+		double const now = elapsed();
+		double const duration = now - m_stageStart;
+		m_stages[static_cast<unsigned>(_stage)] = duration;
+		m_profiler.stage(_stage).recordSeconds(duration);
+		m_spans.push_back({importStageName(_stage), {}, m_stageStart, duration});
+		m_stageStart = now;
+	}
+
+	/// Records an interval which is part of the current stage, like the execution of a
+	/// transaction. @a _start is in seconds since the start of the import, see elapsed().
+	void addSpan(ImportPart _part, std::string const& _label, double _start, double _duration)
 	{
-		m_stages[_name] = m_stageTimer.elapsed();
-		m_stageTimer.restart();
+		m_profiler.part(_part).recordSeconds(_duration);
+		m_spans.push_back({importPartName(_part), _label, _start, _duration});
 	}
 
-	double stageDuration(std::string const& _name) const
+	/// @returns the seconds since the start of the import.
+	double elapsed() const
 	{
-		auto const it = m_stages.find(_name);
-		return it != m_stages.end() ? it->second : 0;
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
 	}
 
+	double stageDuration(ImportStage _stage) const { return m_stages[static_cast<unsigned>(_stage)]; }
+
 	void onFinished(std::unordered_map<std::string, std::string> const& _additionalValues)
 	{
-		double const totalElapsed = m_totalTimer.elapsed();
+		double const totalElapsed = elapsed();
+		static MetricHistogram& s_importTime = MetricsRegistry::instance().histogram(
+			"aleth_block_import_seconds", "Duration of block imports.");
+		s_importTime.recordSeconds(totalElapsed);
 		if (totalElapsed > 0.5)
 		{
             cdebug << "SLOW IMPORT: { " << constructReport(totalElapsed, _additionalValues) << " }";
         }
 	}
 
+	/// @returns the record of the import of the block @a _header with @a _transactions
+	/// transactions, for ImportProfiler::record().
+	ImportTrace trace(BlockHeader const& _header, size_t _transactions) const
+	{
+		ImportTrace ret;
+		ret.hash = _header.hash();
+		ret.number = static_cast<unsigned>(_header.number());
+		ret.gasUsed = _header.gasUsed();
+		ret.transactions = _transactions;
+		ret.start = ImportProfiler::instance().sinceStart(m_start);
+		ret.duration = elapsed();
+		ret.spans = m_spans;
+		return ret;
+	}
+
 private:
-	std::string constructReport(double _totalElapsed, std::unordered_map<std::string, std::string> const& _additionalValues);
+	std::string constructReport(double _totalElapsed, std::unordered_map<std::string, std::string> const& _additionalValues) const;
 
-	Timer m_totalTimer;
-	Timer m_stageTimer;
-	std::unordered_map<std::string, double> m_stages;
+	ImportProfiler& m_profiler;
+	std::chrono::steady_clock::time_point const m_start = std::chrono::steady_clock::now();
+	double m_stageStart = 0;
+	std::array<double, c_importStages> m_stages{};
+	std::vector<ImportSpan> m_spans;
 };
 
 }
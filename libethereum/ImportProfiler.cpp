@@ -0,0 +1,292 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "ImportProfiler.h"
+
+#include <sstream>
+
+namespace dev
+{
+namespace eth
+{
+namespace
+{
+std::string quoted(std::string const& _s)
+{
+    std::string ret = "\"";
+    for (char c : _s)
+    {
+        if (c == '"' || c == '\\')
+            ret += '\\';
+        ret += c;
+    }
+    return ret + "\"";
+}
+
+/// Writes a complete event of the Chrome trace format.
+void writeEvent(std::ostream& _out, std::string const& _name, std::string const& _category,
+    uint64_t _start, double _duration, std::string const& _args = {})
+{
+    _out << "{\"name\":" << quoted(_name) << ",\"cat\":" << quoted(_category)
+         << ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << _start
+         << ",\"dur\":" << static_cast<uint64_t>(_duration * 1e6);
+    if (!_args.empty())
+        _out << ",\"args\":{" << _args << "}";
+    _out << "}";
+}
+}  // namespace
+
+double ImportTrace::gasPerSecond() const
+{
+    for (auto const& span : spans)
+        if (span.stage == "enact" && span.duration > 0)
+            return static_cast<double>(gasUsed) / span.duration;
+    return 0;
+}
+
+char const* importStageName(ImportStage _stage)
+{
+    switch (_stage)
+    {
+    case ImportStage::Verify:
+        return "verify";
+    case ImportStage::Enact:
+        return "enact";
+    case ImportStage::DbWrite:
+        return "dbWrite";
+    case ImportStage::Collation:
+        return "collation";
+    case ImportStage::Route:
+        return "route";
+    case ImportStage::ExtrasWrite:
+        break;
+    }
+    return "extrasWrite";
+}
+
+char const* importPartName(ImportPart _part)
+{
+    switch (_part)
+    {
+    case ImportPart::Transaction:
+        return "transaction";
+    case ImportPart::StateCommit:
+        break;
+    }
+    return "stateCommit";
+}
+
+OpcodeCategory opcodeCategory(Instruction _instruction)
+{
+    auto const op = static_cast<uint8_t>(_instruction);
+    if (op >= 0x01 && op <= 0x0b)
+        return OpcodeCategory::Arithmetic;
+    if (op >= 0x10 && op <= 0x1d)
+        return OpcodeCategory::Bitwise;
+    if (op == 0x20)
+        return OpcodeCategory::Hashing;
+    if ((op >= 0x30 && op <= 0x3f) || _instruction == Instruction::PC ||
+        _instruction == Instruction::GAS)
+        return OpcodeCategory::Environment;
+    if (op >= 0x40 && op <= 0x4f)
+        return OpcodeCategory::Block;
+    if (_instruction == Instruction::POP || (op >= 0x60 && op <= 0x9f))
+        return OpcodeCategory::Stack;
+    if ((op >= 0x51 && op <= 0x53) || _instruction == Instruction::MSIZE)
+        return OpcodeCategory::Memory;
+    if (_instruction == Instruction::SLOAD || _instruction == Instruction::SSTORE)
+        return OpcodeCategory::Storage;
+    if (_instruction == Instruction::STOP || _instruction == Instruction::JUMP ||
+        _instruction == Instruction::JUMPI || _instruction == Instruction::JUMPDEST)
+        return OpcodeCategory::Flow;
+    if (op >= 0xa0 && op <= 0xa4)
+        return OpcodeCategory::Logging;
+    if (op >= 0xf0)
+        return OpcodeCategory::System;
+    return OpcodeCategory::Other;
+}
+
+char const* opcodeCategoryName(OpcodeCategory _category)
+{
+    switch (_category)
+    {
+    case OpcodeCategory::Arithmetic:
+        return "arithmetic";
+    case OpcodeCategory::Bitwise:
+        return "bitwise";
+    case OpcodeCategory::Hashing:
+        return "hashing";
+    case OpcodeCategory::Environment:
+        return "environment";
+    case OpcodeCategory::Block:
+        return "block";
+    case OpcodeCategory::Stack:
+        return "stack";
+    case OpcodeCategory::Memory:
+        return "memory";
+    case OpcodeCategory::Storage:
+        return "storage";
+    case OpcodeCategory::Flow:
+        return "flow";
+    case OpcodeCategory::Logging:
+        return "logging";
+    case OpcodeCategory::System:
+        return "system";
+    case OpcodeCategory::Other:
+        break;
+    }
+    return "other";
+}
+
+ImportProfiler& ImportProfiler::instance()
+{
+    static ImportProfiler s_profiler;
+    return s_profiler;
+}
+
+ImportProfiler::ImportProfiler()
+{
+    for (unsigned i = 0; i < c_importStages; ++i)
+        m_stages[i] = &MetricsRegistry::instance().histogram("aleth_block_import_stage_seconds",
+            "Duration of the stages of block imports.",
+            std::string("stage=\"") + importStageName(static_cast<ImportStage>(i)) + "\"");
+    for (unsigned i = 0; i < c_importParts; ++i)
+        m_parts[i] = &MetricsRegistry::instance().histogram("aleth_block_import_part_seconds",
+            "Duration of the parts of the stages of block imports.",
+            std::string("part=\"") + importPartName(static_cast<ImportPart>(i)) + "\"");
+}
+
+std::map<std::string, MetricHistogram const*> ImportProfiler::stages() const
+{
+    std::map<std::string, MetricHistogram const*> ret;
+    for (unsigned i = 0; i < c_importStages; ++i)
+        ret[importStageName(static_cast<ImportStage>(i))] = m_stages[i];
+    return ret;
+}
+
+std::map<std::string, MetricHistogram const*> ImportProfiler::parts() const
+{
+    std::map<std::string, MetricHistogram const*> ret;
+    for (unsigned i = 0; i < c_importParts; ++i)
+        ret[importPartName(static_cast<ImportPart>(i))] = m_parts[i];
+    return ret;
+}
+
+void ImportProfiler::record(ImportTrace _trace)
+{
+    Guard l(x_traces);
+    m_traces.push_back(std::move(_trace));
+    if (m_traces.size() > c_maxTraces)
+        m_traces.pop_front();
+}
+
+std::vector<ImportTrace> ImportProfiler::traces() const
+{
+    Guard l(x_traces);
+    return std::vector<ImportTrace>(m_traces.begin(), m_traces.end());
+}
+
+void ImportProfiler::addOpcodeTimes(std::array<uint64_t, c_opcodeCategories> const& _counts,
+    std::array<uint64_t, c_opcodeCategories> const& _nanoseconds)
+{
+    for (unsigned i = 0; i < c_opcodeCategories; ++i)
+    {
+        m_opcodeCounts[i].fetch_add(_counts[i], std::memory_order_relaxed);
+        m_opcodeNanoseconds[i].fetch_add(_nanoseconds[i], std::memory_order_relaxed);
+    }
+}
+
+std::array<ImportProfiler::OpcodeTime, c_opcodeCategories> ImportProfiler::opcodeTimes() const
+{
+    std::array<OpcodeTime, c_opcodeCategories> ret;
+    for (unsigned i = 0; i < c_opcodeCategories; ++i)
+    {
+        ret[i].count = m_opcodeCounts[i].load(std::memory_order_relaxed);
+        ret[i].seconds = m_opcodeNanoseconds[i].load(std::memory_order_relaxed) / 1e9;
+    }
+    return ret;
+}
+
+std::string ImportProfiler::chromeTrace() const
+{
+    std::ostringstream out;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (auto const& trace : traces())
+    {
+        std::ostringstream args;
+        args << "\"hash\":\"" << trace.hash.hex() << "\",\"gasUsed\":" << trace.gasUsed
+             << ",\"transactions\":" << trace.transactions
+             << ",\"gasPerSecond\":" << static_cast<uint64_t>(trace.gasPerSecond());
+        if (!first)
+            out << ",";
+        first = false;
+        writeEvent(out, "block #" + toString(trace.number), "block", trace.start,
+            trace.duration, args.str());
+        for (auto const& span : trace.spans)
+        {
+            out << ",";
+            writeEvent(out, span.label.empty() ? span.stage : span.label, span.stage,
+                trace.start + static_cast<uint64_t>(span.start * 1e6), span.duration);
+        }
+    }
+    out << "]}";
+    return out.str();
+}
+
+void ImportProfiler::clear()
+{
+    {
+        Guard l(x_traces);
+        m_traces.clear();
+    }
+    for (unsigned i = 0; i < c_opcodeCategories; ++i)
+    {
+        m_opcodeCounts[i] = 0;
+        m_opcodeNanoseconds[i] = 0;
+    }
+}
+
+uint64_t ImportProfiler::sinceStart(std::chrono::steady_clock::time_point _time) const
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(_time - m_start).count();
+}
+
+void OpcodeTimer::State::charge(std::chrono::steady_clock::time_point _now)
+{
+    if (!running)
+        return;
+    ++counts[category];
+    nanoseconds[category] +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(_now - last).count();
+    running = false;
+}
+
+OpcodeTimer::OpcodeTimer(ImportProfiler& _profiler)
+  : m_profiler(_profiler), m_state(std::make_shared<State>())
+{
+    std::shared_ptr<State> state = m_state;
+    m_onOp = [state](uint64_t, uint64_t, Instruction _instruction, bigint, bigint, bigint,
+                 VMFace const*, ExtVMFace const*) {
+        auto const now = std::chrono::steady_clock::now();
+        state->charge(now);
+        state->category = static_cast<unsigned>(opcodeCategory(_instruction));
+        state->last = now;
+        state->running = true;
+    };
+}
+
+OpcodeTimer::~OpcodeTimer()
+{
+    pause();
+    m_profiler.addOpcodeTimes(m_state->counts, m_state->nanoseconds);
+}
+
+void OpcodeTimer::pause()
+{
+    m_state->charge(std::chrono::steady_clock::now());
+}
+
+}  // namespace eth
+}  // namespace dev
@@ -0,0 +1,219 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Profile of the block imports: the durations of their stages, the gas throughput and the time
+/// spent on each kind of EVM instruction.
+#pragma once
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+#include <libdevcore/Metrics.h>
+#include <libevm/ExtVMFace.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+/// Interval of the import of a block, in seconds from the start of the import.
+struct ImportSpan
+{
+    /// The stage the interval is or is part of, e.g. "enact" or "transaction".
+    std::string stage;
+    /// What the interval is about within its stage, e.g. the transaction index; may be empty.
+    std::string label;
+    double start;
+    double duration;
+};
+
+/// Record of the import of one block.
+struct ImportTrace
+{
+    h256 hash;
+    unsigned number = 0;
+    u256 gasUsed;
+    size_t transactions = 0;
+    /// The start of the import in microseconds since the profiler was created.
+    uint64_t start = 0;
+    double duration = 0;
+    std::vector<ImportSpan> spans;
+
+    /// @returns the gas executed per second of the "enact" stage, or 0 if the block wasn't
+    /// executed.
+    double gasPerSecond() const;
+};
+
+/// Stages of the import of a block, in the order they run in.
+enum class ImportStage : unsigned
+{
+    Verify,
+    Enact,
+    DbWrite,
+    Collation,
+    Route,
+    ExtrasWrite,
+};
+
+unsigned const c_importStages = static_cast<unsigned>(ImportStage::ExtrasWrite) + 1;
+
+char const* importStageName(ImportStage _stage);
+
+/// Parts of the import stages which are profiled on their own.
+enum class ImportPart : unsigned
+{
+    /// The execution of a transaction by "enact"
+    Transaction,
+    /// The commit of the state changes to the trie by "enact"
+    StateCommit,
+};
+
+unsigned const c_importParts = static_cast<unsigned>(ImportPart::StateCommit) + 1;
+
+char const* importPartName(ImportPart _part);
+
+/// Instruction groups of the yellow paper, time is profiled per group.
+enum class OpcodeCategory : unsigned
+{
+    Arithmetic,
+    Bitwise,
+    Hashing,
+    Environment,
+    Block,
+    Stack,
+    Memory,
+    Storage,
+    Flow,
+    Logging,
+    System,
+    Other,
+};
+
+unsigned const c_opcodeCategories = static_cast<unsigned>(OpcodeCategory::Other) + 1;
+
+OpcodeCategory opcodeCategory(Instruction _instruction);
+char const* opcodeCategoryName(OpcodeCategory _category);
+
+/**
+ * @brief Collects what the imports of blocks record about themselves.
+ *
+ * The durations of the import stages of all blocks go into per-stage histograms, which are also
+ * exported as the aleth_block_import_stage_seconds metric. The parts of stages, like the
+ * transactions executed by "enact", go into the aleth_block_import_part_seconds metric instead,
+ * so that the stages add up to the imports. The spans of the last c_maxTraces
+ * imports are kept, for RPC and to be viewed as a Chrome trace.
+ * With opcode profiling enabled, the interpreter reports every instruction executed during
+ * imports, which slows them down; the time is only measured with the interpreter which supports
+ * tracing, not with EVMC VMs.
+ */
+class ImportProfiler
+{
+public:
+    struct OpcodeTime
+    {
+        uint64_t count = 0;
+        double seconds = 0;
+    };
+
+    /// Resolves the histograms of the stages and parts, which are shared by all profilers.
+    ImportProfiler();
+
+    static ImportProfiler& instance();
+
+    /// @returns the histogram of the durations of the stage @a _stage across all imports.
+    MetricHistogram& stage(ImportStage _stage) const
+    {
+        return *m_stages[static_cast<unsigned>(_stage)];
+    }
+    /// @returns the histograms of the stages, by stage name.
+    std::map<std::string, MetricHistogram const*> stages() const;
+    /// @returns the histogram of the durations of @a _part of a stage across all imports.
+    MetricHistogram& part(ImportPart _part) const { return *m_parts[static_cast<unsigned>(_part)]; }
+    /// @returns the histograms of the parts of stages, by part name.
+    std::map<std::string, MetricHistogram const*> parts() const;
+
+    void record(ImportTrace _trace);
+    /// @returns the most recent imports, oldest first.
+    std::vector<ImportTrace> traces() const;
+
+    bool opcodeProfiling() const { return m_opcodeProfiling; }
+    void setOpcodeProfiling(bool _enabled) { m_opcodeProfiling = _enabled; }
+    void addOpcodeTimes(std::array<uint64_t, c_opcodeCategories> const& _counts,
+        std::array<uint64_t, c_opcodeCategories> const& _nanoseconds);
+    std::array<OpcodeTime, c_opcodeCategories> opcodeTimes() const;
+
+    /// @returns the kept imports in the Chrome trace event format, which chrome://tracing and
+    /// Perfetto open.
+    std::string chromeTrace() const;
+
+    /// Drops the kept imports and the opcode times. The stage histograms stay.
+    void clear();
+
+    /// @returns @a _time in microseconds since the profiler was created.
+    uint64_t sinceStart(std::chrono::steady_clock::time_point _time) const;
+
+    static size_t const c_maxTraces = 256;
+
+private:
+    std::chrono::steady_clock::time_point const m_start = std::chrono::steady_clock::now();
+
+    std::array<MetricHistogram*, c_importStages> m_stages;
+    std::array<MetricHistogram*, c_importParts> m_parts;
+
+    mutable Mutex x_traces;
+    std::deque<ImportTrace> m_traces;
+
+    std::atomic<bool> m_opcodeProfiling{false};
+    std::array<std::atomic<uint64_t>, c_opcodeCategories> m_opcodeCounts{};
+    std::array<std::atomic<uint64_t>, c_opcodeCategories> m_opcodeNanoseconds{};
+};
+
+/**
+ * @brief Measures the time the interpreter spends on each category of instructions, through its
+ * tracing callback. Each instruction is charged with the time until the next one starts.
+ * The times are added to the profiler on destruction.
+ */
+class OpcodeTimer
+{
+public:
+    explicit OpcodeTimer(ImportProfiler& _profiler);
+    ~OpcodeTimer();
+
+    OpcodeTimer(OpcodeTimer const&) = delete;
+    OpcodeTimer& operator=(OpcodeTimer const&) = delete;
+
+    /// @returns the callback to execute transactions with.
+    OnOpFunc const& onOp() const { return m_onOp; }
+
+    /// Charges the last instruction executed, to be called when an execution is done.
+    void pause();
+
+private:
+    struct State
+    {
+        std::chrono::steady_clock::time_point last;
+        unsigned category = 0;
+        bool running = false;
+        std::array<uint64_t, c_opcodeCategories> counts{};
+        std::array<uint64_t, c_opcodeCategories> nanoseconds{};
+
+        void charge(std::chrono::steady_clock::time_point _now);
+    };
+
+    ImportProfiler& m_profiler;
+    std::shared_ptr<State> m_state;
+    OnOpFunc m_onOp;
+};
+
+}  // namespace eth
+}  // namespace dev
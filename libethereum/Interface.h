@@ -32,6 +32,9 @@ enum class Reaping
 	Manual
 };
 
+/// Receives the changes of a watch as soon as they are noted.
+using WatchCallback = std::function<void(LocalisedLogEntries const&)>;
+
 enum class FudgeFactor
 {
 	Strict,
@@ -115,6 +118,10 @@ public:
 	/// Install, uninstall and query watches.
 	virtual unsigned installWatch(LogFilter const& _filter, Reaping _r = Reaping::Automatic) = 0;
 	virtual unsigned installWatch(h256 _filterId, Reaping _r = Reaping::Automatic) = 0;
+	/// Install watches whose changes are passed to @a _onChange instead of being kept for polling.
+	/// The callback is called from the thread noting the changes, without any locks held.
+	virtual unsigned installWatch(LogFilter const& _filter, WatchCallback const& _onChange) = 0;
+	virtual unsigned installWatch(h256 _filterId, WatchCallback const& _onChange) = 0;
 	virtual bool uninstallWatch(unsigned _watchId) = 0;
 	LocalisedLogEntries peekWatchSafe(unsigned _watchId) const { try { return peekWatch(_watchId); } catch (...) { return LocalisedLogEntries(); } }
 	LocalisedLogEntries checkWatchSafe(unsigned _watchId) { try { return checkWatch(_watchId); } catch (...) { return LocalisedLogEntries(); } }
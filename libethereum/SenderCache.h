@@ -0,0 +1,85 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#pragma once
+
+#include "Transaction.h"
+
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+#include <libdevcore/LruCache.h>
+#include <libdevcore/Metrics.h>
+
+#include <boost/optional.hpp>
+
+#include <array>
+
+namespace dev
+{
+namespace eth
+{
+
+/**
+ * @brief Thread-safe cache of the senders recovered from the signatures of transactions, by
+ * transaction hash. The transaction queue fills it, so that the transactions of a new block which
+ * have already been through the queue skip the ECDSA recovery during block verification.
+ * The entries are spread over shards locked separately; a full shard drops its least recently
+ * used entry.
+ */
+class SenderCache
+{
+public:
+    void store(h256 const& _transactionHash, Address const& _sender)
+    {
+        Shard& s = shard(_transactionHash);
+        Guard l(s.x_cache);
+        s.cache.insert(_transactionHash, _sender);
+    }
+
+    boost::optional<Address> find(h256 const& _transactionHash)
+    {
+        Shard& s = shard(_transactionHash);
+        Guard l(s.x_cache);
+        if (Address const* sender = s.cache.find(_transactionHash))
+        {
+            m_hits.inc();
+            return *sender;
+        }
+        m_misses.inc();
+        return boost::none;
+    }
+
+    /// Sets the sender of @a _t from the cache, or recovers it from the signature if it isn't
+    /// cached. Throws like Transaction::sender() for a transaction with an invalid signature.
+    void setSender(Transaction& _t)
+    {
+        if (auto const sender = find(_t.sha3()))
+            _t.forceSender(*sender);
+        else
+            _t.sender();
+    }
+
+    static SenderCache& instance() { static SenderCache cache; return cache; }
+
+private:
+    static size_t const c_shards = 16;
+    static size_t const c_maxSize = 32768;
+
+    struct Shard
+    {
+        Mutex x_cache;
+        LruCache<h256, Address> cache{c_maxSize / c_shards};
+    };
+
+    Shard& shard(h256 const& _transactionHash) { return m_shards[_transactionHash[0] % c_shards]; }
+
+    std::array<Shard, c_shards> m_shards;
+    MetricCounter& m_hits = MetricsRegistry::instance().counter(
+        "aleth_cache_lookups_total", "Lookups of caches.", "cache=\"sender\",result=\"hit\"");
+    MetricCounter& m_misses = MetricsRegistry::instance().counter(
+        "aleth_cache_lookups_total", "Lookups of caches.", "cache=\"sender\",result=\"miss\"");
+};
+
+}
+}
@@ -6,6 +6,7 @@
 #include "Client.h"
 #include "SnapshotStorage.h"
 
+#include <libdevcore/CommonIO.h>
 #include <libdevcore/FileSystem.h>
 #include <libdevcore/RLP.h>
 #include <libdevcore/TrieHash.h>
@@ -13,12 +14,63 @@
 
 #include <snappy.h>
 
+#include <boost/filesystem/operations.hpp>
+
+#include <deque>
+#include <future>
+
 namespace dev
 {
 namespace eth
 {
 
-void SnapshotImporter::import(SnapshotStorageFace const& _snapshotStorage, h256 const& /*_genesisHash*/)
+namespace
+{
+/// Reads and decompresses chunks in the given order on background threads, keeping at most
+/// _readAhead chunks in flight, so that decompression overlaps with the import of the current one.
+class ChunkReader
+{
+public:
+    ChunkReader(SnapshotStorageFace const& _snapshotStorage, h256s _chunkHashes, unsigned _readAhead)
+      : m_snapshotStorage(_snapshotStorage),
+        m_chunkHashes(std::move(_chunkHashes)),
+        m_readAhead(_readAhead)
+    {
+        scheduleReads();
+    }
+
+    bool done() const { return m_pending.empty(); }
+
+    std::string next()
+    {
+        assert(!done());
+        std::future<std::string> chunk = std::move(m_pending.front());
+        m_pending.pop_front();
+        scheduleReads();
+        return chunk.get();
+    }
+
+private:
+    void scheduleReads()
+    {
+        while (m_pending.size() < m_readAhead && m_nextToSchedule < m_chunkHashes.size())
+        {
+            h256 const& chunkHash = m_chunkHashes[m_nextToSchedule++];
+            m_pending.push_back(std::async(std::launch::async,
+                [this, chunkHash] { return m_snapshotStorage.readChunk(chunkHash); }));
+        }
+    }
+
+    SnapshotStorageFace const& m_snapshotStorage;
+    h256s const m_chunkHashes;
+    unsigned const m_readAhead;
+    size_t m_nextToSchedule = 0;
+    std::deque<std::future<std::string>> m_pending;
+};
+}  // namespace
+
+void SnapshotImporter::import(SnapshotStorageFace const& _snapshotStorage,
+    h256 const& /*_genesisHash*/, boost::filesystem::path const& _progressPath)
 {
     bytes const manifestBytes = _snapshotStorage.readManifest();
     RLP manifest(manifestBytes);
@@ -34,93 +86,51 @@ void SnapshotImporter::import(SnapshotStorageFace const& _snapshotStorage, h256
     h256 const blockHash = manifest[5].toHash<h256>(RLP::VeryStrict);
     LOG(m_logger) << "Importing snapshot for block " << blockNumber << " block hash " << blockHash;
 
+    m_progressPath = _progressPath;
+    m_manifestHash = sha3(manifestBytes);
+
     h256s const stateChunkHashes = manifest[1].toVector<h256>(RLP::VeryStrict);
     h256 const stateRoot = manifest[3].toHash<h256>(RLP::VeryStrict);
     importStateChunks(_snapshotStorage, stateChunkHashes, stateRoot);
 
     h256s const blockChunkHashes = manifest[2].toVector<h256>(RLP::VeryStrict);
     importBlockChunks(_snapshotStorage, blockChunkHashes);
+
+    if (!m_progressPath.empty())
+        boost::filesystem::remove(m_progressPath);
 }
 
 void SnapshotImporter::importStateChunks(SnapshotStorageFace const& _snapshotStorage, h256s const& _stateChunkHashes, h256 const& _stateRoot)
 {
     size_t const stateChunkCount = _stateChunkHashes.size();
 
-    size_t chunksImported = 0;
+    size_t chunksImported = loadStateImportProgress();
+    if (chunksImported > stateChunkCount)
+        BOOST_THROW_EXCEPTION(InvalidSnapshotImportProgress());
+    if (chunksImported > 0)
+        LOG(m_logger) << "Resuming import after " << chunksImported << " state chunks";
+
     size_t accountsImported = 0;
 
-    for (auto const& stateChunkHash: _stateChunkHashes)
+    ChunkReader reader(_snapshotStorage,
+        h256s(_stateChunkHashes.begin() + chunksImported, _stateChunkHashes.end()),
+        m_chunksReadAhead);
+    while (!reader.done())
     {
-        std::string const chunkUncompressed = _snapshotStorage.readChunk(stateChunkHash);
+        std::string const chunkUncompressed = reader.next();
 
         RLP const accounts(chunkUncompressed);
-        size_t const accountCount = accounts.itemCount();
-        for (size_t accountIndex = 0; accountIndex < accountCount; ++accountIndex)
-        {
-            RLP const addressAndAccount = accounts[accountIndex];
-            if (addressAndAccount.itemCount() != 2)
-                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-            h256 const addressHash = addressAndAccount[0].toHash<h256>(RLP::VeryStrict);
-            if (!addressHash)
-                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-            // splitted parts of account can be only first in chunk
-            if (accountIndex > 0 && m_stateImporter.isAccountImported(addressHash))
-                BOOST_THROW_EXCEPTION(AccountAlreadyImported());
-
-            RLP const account = addressAndAccount[1];
-            if (account.itemCount() != 5)
-                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-            u256 const nonce = account[0].toInt<u256>(RLP::VeryStrict);
-            u256 const balance = account[1].toInt<u256>(RLP::VeryStrict);
-
-            RLP const storage = account[4];
-            std::map<h256, bytes> storageMap;
-            for (auto hashAndValue: storage)
-            {
-                if (hashAndValue.itemCount() != 2)
-                    BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-                h256 const keyHash = hashAndValue[0].toHash<h256>(RLP::VeryStrict);
-                if (!keyHash || storageMap.find(keyHash) != storageMap.end())
-                    BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-                bytes value = hashAndValue[1].toBytes(RLP::VeryStrict);
-                if (value.empty())
-                    BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-
-                storageMap.emplace(keyHash, std::move(value));
-            }
-
-            byte const codeFlag = account[2].toInt<byte>(RLP::VeryStrict);
-            h256 codeHash;
-            switch (codeFlag)
-            {
-            case 0:
-                codeHash = EmptySHA3;
-                break;
-            case 1:
-                codeHash = m_stateImporter.importCode(account[3].toBytesConstRef(RLP::VeryStrict));
-                break;
-            case 2:
-                codeHash = account[3].toHash<h256>(RLP::VeryStrict);
-                if (!codeHash || m_stateImporter.lookupCode(codeHash).empty())
-                    BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-                break;
-            default:
-                BOOST_THROW_EXCEPTION(InvalidStateChunkData());
-            }
-
-            m_stateImporter.importAccount(addressHash, nonce, balance, storageMap, codeHash);
-        }
-        accountsImported += accountCount;
+        size_t accountIndex = 0;
+        for (auto const addressAndAccount: accounts)
+            importAccount(addressAndAccount, accountIndex++ == 0);
+        accountsImported += accountIndex;
 
         m_stateImporter.commitStateDatabase();
 
         ++chunksImported;
-        LOG(m_logger) << "Imported chunk " << chunksImported << " (" << accounts.itemCount()
+        saveStateImportProgress(chunksImported);
+
+        LOG(m_logger) << "Imported chunk " << chunksImported << " (" << accountIndex
                       << " account records) Total account records imported: " << accountsImported;
         LOG(m_logger) << stateChunkCount - chunksImported << " chunks left to import";
     }
@@ -134,14 +144,111 @@ void SnapshotImporter::importStateChunks(SnapshotStorageFace const& _snapshotSto
         BOOST_THROW_EXCEPTION(StateTrieReconstructionFailed());
 }
 
+void SnapshotImporter::importAccount(RLP const& _addressAndAccount, bool _isFirstInChunk)
+{
+    if (_addressAndAccount.itemCount() != 2)
+        BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+    h256 const addressHash = _addressAndAccount[0].toHash<h256>(RLP::VeryStrict);
+    if (!addressHash)
+        BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+    // splitted parts of account can be only first in chunk
+    if (!_isFirstInChunk && m_stateImporter.isAccountImported(addressHash))
+        BOOST_THROW_EXCEPTION(AccountAlreadyImported());
+
+    RLP const account = _addressAndAccount[1];
+    if (account.itemCount() != 5)
+        BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+    u256 const nonce = account[0].toInt<u256>(RLP::VeryStrict);
+    u256 const balance = account[1].toInt<u256>(RLP::VeryStrict);
+
+    // storage values are not copied out of the chunk, only references to them are collected
+    RLP const storage = account[4];
+    StorageEntries storageEntries;
+    storageEntries.reserve(storage.itemCount());
+    h256Hash storageKeys;
+    for (auto const hashAndValue: storage)
+    {
+        if (hashAndValue.itemCount() != 2)
+            BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+        h256 const keyHash = hashAndValue[0].toHash<h256>(RLP::VeryStrict);
+        if (!keyHash || !storageKeys.insert(keyHash).second)
+            BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+        bytesConstRef const value = hashAndValue[1].toBytesConstRef(RLP::VeryStrict);
+        if (value.empty())
+            BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+
+        storageEntries.emplace_back(keyHash, value);
+    }
+
+    byte const codeFlag = account[2].toInt<byte>(RLP::VeryStrict);
+    h256 codeHash;
+    switch (codeFlag)
+    {
+    case 0:
+        codeHash = EmptySHA3;
+        break;
+    case 1:
+        codeHash = m_stateImporter.importCode(account[3].toBytesConstRef(RLP::VeryStrict));
+        break;
+    case 2:
+        codeHash = account[3].toHash<h256>(RLP::VeryStrict);
+        if (!codeHash || m_stateImporter.lookupCode(codeHash).empty())
+            BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+        break;
+    default:
+        BOOST_THROW_EXCEPTION(InvalidStateChunkData());
+    }
+
+    m_stateImporter.importAccount(addressHash, nonce, balance, storageEntries, codeHash);
+}
+
+size_t SnapshotImporter::loadStateImportProgress()
+{
+    if (m_progressPath.empty() || !boost::filesystem::exists(m_progressPath))
+        return 0;
+
+    bytes const progressBytes = contents(m_progressPath);
+    RLP const progress(progressBytes);
+    if (!progress.isList() || progress.itemCount() != 3)
+        BOOST_THROW_EXCEPTION(InvalidSnapshotImportProgress());
+
+    // progress of another snapshot's import is of no use
+    if (progress[0].toHash<h256>(RLP::VeryStrict) != m_manifestHash)
+    {
+        LOG(m_logger) << "Ignoring import progress of a different snapshot";
+        return 0;
+    }
+
+    size_t const chunksImported = progress[1].toInt<size_t>(RLP::VeryStrict);
+    m_stateImporter.setStateRoot(progress[2].toHash<h256>(RLP::VeryStrict));
+    return chunksImported;
+}
+
+void SnapshotImporter::saveStateImportProgress(size_t _chunksImported)
+{
+    if (m_progressPath.empty())
+        return;
+
+    RLPStream progress(3);
+    progress << m_manifestHash << _chunksImported << m_stateImporter.stateRoot();
+    writeFile(m_progressPath, progress.out(), true);
+}
+
 void SnapshotImporter::importBlockChunks(SnapshotStorageFace const& _snapshotStorage, h256s const& _blockChunkHashes)
 {
     size_t const blockChunkCount = _blockChunkHashes.size();
     size_t blockChunksImported = 0;
     // chunks are in decreasing order of first block number, so we go backwards to start from the oldest block
+    ChunkReader reader(_snapshotStorage, h256s(_blockChunkHashes.rbegin(), _blockChunkHashes.rend()),
+        m_chunksReadAhead);
     for (auto chunk = _blockChunkHashes.rbegin(); chunk != _blockChunkHashes.rend(); ++chunk)
     {
-        std::string const chunkUncompressed = _snapshotStorage.readChunk(*chunk);
+        std::string const chunkUncompressed = reader.next();
 
         RLP blockChunk(chunkUncompressed);
         if (blockChunk.itemCount() < 3)
@@ -11,8 +11,13 @@
 #include <libdevcore/FixedHash.h>
 #include <libdevcore/Log.h>
 
+#include <boost/filesystem/path.hpp>
+
+#include <algorithm>
+
 namespace dev
 {
+class RLP;
 
 namespace eth
 {
@@ -22,19 +27,41 @@ class BlockChainImporterFace;
 class SnapshotStorageFace;
 class StateImporterFace;
 
+/// Number of chunks that are read and decompressed ahead of the one being imported.
+/// Each uncompressed chunk is at most 10 MB, so this bounds the memory used by the read-ahead.
+unsigned const c_defaultSnapshotChunksReadAhead = 8;
+
 class SnapshotImporter
 {
 public:
-    SnapshotImporter(StateImporterFace& _stateImporter, BlockChainImporterFace& _bcImporter): m_stateImporter(_stateImporter), m_blockChainImporter(_bcImporter) {}
+    SnapshotImporter(StateImporterFace& _stateImporter, BlockChainImporterFace& _bcImporter,
+        unsigned _chunksReadAhead = c_defaultSnapshotChunksReadAhead)
+      : m_stateImporter(_stateImporter),
+        m_blockChainImporter(_bcImporter),
+        m_chunksReadAhead(std::max(1u, _chunksReadAhead))
+    {}
 
-    void import(SnapshotStorageFace const& _snapshotStorage, h256 const& _genesisHash);
+    /// Imports the snapshot.
+    /// If @a _progressPath is not empty, the progress of state import is saved there after every
+    /// committed chunk, and the import of the same snapshot is resumed from it if it exists.
+    void import(SnapshotStorageFace const& _snapshotStorage, h256 const& _genesisHash,
+        boost::filesystem::path const& _progressPath = {});
 
 private:
     void importStateChunks(SnapshotStorageFace const& _snapshotStorage, h256s const& _stateChunkHashes, h256 const& _stateRoot);
     void importBlockChunks(SnapshotStorageFace const& _snapshotStorage, h256s const& _blockChunkHashes);
+    void importAccount(RLP const& _addressAndAccount, bool _isFirstInChunk);
+
+    /// Loads saved progress, returns the number of state chunks already imported.
+    size_t loadStateImportProgress();
+    void saveStateImportProgress(size_t _chunksImported);
 
     StateImporterFace& m_stateImporter;
     BlockChainImporterFace& m_blockChainImporter;
+    unsigned const m_chunksReadAhead;
+
+    boost::filesystem::path m_progressPath;
+    h256 m_manifestHash;
 
     Logger m_logger{createLogger(VerbosityInfo, "snap")};
 };
@@ -0,0 +1,286 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "SnapshotProducer.h"
+#include "BlockChain.h"
+#include "SnapshotStorage.h"
+
+#include <libdevcore/RLP.h>
+#include <libdevcore/TrieDB.h>
+#include <libethashseal/Ethash.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <atomic>
+#include <future>
+
+namespace fs = boost::filesystem;
+
+namespace dev
+{
+namespace eth
+{
+namespace
+{
+/// State trie is split by the first nibble of the address hash, every part is walked separately.
+unsigned const c_stateShardCount = 16;
+
+/// Size of RLP list headers and integers of an account record, used only for chunk size estimation.
+size_t const c_accountRecordOverhead = 100;
+
+/// Writes accounts with address hashes in the range [_begin, _end) into chunks.
+/// Every shard works with its own copy of the state DB, so that shards can be walked concurrently.
+class StateShardWriter
+{
+public:
+    StateShardWriter(OverlayDB const& _stateDb, fs::path const& _snapshotDir, size_t _chunkSize)
+      : m_stateDb(_stateDb), m_snapshotDir(_snapshotDir), m_chunkSize(_chunkSize)
+    {}
+
+    h256s write(h256 const& _stateRoot, h256 const& _begin, h256 const& _end)
+    {
+        SpecificTrieDB<GenericTrieDB<OverlayDB>, h256> const state(&m_stateDb, _stateRoot);
+        for (auto it = state.lower_bound(_begin); it != state.end(); ++it)
+        {
+            auto const addressHashAndAccount = *it;
+            if (_end && addressHashAndAccount.first >= _end)
+                break;
+            addAccount(addressHashAndAccount.first, RLP(addressHashAndAccount.second));
+        }
+        flushChunk();
+
+        return m_chunkHashes;
+    }
+
+private:
+    void addAccount(h256 const& _addressHash, RLP const& _account)
+    {
+        u256 const nonce = _account[0].toInt<u256>();
+        u256 const balance = _account[1].toInt<u256>();
+        h256 const storageRoot = _account[2].toHash<h256>();
+        h256 const codeHash = _account[3].toHash<h256>();
+
+        // code is included only once per shard, later accounts with the same code refer to it by
+        // hash, as well as the parts of split account after the first one
+        byte codeFlag = 0;
+        bytes code;
+        if (codeHash != EmptySHA3)
+        {
+            if (m_writtenCodes.insert(codeHash).second)
+            {
+                codeFlag = 1;
+                code = asBytes(m_stateDb.lookup(codeHash));
+            }
+            else
+            {
+                codeFlag = 2;
+                code = codeHash.asBytes();
+            }
+        }
+
+        std::vector<std::pair<h256, bytes>> storage;
+        size_t partSize = c_accountRecordOverhead + code.size();
+        bool partWritten = false;
+        if (storageRoot != EmptyTrie)
+        {
+            SpecificTrieDB<GenericTrieDB<OverlayDB>, h256> const storageTrie(
+                &m_stateDb, storageRoot);
+            for (auto const keyHashAndValue : storageTrie)
+            {
+                storage.emplace_back(keyHashAndValue.first, keyHashAndValue.second.toBytes());
+                partSize += h256::size + keyHashAndValue.second.size() + 4;
+
+                // split the account, the rest of it starts the next chunk
+                if (m_currentChunkSize + partSize >= m_chunkSize)
+                {
+                    appendAccountPart(_addressHash, nonce, balance, codeFlag, code, storage);
+                    flushChunk();
+                    partWritten = true;
+
+                    storage.clear();
+                    if (codeFlag != 0)
+                    {
+                        codeFlag = 2;
+                        code = codeHash.asBytes();
+                    }
+                    partSize = c_accountRecordOverhead + code.size();
+                }
+            }
+        }
+
+        if (!partWritten || !storage.empty())
+            appendAccountPart(_addressHash, nonce, balance, codeFlag, code, storage);
+
+        if (m_currentChunkSize >= m_chunkSize)
+            flushChunk();
+    }
+
+    void appendAccountPart(h256 const& _addressHash, u256 const& _nonce, u256 const& _balance,
+        byte _codeFlag, bytes const& _code, std::vector<std::pair<h256, bytes>> const& _storage)
+    {
+        RLPStream s(2);
+        s << _addressHash;
+        s.appendList(5);
+        s << _nonce << _balance << _codeFlag << _code;
+        s.appendList(_storage.size());
+        for (auto const& keyHashAndValue : _storage)
+        {
+            s.appendList(2);
+            s << keyHashAndValue.first << keyHashAndValue.second;
+        }
+
+        m_currentChunkSize += s.out().size();
+        m_currentChunk.emplace_back(s.invalidate());
+    }
+
+    void flushChunk()
+    {
+        if (m_currentChunk.empty())
+            return;
+
+        RLPStream s(m_currentChunk.size());
+        for (auto const& accountPart : m_currentChunk)
+            s.appendRaw(accountPart);
+
+        m_chunkHashes.push_back(writeSnapshotChunk(m_snapshotDir, &s.out()));
+
+        m_currentChunk.clear();
+        m_currentChunkSize = 0;
+    }
+
+    OverlayDB m_stateDb;
+    fs::path const m_snapshotDir;
+    size_t const m_chunkSize;
+
+    std::vector<bytes> m_currentChunk;
+    size_t m_currentChunkSize = 0;
+    h256Hash m_writtenCodes;
+    h256s m_chunkHashes;
+};
+
+/// @returns the lowest address hash in the shard, null hash for the end of the last shard
+h256 shardBoundary(unsigned _shard)
+{
+    h256 boundary;
+    if (_shard < c_stateShardCount)
+        boundary[0] = static_cast<byte>(_shard << 4);
+    return boundary;
+}
+
+bytes abridgedBlock(BlockHeader const& _header, RLP const& _block)
+{
+    RLPStream s(12);
+    s << _header.author() << _header.stateRoot() << _header.logBloom() << _header.difficulty()
+      << _header.gasLimit() << _header.gasUsed() << u256(_header.timestamp()) << _header.extraData();
+    s.appendRaw(_block[1].data());
+    s.appendRaw(_block[2].data());
+    s << Ethash::mixHash(_header) << Ethash::nonce(_header);
+    return s.out();
+}
+}  // namespace
+
+void SnapshotProducer::produce(BlockChain const& _blockChain, h256 const& _blockHash,
+    fs::path const& _snapshotDir, unsigned _blockCount)
+{
+    BlockHeader const header(_blockChain.headerData(_blockHash), HeaderData);
+    LOG(m_logger) << "Producing snapshot for block " << header.number() << " block hash "
+                  << _blockHash;
+
+    fs::create_directories(_snapshotDir);
+
+    h256s const stateChunkHashes = produceStateChunks(header.stateRoot(), _snapshotDir);
+    h256s const blockChunkHashes = produceBlockChunks(
+        _blockChain, static_cast<unsigned>(header.number()), _blockCount, _snapshotDir);
+
+    RLPStream manifest(6);
+    manifest << 2 << stateChunkHashes << blockChunkHashes << header.stateRoot()
+             << u256(header.number()) << _blockHash;
+    writeSnapshotManifest(_snapshotDir, manifest.out());
+
+    LOG(m_logger) << "Snapshot written to " << _snapshotDir << ": " << stateChunkHashes.size()
+                  << " state chunks, " << blockChunkHashes.size() << " block chunks";
+}
+
+h256s SnapshotProducer::produceStateChunks(h256 const& _stateRoot, fs::path const& _snapshotDir)
+{
+    std::vector<h256s> shardChunkHashes(c_stateShardCount);
+    std::atomic<unsigned> nextShard{0};
+    auto const writeShards = [&]() {
+        for (unsigned shard = nextShard++; shard < c_stateShardCount; shard = nextShard++)
+        {
+            StateShardWriter writer(m_stateDb, _snapshotDir, m_chunkSize);
+            shardChunkHashes[shard] =
+                writer.write(_stateRoot, shardBoundary(shard), shardBoundary(shard + 1));
+            // m_logger isn't thread-safe, the workers log through the global logger
+            clog(VerbosityInfo, "snap") << "State shard " << shard << " written: "
+                                        << shardChunkHashes[shard].size() << " chunks";
+        }
+    };
+
+    std::vector<std::future<void>> workers;
+    for (unsigned i = 0; i < std::min(m_threads, c_stateShardCount); ++i)
+        workers.push_back(std::async(std::launch::async, writeShards));
+    // get() rethrows the exception if any of the workers failed
+    for (auto& worker : workers)
+        worker.get();
+
+    h256s stateChunkHashes;
+    for (auto const& chunkHashes : shardChunkHashes)
+        stateChunkHashes.insert(stateChunkHashes.end(), chunkHashes.begin(), chunkHashes.end());
+    return stateChunkHashes;
+}
+
+h256s SnapshotProducer::produceBlockChunks(BlockChain const& _blockChain, unsigned _blockNumber,
+    unsigned _blockCount, fs::path const& _snapshotDir)
+{
+    // first block of the chunk must have a parent other than genesis
+    unsigned const firstBlock =
+        std::max(2u, _blockNumber >= _blockCount ? _blockNumber - _blockCount + 1 : 0);
+
+    h256s chunkHashes;
+    std::vector<bytes> blocksAndReceipts;
+    size_t currentChunkSize = 0;
+    unsigned chunkFirstBlock = firstBlock;
+    auto const flushChunk = [&]() {
+        if (blocksAndReceipts.empty())
+            return;
+
+        h256 const parentHash = _blockChain.numberHash(chunkFirstBlock - 1);
+        RLPStream s(3 + blocksAndReceipts.size());
+        s << chunkFirstBlock - 1 << parentHash << _blockChain.details(parentHash).totalDifficulty;
+        for (auto const& blockAndReceipts : blocksAndReceipts)
+            s.appendRaw(blockAndReceipts);
+        chunkHashes.push_back(writeSnapshotChunk(_snapshotDir, &s.out()));
+
+        blocksAndReceipts.clear();
+        currentChunkSize = 0;
+    };
+
+    for (unsigned number = firstBlock; number <= _blockNumber; ++number)
+    {
+        h256 const hash = _blockChain.numberHash(number);
+        bytes const block = _blockChain.block(hash);
+        BlockHeader const header(block);
+
+        RLPStream s(2);
+        s.appendRaw(abridgedBlock(header, RLP(block)));
+        s.appendRaw(_blockChain.receipts(hash).rlp());
+
+        if (blocksAndReceipts.empty())
+            chunkFirstBlock = number;
+        currentChunkSize += s.out().size();
+        blocksAndReceipts.emplace_back(s.invalidate());
+
+        if (currentChunkSize >= m_chunkSize)
+            flushChunk();
+    }
+    flushChunk();
+
+    // importer expects chunks in decreasing order of the first block number
+    std::reverse(chunkHashes.begin(), chunkHashes.end());
+    return chunkHashes;
+}
+
+}  // namespace eth
+}  // namespace dev
@@ -0,0 +1,65 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Class for writing snapshot of the local chain to directory on disk
+#pragma once
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Log.h>
+#include <libdevcore/OverlayDB.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <algorithm>
+#include <thread>
+
+namespace dev
+{
+namespace eth
+{
+class BlockChain;
+
+/// Preferred size of uncompressed chunk, the same as Parity uses.
+size_t const c_snapshotChunkSize = 4 * 1024 * 1024;
+
+/// Number of most recent blocks included into the snapshot.
+unsigned const c_snapshotBlockCount = 30000;
+
+/// Produces snapshot in Parity Warp Sync format, that can be read by SnapshotStorageFace.
+/// For format description see https://github.com/paritytech/parity/wiki/Warp-Sync-Snapshot-Format
+class SnapshotProducer
+{
+public:
+    explicit SnapshotProducer(OverlayDB const& _stateDb,
+        unsigned _threads = std::thread::hardware_concurrency(),
+        size_t _chunkSize = c_snapshotChunkSize)
+      : m_stateDb(_stateDb), m_threads(std::max(1u, _threads)), m_chunkSize(_chunkSize)
+    {}
+
+    /// Writes snapshot of the state at block @a _blockHash and of up to @a _blockCount blocks
+    /// ending with it into @a _snapshotDir.
+    void produce(BlockChain const& _blockChain, h256 const& _blockHash,
+        boost::filesystem::path const& _snapshotDir, unsigned _blockCount = c_snapshotBlockCount);
+
+    /// Walks the state trie in parallel and writes state chunks.
+    /// @returns hashes of written chunks in the order they should be imported.
+    h256s produceStateChunks(h256 const& _stateRoot, boost::filesystem::path const& _snapshotDir);
+
+    /// Writes block chunks for the blocks (@a _blockNumber - @a _blockCount, @a _blockNumber].
+    /// @returns hashes of written chunks in decreasing order of their first block number.
+    h256s produceBlockChunks(BlockChain const& _blockChain, unsigned _blockNumber,
+        unsigned _blockCount, boost::filesystem::path const& _snapshotDir);
+
+private:
+    OverlayDB const& m_stateDb;
+    unsigned const m_threads;
+    size_t const m_chunkSize;
+
+    Logger m_logger{createLogger(VerbosityInfo, "snap")};
+};
+
+}  // namespace eth
+}  // namespace dev
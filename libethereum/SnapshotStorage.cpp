@@ -37,6 +37,16 @@ std::string snappyUncompress(std::string const& _compressed)
 	return uncompressed;
 }
 
+std::string snappyCompress(bytesConstRef _uncompressed)
+{
+	if (_uncompressed.size() > c_maxChunkUncomressedSize)
+		BOOST_THROW_EXCEPTION(ChunkIsTooBig());
+
+	std::string compressed;
+	snappy::Compress(reinterpret_cast<char const*>(_uncompressed.data()), _uncompressed.size(), &compressed);
+	return compressed;
+}
+
 class SnapshotStorage: public SnapshotStorageFace
 {
 public:
@@ -87,9 +97,29 @@ std::unique_ptr<SnapshotStorageFace> createSnapshotStorage(fs::path const& _snap
 	return std::unique_ptr<SnapshotStorageFace>(new SnapshotStorage(_snapshotDirPath));
 }
 
+h256 writeSnapshotChunk(fs::path const& _snapshotDir, bytesConstRef _chunkUncompressed)
+{
+	std::string const chunkCompressed = snappyCompress(_chunkUncompressed);
+	h256 const chunkHash = sha3(chunkCompressed);
+
+	writeFile(_snapshotDir / toHex(chunkHash), bytesConstRef(chunkCompressed), true);
+
+	return chunkHash;
+}
+
+void writeSnapshotManifest(fs::path const& _snapshotDir, bytes const& _manifest)
+{
+	writeFile(_snapshotDir / "MANIFEST", _manifest, true);
+}
+
 fs::path importedSnapshotPath(fs::path const& _dataDir, h256 const& _genesisHash)
 {
     return _dataDir / toHex(_genesisHash.ref().cropped(0, 4)) / "snapshot";
 }
+
+fs::path snapshotImportProgressPath(fs::path const& _dataDir, h256 const& _genesisHash)
+{
+    return _dataDir / toHex(_genesisHash.ref().cropped(0, 4)) / "snapshot-import-progress";
+}
 }
 }
\ No newline at end of file
@@ -43,7 +43,17 @@ public:
 std::unique_ptr<SnapshotStorageFace> createSnapshotStorage(
     boost::filesystem::path const& _snapshotDirPath);
 
+/// Compresses the chunk and writes it into snapshot directory.
+/// @returns hash of the compressed chunk, the name it can be read with by SnapshotStorageFace.
+h256 writeSnapshotChunk(boost::filesystem::path const& _snapshotDir, bytesConstRef _chunkUncompressed);
+
+void writeSnapshotManifest(boost::filesystem::path const& _snapshotDir, bytes const& _manifest);
+
 boost::filesystem::path importedSnapshotPath(
     boost::filesystem::path const& _dataDir, h256 const& _genesisHash);
+
+/// Path to the file keeping the progress of interrupted snapshot import.
+boost::filesystem::path snapshotImportProgressPath(
+    boost::filesystem::path const& _dataDir, h256 const& _genesisHash);
 }
 }
@@ -19,23 +19,69 @@ bool changesStorage(Instruction _inst)
 
 }  // namespace
 
+bool TraceBudget::takeStep()
+{
+    if (m_exhausted.load(std::memory_order_relaxed))
+        return false;
+    if (m_maxSteps && m_steps.fetch_add(1, std::memory_order_relaxed) >= m_maxSteps)
+    {
+        m_exhausted = true;
+        return false;
+    }
+    return true;
+}
+
+bool TraceBudget::takeSize(uint64_t _size)
+{
+    if (!m_maxSize)
+        return true;
+    uint64_t size = m_size.load(std::memory_order_relaxed);
+    do
+    {
+        if (size + _size > m_maxSize)
+        {
+            m_exhausted = true;
+            return false;
+        }
+    } while (!m_size.compare_exchange_weak(size, size + _size, std::memory_order_relaxed));
+    return true;
+}
+
+bool TraceBudget::fits(uint64_t _size)
+{
+    if (m_maxSize && m_size.load(std::memory_order_relaxed) + _size > m_maxSize)
+        m_exhausted = true;
+    return !m_exhausted.load(std::memory_order_relaxed);
+}
+
 void StandardTrace::operator()(uint64_t _steps, uint64_t PC, Instruction inst, bigint newMemSize,
     bigint gasCost, bigint gas, VMFace const* _vm, ExtVMFace const* voidExt)
 {
     (void)_steps;
 
+    if (m_truncated)
+        return;
+    if (!m_budget)
+        m_budget = std::make_shared<TraceBudget>(m_options.limit, m_options.maxOutputSize);
+    // before building anything, the steps after the last one that fits are left out for free
+    if (!m_budget->takeStep())
+    {
+        m_truncated = true;
+        return;
+    }
+
     ExtVM const& ext = dynamic_cast<ExtVM const&>(*voidExt);
     auto vm = dynamic_cast<LegacyVM const*>(_vm);
 
-    Json::Value r(Json::objectValue);
+    Step step;
 
-    Json::Value stack(Json::arrayValue);
     if (vm && !m_options.disableStack)
     {
         // Try extracting information about the stack from the VM is supported.
+        step.hasStack = true;
+        step.stack.reserve(vm->stack().size());
         for (auto const& i : vm->stack())
-            stack.append(toCompactHexPrefixed(i, 1));
-        r["stack"] = stack;
+            step.stack.push_back(toCompactHexPrefixed(i, 1));
     }
 
     bool newContext = false;
@@ -64,49 +110,201 @@ void StandardTrace::operator()(uint64_t _steps, uint64_t PC, Instruction inst, b
         cwarn << "GAA!!! Tracing VM and more than one new/deleted stack frame between steps!";
         cwarn << "Attmepting naive recovery...";
         m_lastInst.resize(ext.depth + 1);
+        m_lastMemory.clear();
     }
 
     if (vm)
     {
         bytes const& memory = vm->memory();
 
-        Json::Value memJson(Json::arrayValue);
-        if (!m_options.disableMemory)
+        bool memoryChanged = true;
+        if (m_options.onlyChanges)
+        {
+            m_lastMemory.resize(ext.depth + 1);
+            memoryChanged = newContext || m_lastMemory[ext.depth] != memory;
+            if (memoryChanged)
+                m_lastMemory[ext.depth] = memory;
+        }
+        if (!m_options.disableMemory && memoryChanged)
         {
+            // two hex digits per byte
+            if (!m_budget->fits(memory.size() * 2))
+            {
+                m_truncated = true;
+                return;
+            }
+            step.hasMemory = true;
+            step.memory.reserve(memory.size() / 32);
             for (unsigned i = 0; i < memory.size(); i += 32)
             {
                 bytesConstRef memRef(memory.data() + i, 32);
-                memJson.append(toHex(memRef));
+                step.memory.push_back(toHex(memRef));
             }
-            r["memory"] = memJson;
         }
-        r["memSize"] = static_cast<uint64_t>(memory.size());
+        step.hasMemSize = true;
+        step.memSize = static_cast<uint64_t>(memory.size());
     }
 
-    if (!m_options.disableStorage &&
-        (m_options.fullStorage || changesStorage(lastInst) || newContext))
+    if (!m_options.disableStorage && m_options.onlyChanges)
     {
-        Json::Value storage(Json::objectValue);
+        // the slot written by the SSTORE before, without reading the storage of the account
+        if (changesStorage(lastInst) && !m_lastStore.first.empty())
+        {
+            step.hasStorage = true;
+            step.storage.insert(m_lastStore);
+        }
+        m_lastStore = {};
+        if (vm && changesStorage(inst))
+        {
+            u256s const stack = vm->stack();
+            if (stack.size() >= 2)
+                m_lastStore = {toCompactHexPrefixed(stack.back(), 1),
+                    toCompactHexPrefixed(stack[stack.size() - 2], 1)};
+        }
+    }
+    else if (!m_options.disableStorage &&
+             (m_options.fullStorage || changesStorage(lastInst) || newContext))
+    {
+        step.hasStorage = true;
         for (auto const& i : ext.state().storage(ext.myAddress))
-            storage[toCompactHexPrefixed(i.second.first, 1)] =
+            step.storage[toCompactHexPrefixed(i.second.first, 1)] =
                 toCompactHexPrefixed(i.second.second, 1);
-        r["storage"] = storage;
     }
 
-    r["op"] = static_cast<uint8_t>(inst);
-    if (m_showMnemonics)
-        r["opName"] = instructionInfo(inst).name;
-    r["pc"] = PC;
-    r["gas"] = toString(gas);
-    r["gasCost"] = toString(gasCost);
-    r["depth"] = ext.depth + 1;  // depth in standard trace is 1-based
+    step.op = inst;
+    step.pc = PC;
+    step.gas = toString(gas);
+    step.gasCost = toString(gasCost);
+    step.depth = ext.depth + 1;  // depth in standard trace is 1-based
     if (!!newMemSize)
-        r["memexpand"] = toString(newMemSize);
+        step.memexpand = toString(newMemSize);
+
+    writeStep(step);
+    if (!m_budget->takeSize(m_stepText.size()))
+    {
+        m_truncated = true;
+        return;
+    }
 
     if (m_outValue)
-        m_outValue->append(r);
+        m_outValue->append(toJson(step));
+    else if (m_outSink)
+        m_outSink(m_stepText);
     else
-        *m_outStream << m_fastWriter.write(r) << std::flush;
+        *m_outStream << m_stepText << "\n" << std::flush;
+}
+
+void StandardTrace::writeStep(Step const& _step)
+{
+    // the members are in the order of Json::Value objects
+    std::string& out = m_stepText;
+    out.clear();
+    auto const quoted = [&out](std::string const& _s) {
+        out += '"';
+        out += _s;
+        out += '"';
+    };
+    out += "{\"depth\":";
+    out += std::to_string(_step.depth);
+    out += ",\"gas\":";
+    quoted(_step.gas);
+    out += ",\"gasCost\":";
+    quoted(_step.gasCost);
+    if (_step.hasMemSize)
+    {
+        out += ",\"memSize\":";
+        out += std::to_string(_step.memSize);
+    }
+    if (!_step.memexpand.empty())
+    {
+        out += ",\"memexpand\":";
+        quoted(_step.memexpand);
+    }
+    if (_step.hasMemory)
+    {
+        out += ",\"memory\":[";
+        for (size_t i = 0; i < _step.memory.size(); ++i)
+        {
+            if (i)
+                out += ',';
+            quoted(_step.memory[i]);
+        }
+        out += ']';
+    }
+    out += ",\"op\":";
+    out += std::to_string(static_cast<unsigned>(_step.op));
+    if (m_showMnemonics)
+    {
+        out += ",\"opName\":";
+        quoted(instructionInfo(_step.op).name);
+    }
+    out += ",\"pc\":";
+    out += std::to_string(_step.pc);
+    if (_step.hasStack)
+    {
+        out += ",\"stack\":[";
+        for (size_t i = 0; i < _step.stack.size(); ++i)
+        {
+            if (i)
+                out += ',';
+            quoted(_step.stack[i]);
+        }
+        out += ']';
+    }
+    if (_step.hasStorage)
+    {
+        out += ",\"storage\":{";
+        bool first = true;
+        for (auto const& i : _step.storage)
+        {
+            if (!first)
+                out += ',';
+            first = false;
+            quoted(i.first);
+            out += ':';
+            quoted(i.second);
+        }
+        out += '}';
+    }
+    out += '}';
+}
+
+Json::Value StandardTrace::toJson(Step const& _step) const
+{
+    Json::Value r(Json::objectValue);
+    if (_step.hasStack)
+    {
+        Json::Value stack(Json::arrayValue);
+        for (auto const& i : _step.stack)
+            stack.append(i);
+        r["stack"] = stack;
+    }
+    if (_step.hasMemory)
+    {
+        Json::Value memJson(Json::arrayValue);
+        for (auto const& i : _step.memory)
+            memJson.append(i);
+        r["memory"] = memJson;
+    }
+    if (_step.hasMemSize)
+        r["memSize"] = _step.memSize;
+    if (_step.hasStorage)
+    {
+        Json::Value storage(Json::objectValue);
+        for (auto const& i : _step.storage)
+            storage[i.first] = i.second;
+        r["storage"] = storage;
+    }
+    r["op"] = static_cast<uint8_t>(_step.op);
+    if (m_showMnemonics)
+        r["opName"] = instructionInfo(_step.op).name;
+    r["pc"] = _step.pc;
+    r["gas"] = _step.gas;
+    r["gasCost"] = _step.gasCost;
+    r["depth"] = _step.depth;
+    if (!_step.memexpand.empty())
+        r["memexpand"] = _step.memexpand;
+    return r;
 }
 }  // namespace eth
 }  // namespace dev
@@ -8,7 +8,12 @@
 #include <libdevcore/Common.h>
 #include <libevm/Instruction.h>
 #include <libevm/VMFace.h>
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
 
 namespace Json
 {
@@ -19,6 +24,45 @@ namespace dev
 {
 namespace eth
 {
+/**
+ * @brief The steps and bytes the traces of one response may take in total, shared by the
+ * StandardTraces writing them, possibly on several threads.
+ * Once a step doesn't fit, the budget is exhausted and all traces sharing it stop recording.
+ */
+class TraceBudget
+{
+public:
+    /// @param _maxSteps maximum number of steps, 0 for no limit
+    /// @param _maxSize maximum total size of the JSON text of the steps in bytes, 0 for no limit
+    TraceBudget(uint64_t _maxSteps, uint64_t _maxSize) : m_maxSteps(_maxSteps), m_maxSize(_maxSize)
+    {}
+
+    /// Takes a step before it is built. @returns false if no more steps are taken.
+    bool takeStep();
+
+    /// Takes @a _size bytes of the JSON text of a step. @returns false if they don't fit, which
+    /// exhausts the budget.
+    bool takeSize(uint64_t _size);
+
+    /// @returns false if @a _size more bytes don't fit, exhausting the budget, without taking
+    /// them. Lets a step give up before building its larger parts.
+    bool fits(uint64_t _size);
+
+    /// @returns true if no more steps are taken.
+    bool exhausted() const
+    {
+        return m_exhausted.load(std::memory_order_relaxed) ||
+               (m_maxSteps && m_steps.load(std::memory_order_relaxed) >= m_maxSteps);
+    }
+
+private:
+    uint64_t const m_maxSteps;
+    uint64_t const m_maxSize;
+    std::atomic<uint64_t> m_steps{0};
+    std::atomic<uint64_t> m_size{0};
+    std::atomic<bool> m_exhausted{false};
+};
+
 class StandardTrace
 {
 public:
@@ -28,18 +72,37 @@ public:
         bool disableMemory = false;
         bool disableStack = false;
         bool fullStorage = false;
+        /// Leave out memory equal to that of the previous step in the same call, and of the storage
+        /// write only the slot written by the previous step. Consumers have to carry them forward.
+        bool onlyChanges = false;
+        /// Maximum number of steps recorded, 0 for no limit. Applies to the trace unless it
+        /// shares a budget, see setBudget().
+        uint64_t limit = 0;
+        /// Maximum total size of the JSON text of the recorded steps in bytes, 0 for no limit.
+        uint64_t maxOutputSize = 0;
     };
 
+    /// Receives every step as the JSON text of an object.
+    using StepSink = std::function<void(std::string const& _step)>;
+
     // Output json trace to stream, one line per op
     explicit StandardTrace(std::ostream& _outStream) noexcept : m_outStream{&_outStream} {}
     // Append json trace to given (array) value
     explicit StandardTrace(Json::Value& _outValue) noexcept : m_outValue{&_outValue} {}
+    // Pass json trace to the sink step by step, nothing is kept in memory
+    explicit StandardTrace(StepSink _outSink) : m_outSink{std::move(_outSink)} {}
 
     void operator()(uint64_t _steps, uint64_t _PC, Instruction _inst, bigint _newMemSize,
         bigint _gasCost, bigint _gas, VMFace const* _vm, ExtVMFace const* _extVM);
 
     void setShowMnemonics() { m_showMnemonics = true; }
     void setOptions(DebugOptions _options) { m_options = _options; }
+    /// Makes the trace take its steps from @a _budget instead of its own limit and maxOutputSize,
+    /// so that several traces are limited together.
+    void setBudget(std::shared_ptr<TraceBudget> _budget) { m_budget = std::move(_budget); }
+
+    /// @returns true if steps have been left out because of the step or size limit.
+    bool truncated() const { return m_truncated; }
 
     OnOpFunc onOp()
     {
@@ -50,12 +113,44 @@ public:
     }
 
 private:
+    /// Fields of a step, null members are left out.
+    struct Step
+    {
+        bool hasStack = false;
+        std::vector<std::string> stack;
+        bool hasMemory = false;
+        std::vector<std::string> memory;
+        bool hasMemSize = false;
+        uint64_t memSize = 0;
+        bool hasStorage = false;
+        std::map<std::string, std::string> storage;
+        Instruction op = Instruction::STOP;
+        uint64_t pc = 0;
+        std::string gas;
+        std::string gasCost;
+        unsigned depth = 0;
+        std::string memexpand;
+    };
+
+    /// Writes @a _step as a JSON object to m_stepText, in the format of Json::FastWriter.
+    void writeStep(Step const& _step);
+    Json::Value toJson(Step const& _step) const;
+
     bool m_showMnemonics = false;
     std::vector<Instruction> m_lastInst;
+    /// Memory of the last step of each call on the call stack, if onlyChanges is set.
+    std::vector<bytes> m_lastMemory;
+    /// Slot and value of the last SSTORE step, taken from its stack, if onlyChanges is set.
+    std::pair<std::string, std::string> m_lastStore;
     std::ostream* m_outStream = nullptr;
     Json::Value* m_outValue = nullptr;
-    Json::FastWriter m_fastWriter;
+    StepSink m_outSink;
     DebugOptions m_options;
+    /// Text of the current step, reused between steps.
+    std::string m_stepText;
+    /// Created from the options with the first step if none has been set.
+    std::shared_ptr<TraceBudget> m_budget;
+    bool m_truncated = false;
 };
 }  // namespace eth
 }  // namespace dev
@@ -8,10 +8,12 @@
 #include "BlockChain.h"
 #include "ExtVM.h"
 #include "TransactionQueue.h"
+#include "TriePrefetcher.h"
 #include "DatabasePaths.h"
 #include <libdevcore/Assertions.h>
 #include <libdevcore/DBFactory.h>
 #include <libdevcore/TrieHash.h>
+#include <libdevcore/WriteBehindDB.h>
 #include <libevm/VMFactory.h>
 #include <boost/filesystem.hpp>
 
@@ -38,10 +40,16 @@ State::State(State const& _s):
     m_nonExistingAccountsCache(_s.m_nonExistingAccountsCache),
     m_touched(_s.m_touched),
     m_unrevertablyTouched(_s.m_unrevertablyTouched),
-    m_accountStartNonce(_s.m_accountStartNonce)
+    m_accountStartNonce(_s.m_accountStartNonce),
+    m_snapshot(_s.m_snapshot),
+    m_snapshotRoot(_s.m_snapshotRoot),
+    m_snapshotDiff(_s.m_snapshotDiff),
+    m_prefetcher(_s.m_prefetcher),
+    m_reportStorageReads(_s.m_reportStorageReads)
 {}
 
-OverlayDB State::openDB(fs::path const& _basePath, h256 const& _genesisHash, WithExisting _we)
+OverlayDB State::openDB(fs::path const& _basePath, h256 const& _genesisHash, WithExisting _we,
+    std::shared_ptr<db::WriteQueue> _writeQueue)
 {
     DatabasePaths const dbPaths{_basePath, _genesisHash};
     if (db::isDiskDatabase())
@@ -60,11 +68,11 @@ OverlayDB State::openDB(fs::path const& _basePath, h256 const& _genesisHash, Wit
         DEV_IGNORE_EXCEPTIONS(fs::permissions(dbPaths.chainPath(), fs::owner_all));
     }
 
+    std::unique_ptr<db::DatabaseFace> db;
     try
     {
         clog(VerbosityTrace, "statedb") << "Opening state database";
-        std::unique_ptr<db::DatabaseFace> db = db::DBFactory::create(dbPaths.statePath());
-        return OverlayDB(std::move(db));
+        db = db::DBFactory::create(dbPaths.statePath());
     }
     catch (boost::exception const& ex)
     {
@@ -101,11 +109,29 @@ OverlayDB State::openDB(fs::path const& _basePath, h256 const& _genesisHash, Wit
             << boost::diagnostic_information(ex);
         throw;
     }
+
+    if (_writeQueue)
+        db.reset(new db::WriteBehindDB(std::move(db), std::move(_writeQueue)));
+
+    OverlayDB ret(std::move(db));
+    try
+    {
+        ret.setRefCounting(db::statePruningHistory() != 0);
+    }
+    catch (RefCountingMismatch const&)
+    {
+        clog(VerbosityError, "statedb")
+            << "The state database " << dbPaths.statePath() << " was created "
+            << (db::statePruningHistory() ? "without" : "with") << " the --prune-state option. "
+            << "Please re-run Aleth with the --rebuild or --kill option to recreate it.";
+        throw;
+    }
+    return ret;
 }
 
 void State::populateFrom(AccountMap const& _map)
 {
-    eth::commit(_map, m_state);
+    eth::commit(_map, m_state, m_snapshot ? &m_snapshotDiff.mut() : nullptr);
     commit(State::CommitBehaviour::KeepEmptyAccounts);
 }
 
@@ -151,6 +177,11 @@ State& State::operator=(State const& _s)
     m_touched = _s.m_touched;
     m_unrevertablyTouched = _s.m_unrevertablyTouched;
     m_accountStartNonce = _s.m_accountStartNonce;
+    m_snapshot = _s.m_snapshot;
+    m_snapshotRoot = _s.m_snapshotRoot;
+    m_snapshotDiff = _s.m_snapshotDiff;
+    m_prefetcher = _s.m_prefetcher;
+    m_reportStorageReads = _s.m_reportStorageReads;
     return *this;
 }
 
@@ -165,14 +196,14 @@ Account* State::account(Address const& _addr)
     if (it != m_cache.end())
         return &it->second;
 
-    if (m_nonExistingAccountsCache.count(_addr))
+    if (m_nonExistingAccountsCache->count(_addr))
         return nullptr;
 
     // Populate basic info.
-    string stateBack = m_state.at(_addr);
+    string const stateBack = baseAccount(_addr);
     if (stateBack.empty())
     {
-        m_nonExistingAccountsCache.insert(_addr);
+        m_nonExistingAccountsCache.mut().insert(_addr);
         return nullptr;
     }
 
@@ -192,6 +223,55 @@ Account* State::account(Address const& _addr)
     return &i.first->second;
 }
 
+string State::baseAccount(Address const& _address) const
+{
+    if (m_snapshot)
+    {
+        h256 const addressHash = sha3(_address);
+        auto const changed = m_snapshotDiff->accounts.find(addressHash);
+        if (changed != m_snapshotDiff->accounts.end())
+            return asString(changed->second);
+
+        string account;
+        if (m_snapshot->account(m_snapshotRoot, addressHash, account))
+            return account;
+    }
+    return m_state.at(_address);
+}
+
+u256 State::baseStorage(Address const& _address, Account const& _account, u256 const& _key) const
+{
+    if (_account.baseRoot() == EmptyTrie)
+        return 0;
+
+    if (m_prefetcher && m_reportStorageReads)
+        m_prefetcher->noteStorageRead(_address, _key);
+
+    if (m_snapshot)
+    {
+        h256 const addressHash = sha3(_address);
+        h256 const keyHash = sha3(h256(_key));
+        StateDiff const& diff = *m_snapshotDiff;
+        auto const changed = diff.storage.find(addressHash);
+        if (changed != diff.storage.end())
+        {
+            auto const value = changed->second.find(keyHash);
+            if (value != changed->second.end())
+                return value->second;
+        }
+        if (diff.wiped.count(addressHash))
+            return 0;
+
+        u256 value;
+        if (m_snapshot->storage(m_snapshotRoot, addressHash, keyHash, value))
+            return value;
+    }
+
+    SecureTrieDB<h256, OverlayDB> const memdb(const_cast<OverlayDB*>(&m_db), _account.baseRoot());  // promise we won't alter the overlay! :)
+    string const payload = memdb.at(_key);
+    return payload.size() ? RLP(payload).toInt<u256>() : 0;
+}
+
 void State::clearCacheIfTooLarge() const
 {
     // TODO: Find a good magic number
@@ -211,11 +291,33 @@ void State::clearCacheIfTooLarge() const
     }
 }
 
+void State::warmUpCache(State const& _s) const
+{
+    for (auto const& addressAndAccount : _s.m_cache)
+    {
+        Account const* cached = account(addressAndAccount.first);
+        if (!cached || cached->isDirty())
+            continue;
+
+        Account const& looked = addressAndAccount.second;
+        // storage cleared or account recreated by _s has nothing in common with ours
+        if (looked.baseRoot() == cached->baseRoot())
+            cached->cacheOriginalStorage(looked);
+        if (cached->code().empty() && !looked.code().empty() &&
+            looked.codeHash() == cached->codeHash())
+            const_cast<Account*>(cached)->noteCode(&looked.code());
+    }
+
+    for (auto const& address : *_s.m_nonExistingAccountsCache)
+        account(address);
+}
+
 void State::commit(CommitBehaviour _commitBehaviour)
 {
     if (_commitBehaviour == CommitBehaviour::RemoveEmptyAccounts)
         removeEmptyAccounts();
-    m_touched += dev::eth::commit(m_cache, m_state);
+    m_touched.mut() +=
+        dev::eth::commit(m_cache, m_state, m_snapshot ? &m_snapshotDiff.mut() : nullptr);
     m_changeLog.clear();
     m_cache.clear();
     m_unchangedCacheEntries.clear();
@@ -297,9 +399,35 @@ void State::setRoot(h256 const& _r)
 {
     m_cache.clear();
     m_unchangedCacheEntries.clear();
-    m_nonExistingAccountsCache.clear();
+    m_nonExistingAccountsCache.reset();
 //  m_touched.clear();
     m_state.setRoot(_r);
+    m_snapshotRoot = _r;
+    m_snapshotDiff.reset();
+}
+
+void State::setSnapshot(std::shared_ptr<StateSnapshot> const& _snapshot)
+{
+    m_snapshot = _snapshot;
+    m_snapshotRoot = h256();
+    m_snapshotDiff.reset();
+}
+
+void State::setPrefetcher(std::shared_ptr<TriePrefetcher> const& _prefetcher)
+{
+    m_prefetcher = _prefetcher;
+    m_db.setNodeCache(_prefetcher ? _prefetcher->cache() : nullptr);
+}
+
+void State::updateSnapshot()
+{
+    if (!m_snapshot)
+        return;
+
+    h256 const root = rootHash();
+    m_snapshot->update(m_snapshotRoot, root, std::move(m_snapshotDiff.mut()));
+    m_snapshotRoot = root;
+    m_snapshotDiff.reset();
 }
 
 bool State::addressInUse(Address const& _id) const
@@ -413,8 +541,13 @@ void State::createContract(Address const& _address)
 void State::createAccount(Address const& _address, Account const&& _account)
 {
     assert(!addressInUse(_address) && "Account already exists");
+    auto const replaced = m_cache.find(_address);
+    bool const hadStorageOrCode = replaced != m_cache.end() && replaced->second.hadStorageOrCode();
     m_cache[_address] = std::move(_account);
-    m_nonExistingAccountsCache.erase(_address);
+    if (hadStorageOrCode)
+        m_cache[_address].noteReplacedStorageOrCode();
+    if (m_nonExistingAccountsCache->count(_address))
+        m_nonExistingAccountsCache.mut().erase(_address);
     m_changeLog.emplace_back(Change::Create, _address);
 }
 
@@ -436,7 +569,7 @@ u256 State::getNonce(Address const& _addr) const
 u256 State::storage(Address const& _id, u256 const& _key) const
 {
     if (Account const* a = account(_id))
-        return a->storageValue(_key, m_db);
+        return a->storageValue(_key, [&] { return baseStorage(_id, *a, _key); });
     else
         return 0;
 }
@@ -450,7 +583,7 @@ void State::setStorage(Address const& _contract, u256 const& _key, u256 const& _
 u256 State::originalStorageValue(Address const& _contract, u256 const& _key) const
 {
     if (Account const* a = account(_contract))
-        return a->originalStorageValue(_key, m_db);
+        return a->originalStorageValue(_key, [&] { return baseStorage(_contract, *a, _key); });
     else
         return 0;
 }
@@ -505,7 +638,7 @@ map<h256, pair<u256, u256>> State::storage(Address const& _id) const
 
 h256 State::storageRoot(Address const& _id) const
 {
-    string s = m_state.at(_id);
+    string const s = baseAccount(_id);
     if (s.size())
     {
         RLP r(s);
@@ -783,17 +916,102 @@ State& dev::eth::createIntermediateState(State& o_s, Block const& _block, unsign
     return o_s;
 }
 
+namespace
+{
+template <class DB>
+bool countsReferences(DB const&)
+{
+    return false;
+}
+
+bool countsReferences(OverlayDB const& _db)
+{
+    return _db.refCounting();
+}
+
 template <class DB>
-AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state)
+void killTrieNodes(DB& _db, RLP const& _node);
+
+/// Drops the reference to the trie node @a _hash and the references it holds to the nodes below.
+template <class DB>
+void killTrieNode(DB& _db, h256 const& _hash)
 {
+    std::string const node = _db.lookup(_hash);
+    _db.kill(_hash);
+    if (!node.empty())
+        killTrieNodes(_db, RLP(node));
+}
+
+/// Drops the references the trie node @a _node holds to the nodes below it.
+template <class DB>
+void killTrieNodes(DB& _db, RLP const& _node)
+{
+    auto const killEntry = [&_db](RLP const& _entry) {
+        if (_entry.isData() && _entry.size() == 32)
+            killTrieNode(_db, _entry.toHash<h256>());
+        else if (_entry.isList())
+            killTrieNodes(_db, _entry);
+    };
+    if (_node.isList() && _node.itemCount() == 2 && !isLeaf(_node))
+        killEntry(_node[1]);
+    else if (_node.isList() && _node.itemCount() == 17)
+        for (unsigned i = 0; i < 16; ++i)
+            killEntry(_node[i]);
+}
+
+/// Drops the references the account @a _address in @a _state holds to the storage trie and the
+/// code its new version @a _account doesn't have any more, so that pruning deletes them. This
+/// walks the whole storage trie.
+template <class DB>
+void killReplacedAccountData(
+    SecureTrieDB<Address, DB>& _state, Address const& _address, Account const& _account)
+{
+    std::string const account = _state.at(_address);
+    if (account.empty())
+        return;
+
+    RLP const r(account);
+    h256 const storageRoot = r[2].toHash<h256>();
+    if (storageRoot != EmptyTrie && storageRoot != _account.baseRoot())
+        killTrieNode(*_state.db(), storageRoot);
+    h256 const codeHash = r[3].toHash<h256>();
+    if (codeHash != EmptySHA3 && codeHash != _account.codeHash())
+        _state.db()->kill(codeHash);
+}
+}  // namespace
+
+template <class DB>
+AddressHash dev::eth::commit(
+    AccountMap const& _cache, SecureTrieDB<Address, DB>& _state, StateDiff* o_diff)
+{
+    bool const refCounting = countsReferences(*_state.db());
     AddressHash ret;
     for (auto const& i: _cache)
         if (i.second.isDirty())
         {
+            h256 const addressHash = o_diff ? sha3(i.first) : h256();
+            // Removed accounts and accounts recreated over existing ones have an empty base
+            // storage, the storage trie and code they had are no longer referenced by the state.
+            // Accounts which had neither, like all EOAs, have nothing to release.
+            if (refCounting && i.second.hadStorageOrCode() &&
+                (i.second.baseRoot() == EmptyTrie || i.second.hasNewCode()))
+                killReplacedAccountData(_state, i.first, i.second);
+
             if (!i.second.isAlive())
+            {
                 _state.remove(i.first);
+                if (o_diff)
+                {
+                    o_diff->wipe(addressHash);
+                    o_diff->accounts[addressHash].clear();
+                }
+            }
             else
             {
+                // the storage before the overlay is empty for new and cleared accounts
+                if (o_diff && i.second.baseRoot() == EmptyTrie)
+                    o_diff->wipe(addressHash);
+
                 auto const version = i.second.version();
 
                 // version = 0: [nonce, balance, storageRoot, codeHash]
@@ -810,10 +1028,14 @@ AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>
                 {
                     SecureTrieDB<h256, DB> storageDB(_state.db(), i.second.baseRoot());
                     for (auto const& j: i.second.storageOverlay())
+                    {
                         if (j.second)
                             storageDB.insert(j.first, rlp(j.second));
                         else
                             storageDB.remove(j.first);
+                        if (o_diff)
+                            o_diff->storage[addressHash][sha3(h256(j.first))] = j.second;
+                    }
                     assert(storageDB.root());
                     s.append(storageDB.root());
                 }
@@ -833,6 +1055,8 @@ AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>
                     s << i.second.version();
 
                 _state.insert(i.first, &s.out());
+                if (o_diff)
+                    o_diff->accounts[addressHash] = s.out();
             }
             ret.insert(i.first);
         }
@@ -840,5 +1064,5 @@ AddressHash dev::eth::commit(AccountMap const& _cache, SecureTrieDB<Address, DB>
 }
 
 
-template AddressHash dev::eth::commit<OverlayDB>(AccountMap const& _cache, SecureTrieDB<Address, OverlayDB>& _state);
-template AddressHash dev::eth::commit<StateCacheDB>(AccountMap const& _cache, SecureTrieDB<Address, StateCacheDB>& _state);
+template AddressHash dev::eth::commit<OverlayDB>(AccountMap const& _cache, SecureTrieDB<Address, OverlayDB>& _state, StateDiff* o_diff);
+template AddressHash dev::eth::commit<StateCacheDB>(AccountMap const& _cache, SecureTrieDB<Address, StateCacheDB>& _state, StateDiff* o_diff);
@@ -7,9 +7,11 @@
 #include "Account.h"
 #include "GasPricer.h"
 #include "SecureTrieDB.h"
+#include "StateSnapshot.h"
 #include "Transaction.h"
 #include "TransactionReceipt.h"
 #include <libdevcore/Common.h>
+#include <libdevcore/CopyOnWrite.h>
 #include <libdevcore/OverlayDB.h>
 #include <libdevcore/RLP.h>
 #include <libethcore/BlockHeader.h>
@@ -23,6 +25,7 @@ namespace dev
 {
 
 namespace test { class ImportTest; class StateLoader; }
+namespace db { class WriteQueue; }
 
 namespace eth
 {
@@ -48,6 +51,7 @@ using LogBloomRequirementError = boost::tuple<errinfo_required_LogBloom, errinfo
 class BlockChain;
 class State;
 class TransactionQueue;
+class TriePrefetcher;
 struct VerifiedBlockRef;
 
 enum class BaseState
@@ -171,7 +175,9 @@ public:
     State& operator=(State const& _s);
 
     /// Open a DB - useful for passing into the constructor & keeping for other states that are necessary.
-    static OverlayDB openDB(boost::filesystem::path const& _path, h256 const& _genesisHash, WithExisting _we = WithExisting::Trust);
+    /// Its writes are made by @a _writeQueue in the background, if given.
+    static OverlayDB openDB(boost::filesystem::path const& _path, h256 const& _genesisHash,
+        WithExisting _we = WithExisting::Trust, std::shared_ptr<db::WriteQueue> _writeQueue = {});
     OverlayDB const& db() const { return m_db; }
     OverlayDB& db() { return m_db; }
 
@@ -300,6 +306,27 @@ public:
     /// Resets any uncommitted changes to the cache.
     void setRoot(h256 const& _root);
 
+    /// Reads the accounts and storage of the states covered by @a _snapshot from it rather than
+    /// from the trie.
+    void setSnapshot(std::shared_ptr<StateSnapshot> const& _snapshot);
+
+    /// Adds to the snapshot the changes committed since the root was set or since the last call,
+    /// as the layer of the current root.
+    void updateSnapshot();
+
+    /// Reads the trie nodes @a _prefetcher has read ahead from its cache.
+    void setPrefetcher(std::shared_ptr<TriePrefetcher> const& _prefetcher);
+
+    /// Reports the storage values read from the database to the prefetcher, so that it reads them
+    /// ahead for the next blocks. Only enabled for the states of imported blocks.
+    void setReportStorageReads(bool _report) { m_reportStorageReads = _report; }
+
+    /// Loads into the cache the unmodified versions of the accounts that @a _s has looked up,
+    /// together with their storage values and code already read by @a _s.
+    /// @a _s must be derived from this state, so that subsequent copies of this state don't
+    /// need to read them from the database again.
+    void warmUpCache(State const& _s) const;
+
     /// Get the account start nonce. May be required.
     u256 const& accountStartNonce() const { return m_accountStartNonce; }
     u256 const& requireAccountStartNonce() const;
@@ -329,6 +356,14 @@ private:
     /// The pointer is valid until the next access to the state or account.
     Account* account(Address const& _addr);
 
+    /// @returns the RLP of the account at the given address in the state at the root, empty if it
+    /// does not exist.
+    std::string baseAccount(Address const& _address) const;
+
+    /// @returns the value of @a _key in the storage of @a _account at the given address in the
+    /// state at the root.
+    u256 baseStorage(Address const& _address, Account const& _account, u256 const& _key) const;
+
     /// Purges non-modified entries in m_cache if it grows too large.
     void clearCacheIfTooLarge() const;
 
@@ -347,15 +382,26 @@ private:
     mutable std::unordered_map<Address, Account> m_cache;
     /// Tracks entries in m_cache that can potentially be purged if it grows too large.
     mutable std::vector<Address> m_unchangedCacheEntries;
-    /// Tracks addresses that are known to not exist.
-    mutable std::set<Address> m_nonExistingAccountsCache;
-    /// Tracks all addresses touched so far.
-    AddressHash m_touched;
+    /// Tracks addresses that are known to not exist. Shared with copies of the state until modified.
+    mutable CopyOnWrite<std::set<Address>> m_nonExistingAccountsCache;
+    /// Tracks all addresses touched so far. Shared with copies of the state until modified.
+    CopyOnWrite<AddressHash> m_touched;
     /// Tracks addresses that were touched and should stay touched in case of rollback
     AddressHash m_unrevertablyTouched;
 
     u256 m_accountStartNonce;
 
+    /// Flat snapshot of the recent states, null if disabled.
+    std::shared_ptr<StateSnapshot> m_snapshot;
+    /// The root of the state which m_snapshotDiff is relative to.
+    h256 m_snapshotRoot;
+    /// The changes committed since m_snapshotRoot. Shared with copies of the state until modified.
+    CopyOnWrite<StateDiff> m_snapshotDiff;
+
+    /// Reader of the trie nodes ahead of block execution, null if disabled.
+    std::shared_ptr<TriePrefetcher> m_prefetcher;
+    bool m_reportStorageReads = false;
+
     friend std::ostream& operator<<(std::ostream& _out, State const& _s);
     ChangeLog m_changeLog;
 };
@@ -364,8 +410,10 @@ std::ostream& operator<<(std::ostream& _out, State const& _s);
 
 State& createIntermediateState(State& o_s, Block const& _block, unsigned _txIndex, BlockChain const& _bc);
 
+/// Writes the changed accounts of @a _cache into @a _state, and also into @a o_diff if given.
 template <class DB>
-AddressHash commit(AccountMap const& _cache, SecureTrieDB<Address, DB>& _state);
+AddressHash commit(
+    AccountMap const& _cache, SecureTrieDB<Address, DB>& _state, StateDiff* o_diff = nullptr);
 
 }
 }
@@ -20,7 +20,7 @@ class StateImporter: public StateImporterFace
 public:
 	explicit StateImporter(OverlayDB& _stateDb): m_trie(&_stateDb) { m_trie.init(); }
 
-	void importAccount(h256 const& _addressHash, u256 const& _nonce, u256 const& _balance, std::map<h256, bytes> const& _storage, h256 const& _codeHash) override
+	void importAccount(h256 const& _addressHash, u256 const& _nonce, u256 const& _balance, StorageEntries const& _storage, h256 const& _codeHash) override
 	{
 		RLPStream s(4);
 		s << _nonce << _balance;
@@ -55,6 +55,8 @@ public:
 
 	h256 stateRoot() const override { return m_trie.root(); }
 
+	void setStateRoot(h256 const& _root) override { m_trie.setRoot(_root); }
+
 	std::string lookupCode(h256 const& _hash) const override { return m_trie.db()->lookup(_hash); }
 
 private:
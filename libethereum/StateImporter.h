@@ -11,6 +11,8 @@
 #include <libdevcore/FixedHash.h>
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace dev
 {
@@ -22,12 +24,16 @@ namespace eth
 
 DEV_SIMPLE_EXCEPTION(InvalidAccountInTheDatabase);
 
+/// Storage entries of an account (key hash and value) referencing the data of the chunk
+/// they were decoded from, so that they are not copied while importing.
+using StorageEntries = std::vector<std::pair<h256, bytesConstRef>>;
+
 class StateImporterFace
 {
 public:
 	virtual ~StateImporterFace() = default;
 
-	virtual void importAccount(h256 const& _addressHash, u256 const& _nonce, u256 const& _balance, std::map<h256, bytes> const& _storage, h256 const& _codeHash) = 0;
+	virtual void importAccount(h256 const& _addressHash, u256 const& _nonce, u256 const& _balance, StorageEntries const& _storage, h256 const& _codeHash) = 0;
 
 	virtual h256 importCode(bytesConstRef _code) = 0;
 
@@ -37,6 +43,9 @@ public:
 
 	virtual h256 stateRoot() const = 0;
 
+	/// Continues import on top of the previously committed state with the given root.
+	virtual void setStateRoot(h256 const& _root) = 0;
+
 	virtual std::string lookupCode(h256 const& _hash) const = 0;
 };
 		
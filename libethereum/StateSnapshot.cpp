@@ -0,0 +1,372 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "StateSnapshot.h"
+
+#include <libdevcore/DBFactory.h>
+#include <libdevcore/Log.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/TrieDB.h>
+
+#include <boost/filesystem/operations.hpp>
+
+namespace fs = boost::filesystem;
+
+namespace dev
+{
+namespace eth
+{
+namespace
+{
+// The accounts are stored as RLP [incarnation, account] or [incarnation] for the deleted ones, the
+// storage values as RLP [incarnation, value]. Clearing the storage of an account increments its
+// incarnation, which hides the storage values written before.
+char const c_accountPrefix = 'a';
+char const c_storagePrefix = 's';
+db::Slice const c_sliceRoot = db::Slice("root");
+
+/// Number of accounts written to the disk layer in one batch during generation.
+unsigned const c_generationBatchAccounts = 10000;
+
+bytes accountKey(h256 const& _addressHash)
+{
+    bytes key(1 + h256::size);
+    key[0] = c_accountPrefix;
+    _addressHash.ref().copyTo(bytesRef(&key).cropped(1));
+    return key;
+}
+
+bytes storageKey(h256 const& _addressHash, h256 const& _keyHash)
+{
+    bytes key(1 + 2 * h256::size);
+    key[0] = c_storagePrefix;
+    _addressHash.ref().copyTo(bytesRef(&key).cropped(1));
+    _keyHash.ref().copyTo(bytesRef(&key).cropped(1 + h256::size));
+    return key;
+}
+
+db::Slice toSlice(bytes const& _b)
+{
+    return db::Slice(reinterpret_cast<char const*>(_b.data()), _b.size());
+}
+}  // namespace
+
+StateSnapshot::StateSnapshot(fs::path const& _path, unsigned _layers)
+  : m_path(_path), m_layers(_layers), m_db(db::DBFactory::create(_path))
+{
+    std::string const root = m_db->lookup(c_sliceRoot);
+    if (!root.empty())
+    {
+        m_diskRoot = h256(root, h256::FromBinary);
+        m_generated = true;
+    }
+}
+
+StateSnapshot::~StateSnapshot()
+{
+    stopGeneration();
+}
+
+bool StateSnapshot::covers(h256 const& _root) const
+{
+    ReadGuard l(x_snapshot);
+    return m_generated && (_root == m_diskRoot || m_diffLayers.count(_root));
+}
+
+bool StateSnapshot::contains(h256 const& _root) const
+{
+    ReadGuard l(x_snapshot);
+    return (m_diskRoot && _root == m_diskRoot) || m_diffLayers.count(_root);
+}
+
+bool StateSnapshot::generating() const
+{
+    return m_generating;
+}
+
+bool StateSnapshot::account(
+    h256 const& _root, h256 const& _addressHash, std::string& o_account) const
+{
+    ReadGuard l(x_snapshot);
+    if (!m_generated)
+        return false;
+
+    for (h256 root = _root; root != m_diskRoot;)
+    {
+        auto const layer = m_diffLayers.find(root);
+        if (layer == m_diffLayers.end())
+            return false;
+
+        auto const account = layer->second->diff.accounts.find(_addressHash);
+        if (account != layer->second->diff.accounts.end())
+        {
+            o_account = asString(account->second);
+            return true;
+        }
+        root = layer->second->parent;
+    }
+
+    diskAccount(_addressHash, &o_account);
+    return true;
+}
+
+bool StateSnapshot::storage(
+    h256 const& _root, h256 const& _addressHash, h256 const& _keyHash, u256& o_value) const
+{
+    ReadGuard l(x_snapshot);
+    if (!m_generated)
+        return false;
+
+    for (h256 root = _root; root != m_diskRoot;)
+    {
+        auto const layer = m_diffLayers.find(root);
+        if (layer == m_diffLayers.end())
+            return false;
+
+        StateDiff const& diff = layer->second->diff;
+        auto const storage = diff.storage.find(_addressHash);
+        if (storage != diff.storage.end())
+        {
+            auto const value = storage->second.find(_keyHash);
+            if (value != storage->second.end())
+            {
+                o_value = value->second;
+                return true;
+            }
+        }
+        if (diff.wiped.count(_addressHash))
+        {
+            o_value = 0;
+            return true;
+        }
+        root = layer->second->parent;
+    }
+
+    o_value = 0;
+    if (uint64_t const incarnation = diskAccount(_addressHash, nullptr))
+    {
+        std::string const value = m_db->lookup(toSlice(storageKey(_addressHash, _keyHash)));
+        if (!value.empty())
+        {
+            RLP const rlp(value);
+            if (rlp[0].toInt<uint64_t>() == incarnation)
+                o_value = rlp[1].toInt<u256>();
+        }
+    }
+    return true;
+}
+
+void StateSnapshot::update(h256 const& _parentRoot, h256 const& _root, StateDiff _diff)
+{
+    WriteGuard l(x_snapshot);
+    auto const contains = [&](h256 const& _r) {
+        return (m_diskRoot && _r == m_diskRoot) || m_diffLayers.count(_r);
+    };
+    // A state seen before, e.g. on another branch, reads the same from its layer.
+    if (contains(_root) || !contains(_parentRoot))
+        return;
+
+    m_diffLayers[_root] = std::make_shared<Layer const>(Layer{_parentRoot, std::move(_diff)});
+}
+
+void StateSnapshot::cap(h256 const& _root, unsigned _layers)
+{
+    WriteGuard l(x_snapshot);
+    if (!m_generated)
+        return;
+
+    std::vector<h256> path;
+    for (h256 root = _root; root != m_diskRoot;)
+    {
+        auto const layer = m_diffLayers.find(root);
+        if (layer == m_diffLayers.end())
+            return;
+        path.push_back(root);
+        root = layer->second->parent;
+    }
+    if (path.size() <= _layers)
+        return;
+
+    for (size_t i = path.size(); i > _layers; --i)
+    {
+        h256 const& root = path[i - 1];
+        writeDisk(root, *m_diffLayers.at(root));
+        m_diffLayers.erase(root);
+        m_diskRoot = root;
+    }
+
+    // Drop the branches which forked below the new disk layer.
+    for (bool dropped = true; dropped;)
+    {
+        dropped = false;
+        for (auto it = m_diffLayers.begin(); it != m_diffLayers.end();)
+            if (it->second->parent != m_diskRoot && !m_diffLayers.count(it->second->parent))
+            {
+                it = m_diffLayers.erase(it);
+                dropped = true;
+            }
+            else
+                ++it;
+    }
+}
+
+uint64_t StateSnapshot::diskAccount(h256 const& _addressHash, std::string* o_account) const
+{
+    std::string const account = m_db->lookup(toSlice(accountKey(_addressHash)));
+    if (account.empty())
+    {
+        if (o_account)
+            o_account->clear();
+        return 0;
+    }
+
+    RLP const rlp(account);
+    if (o_account)
+        *o_account = rlp.itemCount() > 1 ? rlp[1].data().toString() : std::string();
+    return rlp[0].toInt<uint64_t>();
+}
+
+void StateSnapshot::writeDisk(h256 const& _root, Layer const& _layer)
+{
+    StateDiff const& diff = _layer.diff;
+    std::unordered_map<h256, uint64_t> incarnations;
+    for (auto const& addressHash : diff.wiped)
+        incarnations[addressHash] = diskAccount(addressHash, nullptr) + 1;
+    auto const incarnation = [&](h256 const& _addressHash) {
+        auto const it = incarnations.find(_addressHash);
+        if (it != incarnations.end())
+            return it->second;
+        return incarnations[_addressHash] =
+                   std::max<uint64_t>(diskAccount(_addressHash, nullptr), 1);
+    };
+
+    std::unique_ptr<db::WriteBatchFace> batch = m_db->createWriteBatch();
+    for (auto const& account : diff.accounts)
+    {
+        RLPStream s(account.second.empty() ? 1 : 2);
+        s << incarnation(account.first);
+        if (!account.second.empty())
+            s.appendRaw(account.second);
+        batch->insert(toSlice(accountKey(account.first)), toSlice(s.out()));
+    }
+    for (auto const& storage : diff.storage)
+    {
+        uint64_t const storageIncarnation = incarnation(storage.first);
+        for (auto const& value : storage.second)
+        {
+            bytes const key = storageKey(storage.first, value.first);
+            if (value.second)
+            {
+                RLPStream s(2);
+                s << storageIncarnation << value.second;
+                batch->insert(toSlice(key), toSlice(s.out()));
+            }
+            else
+                batch->kill(toSlice(key));
+        }
+    }
+    batch->insert(c_sliceRoot, db::Slice(reinterpret_cast<char const*>(_root.data()), h256::size));
+    m_db->commit(std::move(batch));
+}
+
+void StateSnapshot::resetDisk(h256 const& _root)
+{
+    WriteGuard l(x_snapshot);
+    m_db.reset();
+    if (db::isDiskDatabase())
+        fs::remove_all(m_path);
+    m_db = db::DBFactory::create(m_path);
+    m_diskRoot = _root;
+    m_generated = false;
+    m_diffLayers.clear();
+}
+
+void StateSnapshot::generate(OverlayDB const& _db, h256 const& _root)
+{
+    clog(VerbosityInfo, "statedb") << "Generating the state snapshot of " << _root;
+    resetDisk(_root);
+
+    OverlayDB db = _db;
+    GenericTrieDB<OverlayDB> const accounts(&db, _root);
+    unsigned accountCount = 0;
+    std::unique_ptr<db::WriteBatchFace> batch = m_db->createWriteBatch();
+    for (auto it = accounts.begin(); it != accounts.end(); ++it)
+    {
+        if (m_abortGeneration)
+        {
+            WriteGuard l(x_snapshot);
+            m_diskRoot = h256();
+            m_diffLayers.clear();
+            clog(VerbosityInfo, "statedb") << "State snapshot generation stopped";
+            return;
+        }
+
+        auto const account = *it;
+        h256 const addressHash(account.first);
+        RLPStream s(2);
+        s << 1;
+        s.appendRaw(account.second);
+        batch->insert(toSlice(accountKey(addressHash)), toSlice(s.out()));
+
+        h256 const storageRoot = RLP(account.second)[2].toHash<h256>();
+        if (storageRoot != EmptyTrie)
+        {
+            GenericTrieDB<OverlayDB> const storage(&db, storageRoot);
+            for (auto storageIt = storage.begin(); storageIt != storage.end(); ++storageIt)
+            {
+                auto const value = *storageIt;
+                RLPStream v(2);
+                v << 1 << RLP(value.second).toInt<u256>();
+                batch->insert(
+                    toSlice(storageKey(addressHash, h256(value.first))), toSlice(v.out()));
+            }
+        }
+
+        if (++accountCount % c_generationBatchAccounts == 0)
+        {
+            m_db->commit(std::move(batch));
+            batch = m_db->createWriteBatch();
+            clog(VerbosityInfo, "statedb") << "State snapshot: " << accountCount << " accounts";
+        }
+    }
+    batch->insert(c_sliceRoot, db::Slice(reinterpret_cast<char const*>(_root.data()), h256::size));
+    m_db->commit(std::move(batch));
+
+    WriteGuard l(x_snapshot);
+    m_generated = true;
+    clog(VerbosityInfo, "statedb") << "Generated the state snapshot of " << _root << ": "
+                                   << accountCount << " accounts";
+}
+
+void StateSnapshot::startGeneration(OverlayDB const& _db, h256 const& _root)
+{
+    stopGeneration();
+    m_generating = true;
+    m_generator = std::thread([this, _db, _root]() {
+        setThreadName("snapshot");
+        try
+        {
+            generate(_db, _root);
+        }
+        catch (std::exception const& _e)
+        {
+            cwarn << "State snapshot generation failed: " << _e.what();
+            WriteGuard l(x_snapshot);
+            m_diskRoot = h256();
+            m_diffLayers.clear();
+        }
+        m_generating = false;
+    });
+}
+
+void StateSnapshot::stopGeneration()
+{
+    m_abortGeneration = true;
+    if (m_generator.joinable())
+        m_generator.join();
+    m_abortGeneration = false;
+}
+
+}  // namespace eth
+}  // namespace dev
@@ -0,0 +1,145 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Flat key-value copy of the recent states, answering account and storage reads without walking
+/// the state trie.
+#pragma once
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+#include <libdevcore/OverlayDB.h>
+#include <libdevcore/db.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace dev
+{
+namespace eth
+{
+/// Changes of a state relative to its parent state, keyed by the hashes of the addresses and of
+/// the storage keys as in the state trie.
+struct StateDiff
+{
+    /// The RLP of the changed accounts, empty for the deleted ones.
+    std::unordered_map<h256, bytes> accounts;
+    /// The changed storage values, zero for the deleted ones.
+    std::unordered_map<h256, std::unordered_map<h256, u256>> storage;
+    /// The accounts whose storage was cleared before the changes in storage.
+    std::unordered_set<h256> wiped;
+
+    /// Records that the storage of the account @a _addressHash is cleared.
+    void wipe(h256 const& _addressHash)
+    {
+        storage.erase(_addressHash);
+        wiped.insert(_addressHash);
+    }
+
+    bool empty() const { return accounts.empty() && storage.empty() && wiped.empty(); }
+};
+
+/**
+ * @brief Flat snapshot of the state of the recent blocks.
+ *
+ * A disk layer holds the whole state of one block as keccak(address) -> account and
+ * keccak(address) ‖ keccak(key) -> storage value, and on top of it a tree of in-memory diff layers
+ * holds the changes of the following blocks, keyed by state root. Reads of a state the layers
+ * cover cost a few hash table lookups and at most two database reads; the other states are read
+ * from the trie.
+ *
+ * The disk layer is generated once from the state trie on a background thread and then follows
+ * the head: cap() merges the layers more than the given number of blocks below it into the disk
+ * layer and drops the layers of the other branches. The diff layers are lost on a crash, the disk
+ * layer is then generated anew.
+ */
+class StateSnapshot
+{
+public:
+    /// Opens the disk layer at @a _path (unused for the memory database), keeping @a _layers diff
+    /// layers below the head.
+    StateSnapshot(boost::filesystem::path const& _path, unsigned _layers);
+    ~StateSnapshot();
+
+    /// @returns true if the reads of the state @a _root are answered by the snapshot.
+    bool covers(h256 const& _root) const;
+
+    /// @returns true if @a _root is the disk layer or a diff layer, even if the disk layer is
+    /// still being generated.
+    bool contains(h256 const& _root) const;
+
+    /// Reads the account @a _addressHash of the state @a _root into @a o_account, empty if the
+    /// account doesn't exist.
+    /// @returns false if the snapshot doesn't cover @a _root.
+    bool account(h256 const& _root, h256 const& _addressHash, std::string& o_account) const;
+
+    /// Reads the storage value @a _keyHash of the account @a _addressHash of the state @a _root.
+    /// @returns false if the snapshot doesn't cover @a _root.
+    bool storage(
+        h256 const& _root, h256 const& _addressHash, h256 const& _keyHash, u256& o_value) const;
+
+    /// Adds the layer of the state @a _root derived from @a _parentRoot by @a _diff.
+    /// Does nothing unless the snapshot contains @a _parentRoot.
+    void update(h256 const& _parentRoot, h256 const& _root, StateDiff _diff);
+
+    /// Merges the layers more than the configured number of blocks below @a _root into the disk
+    /// layer and drops the layers which don't lead to @a _root.
+    void cap(h256 const& _root) { cap(_root, m_layers); }
+
+    /// Merges all layers up to @a _root into the disk layer.
+    void flatten(h256 const& _root) { cap(_root, 0); }
+
+    /// Starts generating the disk layer from the state trie @a _root of @a _db on a background
+    /// thread, dropping the current layers. Generation stops early if the trie is pruned
+    /// meanwhile.
+    void startGeneration(OverlayDB const& _db, h256 const& _root);
+
+    /// Generates the disk layer from the state trie @a _root of @a _db on the calling thread.
+    void generate(OverlayDB const& _db, h256 const& _root);
+
+    /// Stops the generation of the disk layer, which leaves the snapshot empty.
+    void stopGeneration();
+
+    /// @returns true while the disk layer is being generated on the background thread.
+    bool generating() const;
+
+private:
+    struct Layer
+    {
+        h256 parent;
+        StateDiff diff;
+    };
+
+    void cap(h256 const& _root, unsigned _layers);
+
+    /// Prepares the disk layer for being generated for @a _root.
+    void resetDisk(h256 const& _root);
+    /// Writes @a _layer into the disk layer, which becomes the state @a _root.
+    void writeDisk(h256 const& _root, Layer const& _layer);
+    /// @returns the incarnation of the storage of the account @a _addressHash on disk, 0 if the
+    /// account was never written, and its RLP into @a o_account.
+    uint64_t diskAccount(h256 const& _addressHash, std::string* o_account) const;
+
+    boost::filesystem::path const m_path;
+    unsigned const m_layers;
+
+    mutable SharedMutex x_snapshot;
+    std::unique_ptr<db::DatabaseFace> m_db;
+    h256 m_diskRoot;
+    bool m_generated = false;
+    std::unordered_map<h256, std::shared_ptr<Layer const>> m_diffLayers;
+
+    std::thread m_generator;
+    std::atomic<bool> m_generating{false};
+    std::atomic<bool> m_abortGeneration{false};
+};
+
+}  // namespace eth
+}  // namespace dev
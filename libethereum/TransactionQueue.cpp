@@ -3,6 +3,7 @@
 // Licensed under the GNU General Public License, Version 3.
 
 #include "TransactionQueue.h"
+#include "SenderCache.h"
 
 #include <libdevcore/Log.h>
 #include <libethcore/Exceptions.h>
@@ -84,6 +85,10 @@ ImportResult TransactionQueue::import(Transaction const& _transaction, IfDropped
             ret = manageImport_WITH_LOCK(h, _transaction);
         }
     }
+    // spare the block verification the recovery when the transaction gets mined
+    Address const& sender = _transaction.safeSender();
+    if (ret == ImportResult::Success && sender)
+        SenderCache::instance().store(h, sender);
     return ret;
 }
 
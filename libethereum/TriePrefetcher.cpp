@@ -0,0 +1,194 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "TriePrefetcher.h"
+#include "SecureTrieDB.h"
+#include "Transaction.h"
+
+#include <libdevcore/Log.h>
+#include <libdevcore/RLP.h>
+#include <libdevcore/SHA3.h>
+#include <libdevcore/TrieDB.h>
+
+#include <unordered_set>
+
+namespace dev
+{
+namespace eth
+{
+namespace
+{
+/// Reads through the node cache, adding the nodes it reads from the database to it.
+class PrefetchingDB : public OverlayDB
+{
+public:
+    PrefetchingDB(OverlayDB const& _db, TrieNodeCache& _cache) : OverlayDB(_db), m_cache(_cache) {}
+
+    std::string lookup(h256 const& _h) const
+    {
+        std::string node;
+        if (m_cache.find(_h, node))
+            return node;
+        node = OverlayDB::lookup(_h);
+        if (!node.empty())
+            m_cache.insert(_h, node);
+        return node;
+    }
+
+    bool exists(h256 const& _h) const { return !lookup(_h).empty(); }
+
+private:
+    TrieNodeCache& m_cache;
+};
+}  // namespace
+
+TriePrefetcher::TriePrefetcher(unsigned _threads, size_t _cacheCapacity)
+  : m_threadCount(std::max(1u, _threads)), m_cache(std::make_shared<TrieNodeCache>(_cacheCapacity))
+{}
+
+TriePrefetcher::~TriePrefetcher()
+{
+    {
+        UniqueGuard l(x_queue);
+        m_stopping = true;
+        m_queue.clear();
+    }
+    m_queueChanged.notify_all();
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+void TriePrefetcher::prefetch(OverlayDB const& _db, h256 const& _root, VerifiedBlockRef const& _block)
+{
+    auto const source = std::make_shared<Source const>(Source{_db, _root});
+    std::unordered_set<Address> queued;
+    auto const queueOnce = [&](Address const& _address) {
+        if (queued.insert(_address).second)
+            queue(source, _address);
+    };
+
+    queueOnce(_block.info.author());
+    for (auto const& t : _block.transactions)
+    {
+        queueOnce(t.safeSender());
+        if (!t.isCreation())
+            queueOnce(t.receiveAddress());
+    }
+}
+
+void TriePrefetcher::queue(std::shared_ptr<Source const> const& _source, Address const& _address)
+{
+    Task task{_source, _address, storageReads(_address)};
+    {
+        UniqueGuard l(x_queue);
+        if (m_workers.empty())
+            startWorkers();
+        m_queue.push_back(std::move(task));
+    }
+    m_queueChanged.notify_all();
+}
+
+void TriePrefetcher::noteStorageRead(Address const& _address, u256 const& _key)
+{
+    Guard l(x_storageReads);
+    if (auto const* keys = m_storageReads.find(_address))
+    {
+        if ((*keys)->size() < c_maxKeysPerAccount)
+            (*keys)->insert(_key);
+    }
+    else
+        m_storageReads.insert(_address, std::make_shared<std::set<u256>>(std::set<u256>{_key}));
+}
+
+std::vector<u256> TriePrefetcher::storageReads(Address const& _address)
+{
+    Guard l(x_storageReads);
+    if (auto const* keys = m_storageReads.find(_address))
+        return std::vector<u256>((*keys)->begin(), (*keys)->end());
+    return {};
+}
+
+void TriePrefetcher::clear()
+{
+    {
+        UniqueGuard l(x_queue);
+        m_queue.clear();
+        m_queueChanged.wait(l, [this] { return !m_running; });
+    }
+    m_cache->clear();
+}
+
+void TriePrefetcher::wait()
+{
+    UniqueGuard l(x_queue);
+    m_queueChanged.wait(l, [this] { return m_queue.empty() && !m_running; });
+}
+
+void TriePrefetcher::startWorkers()
+{
+    for (unsigned i = 0; i < m_threadCount; ++i)
+        m_workers.emplace_back([this, i]() {
+            setThreadName("prefetch" + toString(i));
+            work();
+        });
+}
+
+void TriePrefetcher::work()
+{
+    while (true)
+    {
+        Task task;
+        {
+            UniqueGuard l(x_queue);
+            m_queueChanged.wait(l, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping)
+                return;
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+            ++m_running;
+        }
+
+        try
+        {
+            run(task);
+        }
+        catch (std::exception const& _e)
+        {
+            // The state may have been pruned meanwhile, the import then reads what it needs.
+            clog(VerbosityTrace, "prefetch") << "Failed to prefetch " << task.address << ": "
+                                             << _e.what();
+        }
+
+        {
+            UniqueGuard l(x_queue);
+            --m_running;
+        }
+        m_queueChanged.notify_all();
+    }
+}
+
+void TriePrefetcher::run(Task const& _task)
+{
+    PrefetchingDB db(_task.source->db, *m_cache);
+    SecureTrieDB<Address, PrefetchingDB> const state(&db, _task.source->root);
+    std::string const account = state.at(_task.address);
+    if (account.empty())
+        return;
+
+    RLP const rlp(account);
+    h256 const storageRoot = rlp[2].toHash<h256>();
+    h256 const codeHash = rlp[3].toHash<h256>();
+    if (codeHash != EmptySHA3)
+        db.lookup(codeHash);
+
+    if (storageRoot != EmptyTrie && !_task.keys.empty())
+    {
+        SecureTrieDB<h256, PrefetchingDB> const storage(&db, storageRoot);
+        for (auto const& key : _task.keys)
+            storage.at(h256(key));
+    }
+}
+
+}  // namespace eth
+}  // namespace dev
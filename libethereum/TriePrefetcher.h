@@ -0,0 +1,106 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Background reading of the state trie nodes which the blocks about to be imported are likely to
+/// touch.
+#pragma once
+
+#include "VerifiedBlock.h"
+
+#include <libdevcore/Common.h>
+#include <libdevcore/FixedHash.h>
+#include <libdevcore/Guards.h>
+#include <libdevcore/LruCache.h>
+#include <libdevcore/OverlayDB.h>
+#include <libdevcore/TrieNodeCache.h>
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <set>
+#include <thread>
+
+namespace dev
+{
+namespace eth
+{
+/**
+ * @brief Warms the trie paths a block is going to read while the blocks before it execute.
+ *
+ * For each queued block, worker threads walk the state trie down to its author, to the senders
+ * and recipients of its transactions and to the code of the recipients, and the storage tries of
+ * the recipients down to the storage values which executions of their code have read before.
+ * The nodes read from the disk database go into a node cache which the states of the chain read
+ * through, see OverlayDB::setNodeCache().
+ */
+class TriePrefetcher
+{
+public:
+    /// Creates a prefetcher reading on @a _threads threads, which are started with the first
+    /// prefetch(), into a cache of @a _cacheCapacity nodes.
+    explicit TriePrefetcher(unsigned _threads = c_defaultThreads,
+        size_t _cacheCapacity = TrieNodeCache::c_defaultCapacity);
+    ~TriePrefetcher();
+
+    std::shared_ptr<TrieNodeCache> const& cache() const { return m_cache; }
+
+    /// Queues reading the nodes of the state @a _root of @a _db which @a _block is likely to touch.
+    void prefetch(OverlayDB const& _db, h256 const& _root, VerifiedBlockRef const& _block);
+
+    /// Records that the value of @a _key in the storage of @a _address has been read, so that it
+    /// is prefetched for the following transactions calling @a _address.
+    void noteStorageRead(Address const& _address, u256 const& _key);
+
+    /// @returns the storage keys of @a _address read so far, at most c_maxKeysPerAccount.
+    std::vector<u256> storageReads(Address const& _address);
+
+    /// Drops the queued reads and the cached nodes.
+    void clear();
+
+    /// Waits until the queued reads are done.
+    void wait();
+
+    static unsigned const c_defaultThreads = 2;
+    /// The number of contracts whose storage reads are remembered.
+    static size_t const c_maxAccounts = 4096;
+    /// The number of storage keys remembered per contract.
+    static size_t const c_maxKeysPerAccount = 64;
+
+private:
+    /// The state which the reads of one prefetch() are from.
+    struct Source
+    {
+        OverlayDB db;
+        h256 root;
+    };
+
+    struct Task
+    {
+        std::shared_ptr<Source const> source;
+        Address address;
+        std::vector<u256> keys;
+    };
+
+    void queue(std::shared_ptr<Source const> const& _source, Address const& _address);
+    void startWorkers();
+    void work();
+    void run(Task const& _task);
+
+    unsigned const m_threadCount;
+    std::shared_ptr<TrieNodeCache> const m_cache;
+
+    Mutex x_storageReads;
+    LruCache<Address, std::shared_ptr<std::set<u256>>> m_storageReads{c_maxAccounts};
+
+    Mutex x_queue;
+    std::condition_variable m_queueChanged;
+    std::deque<Task> m_queue;
+    unsigned m_running = 0;
+    bool m_stopping = false;
+    std::vector<std::thread> m_workers;
+};
+
+}  // namespace eth
+}  // namespace dev
@@ -329,6 +329,16 @@ WarpCapability::WarpCapability(std::shared_ptr<p2p::CapabilityHostFace> _host,
     m_peerObserver(
         _snapshotDownloadPath.empty() ? nullptr : createPeerObserver(_snapshotDownloadPath))
 {
+    if (m_snapshot)
+    {
+        // manifest is read once, it's sent in every status and on every manifest request
+        m_snapshotManifest = m_snapshot->readManifest();
+        RLP manifest(m_snapshotManifest);
+        if (manifest.itemCount() != 6)
+            BOOST_THROW_EXCEPTION(InvalidSnapshotManifest());
+        m_snapshotBlockNumber = manifest[4].toInt<u256>(RLP::VeryStrict);
+        m_snapshotBlockHash = manifest[5].toHash<h256>(RLP::VeryStrict);
+    }
 }
 
 std::chrono::milliseconds WarpCapability::backgroundWorkInterval() const
@@ -346,21 +356,9 @@ void WarpCapability::onConnect(NodeID const& _peerID, u256 const& /* _peerCapabi
 {
     m_peers.emplace(_peerID, WarpPeerStatus{});
 
-    u256 snapshotBlockNumber;
-    h256 snapshotBlockHash;
-    if (m_snapshot)
-    {
-        bytes const snapshotManifest(m_snapshot->readManifest());
-        RLP manifest(snapshotManifest);
-        if (manifest.itemCount() != 6)
-            BOOST_THROW_EXCEPTION(InvalidSnapshotManifest());
-        snapshotBlockNumber = manifest[4].toInt<u256>(RLP::VeryStrict);
-        snapshotBlockHash = manifest[5].toHash<h256>(RLP::VeryStrict);
-    }
-
     requestStatus(_peerID, c_WarpProtocolVersion, m_networkId,
         m_blockChain.details().totalDifficulty, m_blockChain.currentHash(),
-        m_blockChain.genesisHash(), snapshotBlockHash, snapshotBlockNumber);
+        m_blockChain.genesisHash(), m_snapshotBlockHash, m_snapshotBlockNumber);
 }
 
 bool WarpCapability::interpretCapabilityPacket(NodeID const& _peerID, unsigned _id, RLP const& _r)
@@ -397,7 +395,8 @@ bool WarpCapability::interpretCapabilityPacket(NodeID const& _peerID, unsigned _
                           << peerStatus.m_snapshotHash << " snapshot number "
                           << peerStatus.m_snapshotNumber;
             setIdle(_peerID);
-            m_peerObserver->onPeerStatus(_peerID);
+            if (m_peerObserver)
+                m_peerObserver->onPeerStatus(_peerID);
             break;
         }
         case GetSnapshotManifestPacket:
@@ -407,7 +406,7 @@ bool WarpCapability::interpretCapabilityPacket(NodeID const& _peerID, unsigned _
 
             RLPStream s;
             m_host->prep(_peerID, name(), s, SnapshotManifestPacket, 1)
-                .appendRaw(m_snapshot->readManifest());
+                .appendRaw(m_snapshotManifest);
             m_host->sealAndSend(_peerID, s);
             break;
         }
@@ -417,6 +416,7 @@ bool WarpCapability::interpretCapabilityPacket(NodeID const& _peerID, unsigned _
                 return false;
 
             const h256 chunkHash = _r[0].toHash<h256>(RLP::VeryStrict);
+            LOG(m_logger) << "Serving snapshot chunk " << chunkHash << " to " << _peerID;
 
             RLPStream s;
             m_host->prep(_peerID, name(), s, SnapshotDataPacket, 1)
@@ -435,19 +435,22 @@ bool WarpCapability::interpretCapabilityPacket(NodeID const& _peerID, unsigned _
         case BlockHeadersPacket:
         {
             setIdle(_peerID);
-            m_peerObserver->onPeerBlockHeaders(_peerID, _r);
+            if (m_peerObserver)
+                m_peerObserver->onPeerBlockHeaders(_peerID, _r);
             break;
         }
         case SnapshotManifestPacket:
         {
             setIdle(_peerID);
-            m_peerObserver->onPeerManifest(_peerID, _r);
+            if (m_peerObserver)
+                m_peerObserver->onPeerManifest(_peerID, _r);
             break;
         }
         case SnapshotDataPacket:
         {
             setIdle(_peerID);
-            m_peerObserver->onPeerData(_peerID, _r);
+            if (m_peerObserver)
+                m_peerObserver->onPeerData(_peerID, _r);
             break;
         }
         default:
@@ -470,7 +473,8 @@ bool WarpCapability::interpretCapabilityPacket(NodeID const& _peerID, unsigned _
 
 void WarpCapability::onDisconnect(NodeID const& _peerID)
 {
-    m_peerObserver->onPeerDisconnect(_peerID, m_peers[_peerID].m_asking);
+    if (m_peerObserver)
+        m_peerObserver->onPeerDisconnect(_peerID, m_peers[_peerID].m_asking);
     m_peers.erase(_peerID);
 }
 
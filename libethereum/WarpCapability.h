@@ -124,7 +124,11 @@ private:
     BlockChain const& m_blockChain;
     u256 const m_networkId;
 
+    /// Snapshot we give out to peers, null if we don't have one
     std::shared_ptr<SnapshotStorageFace> m_snapshot;
+    bytes m_snapshotManifest;
+    u256 m_snapshotBlockNumber;
+    h256 m_snapshotBlockHash;
     std::shared_ptr<WarpPeerObserverFace> m_peerObserver;
 
     std::unordered_map<NodeID, WarpPeerStatus> m_peers;
@@ -209,6 +209,15 @@ evmc::result EvmCHost::call(evmc_message const& _msg) noexcept
     params.data = {_msg.input_data, _msg.input_size};
     params.staticCall = (_msg.flags & EVMC_STATIC) != 0;
     params.onOp = {};
+    // EVMC messages don't carry the calling instruction. In a static context CALL and STATICCALL
+    // both make a static call without value, the more common STATICCALL is reported. Executions
+    // observed by a CallTracer run on the LegacyVM, which passes the actual instruction.
+    if (_msg.kind == EVMC_DELEGATECALL)
+        params.op = Instruction::DELEGATECALL;
+    else if (_msg.kind == EVMC_CALLCODE)
+        params.op = Instruction::CALLCODE;
+    else if (params.staticCall)
+        params.op = Instruction::STATICCALL;
 
     CallResult result = m_extVM.call(params);
     evmc_result evmcResult = {};
@@ -123,6 +123,8 @@ struct CallParameters
     bytesConstRef data;
     bool staticCall = false;
     OnOpFunc onOp;
+    /// The instruction making the call, for tracers.
+    Instruction op = Instruction::CALL;
 };
 
 class EnvInfo
@@ -190,6 +190,7 @@ bool LegacyVM::caseCallSetup(CallParameters *callParams, bytesRef& o_output)
     assert(callParams->valueTransfer == 0);
     assert(callParams->apparentValue == 0);
 
+    callParams->op = m_OP;
     callParams->staticCall = (m_OP == Instruction::STATICCALL || m_ext->staticCall);
     auto const destinationAddr = asAddress(m_SP[1]);
     if (callParams->staticCall && isPrecompiledContract(destinationAddr))
@@ -45,6 +45,26 @@ public:
             session->addRating(_r);
     }
 
+    void noteResponseLatency(
+        NodeID const& _nodeID, std::chrono::steady_clock::duration _latency) override
+    {
+        auto session = m_host.peerSession(_nodeID);
+        if (session)
+            session->metrics().noteResponseLatency(_latency);
+    }
+
+    void noteReceivedItems(NodeID const& _nodeID, unsigned _useful, unsigned _duplicate) override
+    {
+        auto session = m_host.peerSession(_nodeID);
+        if (!session)
+            return;
+
+        if (_useful)
+            session->metrics().noteUsefulItems(_useful);
+        if (_duplicate)
+            session->metrics().noteDuplicateItems(_duplicate);
+    }
+
     RLPStream& prep(NodeID const& _nodeID, std::string const& _capabilityName, RLPStream& _s,
         unsigned _id, unsigned _args = 0) override
     {
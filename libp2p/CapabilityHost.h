@@ -61,6 +61,18 @@ public:
     /// Has no effect if the peer is not connected.
     virtual void updateRating(NodeID const& _nodeID, int _r) = 0;
 
+    /// Record the time it took the connected peer to answer our request.
+    /// This affects the peer's score and the order of peer iteration in forEachPeer.
+    /// Has no effect if the peer is not connected.
+    virtual void noteResponseLatency(
+        NodeID const& _nodeID, std::chrono::steady_clock::duration _latency) = 0;
+
+    /// Record that the connected peer sent us @a _useful items we didn't have and
+    /// @a _duplicate items we already had.
+    /// This affects the peer's score and the order of peer iteration in forEachPeer.
+    /// Has no effect if the peer is not connected.
+    virtual void noteReceivedItems(NodeID const& _nodeID, unsigned _useful, unsigned _duplicate) = 0;
+
     /// Mark the connected peer as having poor behaviour.
     /// This affects only isRude() result.
     /// Has no effect if the peer is not connected.
@@ -24,6 +24,7 @@
 #include <libdevcore/Exceptions.h>
 #include <libdevcore/RLP.h>
 #include <libdevcore/Guards.h>
+#include "PeerMetrics.h"
 namespace ba = boost::asio;
 namespace bi = boost::asio::ip;
 
@@ -72,11 +73,12 @@ struct ECDHEError: virtual Exception {};
         (boost::log::keywords::severity = SEVERITY)(boost::log::keywords::channel = "net"))
 
 NET_GLOBAL_LOGGER(netnote, VerbosityInfo)
-#define cnetnote LOG(dev::p2p::g_netnoteLogger::get())
+#define cnetnote DEV_GLOBAL_LOG(dev::VerbosityInfo, "net", dev::p2p::g_netnoteLogger::get())
 NET_GLOBAL_LOGGER(netlog, VerbosityDebug)
-#define cnetlog LOG(dev::p2p::g_netlogLogger::get())
+#define cnetlog DEV_GLOBAL_LOG(dev::VerbosityDebug, "net", dev::p2p::g_netlogLogger::get())
 NET_GLOBAL_LOGGER(netdetails, VerbosityTrace)
-#define cnetdetails LOG(dev::p2p::g_netdetailsLogger::get())
+#define cnetdetails \
+    DEV_GLOBAL_LOG(dev::VerbosityTrace, "net", dev::p2p::g_netdetailsLogger::get())
 
 enum P2pPacketType
 {
@@ -140,6 +142,7 @@ struct PeerSessionInfo
     std::chrono::steady_clock::duration lastPing;
     std::set<CapDesc> const caps;
     std::map<std::string, std::string> notes;
+    PeerMetricsSnapshot metrics;
 };
 
 using PeerSessionInfos = std::vector<PeerSessionInfo>;
@@ -315,4 +318,14 @@ template <> struct hash<bi::address>
         return std::hash<std::string>()(_a.to_string());
     }
 };
+
+template <> struct hash<bi::udp::endpoint>
+{
+    size_t operator()(bi::udp::endpoint const& _e) const
+    {
+        size_t seed = std::hash<bi::address>()(_e.address());
+        boost::hash_combine(seed, _e.port());
+        return seed;
+    }
+};
 }  // namespace std
@@ -14,6 +14,7 @@
 #include <libdevcore/CommonIO.h>
 #include <libdevcore/Exceptions.h>
 #include <libdevcore/FileSystem.h>
+#include <libdevcore/Metrics.h>
 #include <boost/algorithm/string.hpp>
 #include <chrono>
 #include <memory>
@@ -103,6 +104,9 @@ Host::Host(
 {
     LOG(m_infoLogger) << "Id: " << id();
     LOG(m_infoLogger) << "ENR: " << m_restoredENR;
+
+    MetricGauge& peers = MetricsRegistry::instance().gauge("aleth_p2p_peers", "Connected peers.");
+    MetricsRegistry::instance().addCollector(this, [this, &peers]() { peers.set(peerCount()); });
 }
 
 Host::Host(string const& _clientVersion, NetworkConfig const& _n, bytesConstRef _restoreNetwork)
@@ -113,6 +117,7 @@ Host::Host(string const& _clientVersion, NetworkConfig const& _n, bytesConstRef
 
 Host::~Host()
 {
+    MetricsRegistry::instance().removeCollector(this);
     stop();
     terminate();
 }
@@ -328,7 +333,7 @@ void Host::startPeerSession(Public const& _id, RLP const& _hello,
     shared_ptr<SessionFace> session = make_shared<Session>(this, move(_io), _s, peer,
         PeerSessionInfo({_id, clientVersion, peer->endpoint.address().to_string(), listenPort,
             chrono::steady_clock::duration(), _hello[2].toSet<CapDesc>(),
-            map<string, string>()}));
+            map<string, string>(), PeerMetricsSnapshot{}}));
     if (protocolVersion < dev::p2p::c_protocolVersion - 1)
     {
         session->disconnect(IncompatibleProtocol);
@@ -772,7 +777,10 @@ PeerSessionInfos Host::peerSessionInfos() const
     for (auto& i: m_sessions)
         if (auto j = i.second.lock())
             if (j->isConnected())
+            {
                 ret.push_back(j->info());
+                ret.back().metrics = j->metrics().snapshot();
+            }
     return ret;
 }
 
@@ -803,10 +811,9 @@ void Host::run(boost::system::error_code const& _ec)
     keepAlivePeers();
     logActivePeers();
 
-    // At this time peers will be disconnected based on natural TCP timeout.
-    // disconnectLatePeers needs to be updated for the assumption that Session
-    // is always live and to ensure reputation and fallback timers are properly
-    // updated. // disconnectLatePeers();
+    // Late peers are disconnected only while we have more than the ideal number of peers,
+    // otherwise they are left to the natural TCP timeout.
+    disconnectLatePeers();
 
     // todo: update peerSlotsAvailable()
 
@@ -930,6 +937,9 @@ void Host::keepAlivePeers()
         return;
 
     RecursiveGuard l(x_sessions);
+    shared_ptr<SessionFace> leastUseful;
+    PeerMetricsSnapshot leastUsefulMetrics;
+    size_t connectedCount = 0;
     {
         for (auto it = m_sessions.begin(); it != m_sessions.end();)
         {
@@ -938,12 +948,32 @@ void Host::keepAlivePeers()
             {
                 p->ping();
                 ++it;
+
+                ++connectedCount;
+                if (p->peer()->peerType == PeerType::Required)
+                    continue;
+                auto metrics = p->metrics().snapshot();
+                if (!leastUseful || metrics.score < leastUsefulMetrics.score)
+                {
+                    leastUseful = move(p);
+                    leastUsefulMetrics = move(metrics);
+                }
             }
             else
                 it = m_sessions.erase(it);
         }
     }
 
+    // Free a slot for a better peer when we have more than enough of them and the one with the
+    // lowest score mostly sends us the data we already have.
+    if (connectedCount > m_idealPeerCount && leastUseful &&
+        leastUsefulMetrics.duplicateItems > leastUsefulMetrics.usefulItems)
+    {
+        LOG(m_logger) << "Disconnecting least useful peer " << leastUseful->id() << " (score "
+                      << leastUsefulMetrics.score << ")";
+        leastUseful->disconnect(UselessPeer);
+    }
+
     m_lastPing = chrono::steady_clock::now();
 }
 
@@ -967,12 +997,31 @@ void Host::disconnectLatePeers()
         return;
 
     RecursiveGuard l(x_sessions);
+    vector<pair<double, shared_ptr<SessionFace>>> latePeers;
+    size_t connectedCount = 0;
     for (auto p : m_sessions)
     {
         auto pp = p.second.lock();
         if (pp && pp->isConnected())
-            if (now - c_keepAliveTimeOut > m_lastPing && pp->lastReceived() < m_lastPing)
-                pp->disconnect(PingTimeout);
+        {
+            ++connectedCount;
+            if (pp->lastReceived() < m_lastPing)
+                latePeers.emplace_back(pp->metrics().score(), move(pp));
+        }
+    }
+
+    // disconnect only the peers over the ideal count, starting from the lowest score
+    sort(latePeers.begin(), latePeers.end(),
+        [](pair<double, shared_ptr<SessionFace>> const& _left,
+            pair<double, shared_ptr<SessionFace>> const& _right) {
+            return _left.first < _right.first;
+        });
+    for (auto const& p : latePeers)
+    {
+        if (connectedCount <= m_idealPeerCount)
+            break;
+        p.second->disconnect(PingTimeout);
+        --connectedCount;
     }
 }
 
@@ -1173,7 +1222,8 @@ void Host::forEachPeer(
     string const& _capabilityName, function<bool(NodeID const&)> _f) const
 {
     RecursiveGuard l(x_sessions);
-    vector<shared_ptr<SessionFace>> sessions;
+    // score is taken once per peer, as it can change while sorting
+    vector<pair<double, shared_ptr<SessionFace>>> sessions;
     for (auto const& i : m_sessions)
     {
         auto const s = i.second.lock();
@@ -1182,21 +1232,23 @@ void Host::forEachPeer(
             vector<CapDesc> capabilities = s->capabilities();
             for (auto const& cap : capabilities)
                 if (cap.first == _capabilityName)
-                    sessions.emplace_back(move(s));
+                    sessions.emplace_back(s->metrics().score(), move(s));
         }
     }
 
-    // order peers by rating, connection age
-    auto sessionLess = [](shared_ptr<SessionFace> const& _left,
-                           shared_ptr<SessionFace> const& _right) {
-        return _left->rating() == _right->rating() ?
-                   _left->connectionTime() < _right->connectionTime() :
-                   _left->rating() > _right->rating();
+    // order peers by score, rating, connection age
+    auto sessionLess = [](pair<double, shared_ptr<SessionFace>> const& _left,
+                           pair<double, shared_ptr<SessionFace>> const& _right) {
+        if (_left.first != _right.first)
+            return _left.first > _right.first;
+        return _left.second->rating() == _right.second->rating() ?
+                   _left.second->connectionTime() < _right.second->connectionTime() :
+                   _left.second->rating() > _right.second->rating();
     };
     sort(sessions.begin(), sessions.end(), sessionLess);
 
     for (auto const& s : sessions)
-        if (!_f(s->id()))
+        if (!_f(s.second->id()))
             return;
 }
 
@@ -301,13 +301,15 @@ private:
     /// Returns true if pending and connected peer count is less than maximum
     bool peerSlotsAvailable(PeerSlotType _type = Ingress);
     
-    /// Ping the peers to update the latency information and disconnect peers which have timed out.
+    /// Ping the peers to update the latency information. If there are more peers than the ideal
+    /// count, disconnect the one with the lowest score if it sends mostly the data we already have.
     void keepAlivePeers();
 
     /// Log count of active peers and information about each peer
     void logActivePeers();
 
-    /// Disconnect peers which didn't respond to keepAlivePeers ping prior to c_keepAliveTimeOut.
+    /// Disconnect peers which didn't respond to keepAlivePeers ping prior to c_keepAliveTimeOut,
+    /// as long as there are more peers than the ideal count. Peers with lower score go first.
     void disconnectLatePeers();
 
     /// Called only from startedWorking().
@@ -37,6 +37,44 @@ inline bool operator==(weak_ptr<NodeEntry> const& _weak, shared_ptr<NodeEntry> c
     return !_weak.owner_before(_shared) && !_shared.owner_before(_weak);
 }
 
+size_t NodeTable::NodeBucket::find(shared_ptr<NodeEntry> const& _entry) const
+{
+    for (size_t i = 0; i < m_size; ++i)
+        if (m_nodeIDHashes[i] == _entry->nodeIDHash && m_nodes[i] == _entry)
+            return i;
+    return m_size;
+}
+
+void NodeTable::NodeBucket::pushBack(shared_ptr<NodeEntry> const& _entry)
+{
+    assert(!full());
+    m_nodeIDHashes[m_size] = _entry->nodeIDHash;
+    m_nodes[m_size] = _entry;
+    ++m_size;
+}
+
+void NodeTable::NodeBucket::moveToBack(size_t _i)
+{
+    assert(_i < m_size);
+    rotate(m_nodeIDHashes.begin() + _i, m_nodeIDHashes.begin() + _i + 1,
+        m_nodeIDHashes.begin() + m_size);
+    rotate(m_nodes.begin() + _i, m_nodes.begin() + _i + 1, m_nodes.begin() + m_size);
+}
+
+void NodeTable::NodeBucket::erase(size_t _i)
+{
+    moveToBack(_i);
+    --m_size;
+    m_nodes[m_size].reset();
+}
+
+void NodeTable::NodeBucket::clear()
+{
+    for (size_t i = 0; i < m_size; ++i)
+        m_nodes[i].reset();
+    m_size = 0;
+}
+
 NodeTable::NodeTable(ba::io_context& _io, KeyPair const& _alias, NodeIPEndpoint const& _endpoint,
     ENR const& _enr, bool _enabled, bool _allowLocalDiscovery)
   : m_hostNodeID{_alias.pub()},
@@ -180,8 +218,8 @@ list<NodeEntry> NodeTable::snapshot() const
     DEV_GUARDED(x_state)
     {
         for (auto const& s : m_buckets)
-            for (auto const& np : s.nodes)
-                if (auto n = np.lock())
+            for (size_t i = 0; i < s.size(); ++i)
+                if (auto n = s.node(i).lock())
                     ret.push_back(*n);
     }
     return ret;
@@ -233,7 +271,7 @@ void NodeTable::doDiscoveryRound(
             FindNode p(nodeEntry->endpoint(), _node);
             p.expiration = nextRequestExpirationTime();
             p.sign(m_secret);
-            m_sentFindNodes.emplace_back(nodeEntry->id(), chrono::steady_clock::now());
+            m_sentFindNodes[nodeEntry->id()] = chrono::steady_clock::now();
             LOG(m_logger) << p.typeName() << " to " << nodeEntry->node << " (target: " << _node
                           << ")";
             m_socket->send(p);
@@ -276,29 +314,46 @@ void NodeTable::doDiscoveryRound(
 
 vector<shared_ptr<NodeEntry>> NodeTable::nearestNodeEntries(NodeID const& _target)
 {
-    auto const distanceToTargetLess = [](pair<int, shared_ptr<NodeEntry>> const& _node1,
-                                          pair<int, shared_ptr<NodeEntry>> const& _node2) {
-        return _node1.first < _node2.first;
+    h256 const targetHash = sha3(_target);
+    // Nodes of the bucket at the target's distance from us are closer to the target than any
+    // other nodes. Nodes of the buckets closer to us are all at the target's distance from it,
+    // and nodes of the buckets further from us are at their bucket's distance from it.
+    int const targetDistance = distance(m_hostNodeIDHash, targetHash);
+
+    vector<shared_ptr<NodeEntry>> ret;
+    ret.reserve(s_bucketSize);
+    auto const appendBucket = [&ret](NodeBucket const& _bucket) {
+        for (size_t i = 0; i < _bucket.size() && ret.size() < s_bucketSize; ++i)
+            if (auto node = _bucket.node(i).lock())
+                ret.emplace_back(move(node));
     };
 
-    h256 const targetHash = sha3(_target);
+    Guard l(x_state);
+    if (targetDistance > 0)
+    {
+        NodeBucket const& targetBucket = m_buckets[targetDistance - 1];
+        vector<pair<int, size_t>> distanceAndIndex;
+        distanceAndIndex.reserve(targetBucket.size());
+        for (size_t i = 0; i < targetBucket.size(); ++i)
+            distanceAndIndex.emplace_back(distance(targetHash, targetBucket.nodeIDHash(i)), i);
+        stable_sort(distanceAndIndex.begin(), distanceAndIndex.end(),
+            [](pair<int, size_t> const& _a, pair<int, size_t> const& _b) {
+                return _a.first < _b.first;
+            });
 
-    std::multiset<pair<int, shared_ptr<NodeEntry>>, decltype(distanceToTargetLess)>
-        nodesByDistanceToTarget(distanceToTargetLess);
-    for (auto const& bucket : m_buckets)
-        for (auto const& nodeWeakPtr : bucket.nodes)
-            if (auto node = nodeWeakPtr.lock())
-            {
-                nodesByDistanceToTarget.emplace(distance(targetHash, node->nodeIDHash), node);
+        for (auto const& d : distanceAndIndex)
+            if (auto node = targetBucket.node(d.second).lock())
+                ret.emplace_back(move(node));
 
-                if (nodesByDistanceToTarget.size() > s_bucketSize)
-                    nodesByDistanceToTarget.erase(--nodesByDistanceToTarget.end());
-            }
+        for (int i = 0; i < targetDistance - 1 && ret.size() < s_bucketSize; ++i)
+            appendBucket(m_buckets[i]);
+    }
 
-    vector<shared_ptr<NodeEntry>> ret;
-    for (auto& distanceAndNode : nodesByDistanceToTarget)
-        ret.emplace_back(move(distanceAndNode.second));
+    for (unsigned i = targetDistance; i < s_bins && ret.size() < s_bucketSize; ++i)
+        appendBucket(m_buckets[i]);
 
+    if (ret.size() > s_bucketSize)
+        ret.resize(s_bucketSize);
     return ret;
 }
 
@@ -321,9 +376,11 @@ void NodeTable::ping(Node const& _node, shared_ptr<NodeEntry> _replacementNodeEn
     LOG(m_logger) << p.typeName() << " to " << _node;
     m_socket->send(p);
 
-    NodeValidation const validation{_node.id, _node.endpoint.tcpPort(), chrono::steady_clock::now(),
-        pingHash, _replacementNodeEntry};
+    auto const now = chrono::steady_clock::now();
+    NodeValidation const validation{
+        _node.id, _node.endpoint.tcpPort(), now, pingHash, _replacementNodeEntry};
     m_sentPings.insert({_node.endpoint, validation});
+    m_pingTimeouts.emplace_back(_node.endpoint, now);
 }
 
 void NodeTable::schedulePing(Node const& _node)
@@ -369,22 +426,21 @@ void NodeTable::noteActiveNode(shared_ptr<NodeEntry> _nodeEntry)
         Guard l(x_state);
         // Find a bucket to put a node to
         NodeBucket& s = bucket_UNSAFE(_nodeEntry.get());
-        auto& nodes = s.nodes;
 
         // check if the node is already in the bucket
-        auto it = find(nodes.begin(), nodes.end(), _nodeEntry);
-        if (it != nodes.end())
+        auto const index = s.find(_nodeEntry);
+        if (index != s.size())
         {
             // if it was in the bucket, move it to the last position
-            nodes.splice(nodes.end(), nodes, it);
+            s.moveToBack(index);
         }
         else
         {
-            if (nodes.size() < s_bucketSize)
+            if (!s.full())
             {
                 // if it was not there, just add it as a most recently seen node
                 // (i.e. to the end of the list)
-                nodes.push_back(_nodeEntry);
+                s.pushBack(_nodeEntry);
                 DEV_GUARDED(x_nodes) { m_allNodes.insert({_nodeEntry->id(), _nodeEntry}); }
                 if (m_nodeEventHandler)
                     m_nodeEventHandler->appendEvent(_nodeEntry->id(), NodeEntryAdded);
@@ -392,13 +448,13 @@ void NodeTable::noteActiveNode(shared_ptr<NodeEntry> _nodeEntry)
             else
             {
                 // if bucket is full, start eviction process for the least recently seen node
-                nodeToEvict = nodes.front().lock();
+                nodeToEvict = s.front().lock();
                 // It could have been replaced in addNode(), then weak_ptr is expired.
                 // If so, just add a new one instead of expired
                 if (!nodeToEvict)
                 {
-                    nodes.pop_front();
-                    nodes.push_back(_nodeEntry);
+                    s.erase(0);
+                    s.pushBack(_nodeEntry);
                     DEV_GUARDED(x_nodes) { m_allNodes.insert({_nodeEntry->id(), _nodeEntry}); }
                     if (m_nodeEventHandler)
                         m_nodeEventHandler->appendEvent(_nodeEntry->id(), NodeEntryAdded);
@@ -417,8 +473,9 @@ void NodeTable::dropNode(shared_ptr<NodeEntry> _n)
     {
         Guard l(x_state);
         NodeBucket& s = bucket_UNSAFE(_n.get());
-        s.nodes.remove_if(
-            [_n](weak_ptr<NodeEntry> const& _bucketEntry) { return _bucketEntry == _n; });
+        auto const index = s.find(_n);
+        if (index != s.size())
+            s.erase(index);
     }
 
     DEV_GUARDED(x_nodes) { m_allNodes.erase(_n->id()); }
@@ -591,14 +648,12 @@ shared_ptr<NodeEntry> NodeTable::handleNeighbours(
     auto const& in = dynamic_cast<Neighbours const&>(_packet);
 
     bool expected = false;
-    auto now = chrono::steady_clock::now();
-    m_sentFindNodes.remove_if([&](NodeIdTimePoint const& _t) noexcept {
-        if (_t.first != in.sourceid)
-            return false;
-        if (now - _t.second < c_reqTimeoutMs)
-            expected = true;
-        return true;
-    });
+    auto const sentFindNode = m_sentFindNodes.find(in.sourceid);
+    if (sentFindNode != m_sentFindNodes.end())
+    {
+        expected = chrono::steady_clock::now() - sentFindNode->second < c_reqTimeoutMs;
+        m_sentFindNodes.erase(sentFindNode);
+    }
     if (!expected)
     {
         LOG(m_logger) << "Dropping unsolicited neighbours packet from " << _packet.sourceid << "@"
@@ -779,22 +834,35 @@ void NodeTable::doDiscovery()
 void NodeTable::doHandleTimeouts()
 {
     runBackgroundTask(c_handleTimeoutsIntervalMs, m_timeoutsTimer, [this]() {
+        auto const now = chrono::steady_clock::now();
         vector<shared_ptr<NodeEntry>> nodesToActivate;
-        for (auto it = m_sentPings.begin(); it != m_sentPings.end();)
+        while (!m_pingTimeouts.empty() && now > m_pingTimeouts.front().second + m_requestTimeToLive)
         {
-            if (chrono::steady_clock::now() > it->second.pingSentTime + m_requestTimeToLive)
-            {
-                if (auto node = nodeEntry(it->second.nodeID))
-                {
-                    dropNode(move(node));
+            auto const endpointAndTime = m_pingTimeouts.front();
+            m_pingTimeouts.pop_front();
 
-                    // save the replacement node that should be activated
-                    if (it->second.replacementNodeEntry)
-                        nodesToActivate.emplace_back(move(it->second.replacementNodeEntry));
-                }
+            // skip the pings which were answered, and the ones which were answered and sent again
+            auto it = m_sentPings.find(endpointAndTime.first);
+            if (it == m_sentPings.end() || it->second.pingSentTime != endpointAndTime.second)
+                continue;
+
+            if (auto node = nodeEntry(it->second.nodeID))
+            {
+                dropNode(move(node));
 
-                it = m_sentPings.erase(it);
+                // save the replacement node that should be activated
+                if (it->second.replacementNodeEntry)
+                    nodesToActivate.emplace_back(move(it->second.replacementNodeEntry));
             }
+
+            m_sentPings.erase(it);
+        }
+
+        // forget FindNode requests which weren't answered in time
+        for (auto it = m_sentFindNodes.begin(); it != m_sentFindNodes.end();)
+        {
+            if (now - it->second >= c_reqTimeoutMs)
+                it = m_sentFindNodes.erase(it);
             else
                 ++it;
         }
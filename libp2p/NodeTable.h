@@ -10,6 +10,7 @@
 #include <libp2p/UDP.h>
 #include <boost/integer/static_log2.hpp>
 #include <algorithm>
+#include <deque>
 
 namespace dev
 {
@@ -101,7 +102,6 @@ class NodeTable : UDPSocketEvents
     friend std::ostream& operator<<(std::ostream& _out, NodeTable const& _nodeTable);
     using NodeSocket = UDPSocket<NodeTable, 1280>;
     using TimePoint = std::chrono::steady_clock::time_point;	///< Steady time point.
-    using NodeIdTimePoint = std::pair<NodeID, TimePoint>;
 
 public:
     // Period during which we consider last PONG results to be valid before sending new PONG
@@ -238,10 +238,38 @@ protected:
     /// Refresh interval prevents bucket from becoming stale. [Kademlia]
     static constexpr std::chrono::milliseconds c_bucketRefreshMs{7200};
 
-    struct NodeBucket
+    /// Fixed-size bucket with nodes stored contiguously, ordered from the least recently seen to
+    /// the most recently seen. Hashes of node IDs are kept in a separate array, so that the
+    /// bucket can be searched and nodes can be sorted by distance without locking the entries.
+    class NodeBucket
     {
-        unsigned distance;
-        std::list<std::weak_ptr<NodeEntry>> nodes;
+    public:
+        unsigned distance = 0;
+
+        size_t size() const { return m_size; }
+        bool full() const { return m_size == s_bucketSize; }
+
+        std::weak_ptr<NodeEntry> const& node(size_t _i) const { return m_nodes[_i]; }
+        h256 const& nodeIDHash(size_t _i) const { return m_nodeIDHashes[_i]; }
+        std::weak_ptr<NodeEntry> const& front() const { return m_nodes.front(); }
+        std::weak_ptr<NodeEntry> const& back() const { return m_nodes[m_size - 1]; }
+
+        /// @returns the position of the entry in the bucket or size() if it's not there.
+        size_t find(std::shared_ptr<NodeEntry> const& _entry) const;
+
+        /// Appends the entry as the most recently seen. Bucket must not be full.
+        void pushBack(std::shared_ptr<NodeEntry> const& _entry);
+
+        /// Moves the entry at position @a _i to the most recently seen position.
+        void moveToBack(size_t _i);
+
+        void erase(size_t _i);
+        void clear();
+
+    private:
+        std::array<h256, s_bucketSize> m_nodeIDHashes;
+        std::array<std::weak_ptr<NodeEntry>, s_bucketSize> m_nodes;
+        size_t m_size = 0;
     };
 
     /// @return true if the node is valid to be added to the node table.
@@ -354,12 +382,17 @@ protected:
     /// State of p2p node network. Only includes nodes for which we've completed the endpoint proof
     std::array<NodeBucket, s_bins> m_buckets;
 
-    std::list<NodeIdTimePoint> m_sentFindNodes;					///< Timeouts for FindNode requests.
+    std::unordered_map<NodeID, TimePoint> m_sentFindNodes;			///< Time of the last FindNode request sent to the node.
 
     std::shared_ptr<NodeSocket> m_socket;							///< Shared pointer for our UDPSocket; ASIO requires shared_ptr.
 
     // The info about PING packets we've sent to other nodes and haven't received PONG yet
-    std::map<bi::udp::endpoint, NodeValidation> m_sentPings;
+    std::unordered_map<bi::udp::endpoint, NodeValidation> m_sentPings;
+
+    // Sent PINGs in the order of sending. As all of them have the same time to live, they also
+    // expire in this order, so doHandleTimeouts() only needs to look at the front of the queue.
+    // Entries for which PONG has been received are skipped when they reach the front.
+    std::deque<std::pair<bi::udp::endpoint, TimePoint>> m_pingTimeouts;
 
     // Expiration time of sent discovery packets.
     std::chrono::seconds m_requestTimeToLive;
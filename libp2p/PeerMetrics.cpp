@@ -0,0 +1,90 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "PeerMetrics.h"
+
+#include <algorithm>
+
+namespace dev
+{
+namespace p2p
+{
+namespace
+{
+/// Weight of the latest response in the average latency.
+double const c_latencyAverageWeight = 0.2;
+}  // namespace
+
+void PeerMetrics::noteReceived(std::string const& _capability, unsigned _packetType, size_t _bytes)
+{
+    Guard l(x_metrics);
+    auto& traffic = m_metrics.traffic[{_capability, _packetType}];
+    ++traffic.packetsIn;
+    traffic.bytesIn += _bytes;
+    m_metrics.bytesIn += _bytes;
+}
+
+void PeerMetrics::noteSent(std::string const& _capability, unsigned _packetType, size_t _bytes)
+{
+    Guard l(x_metrics);
+    auto& traffic = m_metrics.traffic[{_capability, _packetType}];
+    ++traffic.packetsOut;
+    traffic.bytesOut += _bytes;
+    m_metrics.bytesOut += _bytes;
+}
+
+void PeerMetrics::noteResponseLatency(std::chrono::steady_clock::duration _latency)
+{
+    auto const latencyMs = std::chrono::duration_cast<std::chrono::milliseconds>(_latency);
+    auto const bucket = std::lower_bound(c_peerLatencyBucketsMs.begin(),
+                            c_peerLatencyBucketsMs.end(), latencyMs.count()) -
+                        c_peerLatencyBucketsMs.begin();
+
+    Guard l(x_metrics);
+    ++m_metrics.latencyHistogram[bucket];
+    if (m_responseCount++ == 0)
+        m_metrics.averageLatency = latencyMs;
+    else
+        m_metrics.averageLatency = std::chrono::milliseconds(static_cast<int64_t>(
+            c_latencyAverageWeight * latencyMs.count() +
+            (1 - c_latencyAverageWeight) * m_metrics.averageLatency.count()));
+}
+
+void PeerMetrics::noteUsefulItems(unsigned _count)
+{
+    Guard l(x_metrics);
+    m_metrics.usefulItems += _count;
+}
+
+void PeerMetrics::noteDuplicateItems(unsigned _count)
+{
+    Guard l(x_metrics);
+    m_metrics.duplicateItems += _count;
+}
+
+double PeerMetrics::score() const
+{
+    Guard l(x_metrics);
+    return scoreUnsafe();
+}
+
+PeerMetricsSnapshot PeerMetrics::snapshot() const
+{
+    Guard l(x_metrics);
+    PeerMetricsSnapshot ret = m_metrics;
+    ret.score = scoreUnsafe();
+    return ret;
+}
+
+double PeerMetrics::scoreUnsafe() const
+{
+    // share of useful items smoothed so that a few items don't decide the score
+    double const usefulness = (m_metrics.usefulItems + 1.0) /
+                              (m_metrics.usefulItems + m_metrics.duplicateItems + 2.0);
+    double const latencySeconds = m_metrics.averageLatency.count() / 1000.0;
+    return usefulness / (1 + latencySeconds);
+}
+
+}  // namespace p2p
+}  // namespace dev
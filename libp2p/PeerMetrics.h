@@ -0,0 +1,83 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Per-connection traffic and usefulness statistics used to rank peers.
+#pragma once
+
+#include <libdevcore/Guards.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace dev
+{
+namespace p2p
+{
+/// Number of packets and bytes (as sent over the wire, including framing) of one packet type.
+struct PacketTraffic
+{
+    uint64_t packetsIn = 0;
+    uint64_t bytesIn = 0;
+    uint64_t packetsOut = 0;
+    uint64_t bytesOut = 0;
+};
+
+/// Upper bounds of response latency histogram buckets, the last bucket has no upper bound.
+constexpr std::array<unsigned, 7> c_peerLatencyBucketsMs{{50, 100, 250, 500, 1000, 2500, 5000}};
+
+/// Point-in-time copy of PeerMetrics.
+struct PeerMetricsSnapshot
+{
+    /// Traffic by capability name ("p2p" for the base protocol) and packet type within it.
+    std::map<std::pair<std::string, unsigned>, PacketTraffic> traffic;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+
+    /// Number of responses in each bucket of c_peerLatencyBucketsMs plus the unbounded one.
+    std::array<uint64_t, c_peerLatencyBucketsMs.size() + 1> latencyHistogram{};
+    /// Exponentially weighted moving average of response latency.
+    std::chrono::milliseconds averageLatency{0};
+
+    /// Number of received items (blocks, headers, transactions) that we didn't have yet.
+    uint64_t usefulItems = 0;
+    /// Number of received items that we already had.
+    uint64_t duplicateItems = 0;
+
+    double score = 0;
+};
+
+/// Statistics of a single peer session. Thread-safe.
+class PeerMetrics
+{
+public:
+    void noteReceived(std::string const& _capability, unsigned _packetType, size_t _bytes);
+    void noteSent(std::string const& _capability, unsigned _packetType, size_t _bytes);
+
+    /// Records the time the peer took to answer our request.
+    void noteResponseLatency(std::chrono::steady_clock::duration _latency);
+
+    void noteUsefulItems(unsigned _count);
+    void noteDuplicateItems(unsigned _count);
+
+    /// @returns the score in (0, 1], higher for the peers sending less data we already have and
+    /// answering faster. Peers without history get 0.5.
+    double score() const;
+
+    PeerMetricsSnapshot snapshot() const;
+
+private:
+    double scoreUnsafe() const;
+
+    mutable Mutex x_metrics;
+    PeerMetricsSnapshot m_metrics;
+    uint64_t m_responseCount = 0;
+};
+
+}  // namespace p2p
+}  // namespace dev
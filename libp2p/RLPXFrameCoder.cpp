@@ -34,8 +34,8 @@ namespace p2p
 class RLPXFrameCoderImpl
 {
 public:
-	/// Update state of _mac.
-	void updateMAC(CryptoPP::Keccak_256& _mac, bytesConstRef _seed = {});
+	/// Update state of _mac using _macEnc.
+	static void updateMAC(CryptoPP::Keccak_256& _mac, CryptoPP::ECB_Mode<CryptoPP::AES>::Encryption& _macEnc, bytesConstRef _seed = {});
 
 	CryptoPP::SecByteBlock frameEncKey;						///< Key for m_frameEnc
 	CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption frameEnc;	///< Encoder for egress plaintext.
@@ -43,14 +43,12 @@ public:
 	CryptoPP::SecByteBlock frameDecKey;						///< Key for m_frameDec
 	CryptoPP::CTR_Mode<CryptoPP::AES>::Encryption frameDec;	///< Decoder for egress plaintext.
 
-	CryptoPP::SecByteBlock macEncKey;						/// Key for m_macEnd
-	CryptoPP::ECB_Mode<CryptoPP::AES>::Encryption macEnc;	/// One-way coder used by updateMAC for ingress and egress MAC updates.
+	CryptoPP::SecByteBlock macEncKey;								/// Key for egressMacEnc and ingressMacEnc
+	CryptoPP::ECB_Mode<CryptoPP::AES>::Encryption egressMacEnc;	/// One-way coder used by updateMAC for egress MAC updates.
+	CryptoPP::ECB_Mode<CryptoPP::AES>::Encryption ingressMacEnc;	/// One-way coder used by updateMAC for ingress MAC updates.
 
 	CryptoPP::Keccak_256 egressMac;		///< State of MAC for egress ciphertext.
 	CryptoPP::Keccak_256 ingressMac;	///< State of MAC for ingress ciphertext.
-
-private:
-	Mutex x_macEnc;  ///< Mutex.
 };
 }
 }
@@ -110,7 +108,8 @@ void RLPXFrameCoder::setup(bool _originated, h512 const& _remoteEphemeral, h256
 	sha3(keyMaterial, outRef); // output mac-secret
 	m_impl->macEncKey.resize(h256::size);
 	memcpy(m_impl->macEncKey.data(), outRef.data(), h256::size);
-	m_impl->macEnc.SetKey(m_impl->macEncKey, h256::size);
+	m_impl->egressMacEnc.SetKey(m_impl->macEncKey, h256::size);
+	m_impl->ingressMacEnc.SetKey(m_impl->macEncKey, h256::size);
 
 	// Initiator egress-mac: sha3(mac-secret^recipient-nonce || auth-sent-init)
 	//           ingress-mac: sha3(mac-secret^initiator-nonce || auth-recvd-ack)
@@ -162,34 +161,39 @@ void RLPXFrameCoder::writeFrame(uint16_t _protocolType, uint16_t _seqId, uint32_
 
 void RLPXFrameCoder::writeFrame(RLPStream const& _header, bytesConstRef _payload, bytes& o_bytes)
 {
-	// TODO: SECURITY check header values && header <= 16 bytes
-	bytes headerWithMac(h256::size);
-	bytesConstRef(&_header.out()).copyTo(bytesRef(&headerWithMac));
-	m_impl->frameEnc.ProcessData(headerWithMac.data(), headerWithMac.data(), 16);
-	updateEgressMACWithHeader(bytesConstRef(&headerWithMac).cropped(0, 16));
-	egressDigest().ref().copyTo(bytesRef(&headerWithMac).cropped(h128::size,h128::size));
+	writeFrame(&_header.out(), _payload, o_bytes);
+}
 
+void RLPXFrameCoder::writeFrame(bytesConstRef _header, bytesConstRef _payload, bytes& o_bytes)
+{
+	// TODO: SECURITY check header values && header <= 16 bytes
 	auto padding = (16 - (_payload.size() % 16)) % 16;
-	o_bytes.swap(headerWithMac);
-	o_bytes.resize(32 + _payload.size() + padding + h128::size);
-	bytesRef packetRef(o_bytes.data() + 32, _payload.size());
-	m_impl->frameEnc.ProcessData(packetRef.data(), _payload.data(), _payload.size());
-	bytesRef paddingRef(o_bytes.data() + 32 + _payload.size(), padding);
-	if (padding)
-		m_impl->frameEnc.ProcessData(paddingRef.data(), paddingRef.data(), padding);
-	bytesRef packetWithPaddingRef(o_bytes.data() + 32, _payload.size() + padding);
+
+	// frame is laid out in its final buffer up front; _payload may point into o_bytes, so it's
+	// swapped in only when done
+	bytes frame(h256::size + _payload.size() + padding + h128::size);
+	bytesRef frameRef(&frame);
+	_header.copyTo(frameRef.cropped(0, h128::size));
+	m_impl->frameEnc.ProcessData(frame.data(), frame.data(), h128::size);
+	updateEgressMACWithHeader(frameRef.cropped(0, h128::size));
+	egressDigest().ref().copyTo(frameRef.cropped(h128::size, h128::size));
+
+	// payload and zero padding are encrypted with a single call, so that the cipher can process
+	// many blocks at once instead of handling the tail separately
+	bytesRef packetWithPaddingRef = frameRef.cropped(h256::size, _payload.size() + padding);
+	_payload.copyTo(packetWithPaddingRef);
+	m_impl->frameEnc.ProcessData(packetWithPaddingRef.data(), packetWithPaddingRef.data(), packetWithPaddingRef.size());
 	updateEgressMACWithFrame(packetWithPaddingRef);
-	bytesRef macRef(o_bytes.data() + 32 + _payload.size() + padding, h128::size);
-	egressDigest().ref().copyTo(macRef);
+	egressDigest().ref().copyTo(frameRef.cropped(h256::size + packetWithPaddingRef.size(), h128::size));
+
+	o_bytes.swap(frame);
 }
 
 void RLPXFrameCoder::writeSingleFramePacket(bytesConstRef _packet, bytes& o_bytes)
 {
-	RLPStream header;
 	uint32_t len = (uint32_t)_packet.size();
-	header.appendRaw(bytes({byte((len >> 16) & 0xff), byte((len >> 8) & 0xff), byte(len & 0xff)}));
-	header.appendRaw(bytes({0xc2,0x80,0x80}));
-	writeFrame(header, _packet, o_bytes);
+	byte const header[] = {byte((len >> 16) & 0xff), byte((len >> 8) & 0xff), byte(len & 0xff), 0xc2, 0x80, 0x80};
+	writeFrame(bytesConstRef(header, sizeof(header)), _packet, o_bytes);
 }
 
 bool RLPXFrameCoder::authAndDecryptHeader(bytesRef io)
@@ -233,27 +237,27 @@ h128 RLPXFrameCoder::ingressDigest()
 
 void RLPXFrameCoder::updateEgressMACWithHeader(bytesConstRef _headerCipher)
 {
-	m_impl->updateMAC(m_impl->egressMac, _headerCipher.cropped(0, 16));
+	m_impl->updateMAC(m_impl->egressMac, m_impl->egressMacEnc, _headerCipher.cropped(0, 16));
 }
 
 void RLPXFrameCoder::updateEgressMACWithFrame(bytesConstRef _cipher)
 {
 	m_impl->egressMac.Update(_cipher.data(), _cipher.size());
-	m_impl->updateMAC(m_impl->egressMac);
+	m_impl->updateMAC(m_impl->egressMac, m_impl->egressMacEnc);
 }
 
 void RLPXFrameCoder::updateIngressMACWithHeader(bytesConstRef _headerCipher)
 {
-	m_impl->updateMAC(m_impl->ingressMac, _headerCipher.cropped(0, 16));
+	m_impl->updateMAC(m_impl->ingressMac, m_impl->ingressMacEnc, _headerCipher.cropped(0, 16));
 }
 
 void RLPXFrameCoder::updateIngressMACWithFrame(bytesConstRef _cipher)
 {
 	m_impl->ingressMac.Update(_cipher.data(), _cipher.size());
-	m_impl->updateMAC(m_impl->ingressMac);
+	m_impl->updateMAC(m_impl->ingressMac, m_impl->ingressMacEnc);
 }
 
-void RLPXFrameCoderImpl::updateMAC(CryptoPP::Keccak_256& _mac, bytesConstRef _seed)
+void RLPXFrameCoderImpl::updateMAC(CryptoPP::Keccak_256& _mac, CryptoPP::ECB_Mode<CryptoPP::AES>::Encryption& _macEnc, bytesConstRef _seed)
 {
 	if (_seed.size() && _seed.size() != h128::size)
 		asserts(false);
@@ -263,10 +267,7 @@ void RLPXFrameCoderImpl::updateMAC(CryptoPP::Keccak_256& _mac, bytesConstRef _se
 	prevDigest.TruncatedFinal(encDigest.data(), h128::size);
 	h128 prevDigestOut = encDigest;
 
-	{
-		Guard l(x_macEnc);
-		macEnc.ProcessData(encDigest.data(), encDigest.data(), 16);
-	}
+	_macEnc.ProcessData(encDigest.data(), encDigest.data(), 16);
 	if (_seed.size())
 		encDigest ^= *(h128*)_seed.data();
 	else
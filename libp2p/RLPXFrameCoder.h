@@ -97,6 +97,9 @@ public:
 protected:
     void writeFrame(RLPStream const& _header, bytesConstRef _payload, bytes& o_bytes);
 
+    /// Encrypt frame with given header (at most 16 bytes, zero-padded) and payload into o_bytes.
+    void writeFrame(bytesConstRef _header, bytesConstRef _payload, bytes& o_bytes);
+
     /// Update state of egress MAC with frame header.
     void updateEgressMACWithHeader(bytesConstRef _headerCipher);
 
@@ -228,15 +228,24 @@ void Session::send(bytes&& _msg)
 
 void Session::write()
 {
-    bytes const* out = nullptr;
+    // frame everything queued so far and send all frames with a single write, packets queued
+    // meanwhile are sent by the next write
+    std::vector<ba::const_buffer> buffers;
     DEV_GUARDED(x_framing)
     {
-        m_io->writeSingleFramePacket(&m_writeQueue[0], m_writeQueue[0]);
-        out = &m_writeQueue[0];
+        buffers.reserve(m_writeQueue.size());
+        for (auto& packet : m_writeQueue)
+        {
+            auto const capabilityAndType = capabilityPacketType(packet[0]);
+            m_io->writeSingleFramePacket(&packet, packet);
+            m_metrics.noteSent(capabilityAndType.first, capabilityAndType.second, packet.size());
+            buffers.push_back(ba::buffer(packet));
+        }
     }
     auto self(shared_from_this());
-    ba::async_write(m_socket->ref(), ba::buffer(*out),
-        [this, self](boost::system::error_code ec, std::size_t /*length*/) {
+    size_t const framedCount = buffers.size();
+    ba::async_write(m_socket->ref(), buffers,
+        [this, self, framedCount](boost::system::error_code ec, std::size_t /*length*/) {
             // must check queue, as write callback can occur following dropped()
             if (ec)
             {
@@ -247,7 +256,7 @@ void Session::write()
 
             DEV_GUARDED(x_framing)
             {
-                m_writeQueue.pop_front();
+                m_writeQueue.erase(m_writeQueue.begin(), m_writeQueue.begin() + framedCount);
                 if (m_writeQueue.empty())
                     return;
             }
@@ -379,6 +388,9 @@ void Session::doRead()
                     else
                     {
                         auto packetType = static_cast<P2pPacketType>(RLP(frame.cropped(0, 1)).toInt<unsigned>());
+                        auto const capabilityAndType = capabilityPacketType(packetType);
+                        m_metrics.noteReceived(capabilityAndType.first, capabilityAndType.second,
+                            h256::size + tlen);
                         RLP r(frame.cropped(1));
                         bool ok = readPacket(hProtocolId, packetType, r);
                         if (!ok)
@@ -472,3 +484,16 @@ char const* Session::capabilityPacketTypeToString(unsigned _packetType) const
     }
     return "Unknown";
 }
+
+pair<string, unsigned> Session::capabilityPacketType(unsigned _packetType) const
+{
+    if (_packetType < UserPacket)
+        return {"p2p", _packetType};
+    for (auto const& capIter : m_capabilities)
+    {
+        auto const& capName = capIter.first.first;
+        if (canHandle(capName, capIter.second->messageCount(), _packetType))
+            return {capName, _packetType - *capabilityOffset(capName)};
+    }
+    return {"unknown", _packetType};
+}
@@ -6,6 +6,7 @@
 
 #include "Capability.h"
 #include "Common.h"
+#include "PeerMetrics.h"
 #include "RLPXSocket.h"
 #include <libdevcore/Common.h>
 #include <libdevcore/Guards.h>
@@ -62,6 +63,8 @@ public:
 
     virtual ReputationManager& repMan() = 0;
 
+    virtual PeerMetrics& metrics() = 0;
+
     virtual void disableCapability(
         std::string const& _capabilityName, std::string const& _problem) = 0;
 
@@ -109,6 +112,8 @@ public:
 
     ReputationManager& repMan() override;
 
+    PeerMetrics& metrics() override { return m_metrics; }
+
     void disableCapability(
         std::string const& _capabilityName, std::string const& _problem) override;
 
@@ -150,6 +155,10 @@ private:
 
     char const* capabilityPacketTypeToString(unsigned _packetType) const;
 
+    /// @returns name of the capability ("p2p" for the base protocol) handling the packet and
+    /// packet type relative to the capability's offset.
+    std::pair<std::string, unsigned> capabilityPacketType(unsigned _packetType) const;
+
     Host* m_server;							///< The host that owns us. Never null.
 
     std::unique_ptr<RLPXFrameCoder> m_io;	///< Transport over which packets are sent.
@@ -179,6 +188,8 @@ private:
 
     std::string m_logSuffix;
 
+    PeerMetrics m_metrics;					///< Traffic and usefulness statistics of the session.
+
     Logger m_netLogger{createLogger(VerbosityDebug, "net")};
     Logger m_netLoggerDetail{createLogger(VerbosityTrace, "net")};
     Logger m_netLoggerError{createLogger(VerbosityError, "net")};
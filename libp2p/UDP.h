@@ -16,6 +16,13 @@
 #include <libdevcore/Log.h>
 #include <libdevcore/RLP.h>
 #include "Common.h"
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
 namespace ba = boost::asio;
 namespace bi = ba::ip;
 
@@ -85,6 +92,9 @@ struct UDPSocketEvents
  * @brief UDP Interface
  * Handler must implement UDPSocketEvents.
  *
+ * On Linux datagrams are received and sent in batches with recvmmsg/sendmmsg, so that a single
+ * system call and a single asio handler serve many discovery packets.
+ *
  * @todo multiple endpoints (we cannot advertise 0.0.0.0)
  * @todo decouple deque from UDPDatagram and add ref() to datagram for fire&forget
  */
@@ -95,6 +105,13 @@ public:
     enum { maxDatagramSize = MaxDatagramSize };
     static_assert((unsigned)maxDatagramSize < 65507u, "UDP datagrams cannot be larger than 65507 bytes");
 
+#if defined(__linux__)
+    /// Maximum number of datagrams received or sent with one system call.
+    static constexpr unsigned c_ioBatchSize = 32;
+#else
+    static constexpr unsigned c_ioBatchSize = 1;
+#endif
+
     /// Create socket for specific endpoint.
     UDPSocket(ba::io_context& _io, UDPSocketEvents& _host, bi::udp::endpoint _endpoint)
       : m_host(_host), m_endpoint(_endpoint), m_socket(_io)
@@ -129,6 +146,15 @@ protected:
 
     void doWrite();
 
+#if defined(__linux__)
+    /// Receives all datagrams available in the socket (up to c_ioBatchSize) and passes them to
+    /// the host.
+    void receiveBatch();
+
+    /// Sends datagrams from the front of the queue, removes the sent ones. x_sendQ must be locked.
+    void sendBatch();
+#endif
+
     void disconnectWithError(boost::system::error_code _ec);
 
     std::atomic<bool> m_started;					///< Atomically ensure connection is started once. Start cannot occur unless m_started is false. Managed by start and disconnectWithError.
@@ -139,7 +165,7 @@ protected:
 
     Mutex x_sendQ;
     std::deque<UDPDatagram> m_sendQ;				///< Queue for egress data.
-    std::array<byte, maxDatagramSize> m_recvData;	///< Buffer for ingress data.
+    std::array<std::array<byte, maxDatagramSize>, c_ioBatchSize> m_recvData;	///< Buffers for ingress data.
     bi::udp::endpoint m_recvEndpoint;				///< Endpoint data was received from.
     bi::udp::socket m_socket;						///< Boost asio udp socket.
 
@@ -163,6 +189,10 @@ void UDPSocket<Handler, MaxDatagramSize>::connect()
     {
         m_socket.bind(bi::udp::endpoint(bi::udp::v4(), m_endpoint.port()));
     }
+#if defined(__linux__)
+    // batches are read and written until the socket would block
+    m_socket.non_blocking(true);
+#endif
 
     // clear write queue so reconnect doesn't send stale messages
     Guard l(x_sendQ);
@@ -193,7 +223,20 @@ void UDPSocket<Handler, MaxDatagramSize>::doRead()
         return;
 
     auto self(UDPSocket<Handler, MaxDatagramSize>::shared_from_this());
-    m_socket.async_receive_from(boost::asio::buffer(m_recvData), m_recvEndpoint, [this, self](boost::system::error_code _ec, size_t _len)
+#if defined(__linux__)
+    m_socket.async_wait(bi::udp::socket::wait_read, [this, self](boost::system::error_code _ec)
+    {
+        if (m_closed)
+            return disconnectWithError(_ec);
+
+        if (_ec != boost::system::errc::success)
+            cnetlog << "Receiving UDP message failed. " << _ec.value() << " : " << _ec.message();
+        else
+            receiveBatch();
+        doRead();
+    });
+#else
+    m_socket.async_receive_from(boost::asio::buffer(m_recvData[0]), m_recvEndpoint, [this, self](boost::system::error_code _ec, size_t _len)
     {
         if (m_closed)
             return disconnectWithError(_ec);
@@ -202,9 +245,10 @@ void UDPSocket<Handler, MaxDatagramSize>::doRead()
             cnetlog << "Receiving UDP message failed. " << _ec.value() << " : " << _ec.message();
 
         if (_len)
-            m_host.onPacketReceived(this, m_recvEndpoint, bytesConstRef(m_recvData.data(), _len));
+            m_host.onPacketReceived(this, m_recvEndpoint, bytesConstRef(m_recvData[0].data(), _len));
         doRead();
     });
+#endif
 }
 
 template <typename Handler, unsigned MaxDatagramSize>
@@ -213,8 +257,29 @@ void UDPSocket<Handler, MaxDatagramSize>::doWrite()
     if (m_closed)
         return;
 
-    const UDPDatagram& datagram = m_sendQ[0];
     auto self(UDPSocket<Handler, MaxDatagramSize>::shared_from_this());
+#if defined(__linux__)
+    m_socket.async_wait(bi::udp::socket::wait_write, [this, self](boost::system::error_code _ec)
+    {
+        if (m_closed)
+            return disconnectWithError(_ec);
+
+        Guard l(x_sendQ);
+        if (_ec != boost::system::errc::success)
+        {
+            cnetlog << "Failed delivering UDP message. " << _ec.value() << " : " << _ec.message();
+            if (!m_sendQ.empty())
+                m_sendQ.pop_front();
+        }
+        else
+            sendBatch();
+
+        if (m_sendQ.empty())
+            return;
+        doWrite();
+    });
+#else
+    const UDPDatagram& datagram = m_sendQ[0];
     bi::udp::endpoint endpoint(datagram.endpoint());
     m_socket.async_send_to(boost::asio::buffer(datagram.data), endpoint, [this, self, endpoint](boost::system::error_code _ec, std::size_t)
     {
@@ -230,7 +295,77 @@ void UDPSocket<Handler, MaxDatagramSize>::doWrite()
             return;
         doWrite();
     });
+#endif
+}
+
+#if defined(__linux__)
+template <typename Handler, unsigned MaxDatagramSize>
+void UDPSocket<Handler, MaxDatagramSize>::receiveBatch()
+{
+    std::array<mmsghdr, c_ioBatchSize> headers{};
+    std::array<iovec, c_ioBatchSize> buffers;
+    std::array<bi::udp::endpoint, c_ioBatchSize> senders;
+    for (unsigned i = 0; i < c_ioBatchSize; ++i)
+    {
+        buffers[i].iov_base = m_recvData[i].data();
+        buffers[i].iov_len = m_recvData[i].size();
+        headers[i].msg_hdr.msg_iov = &buffers[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+        headers[i].msg_hdr.msg_name = senders[i].data();
+        headers[i].msg_hdr.msg_namelen = static_cast<socklen_t>(senders[i].capacity());
+    }
+
+    int const received =
+        ::recvmmsg(m_socket.native_handle(), headers.data(), c_ioBatchSize, MSG_DONTWAIT, nullptr);
+    if (received < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+            cnetlog << "Receiving UDP messages failed. " << errno << " : " << strerror(errno);
+        return;
+    }
+
+    for (int i = 0; i < received && !m_closed; ++i)
+    {
+        if (!headers[i].msg_len)
+            continue;
+        senders[i].resize(headers[i].msg_hdr.msg_namelen);
+        m_host.onPacketReceived(
+            this, senders[i], bytesConstRef(m_recvData[i].data(), headers[i].msg_len));
+    }
+}
+
+template <typename Handler, unsigned MaxDatagramSize>
+void UDPSocket<Handler, MaxDatagramSize>::sendBatch()
+{
+    auto const count = static_cast<unsigned>(std::min(m_sendQ.size(), size_t{c_ioBatchSize}));
+    std::array<mmsghdr, c_ioBatchSize> headers{};
+    std::array<iovec, c_ioBatchSize> buffers;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        UDPDatagram const& datagram = m_sendQ[i];
+        buffers[i].iov_base = const_cast<byte*>(datagram.data.data());
+        buffers[i].iov_len = datagram.data.size();
+        headers[i].msg_hdr.msg_iov = &buffers[i];
+        headers[i].msg_hdr.msg_iovlen = 1;
+        headers[i].msg_hdr.msg_name = const_cast<void*>(
+            static_cast<void const*>(datagram.endpoint().data()));
+        headers[i].msg_hdr.msg_namelen = static_cast<socklen_t>(datagram.endpoint().size());
+    }
+
+    int sent = ::sendmmsg(m_socket.native_handle(), headers.data(), count, MSG_DONTWAIT);
+    if (sent < 0)
+    {
+        // socket buffer is full, wait until it becomes writable again
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return;
+
+        // error is reported only for the first datagram of the batch, drop it
+        cnetlog << "Failed delivering UDP message. " << errno << " : " << strerror(errno);
+        sent = 1;
+    }
+    m_sendQ.erase(m_sendQ.begin(), m_sendQ.begin() + sent);
 }
+#endif
 
 template <typename Handler, unsigned MaxDatagramSize>
 void UDPSocket<Handler, MaxDatagramSize>::disconnectWithError(boost::system::error_code _ec)
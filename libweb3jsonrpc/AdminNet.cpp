@@ -1,6 +1,7 @@
 #include <jsonrpccpp/common/exception.h>
 #include <libwebthree/WebThree.h>
 #include <libdevcore/CommonJS.h>
+#include <libdevcore/Metrics.h>
 #include <libethcore/Common.h>
 #include "AdminNet.h"
 #include "SessionManager.h"
@@ -71,3 +72,11 @@ bool AdminNet::admin_addPeer(string const& _node)
 	m_network.addPeer(p2p::NodeSpec(_node), p2p::PeerType::Required);
 	return true;
 }
+
+Json::Value AdminNet::admin_metrics()
+{
+	Json::Value ret(Json::objectValue);
+	for (auto const& value: MetricsRegistry::instance().values())
+		ret[value.first] = value.second;
+	return ret;
+}
@@ -25,6 +25,8 @@ public:
 	virtual Json::Value admin_nodeInfo() override;
 	virtual Json::Value admin_peers() override;
 	virtual bool admin_addPeer(std::string const& _node) override;
+	/// @returns the values of the metrics of the process, see MetricsRegistry.
+	virtual Json::Value admin_metrics() override;
 
 private:
 	NetworkFace& m_network;
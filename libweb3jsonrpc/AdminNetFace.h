@@ -20,6 +20,7 @@ namespace dev {
                     this->bindAndAddMethod(jsonrpc::Procedure("admin_nodeInfo", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT,  NULL), &dev::rpc::AdminNetFace::admin_nodeInfoI);
                     this->bindAndAddMethod(jsonrpc::Procedure("admin_peers", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT,  NULL), &dev::rpc::AdminNetFace::admin_peersI);
                     this->bindAndAddMethod(jsonrpc::Procedure("admin_addPeer", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_BOOLEAN, "param1",jsonrpc::JSON_STRING, NULL), &dev::rpc::AdminNetFace::admin_addPeerI);
+                    this->bindAndAddMethod(jsonrpc::Procedure("admin_metrics", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT,  NULL), &dev::rpc::AdminNetFace::admin_metricsI);
                 }
 
                 inline virtual void admin_net_connectI(const Json::Value &request, Json::Value &response)
@@ -48,12 +49,18 @@ namespace dev {
                 {
                     response = this->admin_addPeer(request[0u].asString());
                 }
+                inline virtual void admin_metricsI(const Json::Value &request, Json::Value &response)
+                {
+                    (void)request;
+                    response = this->admin_metrics();
+                }
                 virtual bool admin_net_connect(const std::string& param1, const std::string& param2) = 0;
                 virtual Json::Value admin_net_peers(const std::string& param1) = 0;
                 virtual Json::Value admin_net_nodeInfo(const std::string& param1) = 0;
                 virtual Json::Value admin_nodeInfo() = 0;
                 virtual Json::Value admin_peers() = 0;
                 virtual bool admin_addPeer(const std::string& param1) = 0;
+                virtual Json::Value admin_metrics() = 0;
         };
 
     }
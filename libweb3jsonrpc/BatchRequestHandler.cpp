@@ -0,0 +1,189 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "BatchRequestHandler.h"
+
+#include <libdevcore/Guards.h>
+#include <libethereum/ClientBase.h>
+
+#include <jsonrpccpp/common/errors.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <unordered_set>
+
+using namespace std;
+using namespace dev;
+using namespace dev::rpc;
+
+namespace
+{
+/// Methods that only read the chain, the state or the node status. Filter polling methods are not
+/// here, as they consume the accumulated changes.
+unordered_set<string> const c_readOnlyMethods = {
+    "eth_accounts",
+    "eth_blockNumber",
+    "eth_call",
+    "eth_chainId",
+    "eth_coinbase",
+    "eth_estimateGas",
+    "eth_gasPrice",
+    "eth_getBalance",
+    "eth_getBlockByHash",
+    "eth_getBlockByNumber",
+    "eth_getBlockTransactionCountByHash",
+    "eth_getBlockTransactionCountByNumber",
+    "eth_getCode",
+    "eth_getLogs",
+    "eth_getLogsEx",
+    "eth_getStorageAt",
+    "eth_getStorageRoot",
+    "eth_getTransactionByBlockHashAndIndex",
+    "eth_getTransactionByBlockNumberAndIndex",
+    "eth_getTransactionByHash",
+    "eth_getTransactionCount",
+    "eth_getTransactionReceipt",
+    "eth_getUncleByBlockHashAndIndex",
+    "eth_getUncleByBlockNumberAndIndex",
+    "eth_getUncleCountByBlockHash",
+    "eth_getUncleCountByBlockNumber",
+    "eth_hashrate",
+    "eth_mining",
+    "eth_pendingTransactions",
+    "eth_protocolVersion",
+    "eth_syncing",
+    "net_listening",
+    "net_peerCount",
+    "net_version",
+    "web3_clientVersion",
+    "debug_traceBlockByHash",
+    "debug_traceBlockByNumber",
+    "debug_traceCall",
+    "debug_traceChain",
+    "debug_traceTransaction",
+    "debug_storageRangeAt",
+    "debug_accountRange",
+    "debug_preimage",
+};
+
+bool isReadOnlyCall(Json::Value const& _call)
+{
+    return _call.isObject() && _call["method"].isString() &&
+           BatchRequestHandler::isReadOnly(_call["method"].asString());
+}
+}  // namespace
+
+BatchRequestHandler::BatchRequestHandler(jsonrpc::IProtocolHandler& _handler,
+    unsigned _workerThreads, unsigned _maxConcurrentCalls, CaptureSnapshot _captureSnapshot)
+  : m_handler(_handler),
+    m_maxConcurrentCalls(max(_maxConcurrentCalls, 1u)),
+    m_captureSnapshot(move(_captureSnapshot)),
+    m_work(new boost::asio::io_service::work(m_ioService))
+{
+    for (unsigned i = 0; i < max(_workerThreads, 1u); ++i)
+        m_workers.emplace_back([this]() { m_ioService.run(); });
+}
+
+BatchRequestHandler::~BatchRequestHandler()
+{
+    m_work.reset();
+    m_ioService.stop();
+    for (auto& worker : m_workers)
+        worker.join();
+}
+
+bool BatchRequestHandler::isReadOnly(string const& _method)
+{
+    return c_readOnlyMethods.count(_method) != 0;
+}
+
+BatchRequestHandler::CaptureSnapshot BatchRequestHandler::clientHead(
+    eth::ClientBase const& _client)
+{
+    return [&_client]() -> EnterSnapshot {
+        auto const head = _client.headSnapshot();
+        return [&_client, head]() {
+            return make_shared<eth::ClientBase::PinnedHead>(_client, head);
+        };
+    };
+}
+
+void BatchRequestHandler::HandleRequest(string const& _request, string& o_response)
+{
+    Json::Value parsed;
+    if (!Json::Reader().parse(_request, parsed, false) || !parsed.isArray() || parsed.size() < 2)
+    {
+        // errors and single requests are handled as before
+        m_handler.HandleRequest(_request, o_response);
+        return;
+    }
+
+    Json::Value const& batch = parsed;
+    vector<Json::Value> responses(batch.size());
+    // a block imported while the batch executes is not seen by the rest of it
+    EnterSnapshot const enterSnapshot = m_captureSnapshot ? m_captureSnapshot() : EnterSnapshot();
+    unsigned begin = 0;
+    while (begin < batch.size())
+    {
+        // run the longest read-only sequence in parallel, then the call that ends it alone
+        unsigned end = begin;
+        while (end < batch.size() && isReadOnlyCall(batch[end]))
+            ++end;
+
+        dispatch(batch, begin, end, enterSnapshot, responses);
+        if (end < batch.size())
+            m_handler.HandleJsonRequest(batch[end], responses[end]);
+        begin = end + 1;
+    }
+
+    // notifications have no response
+    Json::Value result = Json::arrayValue;
+    for (auto& response : responses)
+        if (!response.isNull())
+            result.append(move(response));
+
+    o_response = result.empty() ? string() : Json::FastWriter().write(result);
+}
+
+void BatchRequestHandler::dispatch(Json::Value const& _batch, unsigned _begin, unsigned _end,
+    EnterSnapshot const& _enterSnapshot, vector<Json::Value>& o_responses)
+{
+    if (_begin == _end)
+        return;
+
+    atomic<unsigned> next{_begin};
+    unsigned const taskCount = min(m_maxConcurrentCalls, _end - _begin);
+    unsigned finishedTasks = 0;
+    Mutex x_finished;
+    condition_variable finished;
+
+    auto const handleCalls = [&]() {
+        shared_ptr<void> const snapshot = _enterSnapshot ? _enterSnapshot() : nullptr;
+        for (unsigned i = next++; i < _end; i = next++)
+        {
+            try
+            {
+                m_handler.HandleJsonRequest(_batch[i], o_responses[i]);
+            }
+            catch (std::exception const& _e)
+            {
+                // worker threads must not be terminated by the failure of a single call
+                m_handler.WrapError(
+                    _batch[i], jsonrpc::Errors::ERROR_RPC_INTERNAL_ERROR, _e.what(), o_responses[i]);
+            }
+        }
+
+        Guard l(x_finished);
+        if (++finishedTasks == taskCount)
+            finished.notify_one();
+    };
+    // the calling thread takes part in the work as well
+    for (unsigned i = 1; i < taskCount; ++i)
+        m_ioService.post(handleCalls);
+    handleCalls();
+
+    std::unique_lock<Mutex> l(x_finished);
+    finished.wait(l, [&]() { return finishedTasks == taskCount; });
+}
@@ -0,0 +1,77 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Dispatch of JSON-RPC batch requests to a pool of worker threads.
+#pragma once
+
+#include <jsonrpccpp/server/iclientconnectionhandler.h>
+#include <jsonrpccpp/server/iprotocolhandler.h>
+
+#include <boost/asio/io_service.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+class ClientBase;
+}
+
+namespace rpc
+{
+/// Connection handler that splits batch requests and executes the calls of a batch concurrently.
+/// Calls of read-only methods run in parallel, any other call waits for the calls before it and
+/// blocks the calls after it, so that e.g. the batch can read the transaction it has just sent.
+/// The read-only calls of a batch all read the snapshot of the node captured when the batch
+/// arrives, if a way to capture it is given. Responses are returned in the order of requests.
+/// Single requests are passed to the protocol handler directly.
+class BatchRequestHandler : public jsonrpc::IClientConnectionHandler
+{
+public:
+    /// Called by each thread before it executes read-only calls of a batch, the calls read the
+    /// snapshot of the batch until the returned object is released.
+    using EnterSnapshot = std::function<std::shared_ptr<void>()>;
+    /// Captures the snapshot of the node that the read-only calls of a batch read.
+    using CaptureSnapshot = std::function<EnterSnapshot()>;
+
+    /// @param _workerThreads size of the pool shared by all connections
+    /// @param _maxConcurrentCalls maximum number of calls of one batch executing at the same time;
+    /// connections handle one request at a time, so this is the limit per connection
+    /// @param _captureSnapshot called once per batch, calls read the current state if empty
+    BatchRequestHandler(jsonrpc::IProtocolHandler& _handler, unsigned _workerThreads,
+        unsigned _maxConcurrentCalls, CaptureSnapshot _captureSnapshot = {});
+    ~BatchRequestHandler();
+
+    void HandleRequest(std::string const& _request, std::string& o_response) override;
+
+    /// @returns true if the method doesn't change the state of the node.
+    static bool isReadOnly(std::string const& _method);
+
+    /// @returns the function pinning the "latest" and "pending" blocks of @a _client to its head
+    /// at the time a batch arrives.
+    static CaptureSnapshot clientHead(eth::ClientBase const& _client);
+
+private:
+    /// Executes the calls [_begin, _end) of the batch in parallel, each thread entering
+    /// @a _enterSnapshot first.
+    void dispatch(Json::Value const& _batch, unsigned _begin, unsigned _end,
+        EnterSnapshot const& _enterSnapshot, std::vector<Json::Value>& o_responses);
+
+    jsonrpc::IProtocolHandler& m_handler;
+    unsigned const m_maxConcurrentCalls;
+    CaptureSnapshot const m_captureSnapshot;
+
+    boost::asio::io_service m_ioService;
+    std::unique_ptr<boost::asio::io_service::work> m_work;
+    std::vector<std::thread> m_workers;
+};
+
+}  // namespace rpc
+}  // namespace dev
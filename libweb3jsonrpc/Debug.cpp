@@ -1,19 +1,97 @@
 #include "Debug.h"
 #include "JsonHelper.h"
+#include "SessionManager.h"
 #include <jsonrpccpp/common/exception.h>
 #include <libdevcore/CommonIO.h>
 #include <libdevcore/CommonJS.h>
+#include <libdevcore/ForEachInOrder.h>
 #include <libethcore/CommonJS.h>
+#include <libethereum/CallTracer.h>
 #include <libethereum/Client.h>
 #include <libethereum/Executive.h>
+#include <libethereum/ImportProfiler.h>
 #include <libethereum/StandardTrace.h>
+#include <thread>
 using namespace std;
 using namespace dev;
 using namespace dev::rpc;
 using namespace dev::eth;
 
-Debug::Debug(eth::Client const& _eth):
-    m_eth(_eth)
+namespace
+{
+char const* const c_callTracer = "callTracer";
+char const* const c_prestateTracer = "prestateTracer";
+
+/// @returns the name of the native tracer selected with the "tracer" option, or an empty string
+/// for the trace of the steps.
+string tracerName(Json::Value const& _options)
+{
+    if (!_options.isObject() || !_options.isMember("tracer"))
+        return {};
+    string const name = _options["tracer"].asString();
+    if (name != c_callTracer && name != c_prestateTracer)
+        BOOST_THROW_EXCEPTION(jsonrpc::JsonRpcException(
+            jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS, "Unknown tracer " + name));
+    return name;
+}
+
+/// Executes the transaction with the native tracer @a _tracer, which only observes the calls
+/// and the state they access, so that the VM runs without a per step callback.
+Json::Value traceCalls(Executive& _e, Transaction const& _t, string const& _tracer)
+{
+    auto const execute = [&](CallTracer& _callTracer) {
+        _e.setTracer(&_callTracer);
+        _e.initialize(_t);
+        if (!_e.execute())
+            _e.go();
+        _e.finalize();
+    };
+    if (_tracer == c_callTracer)
+    {
+        CallTreeTracer tracer;
+        execute(tracer);
+        return tracer.jsonValue();
+    }
+    PrestateTracer tracer;
+    execute(tracer);
+    return tracer.jsonValue();
+}
+
+/// The size of the steps of one response in bytes unless the "maxOutputSize" option sets it,
+/// responses are built in memory before they are sent.
+uint64_t const c_defaultMaxOutputSize = 64 * 1024 * 1024;
+
+/// @returns the trace options of a request, with the default maxOutputSize if it has none. A
+/// "maxOutputSize" of 0 lifts the limit.
+StandardTrace::DebugOptions requestOptions(Json::Value const& _options)
+{
+    StandardTrace::DebugOptions options = debugOptions(_options);
+    if (!_options.isObject() || _options["maxOutputSize"].empty())
+        options.maxOutputSize = c_defaultMaxOutputSize;
+    return options;
+}
+
+/// @returns the budget shared by the traces of one response, from the "limit" and "maxOutputSize"
+/// options.
+shared_ptr<TraceBudget> traceBudget(Json::Value const& _options)
+{
+    StandardTrace::DebugOptions const options = requestOptions(_options);
+    return make_shared<TraceBudget>(options.limit, options.maxOutputSize);
+}
+
+/// @returns the number of threads for debug_traceChain from the "threads" option, at most the
+/// number of hardware threads.
+unsigned traceThreads(Json::Value const& _options)
+{
+    unsigned const maxThreads = max(thread::hardware_concurrency(), 1u);
+    if (_options.isObject() && _options.isMember("threads") && _options["threads"].asUInt() > 0)
+        return min(_options["threads"].asUInt(), maxThreads);
+    return maxThreads;
+}
+}  // namespace
+
+Debug::Debug(eth::Client const& _eth, SessionManager& _sm):
+    m_eth(_eth), m_sm(_sm)
 {}
 
 StandardTrace::DebugOptions dev::eth::debugOptions(Json::Value const& _json)
@@ -29,6 +107,12 @@ StandardTrace::DebugOptions dev::eth::debugOptions(Json::Value const& _json)
         op.disableStack =_json["disableStack"].asBool();
     if (!_json["fullStorage"].empty())
         op.fullStorage = _json["fullStorage"].asBool();
+    if (!_json["onlyChanges"].empty())
+        op.onlyChanges = _json["onlyChanges"].asBool();
+    if (!_json["limit"].empty())
+        op.limit = _json["limit"].asUInt64();
+    if (!_json["maxOutputSize"].empty())
+        op.maxOutputSize = _json["maxOutputSize"].asUInt64();
     return op;
 }
 
@@ -66,25 +150,70 @@ State Debug::stateAt(std::string const& _blockHashOrNumber, int _txIndex) const
     return state;
 }
 
-Json::Value Debug::traceTransaction(Executive& _e, Transaction const& _t, Json::Value const& _json)
+Json::Value Debug::traceTransaction(Executive& _e, Transaction const& _t, Json::Value const& _json,
+    bool* o_truncated, shared_ptr<TraceBudget> const& _budget)
 {
+    string const tracer = tracerName(_json);
+    if (!tracer.empty())
+        return traceCalls(_e, _t, tracer);
+
     Json::Value traceJson{Json::arrayValue};
     StandardTrace st{traceJson};
     st.setShowMnemonics();
-    st.setOptions(debugOptions(_json));
+    st.setOptions(requestOptions(_json));
+    if (_budget)
+        st.setBudget(_budget);
     _e.initialize(_t);
     if (!_e.execute())
         _e.go(st.onOp());
     _e.finalize();
+    if (o_truncated)
+        *o_truncated = st.truncated();
     return traceJson;
 }
 
-Json::Value Debug::traceBlock(Block const& _block, Json::Value const& _json)
+bool Debug::writeTrace(Executive& _e, Transaction const& _t, Json::Value const& _json,
+    JsonWriter& o_result, shared_ptr<TraceBudget> const& _budget)
+{
+    string const tracer = tracerName(_json);
+    if (!tracer.empty())
+    {
+        o_result.value(traceCalls(_e, _t, tracer));
+        return false;
+    }
+
+    o_result.beginArray();
+    StandardTrace st{[&o_result](string const& _step) { o_result.raw(_step); }};
+    st.setShowMnemonics();
+    st.setOptions(requestOptions(_json));
+    if (_budget)
+        st.setBudget(_budget);
+    _e.initialize(_t);
+    if (!_e.execute())
+        _e.go(st.onOp());
+    _e.finalize();
+    o_result.endArray();
+    return st.truncated();
+}
+
+Json::Value Debug::traceBlock(Block const& _block, Json::Value const& _json,
+    shared_ptr<TraceBudget> const& _budget, bool& o_truncated)
+{
+    Json::Value traces(Json::arrayValue);
+    o_truncated = false;
+    traceBlock(_block, [&](Executive& _e, Transaction const& _t) {
+        bool truncated = false;
+        traces.append(traceTransaction(_e, _t, _json, &truncated, _budget));
+        o_truncated = o_truncated || truncated;
+    });
+    return traces;
+}
+
+void Debug::traceBlock(Block const& _block, TransactionTracer const& _tracer)
 {
     State s(_block.state());
     s.setRoot(_block.stateRootBeforeTx(0));
 
-    Json::Value traces(Json::arrayValue);
     for (unsigned k = 0; k < _block.pending().size(); k++)
     {
         Transaction t = _block.pending()[k];
@@ -96,9 +225,8 @@ Json::Value Debug::traceBlock(Block const& _block, Json::Value const& _json)
 
         eth::ExecutionResult er;
         e.setResultRecipient(er);
-        traces.append(traceTransaction(e, t, _json));
+        _tracer(e, t);
     }
-    return traces;
 }
 
 Json::Value Debug::debug_traceTransaction(string const& _txHash, Json::Value const& _json)
@@ -112,10 +240,15 @@ Json::Value Debug::debug_traceTransaction(string const& _txHash, Json::Value con
         eth::ExecutionResult er;
         Executive e(s, block, t.transactionIndex(), m_eth.blockChain());
         e.setResultRecipient(er);
-        Json::Value trace = traceTransaction(e, t, _json);
+        if (!tracerName(_json).empty())
+            return traceTransaction(e, t, _json);
+        bool truncated = false;
+        Json::Value trace = traceTransaction(e, t, _json, &truncated);
         ret["gas"] = toJS(t.gas());
         ret["return"] = toHexPrefixed(er.output);
         ret["structLogs"] = trace;
+        if (truncated)
+            ret["truncated"] = true;
     }
     catch(Exception const& _e)
     {
@@ -135,7 +268,10 @@ Json::Value Debug::debug_traceBlockByHash(string const& _blockHash, Json::Value
 {
     Json::Value ret;
     Block block = m_eth.block(h256(_blockHash));
-    ret["structLogs"] = traceBlock(block, _json);
+    bool truncated = false;
+    ret["structLogs"] = traceBlock(block, _json, traceBudget(_json), truncated);
+    if (truncated)
+        ret["truncated"] = true;
     return ret;
 }
 
@@ -143,7 +279,139 @@ Json::Value Debug::debug_traceBlockByNumber(int _blockNumber, Json::Value const&
 {
     Json::Value ret;
     Block block = m_eth.block(blockHash(std::to_string(_blockNumber)));
-    ret["structLogs"] = traceBlock(block, _json);
+    bool truncated = false;
+    ret["structLogs"] = traceBlock(block, _json, traceBudget(_json), truncated);
+    if (truncated)
+        ret["truncated"] = true;
+    return ret;
+}
+
+StreamingMethods Debug::streamingMethods()
+{
+    // the registered methods take over on any exception, also for reporting the error
+    auto const checkParams = [](Json::Value const& _params) {
+        if (!_params.isArray() || _params.size() != 2 || !_params[1u].isObject())
+            BOOST_THROW_EXCEPTION(jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS));
+    };
+    auto const writeBlockTrace = [this](Block const& _block, Json::Value const& _options, JsonWriter& o_result) {
+        o_result.beginObject();
+        o_result.key("structLogs");
+        if (writeBlockTraces(_block, _options, o_result, traceBudget(_options)))
+            o_result.key("truncated").value(true);
+        o_result.endObject();
+    };
+
+    StreamingMethods methods;
+    methods["debug_traceTransaction"] = [=](Json::Value const& _params, JsonWriter& o_result) {
+        checkParams(_params);
+        if (!_params[0u].isString())
+            BOOST_THROW_EXCEPTION(jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS));
+        LocalisedTransaction t = m_eth.localisedTransaction(h256(_params[0u].asString()));
+        Block block = m_eth.block(t.blockHash());
+        State s(State::Null);
+        eth::ExecutionResult er;
+        Executive e(s, block, t.transactionIndex(), m_eth.blockChain());
+        e.setResultRecipient(er);
+        if (!tracerName(_params[1u]).empty())
+        {
+            writeTrace(e, t, _params[1u], o_result);
+            return;
+        }
+        o_result.beginObject();
+        o_result.key("structLogs");
+        bool const truncated = writeTrace(e, t, _params[1u], o_result);
+        o_result.key("gas").value(toJS(t.gas()));
+        o_result.key("return").value(toHexPrefixed(er.output));
+        if (truncated)
+            o_result.key("truncated").value(true);
+        o_result.endObject();
+    };
+    methods["debug_traceBlockByHash"] = [=](Json::Value const& _params, JsonWriter& o_result) {
+        checkParams(_params);
+        if (!_params[0u].isString())
+            BOOST_THROW_EXCEPTION(jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS));
+        writeBlockTrace(m_eth.block(h256(_params[0u].asString())), _params[1u], o_result);
+    };
+    methods["debug_traceBlockByNumber"] = [=](Json::Value const& _params, JsonWriter& o_result) {
+        checkParams(_params);
+        if (!_params[0u].isIntegral())
+            BOOST_THROW_EXCEPTION(jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS));
+        writeBlockTrace(m_eth.block(blockHash(std::to_string(_params[0u].asInt()))), _params[1u], o_result);
+    };
+    methods["debug_traceChain"] = [=](Json::Value const& _params, JsonWriter& o_result) {
+        if (!_params.isArray() || _params.size() != 3 || !_params[0u].isIntegral() ||
+            !_params[1u].isIntegral() || !_params[2u].isObject())
+            BOOST_THROW_EXCEPTION(jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS));
+        int const from = _params[0u].asInt();
+        int const to = _params[1u].asInt();
+        Json::Value const& options = _params[2u];
+        checkChainRange(from, to, options);
+        auto const budget = traceBudget(options);
+
+        o_result.beginArray();
+        // each block is written into its own text on a worker thread and appended to the response
+        // in order, the response is sent once complete and bounded by the budget
+        forEachInOrder<string>(from, to, traceThreads(options),
+            [&](unsigned _number) {
+                Block const block = m_eth.block(m_eth.blockChain().numberHash(_number));
+                string trace;
+                JsonWriter writer(trace);
+                writer.beginObject();
+                writer.key("hash").value(toJS(block.info().hash()));
+                writer.key("number").value(toJS(_number));
+                writer.key("structLogs");
+                if (writeBlockTraces(block, options, writer, budget))
+                    writer.key("truncated").value(true);
+                writer.endObject();
+                return trace;
+            },
+            [&](unsigned, string& _trace) { o_result.raw(_trace); });
+        o_result.endArray();
+    };
+    return methods;
+}
+
+bool Debug::writeBlockTraces(Block const& _block, Json::Value const& _options,
+    JsonWriter& o_result, shared_ptr<TraceBudget> const& _budget)
+{
+    bool truncated = false;
+    o_result.beginArray();
+    traceBlock(_block, [&](Executive& _e, Transaction const& _t) {
+        if (writeTrace(_e, _t, _options, o_result, _budget))
+            truncated = true;
+    });
+    o_result.endArray();
+    return truncated;
+}
+
+void Debug::checkChainRange(int _from, int _to, Json::Value const& _options) const
+{
+    if (_from < 0 || _to < _from || static_cast<unsigned>(_to) > m_eth.number())
+        BOOST_THROW_EXCEPTION(jsonrpc::JsonRpcException(jsonrpc::Errors::ERROR_RPC_INVALID_PARAMS,
+            "Invalid block range " + toString(_from) + " to " + toString(_to)));
+    // report an unknown tracer before starting the threads
+    tracerName(_options);
+}
+
+Json::Value Debug::debug_traceChain(int _from, int _to, Json::Value const& _json)
+{
+    checkChainRange(_from, _to, _json);
+    auto const budget = traceBudget(_json);
+
+    Json::Value ret(Json::arrayValue);
+    forEachInOrder<Json::Value>(_from, _to, traceThreads(_json),
+        [&](unsigned _number) {
+            Block const block = m_eth.block(m_eth.blockChain().numberHash(_number));
+            Json::Value trace(Json::objectValue);
+            trace["hash"] = toJS(block.info().hash());
+            trace["number"] = toJS(_number);
+            bool truncated = false;
+            trace["structLogs"] = traceBlock(block, _json, budget, truncated);
+            if (truncated)
+                trace["truncated"] = true;
+            return trace;
+        },
+        [&](unsigned, Json::Value& _trace) { ret.append(move(_trace)); });
     return ret;
 }
 
@@ -246,10 +514,15 @@ Json::Value Debug::debug_traceCall(Json::Value const& _call, std::string const&
         eth::ExecutionResult er;
         Executive e(temp, m_eth.blockChain().lastBlockHashes());
         e.setResultRecipient(er);
-        Json::Value trace = traceTransaction(e, transaction, _options);
+        if (!tracerName(_options).empty())
+            return traceTransaction(e, transaction, _options);
+        bool truncated = false;
+        Json::Value trace = traceTransaction(e, transaction, _options, &truncated);
         ret["gas"] = toJS(transaction.gas());
         ret["return"] = toHexPrefixed(er.output);
         ret["structLogs"] = trace;
+        if (truncated)
+            ret["truncated"] = true;
     }
     catch(Exception const& _e)
     {
@@ -257,3 +530,82 @@ Json::Value Debug::debug_traceCall(Json::Value const& _call, std::string const&
     }
     return ret;
 }
+
+Json::Value Debug::debug_importProfile()
+{
+    ImportProfiler const& profiler = ImportProfiler::instance();
+
+    auto const latencies = [](map<string, MetricHistogram const*> const& _histograms) {
+        Json::Value ret(Json::objectValue);
+        for (auto const& histogram : _histograms)
+        {
+            MetricHistogram const& h = *histogram.second;
+            Json::Value s(Json::objectValue);
+            s["count"] = static_cast<Json::UInt64>(h.count());
+            s["totalSeconds"] = h.sumSeconds();
+            s["p50"] = h.quantileSeconds(0.5);
+            s["p90"] = h.quantileSeconds(0.9);
+            s["p99"] = h.quantileSeconds(0.99);
+            ret[histogram.first] = s;
+        }
+        return ret;
+    };
+
+    Json::Value blocks(Json::arrayValue);
+    for (auto const& trace : profiler.traces())
+    {
+        Json::Value b(Json::objectValue);
+        b["number"] = trace.number;
+        b["hash"] = toJS(trace.hash);
+        b["transactions"] = static_cast<Json::UInt64>(trace.transactions);
+        b["gasUsed"] = toJS(trace.gasUsed);
+        b["seconds"] = trace.duration;
+        b["gasPerSecond"] = trace.gasPerSecond();
+        Json::Value s(Json::objectValue);
+        for (auto const& span : trace.spans)
+            if (span.label.empty())
+                s[span.stage] = span.duration;
+        b["stages"] = s;
+        blocks.append(b);
+    }
+
+    Json::Value opcodes(Json::objectValue);
+    auto const times = profiler.opcodeTimes();
+    for (unsigned i = 0; i < c_opcodeCategories; ++i)
+    {
+        Json::Value o(Json::objectValue);
+        o["count"] = static_cast<Json::UInt64>(times[i].count);
+        o["seconds"] = times[i].seconds;
+        opcodes[opcodeCategoryName(static_cast<OpcodeCategory>(i))] = o;
+    }
+
+    Json::Value ret(Json::objectValue);
+    ret["stages"] = latencies(profiler.stages());
+    ret["parts"] = latencies(profiler.parts());
+    ret["blocks"] = blocks;
+    ret["opcodeProfiling"] = profiler.opcodeProfiling();
+    ret["opcodeCategories"] = opcodes;
+    return ret;
+}
+
+bool Debug::debug_setOpcodeProfiling(bool _enabled)
+{
+    ImportProfiler::instance().setOpcodeProfiling(_enabled);
+    return true;
+}
+
+bool Debug::debug_writeImportTrace(std::string const& _path, std::string const& _session)
+{
+    RPC_ADMIN;
+    std::string const trace = ImportProfiler::instance().chromeTrace();
+    try
+    {
+        writeFile(_path, bytesConstRef(&trace));
+    }
+    catch (Exception const& _e)
+    {
+        throw jsonrpc::JsonRpcException(
+            "Failed to write " + _path + ": " + diagnostic_information(_e));
+    }
+    return true;
+}
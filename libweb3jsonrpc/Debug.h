@@ -1,6 +1,8 @@
 #pragma once
 #include "DebugFace.h"
+#include "JsonWriter.h"
 #include <libethereum/StandardTrace.h>
+#include <functional>
 
 namespace dev
 {
@@ -23,7 +25,7 @@ class SessionManager;
 class Debug: public DebugFace
 {
 public:
-	explicit Debug(eth::Client const& _eth);
+	Debug(eth::Client const& _eth, SessionManager& _sm);
 
 	virtual RPCModules implementedModules() const override
 	{
@@ -32,21 +34,64 @@ public:
 
     virtual Json::Value debug_accountRange(std::string const& _blockHashOrNumber, int _txIndex,
         std::string const& _addressHash, int _maxResults) override;
+    /// The steps of a trace response are limited to 64 MiB of JSON text unless the
+    /// "maxOutputSize" option sets another size, 0 for no limit. The result has "truncated" set
+    /// if steps have been left out.
     virtual Json::Value debug_traceTransaction(std::string const& _txHash, Json::Value const& _json) override;
 	virtual Json::Value debug_traceCall(Json::Value const& _call, std::string const& _blockNumber, Json::Value const& _options) override;
+	/// The "limit" and "maxOutputSize" options apply to the traces of all transactions of the
+	/// block together; the result has "truncated" set if steps have been left out.
 	virtual Json::Value debug_traceBlockByNumber(int _blockNumber, Json::Value const& _json) override;
 	virtual Json::Value debug_traceBlockByHash(std::string const& _blockHash, Json::Value const& _json) override;
+	/// Traces the blocks from @a _from to @a _to, both included, on the number of threads given by
+	/// the "threads" option, which is capped at the number of cores and defaults to it. Each block
+	/// is replayed from the state root of its parent; the results are in the order of the blocks.
+	/// The "limit" and "maxOutputSize" options apply to all blocks together, each block result
+	/// has "truncated" set if steps of it have been left out. With several threads, which blocks
+	/// are cut short depends on the order they are traced in. The whole response is held in
+	/// memory, long ranges are bounded by the default maxOutputSize, see debug_traceTransaction.
+	virtual Json::Value debug_traceChain(int _from, int _to, Json::Value const& _json) override;
 	virtual Json::Value debug_storageRangeAt(std::string const& _blockHashOrNumber, int _txIndex, std::string const& _address, std::string const& _begin, int _maxResults) override;
 	virtual std::string debug_preimage(std::string const& _hashedKey) override;
 	virtual Json::Value debug_traceBlock(std::string const& _blockRlp, Json::Value const& _json);
+	/// @returns the stage latencies over all imports, separately the latencies of the parts of
+	/// stages like the transactions, the stages and gas throughput of the recent imports and the
+	/// time spent per category of instructions, see eth::ImportProfiler.
+	virtual Json::Value debug_importProfile() override;
+	/// Enables or disables timing the instructions executed by imports, which slows them down.
+	virtual bool debug_setOpcodeProfiling(bool _enabled) override;
+	/// Writes the recent imports to @a _path in the Chrome trace event format. Needs an admin
+	/// session, as it writes to any path the node may write to.
+	virtual bool debug_writeImportTrace(std::string const& _path, std::string const& _session) override;
+
+	/// @returns the trace methods in versions writing the steps to the response one by one,
+	/// instead of collecting them in a Json::Value, see ModularServer::enableStreamingMethods.
+	StreamingMethods streamingMethods();
 
 private:
+	using TransactionTracer = std::function<void(eth::Executive& _e, eth::Transaction const& _t)>;
 
 	eth::Client const& m_eth;
+	SessionManager& m_sm;
 	h256 blockHash(std::string const& _blockHashOrNumber) const;
     eth::State stateAt(std::string const& _blockHashOrNumber, int _txIndex) const;
-    Json::Value traceTransaction(dev::eth::Executive& _e, dev::eth::Transaction const& _t, Json::Value const& _json);
-	Json::Value traceBlock(dev::eth::Block const& _block, Json::Value const& _json);
+    /// @returns the steps of the transaction executed by @a _e, or the result of the native
+    /// tracer named by the "tracer" option ("callTracer" or "prestateTracer") if there is one.
+    /// The steps are taken from @a _budget if it's given, from the limits of the options otherwise.
+    Json::Value traceTransaction(dev::eth::Executive& _e, dev::eth::Transaction const& _t, Json::Value const& _json, bool* o_truncated = nullptr, std::shared_ptr<eth::TraceBudget> const& _budget = {});
+	/// @returns the traces of the transactions of the block, which take their steps from @a _budget.
+	Json::Value traceBlock(dev::eth::Block const& _block, Json::Value const& _json, std::shared_ptr<eth::TraceBudget> const& _budget, bool& o_truncated);
+	/// Calls @a _tracer for the transactions of the block, each with an Executive set up to run it.
+	void traceBlock(dev::eth::Block const& _block, TransactionTracer const& _tracer);
+	/// Writes the trace of the transaction executed by @a _e as an array of steps.
+	/// @returns true if steps have been left out because of the limits of the options, or of
+	/// @a _budget if it's given.
+	bool writeTrace(dev::eth::Executive& _e, dev::eth::Transaction const& _t, Json::Value const& _json, JsonWriter& o_result, std::shared_ptr<eth::TraceBudget> const& _budget = {});
+	/// Writes the traces of the transactions of the block as an array.
+	/// @returns true if steps have been left out because @a _budget is exhausted.
+	bool writeBlockTraces(dev::eth::Block const& _block, Json::Value const& _json, JsonWriter& o_result, std::shared_ptr<eth::TraceBudget> const& _budget);
+	/// Throws if the range for debug_traceChain is not one of existing blocks or the options are invalid.
+	void checkChainRange(int _from, int _to, Json::Value const& _json) const;
 };
 
 }
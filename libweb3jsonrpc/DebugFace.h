@@ -20,7 +20,11 @@ namespace dev {
                     this->bindAndAddMethod(jsonrpc::Procedure("debug_preimage", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",jsonrpc::JSON_STRING, NULL), &dev::rpc::DebugFace::debug_preimageI);
                     this->bindAndAddMethod(jsonrpc::Procedure("debug_traceBlockByNumber", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",jsonrpc::JSON_INTEGER,"param2",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::DebugFace::debug_traceBlockByNumberI);
                     this->bindAndAddMethod(jsonrpc::Procedure("debug_traceBlockByHash", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",jsonrpc::JSON_STRING,"param2",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::DebugFace::debug_traceBlockByHashI);
+                    this->bindAndAddMethod(jsonrpc::Procedure("debug_traceChain", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_ARRAY, "param1",jsonrpc::JSON_INTEGER,"param2",jsonrpc::JSON_INTEGER,"param3",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::DebugFace::debug_traceChainI);
                     this->bindAndAddMethod(jsonrpc::Procedure("debug_traceCall", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT, "param1",jsonrpc::JSON_OBJECT,"param2",jsonrpc::JSON_STRING,"param3",jsonrpc::JSON_OBJECT, NULL), &dev::rpc::DebugFace::debug_traceCallI);
+                    this->bindAndAddMethod(jsonrpc::Procedure("debug_importProfile", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_OBJECT,  NULL), &dev::rpc::DebugFace::debug_importProfileI);
+                    this->bindAndAddMethod(jsonrpc::Procedure("debug_setOpcodeProfiling", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_BOOLEAN, "param1",jsonrpc::JSON_BOOLEAN, NULL), &dev::rpc::DebugFace::debug_setOpcodeProfilingI);
+                    this->bindAndAddMethod(jsonrpc::Procedure("debug_writeImportTrace", jsonrpc::PARAMS_BY_POSITION, jsonrpc::JSON_BOOLEAN, "param1",jsonrpc::JSON_STRING,"param2",jsonrpc::JSON_STRING, NULL), &dev::rpc::DebugFace::debug_writeImportTraceI);
                 }
                 inline virtual void debug_accountRangeI(const Json::Value &request, Json::Value &response)
                 {
@@ -46,17 +50,38 @@ namespace dev {
                 {
                     response = this->debug_traceBlockByHash(request[0u].asString(), request[1u]);
                 }
+                inline virtual void debug_traceChainI(const Json::Value &request, Json::Value &response)
+                {
+                    response = this->debug_traceChain(request[0u].asInt(), request[1u].asInt(), request[2u]);
+                }
                 inline virtual void debug_traceCallI(const Json::Value &request, Json::Value &response)
                 {
                     response = this->debug_traceCall(request[0u], request[1u].asString(), request[2u]);
                 }
+                inline virtual void debug_importProfileI(const Json::Value &request, Json::Value &response)
+                {
+                    (void)request;
+                    response = this->debug_importProfile();
+                }
+                inline virtual void debug_setOpcodeProfilingI(const Json::Value &request, Json::Value &response)
+                {
+                    response = this->debug_setOpcodeProfiling(request[0u].asBool());
+                }
+                inline virtual void debug_writeImportTraceI(const Json::Value &request, Json::Value &response)
+                {
+                    response = this->debug_writeImportTrace(request[0u].asString(), request[1u].asString());
+                }
                 virtual Json::Value debug_accountRange(const std::string& param1, int param2, const std::string& param3, int param4) = 0;
                 virtual Json::Value debug_traceTransaction(const std::string& param1, const Json::Value& param2) = 0;
                 virtual Json::Value debug_storageRangeAt(const std::string& param1, int param2, const std::string& param3, const std::string& param4, int param5) = 0;
                 virtual std::string debug_preimage(const std::string& param1) = 0;
                 virtual Json::Value debug_traceBlockByNumber(int param1, const Json::Value& param2) = 0;
                 virtual Json::Value debug_traceBlockByHash(const std::string& param1, const Json::Value& param2) = 0;
+                virtual Json::Value debug_traceChain(int param1, int param2, const Json::Value& param3) = 0;
                 virtual Json::Value debug_traceCall(const Json::Value& param1, const std::string& param2, const Json::Value& param3) = 0;
+                virtual Json::Value debug_importProfile() = 0;
+                virtual bool debug_setOpcodeProfiling(bool param1) = 0;
+                virtual bool debug_writeImportTrace(const std::string& param1, const std::string& param2) = 0;
         };
 
     }
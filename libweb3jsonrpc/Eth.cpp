@@ -602,6 +602,77 @@ Json::Value Eth::eth_getLogs(Json::Value const& _json)
 	}
 }
 
+namespace
+{
+/// Streaming counterpart of eth_getBlockByHash and eth_getBlockByNumber.
+template <class BlockId>
+void writeBlock(eth::Interface& _client, BlockId _id, bool _includeTransactions, JsonWriter& o_result)
+{
+	auto const blockDetails = _client.blockDetails(_id);
+	auto const blockHeader = _client.blockInfo(_id);
+	auto const uncleHashes = _client.uncleHashes(_id);
+	auto* sealEngine = _client.sealEngine();
+	if (_includeTransactions)
+		writeJson(o_result, blockHeader, blockDetails, uncleHashes, _client.transactions(_id), sealEngine);
+	else
+		writeJson(o_result, blockHeader, blockDetails, uncleHashes, _client.transactionHashes(_id), sealEngine);
+}
+}  // namespace
+
+StreamingMethods Eth::streamingMethods()
+{
+	// parameters the methods can't make sense of throw, so that the call is repeated by the
+	// registered method, which reports the error
+	auto const stringParam = [](Json::Value const& _params, unsigned _index) {
+		if (!_params.isArray() || _params.size() <= _index || !_params[_index].isString())
+			BOOST_THROW_EXCEPTION(JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS));
+		return _params[_index].asString();
+	};
+	auto const boolParam = [](Json::Value const& _params, unsigned _index) {
+		if (!_params.isArray() || _params.size() <= _index || !_params[_index].isBool())
+			BOOST_THROW_EXCEPTION(JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS));
+		return _params[_index].asBool();
+	};
+
+	StreamingMethods methods;
+	methods["eth_getBlockByHash"] = [=](Json::Value const& _params, JsonWriter& o_result) {
+		h256 const h = jsToFixed<32>(stringParam(_params, 0));
+		bool const includeTransactions = boolParam(_params, 1);
+		if (!client()->isKnown(h))
+			o_result.null();
+		else
+			writeBlock(*client(), h, includeTransactions, o_result);
+	};
+	methods["eth_getBlockByNumber"] = [=](Json::Value const& _params, JsonWriter& o_result) {
+		BlockNumber const n = jsToBlockNumber(stringParam(_params, 0));
+		bool const includeTransactions = boolParam(_params, 1);
+		if (!client()->isKnown(n))
+			o_result.null();
+		else
+			writeBlock(*client(), n, includeTransactions, o_result);
+	};
+	methods["eth_getTransactionByHash"] = [=](Json::Value const& _params, JsonWriter& o_result) {
+		h256 const h = jsToFixed<32>(stringParam(_params, 0));
+		if (!client()->isKnownTransaction(h))
+			o_result.null();
+		else
+			writeJson(o_result, client()->localisedTransaction(h));
+	};
+	methods["eth_getTransactionReceipt"] = [=](Json::Value const& _params, JsonWriter& o_result) {
+		h256 const h = jsToFixed<32>(stringParam(_params, 0));
+		if (!client()->isKnownTransaction(h))
+			o_result.null();
+		else
+			writeJson(o_result, client()->localisedTransactionReceipt(h));
+	};
+	methods["eth_getLogs"] = [=](Json::Value const& _params, JsonWriter& o_result) {
+		if (!_params.isArray() || _params.empty() || !_params[0u].isObject())
+			BOOST_THROW_EXCEPTION(JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS));
+		writeJson(o_result, client()->logs(toLogFilter(_params[0u], *client())));
+	};
+	return methods;
+}
+
 Json::Value Eth::eth_getLogsEx(Json::Value const& _json)
 {
 	try
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "EthFace.h"
+#include "JsonWriter.h"
 #include "SessionManager.h"
 #include <jsonrpccpp/common/exception.h>
 #include <jsonrpccpp/server.h>
@@ -107,6 +108,11 @@ public:
 	virtual std::string eth_chainId() override;
 	
 	void setTransactionDefaults(eth::TransactionSkeleton& _t);
+
+	/// @returns the methods returning blocks, transactions, receipts and logs in versions writing
+	/// their result directly, see ModularServer::enableStreamingMethods.
+	StreamingMethods streamingMethods();
+
 protected:
 
 	eth::Interface* client() { return &m_eth; }
@@ -0,0 +1,456 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "HttpServer.h"
+#include "Subscriptions.h"
+
+#include <libdevcore/Log.h>
+#include <libdevcore/Metrics.h>
+
+#include <boost/asio/post.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/optional.hpp>
+
+#include <deque>
+
+using namespace std;
+using namespace dev;
+namespace ba = boost::asio;
+namespace beast = boost::beast;
+namespace http = boost::beast::http;
+namespace websocket = boost::beast::websocket;
+using tcp = boost::asio::ip::tcp;
+
+namespace
+{
+/// Larger requests are refused.
+size_t const c_maxRequestSize = 32 * 1024 * 1024;
+/// HTTP connections are closed if no request is received in this time.
+chrono::seconds const c_idleTimeout{60};
+/// Reading from a WebSocket connection is suspended while it has this many requests waiting.
+size_t const c_maxQueuedRequests = 64;
+/// WebSocket connections with this many messages not written are closed, the client doesn't keep
+/// up with its subscriptions.
+size_t const c_maxQueuedMessages = 4096;
+int const c_listenBacklog = 128;
+char const* const c_metricsTarget = "/metrics";
+char const* const c_jsonContentType = "application/json";
+char const* const c_metricsContentType = "text/plain; version=0.0.4";
+}  // namespace
+
+/// Connection executing its requests one at a time.
+class HttpServer::Session : public enable_shared_from_this<Session>
+{
+public:
+    explicit Session(HttpServer& _server) : m_server(_server) {}
+    virtual ~Session() = default;
+
+    /// Queues the response or the notification for writing. Thread-safe.
+    virtual void send(string _message) = 0;
+    /// Called on the event loop thread.
+    virtual void close() = 0;
+    /// Called on a worker thread to execute the request.
+    virtual void handle(string const& _request) { m_server.OnRequest(_request, this); }
+    /// Called on the event loop thread after the request is executed, @a _failed if executing it
+    /// threw.
+    virtual void onRequestExecuted(bool _failed) = 0;
+
+protected:
+    HttpServer& m_server;
+};
+
+class HttpServer::WebSocketSession : public HttpServer::Session
+{
+public:
+    WebSocketSession(HttpServer& _server, tcp::socket _socket)
+      : Session(_server), m_ws(move(_socket))
+    {}
+
+    void start(http::request<http::string_body> const& _request)
+    {
+        auto self = static_pointer_cast<WebSocketSession>(shared_from_this());
+        if (m_server.m_client)
+        {
+            weak_ptr<WebSocketSession> weak = self;
+            m_subscriptions.reset(
+                new rpc::Subscriptions(*m_server.m_client, [weak](string const& _message) {
+                    if (auto session = weak.lock())
+                        session->send(_message);
+                }));
+        }
+
+        m_ws.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+        m_ws.read_message_max(c_maxRequestSize);
+        m_ws.async_accept(_request, [self](beast::error_code _ec) {
+            if (_ec)
+                self->close();
+            else
+                self->read();
+        });
+    }
+
+    void send(string _message) override
+    {
+        // notifications have no response
+        if (_message.empty())
+            return;
+        auto self = static_pointer_cast<WebSocketSession>(shared_from_this());
+        ba::post(m_server.m_ioContext, [self, message = move(_message)]() mutable {
+            if (!self->isOpen())
+                return;
+            if (self->m_writes.size() >= c_maxQueuedMessages)
+            {
+                clog(VerbosityWarning, "rpc") << "Closing WebSocket connection not reading "
+                                              << c_maxQueuedMessages << " messages";
+                self->close();
+                return;
+            }
+            self->m_writes.push_back(move(message));
+            if (self->m_writes.size() == 1)
+                self->write();
+        });
+    }
+
+    void close() override
+    {
+        if (!isOpen())
+            return;
+        beast::get_lowest_layer(m_ws).close();
+        m_server.m_sessions.erase(shared_from_this());
+    }
+
+    void handle(string const& _request) override
+    {
+        string response;
+        if (m_subscriptions && m_subscriptions->handleRequest(_request, response))
+            send(move(response));
+        else
+            Session::handle(_request);
+    }
+
+    void onRequestExecuted(bool) override
+    {
+        m_executing = false;
+        executeNext();
+        if (m_readPaused && m_requests.size() < c_maxQueuedRequests)
+        {
+            m_readPaused = false;
+            read();
+        }
+    }
+
+private:
+    bool isOpen() { return beast::get_lowest_layer(m_ws).socket().is_open(); }
+
+    void read()
+    {
+        if (m_requests.size() >= c_maxQueuedRequests)
+        {
+            m_readPaused = true;
+            return;
+        }
+        auto self = static_pointer_cast<WebSocketSession>(shared_from_this());
+        m_ws.async_read(m_buffer, [self](beast::error_code _ec, size_t) {
+            if (_ec)
+            {
+                // includes the client closing the connection
+                self->close();
+                return;
+            }
+            self->m_requests.push_back(beast::buffers_to_string(self->m_buffer.data()));
+            self->m_buffer.consume(self->m_buffer.size());
+            self->executeNext();
+            self->read();
+        });
+    }
+
+    void executeNext()
+    {
+        if (m_executing || m_requests.empty() || !isOpen())
+            return;
+        m_executing = true;
+        m_server.execute(shared_from_this(), move(m_requests.front()));
+        m_requests.pop_front();
+    }
+
+    void write()
+    {
+        auto self = static_pointer_cast<WebSocketSession>(shared_from_this());
+        m_ws.text(true);
+        m_ws.async_write(ba::buffer(m_writes.front()), [self](beast::error_code _ec, size_t) {
+            if (_ec)
+            {
+                self->close();
+                return;
+            }
+            self->m_writes.pop_front();
+            if (!self->m_writes.empty())
+                self->write();
+        });
+    }
+
+    websocket::stream<beast::tcp_stream> m_ws;
+    beast::flat_buffer m_buffer;
+    /// Received requests waiting for the execution of the previous one.
+    deque<string> m_requests;
+    bool m_executing = false;
+    bool m_readPaused = false;
+    /// Messages waiting to be written, the first one is being written.
+    deque<string> m_writes;
+    /// Used by the worker executing the request of this session.
+    unique_ptr<rpc::Subscriptions> m_subscriptions;
+};
+
+class HttpServer::HttpSession : public HttpServer::Session
+{
+public:
+    HttpSession(HttpServer& _server, tcp::socket _socket) : Session(_server), m_stream(move(_socket))
+    {}
+
+    void start() { read(); }
+
+    void send(string _message) override
+    {
+        auto self = static_pointer_cast<HttpSession>(shared_from_this());
+        ba::post(m_server.m_ioContext, [self, message = move(_message)]() mutable {
+            // notifications, and batches of notifications only, have an empty response
+            auto const status = message.empty() ? http::status::no_content : http::status::ok;
+            self->respond(status, move(message));
+        });
+    }
+
+    void close() override
+    {
+        if (!m_stream.socket().is_open())
+            return;
+        beast::error_code ec;
+        m_stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+        m_stream.close();
+        m_server.m_sessions.erase(shared_from_this());
+    }
+
+    void onRequestExecuted(bool _failed) override
+    {
+        // the handler doesn't have to send the empty response of a notification
+        if (!m_responded)
+            respond(_failed ? http::status::internal_server_error : http::status::no_content, {});
+    }
+
+private:
+    void read()
+    {
+        // pipelined requests are already in the buffer, they are read one after another
+        m_parser.emplace();
+        m_parser->body_limit(c_maxRequestSize);
+        m_stream.expires_after(c_idleTimeout);
+        auto self = static_pointer_cast<HttpSession>(shared_from_this());
+        http::async_read(m_stream, m_buffer, *m_parser,
+            [self](beast::error_code _ec, size_t) { self->onRead(_ec); });
+    }
+
+    void onRead(beast::error_code _ec)
+    {
+        if (_ec == http::error::body_limit)
+        {
+            m_keepAlive = false;
+            respond(http::status::payload_too_large, {});
+            return;
+        }
+        if (_ec)
+        {
+            // includes the client closing the connection and the idle timeout
+            close();
+            return;
+        }
+
+        http::request<http::string_body> request = m_parser->release();
+        if (m_server.m_rpc && websocket::is_upgrade(request))
+        {
+            m_stream.expires_never();
+            auto session = make_shared<WebSocketSession>(m_server, m_stream.release_socket());
+            m_server.m_sessions.erase(shared_from_this());
+            m_server.m_sessions.insert(session);
+            session->start(request);
+            return;
+        }
+
+        m_version = request.version();
+        m_keepAlive = request.keep_alive();
+        if (request.method() == http::verb::options)
+            respond(http::status::no_content, {});
+        else if (m_server.m_metrics && request.method() == http::verb::get &&
+                 request.target() == c_metricsTarget)
+            respond(http::status::ok, MetricsRegistry::instance().exposition(),
+                c_metricsContentType);
+        else if (!m_server.m_rpc || request.method() != http::verb::post)
+            respond(http::status::method_not_allowed, {});
+        else
+        {
+            m_responded = false;
+            m_stream.expires_never();
+            m_server.execute(shared_from_this(), move(request.body()));
+        }
+    }
+
+    void respond(
+        http::status _status, string _body, char const* _contentType = c_jsonContentType)
+    {
+        if (!m_stream.socket().is_open())
+            return;
+        m_responded = true;
+
+        m_response = {};
+        m_response.version(m_version);
+        m_response.result(_status);
+        m_response.keep_alive(m_keepAlive);
+        m_response.set(http::field::server, "aleth");
+        if (_status == http::status::ok)
+            m_response.set(http::field::content_type, _contentType);
+        if (!m_server.m_corsDomain.empty())
+        {
+            m_response.set(http::field::access_control_allow_origin, m_server.m_corsDomain);
+            m_response.set(http::field::access_control_allow_methods, "POST, OPTIONS");
+            m_response.set(http::field::access_control_allow_headers, "Content-Type");
+        }
+        m_response.body() = move(_body);
+        m_response.prepare_payload();
+
+        m_stream.expires_after(c_idleTimeout);
+        auto self = static_pointer_cast<HttpSession>(shared_from_this());
+        http::async_write(m_stream, m_response, [self](beast::error_code _ec, size_t) {
+            if (_ec || !self->m_keepAlive)
+                self->close();
+            else
+                self->read();
+        });
+    }
+
+    beast::tcp_stream m_stream;
+    beast::flat_buffer m_buffer;
+    boost::optional<http::request_parser<http::string_body>> m_parser;
+    http::response<http::string_body> m_response;
+    unsigned m_version = 11;
+    bool m_keepAlive = true;
+    bool m_responded = true;
+};
+
+HttpServer::HttpServer(string const& _address, unsigned short _port, eth::Interface* _client,
+    string const& _corsDomain, unsigned _workerThreads)
+  : m_endpoint(ba::ip::make_address(_address), _port),
+    m_client(_client),
+    m_corsDomain(_corsDomain),
+    m_workerThreads(max(_workerThreads, 1u))
+{}
+
+HttpServer::~HttpServer()
+{
+    StopListening();
+}
+
+bool HttpServer::StartListening()
+{
+    if (m_running.exchange(true))
+        return false;
+
+    m_ioContext.restart();
+    m_workerContext.restart();
+    try
+    {
+        m_acceptor.reset(new tcp::acceptor(m_ioContext));
+        m_acceptor->open(m_endpoint.protocol());
+        m_acceptor->set_option(tcp::acceptor::reuse_address(true));
+        m_acceptor->bind(m_endpoint);
+        m_acceptor->listen(c_listenBacklog);
+        m_boundPort = m_acceptor->local_endpoint().port();
+    }
+    catch (std::exception const& _e)
+    {
+        clog(VerbosityError, "rpc") << "Failed to listen on " << m_endpoint << ": " << _e.what();
+        m_acceptor.reset();
+        m_running = false;
+        return false;
+    }
+    if (m_rpc)
+        clog(VerbosityInfo, "rpc") << "JSON-RPC HTTP and WebSocket endpoint: "
+                                   << m_endpoint.address() << ":" << m_boundPort;
+    if (m_metrics)
+        clog(VerbosityInfo, "rpc") << "Metrics endpoint: http://" << m_endpoint.address() << ":"
+                                   << m_boundPort << c_metricsTarget;
+
+    accept();
+
+    m_workerGuard.reset(new ba::executor_work_guard<ba::io_context::executor_type>(
+        m_workerContext.get_executor()));
+    for (unsigned i = 0; i < m_workerThreads; ++i)
+        m_workers.emplace_back([this]() { m_workerContext.run(); });
+    m_ioThread = thread([this]() { m_ioContext.run(); });
+    return true;
+}
+
+bool HttpServer::StopListening()
+{
+    if (!m_running.exchange(false))
+        return false;
+
+    ba::post(m_ioContext, [this]() {
+        boost::system::error_code ec;
+        m_acceptor->close(ec);
+        auto const sessions = move(m_sessions);
+        m_sessions.clear();
+        for (auto const& session : sessions)
+            session->close();
+    });
+    // the loop exits once the cancelled operations have completed
+    m_ioThread.join();
+    m_acceptor.reset();
+
+    m_workerGuard.reset();
+    m_workerContext.stop();
+    for (auto& worker : m_workers)
+        worker.join();
+    m_workers.clear();
+    return true;
+}
+
+bool HttpServer::SendResponse(string const& _response, void* _addInfo)
+{
+    clog(VerbosityTrace, "rpc") << _response;
+    static_cast<Session*>(_addInfo)->send(_response);
+    return true;
+}
+
+void HttpServer::accept()
+{
+    m_acceptor->async_accept([this](boost::system::error_code const& _ec, tcp::socket _socket) {
+        if (_ec == ba::error::operation_aborted || !m_acceptor->is_open())
+            return;
+        if (!_ec)
+        {
+            auto session = make_shared<HttpSession>(*this, move(_socket));
+            m_sessions.insert(session);
+            session->start();
+        }
+        accept();
+    });
+}
+
+void HttpServer::execute(shared_ptr<Session> const& _session, string _request)
+{
+    ba::post(m_workerContext, [this, _session, request = move(_request)]() {
+        clog(VerbosityTrace, "rpc") << request;
+        bool failed = false;
+        try
+        {
+            _session->handle(request);
+        }
+        catch (std::exception const& _e)
+        {
+            clog(VerbosityWarning, "rpc") << "Failed to handle request: " << _e.what();
+            failed = true;
+        }
+        ba::post(m_ioContext, [_session, failed]() { _session->onRequestExecuted(failed); });
+    });
+}
@@ -0,0 +1,90 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// JSON-RPC over HTTP/1.1 and WebSocket.
+#pragma once
+
+#include <jsonrpccpp/server/abstractserverconnector.h>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dev
+{
+namespace eth
+{
+class Interface;
+}
+
+/// JSON-RPC connector accepting HTTP POST requests and WebSocket connections on the same port.
+/// HTTP connections are kept alive, pipelined requests are answered in order. WebSocket clients
+/// can use eth_subscribe to get notified about new blocks, logs and pending transactions.
+/// Connections are served by a single event loop thread, requests are executed by a fixed pool of
+/// worker threads, the requests of one connection one at a time.
+class HttpServer : public jsonrpc::AbstractServerConnector
+{
+public:
+    /// @param _client source of subscription notifications, subscriptions are not supported if null
+    /// @param _corsDomain value of Access-Control-Allow-Origin, CORS is disabled if empty
+    /// @param _workerThreads number of threads executing the requests of all connections
+    HttpServer(std::string const& _address, unsigned short _port, eth::Interface* _client,
+        std::string const& _corsDomain = {}, unsigned _workerThreads = 4);
+    ~HttpServer() override;
+
+    bool StartListening() override;
+    bool StopListening() override;
+    bool SendResponse(std::string const& _response, void* _addInfo = nullptr) override;
+
+    /// Answers GET /metrics with MetricsRegistry::exposition(), for Prometheus, and refuses any
+    /// other request if @a _metricsOnly. The metrics are not protected, so this is meant for
+    /// servers on a local address. Call before listening.
+    void enableMetrics(bool _metricsOnly = false)
+    {
+        m_metrics = true;
+        m_rpc = !_metricsOnly;
+    }
+
+    /// @returns the port the server is listening on, which is chosen by the system for port 0.
+    unsigned short port() const { return m_boundPort; }
+
+private:
+    class Session;
+    class HttpSession;
+    class WebSocketSession;
+
+    void accept();
+    /// Executes the request on the worker pool and notes the session when done.
+    void execute(std::shared_ptr<Session> const& _session, std::string _request);
+
+    boost::asio::ip::tcp::endpoint const m_endpoint;
+    eth::Interface* m_client;
+    std::string const m_corsDomain;
+    unsigned const m_workerThreads;
+    bool m_metrics = false;
+    bool m_rpc = true;
+    std::atomic<bool> m_running{false};
+    std::atomic<unsigned short> m_boundPort{0};
+
+    boost::asio::io_context m_ioContext;
+    std::unique_ptr<boost::asio::ip::tcp::acceptor> m_acceptor;
+    std::thread m_ioThread;
+    /// Open sessions, accessed from the event loop thread only.
+    std::set<std::shared_ptr<Session>> m_sessions;
+
+    boost::asio::io_context m_workerContext;
+    std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>
+        m_workerGuard;
+    std::vector<std::thread> m_workers;
+};
+
+}  // namespace dev
@@ -3,6 +3,7 @@
 // Licensed under the GNU General Public License, Version 3.
 
 #include "IpcServerBase.h"
+#include "JsonFramer.h"
 #include <cstdlib>
 #include <cstdio>
 #include <string>
@@ -51,90 +52,38 @@ template <class S> bool IpcServerBase<S>::StopListening()
 
 template <class S> bool IpcServerBase<S>::SendResponse(string const& _response, void* _addInfo)
 {
-    bool fullyWritten = false;
-    bool errorOccured = false;
     S socket = (S)(reinterpret_cast<intptr_t>(_addInfo));
-    string toSend = _response;
-    do
+    for (size_t offset = 0; offset < _response.size();)
     {
-        size_t bytesWritten = Write(socket, toSend);
+        size_t bytesWritten = Write(socket, _response.data() + offset, _response.size() - offset);
         if (bytesWritten == 0)
-            errorOccured = true;
-        else if (bytesWritten < toSend.size())
-        {
-            int len = toSend.size() - bytesWritten;
-            toSend = toSend.substr(bytesWritten + sizeof(char), len);
-        }
-        else
-            fullyWritten = true;
-    } while (!fullyWritten && !errorOccured);
+            return false;
+        offset += bytesWritten;
+    }
     clog(VerbosityTrace, "rpc") << _response;
-    return fullyWritten && !errorOccured;
+    return true;
 }
 
 template <class S> void IpcServerBase<S>::GenerateResponse(S _connection)
 {
     char buffer[c_bufferSize];
+    rpc::JsonFramer framer;
     string request;
-    bool escape = false;
-    bool inString = false;
-    size_t i = 0;
-    int depth = 0;
-    size_t nbytes = 0;
-    do
+    while (size_t nbytes = Read(_connection, buffer, c_bufferSize))
     {
-        nbytes = Read(_connection, buffer, c_bufferSize);
-        if (nbytes <= 0)
-            break;
-        request.append(buffer, nbytes);
-        while (i < request.size())
+        framer.append(buffer, nbytes);
+        while (framer.next(request))
         {
-            char c = request[i];
-            if (c == '\"' && !inString)
-            {
-                inString = true;
-                escape = false;
-            }
-            else if (c == '\"' && inString && !escape)
-            {
-                inString = false;
-                escape = false;
-            }
-            else if (inString && c == '\\' && !escape)
-            {
-                escape = true;
-            }
-            else if (inString)
-            {
-                escape = false;
-            }
-            else if (!inString && (c == '{' || c == '['))
-            {
-                depth++;
-            }
-            else if (!inString && (c == '}' || c == ']'))
-            {
-                depth--;
-                if (depth == 0)
-                {
-                    std::string r = request.substr(0, i + 1);
-                    request.erase(0, i + 1);
-                    clog(VerbosityTrace, "rpc") << r;
-                    OnRequest(r, reinterpret_cast<void*>((intptr_t)_connection));
-                    i = 0;
-                    continue;
-                }
-            }
-            i++;
+            clog(VerbosityTrace, "rpc") << request;
+            OnRequest(request, reinterpret_cast<void*>((intptr_t)_connection));
         }
-    } while (true);
+    }
     DEV_GUARDED(x_sockets)
         m_sockets.erase(_connection);
 }
 
 namespace dev
 {
-template class IpcServerBase<int>;
 template class IpcServerBase<void*>;
 }
 
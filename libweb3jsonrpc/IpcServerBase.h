@@ -25,7 +25,7 @@ public:
 protected:
 	virtual void Listen() = 0;
 	virtual void CloseConnection(S _socket) = 0;
-	virtual size_t Write(S _connection, std::string const& _data) = 0;
+	virtual size_t Write(S _connection, char const* _data, size_t _size) = 0;
 	virtual size_t Read(S _connection, void* _data, size_t _size) = 0;
 	void GenerateResponse(S _connection);
 
@@ -0,0 +1,61 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "JsonFramer.h"
+
+using namespace std;
+using namespace dev::rpc;
+
+void JsonFramer::append(char const* _data, size_t _size)
+{
+    if (m_begin == m_buffer.size())
+    {
+        // everything received so far is consumed, reuse the storage from the start
+        m_buffer.clear();
+        m_begin = m_scanned = 0;
+    }
+    m_buffer.append(_data, _size);
+}
+
+bool JsonFramer::next(string& o_message)
+{
+    for (; m_scanned < m_buffer.size(); ++m_scanned)
+    {
+        char const c = m_buffer[m_scanned];
+        if (m_inString)
+        {
+            if (m_escape)
+                m_escape = false;
+            else if (c == '\\')
+                m_escape = true;
+            else if (c == '"')
+                m_inString = false;
+        }
+        else if (c == '"')
+            m_inString = true;
+        else if (c == '{' || c == '[')
+            ++m_depth;
+        else if (c == '}' || c == ']')
+        {
+            // a stray closing bracket is left to the JSON parser to report
+            if (m_depth > 0 && --m_depth == 0)
+            {
+                ++m_scanned;
+                o_message.assign(m_buffer, m_begin, m_scanned - m_begin);
+                m_begin = m_scanned;
+                return true;
+            }
+        }
+        else if (m_depth == 0 && m_begin == m_scanned &&
+                 (c == ' ' || c == '\n' || c == '\r' || c == '\t'))
+            // whitespace separating the messages
+            ++m_begin;
+    }
+
+    // drop the consumed part so that the buffer only holds the incomplete message
+    m_buffer.erase(0, m_begin);
+    m_scanned -= m_begin;
+    m_begin = 0;
+    return false;
+}
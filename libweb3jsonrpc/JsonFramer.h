@@ -0,0 +1,42 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Splitting of a stream of concatenated JSON values into messages.
+#pragma once
+
+#include <string>
+
+namespace dev
+{
+namespace rpc
+{
+/// Incremental scanner finding the boundaries of JSON objects and arrays in a byte stream.
+/// Data can be appended in chunks of any size; every byte is scanned once, the scanner state is
+/// kept between the chunks. The values are not validated, this is left to the JSON parser.
+class JsonFramer
+{
+public:
+    void append(char const* _data, size_t _size);
+
+    /// Extracts the next complete message.
+    /// @returns false if no complete message has been received yet.
+    bool next(std::string& o_message);
+
+    /// @returns the number of bytes received and not yet returned as a message.
+    size_t bufferedSize() const { return m_buffer.size() - m_begin; }
+
+private:
+    std::string m_buffer;
+    /// Start of the message being scanned in m_buffer; everything before it is consumed.
+    size_t m_begin = 0;
+    /// Position of the first byte not scanned yet.
+    size_t m_scanned = 0;
+    int m_depth = 0;
+    bool m_inString = false;
+    bool m_escape = false;
+};
+
+}  // namespace rpc
+}  // namespace dev
@@ -56,6 +56,31 @@ Json::Value toJson(p2p::PeerSessionInfo const& _p)
         ret["notes"][i.first] = i.second;
     for (auto const& i: _p.caps)
         ret["caps"].append(i.first + "/" + toString((unsigned)i.second));
+
+    Json::Value& metrics = ret["metrics"];
+    metrics["score"] = _p.metrics.score;
+    metrics["bytesIn"] = Json::UInt64(_p.metrics.bytesIn);
+    metrics["bytesOut"] = Json::UInt64(_p.metrics.bytesOut);
+    metrics["usefulItems"] = Json::UInt64(_p.metrics.usefulItems);
+    metrics["duplicateItems"] = Json::UInt64(_p.metrics.duplicateItems);
+    metrics["averageLatency"] = (int)_p.metrics.averageLatency.count();
+    metrics["latencyHistogram"] = Json::objectValue;
+    for (size_t i = 0; i < _p.metrics.latencyHistogram.size(); ++i)
+    {
+        std::string const bucket = i < p2p::c_peerLatencyBucketsMs.size() ?
+                                       "<" + toString(p2p::c_peerLatencyBucketsMs[i]) :
+                                       ">=" + toString(p2p::c_peerLatencyBucketsMs.back());
+        metrics["latencyHistogram"][bucket] = Json::UInt64(_p.metrics.latencyHistogram[i]);
+    }
+    metrics["traffic"] = Json::objectValue;
+    for (auto const& i: _p.metrics.traffic)
+    {
+        Json::Value& packet = metrics["traffic"][i.first.first][toString(i.first.second)];
+        packet["packetsIn"] = Json::UInt64(i.second.packetsIn);
+        packet["bytesIn"] = Json::UInt64(i.second.bytesIn);
+        packet["packetsOut"] = Json::UInt64(i.second.packetsOut);
+        packet["bytesOut"] = Json::UInt64(i.second.bytesOut);
+    }
     return ret;
 }
 
@@ -0,0 +1,412 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "JsonWriter.h"
+
+#include <libdevcore/CommonIO.h>
+#include <libethcore/SealEngine.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::rpc;
+
+namespace
+{
+char const c_hexDigits[] = "0123456789abcdef";
+}  // namespace
+
+JsonWriter& JsonWriter::beginObject()
+{
+    separate();
+    m_out += '{';
+    m_needsComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject()
+{
+    m_out += '}';
+    m_needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray()
+{
+    separate();
+    m_out += '[';
+    m_needsComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray()
+{
+    m_out += ']';
+    m_needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(char const* _key)
+{
+    separate();
+    m_out += '"';
+    m_out += _key;
+    m_out += "\":";
+    // the value follows the key without a comma
+    m_needsComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(string const& _value)
+{
+    separate();
+    m_out += '"';
+    for (char c : _value)
+        switch (c)
+        {
+        case '"':
+            m_out += "\\\"";
+            break;
+        case '\\':
+            m_out += "\\\\";
+            break;
+        case '\n':
+            m_out += "\\n";
+            break;
+        case '\r':
+            m_out += "\\r";
+            break;
+        case '\t':
+            m_out += "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                m_out += "\\u00";
+                m_out += c_hexDigits[static_cast<unsigned char>(c) >> 4];
+                m_out += c_hexDigits[c & 0xf];
+            }
+            else
+                m_out += c;
+        }
+    m_out += '"';
+    m_needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(bool _value)
+{
+    separate();
+    m_out += _value ? "true" : "false";
+    m_needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(uint64_t _value)
+{
+    separate();
+    m_out += to_string(_value);
+    m_needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::null()
+{
+    separate();
+    m_out += "null";
+    m_needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::value(Json::Value const& _value)
+{
+    separate();
+    m_out += Json::FastWriter().write(_value);
+    // FastWriter terminates the output with a new line
+    m_out.pop_back();
+    m_needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(string const& _json)
+{
+    separate();
+    m_out += _json;
+    m_needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::hex(bytesConstRef _data)
+{
+    separate();
+    size_t const begin = m_out.size();
+    m_out.resize(begin + 4 + _data.size() * 2);
+    char* out = &m_out[begin];
+    *out++ = '"';
+    *out++ = '0';
+    *out++ = 'x';
+    if (!_data.empty())
+        encodeHex(_data.data(), _data.size(), out);
+    out[_data.size() * 2] = '"';
+    m_needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::data(bytesConstRef _data)
+{
+    if (_data.empty())
+        return value(string());
+    return hex(_data);
+}
+
+JsonWriter& JsonWriter::quantity(u256 const& _value)
+{
+    if (_value <= numeric_limits<uint64_t>::max())
+        return quantity(static_cast<uint64_t>(_value));
+
+    h256 const bigEndian(_value);
+    separate();
+    m_out += "\"0x";
+    bool leadingZero = true;
+    for (byte b : bigEndian)
+        for (unsigned nibble : {b >> 4, b & 0xf})
+            if (!leadingZero || nibble)
+            {
+                leadingZero = false;
+                m_out += c_hexDigits[nibble];
+            }
+    m_out += '"';
+    m_needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::quantity(uint64_t _value)
+{
+    separate();
+    char digits[16];
+    char* begin = digits + sizeof(digits);
+    do
+    {
+        *--begin = c_hexDigits[_value & 0xf];
+        _value >>= 4;
+    } while (_value);
+    m_out += "\"0x";
+    m_out.append(begin, digits + sizeof(digits));
+    m_out += '"';
+    m_needsComma = true;
+    return *this;
+}
+
+void JsonWriter::separate()
+{
+    if (m_needsComma)
+        m_out += ',';
+}
+
+namespace dev
+{
+namespace eth
+{
+namespace
+{
+void writeHeaderFields(JsonWriter& _w, BlockHeader const& _bi, SealEngineFace* _sealer)
+{
+    // toJson() leaves the hash out if it can't be computed. It is computed before the key is
+    // written, so that a failure doesn't leave the key without a value.
+    h256 hash;
+    bool hasHash = true;
+    try
+    {
+        hash = _bi.hash();
+    }
+    catch (...)
+    {
+        hasHash = false;
+    }
+    if (hasHash)
+        _w.key("hash").hex(hash);
+    _w.key("parentHash").hex(_bi.parentHash());
+    _w.key("sha3Uncles").hex(_bi.sha3Uncles());
+    _w.key("author").hex(_bi.author());
+    _w.key("stateRoot").hex(_bi.stateRoot());
+    _w.key("transactionsRoot").hex(_bi.transactionsRoot());
+    _w.key("receiptsRoot").hex(_bi.receiptsRoot());
+    _w.key("number").quantity(static_cast<uint64_t>(_bi.number()));
+    _w.key("gasUsed").quantity(_bi.gasUsed());
+    _w.key("gasLimit").quantity(_bi.gasLimit());
+    _w.key("extraData").data(&_bi.extraData());
+    _w.key("logsBloom").hex(_bi.logBloom());
+    _w.key("timestamp").quantity(static_cast<uint64_t>(_bi.timestamp()));
+    _w.key("miner").hex(_bi.author());
+    if (_sealer)
+        for (auto const& i : _sealer->jsInfo(_bi))
+            _w.key(i.first.c_str()).value(i.second);
+}
+
+void writeBlockFields(JsonWriter& _w, BlockDetails const& _bd, h256s const& _us)
+{
+    _w.key("totalDifficulty").quantity(_bd.totalDifficulty);
+    _w.key("size").quantity(static_cast<uint64_t>(_bd.blockSizeBytes));
+    _w.key("uncles").beginArray();
+    for (h256 const& h : _us)
+        _w.hex(h);
+    _w.endArray();
+}
+
+void writeTransactionFields(JsonWriter& _w, Transaction const& _t, h256 const& _blockHash,
+    unsigned _transactionIndex, BlockNumber _blockNumber)
+{
+    _w.key("hash").hex(_t.sha3());
+    _w.key("input").data(&_t.data());
+    if (_t.isCreation())
+        _w.key("to").null();
+    else
+        _w.key("to").hex(_t.receiveAddress());
+    _w.key("from").hex(_t.safeSender());
+    _w.key("gas").quantity(_t.gas());
+    _w.key("gasPrice").quantity(_t.gasPrice());
+    _w.key("nonce").quantity(_t.nonce());
+    _w.key("value").quantity(_t.value());
+    _w.key("blockHash").hex(_blockHash);
+    _w.key("transactionIndex").quantity(static_cast<uint64_t>(_transactionIndex));
+    _w.key("blockNumber").quantity(static_cast<uint64_t>(_blockNumber));
+    _w.key("v").quantity(_t.rawV());
+    _w.key("r").hex(_t.signature().r);
+    _w.key("s").hex(_t.signature().s);
+}
+}  // namespace
+
+void writeJson(JsonWriter& _w, BlockHeader const& _bi, SealEngineFace* _sealer)
+{
+    if (!_bi)
+    {
+        _w.null();
+        return;
+    }
+    _w.beginObject();
+    writeHeaderFields(_w, _bi, _sealer);
+    _w.endObject();
+}
+
+void writeJson(JsonWriter& _w, BlockHeader const& _bi, BlockDetails const& _bd, h256s const& _us,
+    Transactions const& _ts, SealEngineFace* _sealer)
+{
+    if (!_bi)
+    {
+        _w.null();
+        return;
+    }
+    _w.beginObject();
+    writeHeaderFields(_w, _bi, _sealer);
+    writeBlockFields(_w, _bd, _us);
+    _w.key("transactions").beginArray();
+    h256 const blockHash = _bi.hash();
+    for (unsigned i = 0; i < _ts.size(); ++i)
+    {
+        _w.beginObject();
+        writeTransactionFields(_w, _ts[i], blockHash, i, static_cast<BlockNumber>(_bi.number()));
+        _w.endObject();
+    }
+    _w.endArray();
+    _w.endObject();
+}
+
+void writeJson(JsonWriter& _w, BlockHeader const& _bi, BlockDetails const& _bd, h256s const& _us,
+    h256s const& _ts, SealEngineFace* _sealer)
+{
+    if (!_bi)
+    {
+        _w.null();
+        return;
+    }
+    _w.beginObject();
+    writeHeaderFields(_w, _bi, _sealer);
+    writeBlockFields(_w, _bd, _us);
+    _w.key("transactions").beginArray();
+    for (h256 const& t : _ts)
+        _w.hex(t);
+    _w.endArray();
+    _w.endObject();
+}
+
+void writeJson(JsonWriter& _w, LocalisedTransaction const& _t)
+{
+    if (!_t)
+    {
+        _w.null();
+        return;
+    }
+    _w.beginObject();
+    writeTransactionFields(_w, _t, _t.blockHash(), _t.transactionIndex(), _t.blockNumber());
+    _w.endObject();
+}
+
+void writeJson(JsonWriter& _w, LocalisedTransactionReceipt const& _t)
+{
+    _w.beginObject();
+    _w.key("transactionHash").hex(_t.hash());
+    _w.key("transactionIndex").value(static_cast<uint64_t>(_t.transactionIndex()));
+    _w.key("blockHash").hex(_t.blockHash());
+    _w.key("blockNumber").value(static_cast<uint64_t>(_t.blockNumber()));
+    _w.key("from").hex(_t.from());
+    _w.key("to").hex(_t.to());
+    _w.key("cumulativeGasUsed").quantity(_t.cumulativeGasUsed());
+    _w.key("gasUsed").quantity(_t.gasUsed());
+    _w.key("contractAddress").hex(_t.contractAddress());
+    _w.key("logs");
+    writeJson(_w, _t.localisedLogs());
+    _w.key("logsBloom").hex(_t.bloom());
+    if (_t.hasStatusCode())
+        _w.key("status").value(toString(_t.statusCode()));
+    else
+        _w.key("stateRoot").hex(_t.stateRoot());
+    _w.endObject();
+}
+
+void writeJson(JsonWriter& _w, LocalisedLogEntry const& _e)
+{
+    if (_e.isSpecial)
+    {
+        _w.hex(_e.special);
+        return;
+    }
+
+    _w.beginObject();
+    _w.key("data").data(&_e.data);
+    _w.key("address").hex(_e.address);
+    _w.key("topics").beginArray();
+    for (h256 const& t : _e.topics)
+        _w.hex(t);
+    _w.endArray();
+    _w.key("polarity").value(_e.polarity == BlockPolarity::Live);
+    if (_e.mined)
+    {
+        _w.key("type").value(string("mined"));
+        _w.key("blockNumber").value(static_cast<uint64_t>(_e.blockNumber));
+        _w.key("blockHash").hex(_e.blockHash);
+        _w.key("logIndex").value(static_cast<uint64_t>(_e.logIndex));
+        _w.key("transactionHash").hex(_e.transactionHash);
+        _w.key("transactionIndex").value(static_cast<uint64_t>(_e.transactionIndex));
+    }
+    else
+    {
+        _w.key("type").value(string("pending"));
+        _w.key("blockNumber").null();
+        _w.key("blockHash").null();
+        _w.key("logIndex").null();
+        _w.key("transactionHash").null();
+        _w.key("transactionIndex").null();
+    }
+    _w.endObject();
+}
+
+void writeJson(JsonWriter& _w, LocalisedLogEntries const& _es)
+{
+    _w.beginArray();
+    for (auto const& e : _es)
+        writeJson(_w, e);
+    _w.endArray();
+}
+
+}  // namespace eth
+}  // namespace dev
@@ -0,0 +1,97 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Serialisation of RPC results straight to JSON text, without building Json::Value trees.
+#pragma once
+
+#include <libdevcore/FixedHash.h>
+#include <libethcore/BlockHeader.h>
+#include <libethcore/LogEntry.h>
+#include <libethereum/BlockDetails.h>
+#include <libethereum/Transaction.h>
+#include <libethereum/TransactionReceipt.h>
+
+#include <json/json.h>
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+namespace dev
+{
+namespace eth
+{
+class SealEngineFace;
+}
+
+namespace rpc
+{
+/// Appends JSON text to a string. Values written inside an object must be preceded by key(), the
+/// writer only takes care of the separators.
+class JsonWriter
+{
+public:
+    explicit JsonWriter(std::string& o_out) : m_out(o_out) {}
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    /// @param _key member name, written without escaping
+    JsonWriter& key(char const* _key);
+
+    JsonWriter& value(std::string const& _value);
+    JsonWriter& value(bool _value);
+    JsonWriter& value(uint64_t _value);
+    JsonWriter& null();
+    /// Writes a value of the Json::Value type, for the parts not worth a dedicated writer.
+    JsonWriter& value(Json::Value const& _value);
+    /// Writes @a _json, the text of a complete JSON value, as it is.
+    JsonWriter& raw(std::string const& _json);
+
+    /// Writes "0x" followed by the hex of all bytes.
+    JsonWriter& hex(bytesConstRef _data);
+    template <unsigned N>
+    JsonWriter& hex(FixedHash<N> const& _hash)
+    {
+        return hex(_hash.ref());
+    }
+    /// Writes the data the way toJS(bytes) does, i.e. an empty string for no data.
+    JsonWriter& data(bytesConstRef _data);
+    /// Writes the number as "0x" followed by the hex digits without leading zeros, like toJS.
+    JsonWriter& quantity(u256 const& _value);
+    JsonWriter& quantity(uint64_t _value);
+
+private:
+    /// Writes the separator before the next value.
+    void separate();
+
+    std::string& m_out;
+    /// A value has been written in the current container, the next one needs a comma.
+    bool m_needsComma = false;
+};
+
+/// Writes the result of a call to @a o_result, throws to report the call as failed.
+using StreamingMethod = std::function<void(Json::Value const& _params, JsonWriter& o_result)>;
+using StreamingMethods = std::unordered_map<std::string, StreamingMethod>;
+
+}  // namespace rpc
+
+namespace eth
+{
+/// Counterparts of the toJson() functions of JsonHelper.h writing the same JSON.
+void writeJson(rpc::JsonWriter& _w, BlockHeader const& _bi, SealEngineFace* _sealer);
+void writeJson(rpc::JsonWriter& _w, BlockHeader const& _bi, BlockDetails const& _bd,
+    h256s const& _us, Transactions const& _ts, SealEngineFace* _sealer);
+void writeJson(rpc::JsonWriter& _w, BlockHeader const& _bi, BlockDetails const& _bd,
+    h256s const& _us, h256s const& _ts, SealEngineFace* _sealer);
+void writeJson(rpc::JsonWriter& _w, LocalisedTransaction const& _t);
+void writeJson(rpc::JsonWriter& _w, LocalisedTransactionReceipt const& _t);
+void writeJson(rpc::JsonWriter& _w, LocalisedLogEntry const& _e);
+void writeJson(rpc::JsonWriter& _w, LocalisedLogEntries const& _es);
+
+}  // namespace eth
+}  // namespace dev
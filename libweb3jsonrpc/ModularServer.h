@@ -16,6 +16,11 @@
 #include <jsonrpccpp/server/iprocedureinvokationhandler.h>
 #include <jsonrpccpp/server/requesthandlerfactory.h>
 
+#include <libdevcore/Metrics.h>
+
+#include "BatchRequestHandler.h"
+#include "StreamingRequestHandler.h"
+
 template <class I> using AbstractMethodPointer = void(I::*)(Json::Value const& _parameter, Json::Value& _result);
 template <class I> using AbstractNotificationPointer = void(I::*)(Json::Value const& _parameter);
 
@@ -94,18 +99,68 @@ public:
     unsigned addConnector(jsonrpc::AbstractServerConnector* _connector)
     {
         m_connectors.emplace_back(_connector);
-        _connector->SetHandler(m_handler.get());
+        _connector->SetHandler(connectionHandler());
         return m_connectors.size() - 1;
     }
 
+    /// Executes the calls of batch requests on a pool of @a _workerThreads threads, at most
+    /// @a _maxConcurrentCalls calls of one connection at a time. The read-only calls of a batch
+    /// read the snapshot @a _captureSnapshot takes when it arrives.
+    void enableParallelBatches(unsigned _workerThreads, unsigned _maxConcurrentCalls,
+        dev::rpc::BatchRequestHandler::CaptureSnapshot _captureSnapshot = {})
+    {
+        m_batchHandler.reset(new dev::rpc::BatchRequestHandler(
+            *m_handler, _workerThreads, _maxConcurrentCalls, std::move(_captureSnapshot)));
+        updateHandlers();
+    }
+
+    /// Answers single calls of the given methods with their streaming counterparts, which write
+    /// the result without building a Json::Value. The registered methods stay the fallback.
+    void enableStreamingMethods(dev::rpc::StreamingMethods _methods)
+    {
+        m_streamingMethods = std::move(_methods);
+        updateHandlers();
+    }
+
     jsonrpc::AbstractServerConnector* connector(unsigned _i) const
     {
         return m_connectors.at(_i).get();
     }
 
 protected:
+    jsonrpc::IClientConnectionHandler* connectionHandler() const
+    {
+        if (m_streamingHandler)
+            return m_streamingHandler.get();
+        return callHandler();
+    }
+
+    /// @returns the handler of the requests not answered by streaming methods.
+    jsonrpc::IClientConnectionHandler* callHandler() const
+    {
+        if (m_batchHandler)
+            return m_batchHandler.get();
+        return m_handler.get();
+    }
+
+    void updateHandlers()
+    {
+        if (m_streamingMethods.empty())
+            m_streamingHandler.reset();
+        else
+            m_streamingHandler.reset(
+                new dev::rpc::StreamingRequestHandler(*callHandler(), m_streamingMethods));
+        for (auto const& connector: m_connectors)
+            connector->SetHandler(connectionHandler());
+    }
+
     std::vector<std::unique_ptr<jsonrpc::AbstractServerConnector>> m_connectors;
     std::unique_ptr<jsonrpc::IProtocolHandler> m_handler;
+    /// Handler of batch requests, parallel dispatch is disabled if null.
+    std::unique_ptr<dev::rpc::BatchRequestHandler> m_batchHandler;
+    dev::rpc::StreamingMethods m_streamingMethods;
+    /// Handler of the calls of streaming methods, put in front of the other handlers if not null.
+    std::unique_ptr<dev::rpc::StreamingRequestHandler> m_streamingHandler;
     /// Mapping for implemented modules, to be filled by subclasses during construction.
     Json::Value m_implementedModules;
 };
@@ -123,7 +178,10 @@ public:
             return;
         for (auto const& method: m_interface->methods())
         {
-            m_methods[std::get<0>(method).GetProcedureName()] = std::get<1>(method);
+            std::string const& name = std::get<0>(method).GetProcedureName();
+            m_methods[name] = {std::get<1>(method),
+                &dev::MetricsRegistry::instance().histogram("aleth_rpc_call_seconds",
+                    "Duration of RPC method calls.", "method=\"" + name + "\"")};
             this->m_handler->AddProcedure(std::get<0>(method));
         }
 
@@ -142,9 +200,10 @@ public:
         auto pointer = m_methods.find(_proc.GetProcedureName());
         if (pointer != m_methods.end())
         {
+            dev::ScopedMetricTimer const timer(*pointer->second.latency);
             try
             {
-                (m_interface.get()->*(pointer->second))(_input, _output);
+                (m_interface.get()->*(pointer->second.pointer))(_input, _output);
             }
             catch (Json::Exception const& ex)
             {
@@ -177,7 +236,14 @@ public:
     }
 
 private:
+    struct Method
+    {
+        MethodPointer pointer;
+        /// Durations of the calls of the method.
+        dev::MetricHistogram* latency;
+    };
+
     std::unique_ptr<I> m_interface;
-    std::map<std::string, MethodPointer> m_methods;
+    std::map<std::string, Method> m_methods;
     std::map<std::string, NotificationPointer> m_notifications;
 };
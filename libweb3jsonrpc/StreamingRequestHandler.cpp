@@ -0,0 +1,86 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "StreamingRequestHandler.h"
+
+#include <libdevcore/Log.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::rpc;
+
+StreamingRequestHandler::StreamingRequestHandler(
+    jsonrpc::IClientConnectionHandler& _next, StreamingMethods _methods)
+  : m_next(_next), m_methods(move(_methods))
+{
+    for (auto const& method : m_methods)
+    {
+        m_quotedNames.push_back('"' + method.first + '"');
+        m_latencies[method.first] = &MetricsRegistry::instance().histogram(
+            "aleth_rpc_call_seconds", "Duration of RPC method calls.",
+            "method=\"" + method.first + "\"");
+    }
+}
+
+void StreamingRequestHandler::HandleRequest(string const& _request, string& o_response)
+{
+    if (!handle(_request, o_response))
+        m_next.HandleRequest(_request, o_response);
+}
+
+bool StreamingRequestHandler::handle(string const& _request, string& o_response)
+{
+    // the requests for other methods are parsed only once, by the next handler
+    bool mentioned = false;
+    for (auto const& name : m_quotedNames)
+        if (_request.find(name) != string::npos)
+        {
+            mentioned = true;
+            break;
+        }
+    if (!mentioned)
+        return false;
+
+    Json::Value request;
+    if (!Json::Reader().parse(_request, request, false) || !request.isObject())
+        return false;
+    // notifications and malformed requests get the usual treatment
+    if (request["jsonrpc"] != "2.0" || !request.isMember("id") || !request["method"].isString())
+        return false;
+    Json::Value const& id = request["id"];
+    if (!id.isString() && !id.isIntegral() && !id.isNull())
+        return false;
+    Json::Value const& params = request["params"];
+    if (!params.isArray() && !params.isNull())
+        return false;
+    auto const method = m_methods.find(request["method"].asString());
+    if (method == m_methods.end())
+        return false;
+
+    o_response.clear();
+    JsonWriter writer(o_response);
+    writer.beginObject();
+    writer.key("id").value(id);
+    writer.key("jsonrpc").value(string("2.0"));
+    writer.key("result");
+    ScopedMetricTimer const timer(*m_latencies.at(method->first));
+    try
+    {
+        method->second(params, writer);
+    }
+    catch (std::exception const& _e)
+    {
+        clog(VerbosityTrace, "rpc") << "Streaming " << method->first << " failed: " << _e.what();
+        o_response.clear();
+        return false;
+    }
+    catch (...)
+    {
+        o_response.clear();
+        return false;
+    }
+    writer.endObject();
+    o_response += '\n';
+    return true;
+}
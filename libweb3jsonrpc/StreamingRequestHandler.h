@@ -0,0 +1,47 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// Dispatch of JSON-RPC calls to methods writing their result as JSON text.
+#pragma once
+
+#include "JsonWriter.h"
+
+#include <libdevcore/Metrics.h>
+
+#include <jsonrpccpp/server/iclientconnectionhandler.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dev
+{
+namespace rpc
+{
+/// Connection handler answering single calls of the given methods with a StreamingMethod, which
+/// writes the result into the response without building a Json::Value first. Everything else,
+/// including batches and calls whose method throws, is passed on to the next handler, which then
+/// produces the response or the error the usual way.
+class StreamingRequestHandler : public jsonrpc::IClientConnectionHandler
+{
+public:
+    StreamingRequestHandler(jsonrpc::IClientConnectionHandler& _next, StreamingMethods _methods);
+
+    void HandleRequest(std::string const& _request, std::string& o_response) override;
+
+private:
+    /// @returns true if the response has been written.
+    bool handle(std::string const& _request, std::string& o_response);
+
+    jsonrpc::IClientConnectionHandler& m_next;
+    StreamingMethods const m_methods;
+    /// Method names in quotes, to skip parsing requests for other methods.
+    std::vector<std::string> m_quotedNames;
+    /// Durations of the calls of each method.
+    std::unordered_map<std::string, MetricHistogram*> m_latencies;
+};
+
+}  // namespace rpc
+}  // namespace dev
@@ -0,0 +1,145 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include "Subscriptions.h"
+#include "JsonHelper.h"
+
+#include <libdevcore/CommonJS.h>
+#include <libethereum/ClientBase.h>
+
+#include <jsonrpccpp/common/exception.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::rpc;
+using namespace jsonrpc;
+
+namespace
+{
+/// Maximum number of subscriptions of one connection.
+size_t const c_maxSubscriptions = 1024;
+
+string notification(string const& _subscription, Json::Value _result)
+{
+    Json::Value message;
+    message["jsonrpc"] = "2.0";
+    message["method"] = "eth_subscription";
+    message["params"]["subscription"] = _subscription;
+    message["params"]["result"] = move(_result);
+    return Json::FastWriter().write(message);
+}
+}  // namespace
+
+Subscriptions::~Subscriptions()
+{
+    for (auto const& watch : m_watches)
+        m_client.uninstallWatch(watch.second);
+}
+
+bool Subscriptions::handleRequest(string const& _request, string& o_response)
+{
+    // almost all requests are for other methods, don't parse them twice
+    if (_request.find("eth_subscribe") == string::npos &&
+        _request.find("eth_unsubscribe") == string::npos)
+        return false;
+
+    Json::Value parsed;
+    if (!Json::Reader().parse(_request, parsed, false) || !parsed.isObject())
+        return false;
+    Json::Value const& request = parsed;
+    if (!request["method"].isString())
+        return false;
+    string const method = request["method"].asString();
+    if (method != "eth_subscribe" && method != "eth_unsubscribe")
+        return false;
+
+    Json::Value response;
+    response["jsonrpc"] = "2.0";
+    response["id"] = request["id"];
+    try
+    {
+        if (method == "eth_subscribe")
+            response["result"] = subscribe(request["params"]);
+        else
+            response["result"] = unsubscribe(request["params"]);
+    }
+    catch (JsonRpcException const& _e)
+    {
+        response["error"]["code"] = _e.GetCode();
+        response["error"]["message"] = _e.GetMessage();
+    }
+    catch (std::exception const& _e)
+    {
+        response["error"]["code"] = Errors::ERROR_RPC_INVALID_PARAMS;
+        response["error"]["message"] = _e.what();
+    }
+    o_response = Json::FastWriter().write(response);
+    return true;
+}
+
+string Subscriptions::subscribe(Json::Value const& _params)
+{
+    if (!_params.isArray() || _params.empty() || !_params[0].isString())
+        throw JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS, "Subscription type expected");
+    if (m_watches.size() >= c_maxSubscriptions)
+        throw JsonRpcException(Errors::ERROR_RPC_INVALID_REQUEST, "Too many subscriptions");
+
+    string const type = _params[0].asString();
+    string const id = toJS(h128::random());
+    Interface& client = m_client;
+    Send const send = m_send;
+    unsigned watch = 0;
+    if (type == "newHeads")
+        watch = client.installWatch(ChainChangedFilter, [&client, send, id](
+                                                            LocalisedLogEntries const& _changes) {
+            for (auto const& change : _changes)
+            {
+                // chain changes include the blocks that have left the canonical chain
+                h256 const& hash = change.special;
+                if (client.hashFromNumber(client.numberFromHash(hash)) == hash)
+                    send(notification(id, toJson(client.blockInfo(hash), client.sealEngine())));
+            }
+        });
+    else if (type == "newPendingTransactions" || type == "pendingTransactions")
+        watch = client.installWatch(
+            PendingChangedFilter, [send, id](LocalisedLogEntries const& _changes) {
+                for (auto const& change : _changes)
+                    send(notification(id, toJS(change.special)));
+            });
+    else if (type == "logs")
+    {
+        LogFilter const filter =
+            toLogFilter(_params.size() > 1 ? _params[1] : Json::Value(Json::objectValue), client);
+        watch = client.installWatch(filter, [send, id](LocalisedLogEntries const& _changes) {
+            for (auto const& change : _changes)
+                // logs of pending transactions are not reported
+                if (change.mined)
+                {
+                    Json::Value log = toJson(change);
+                    log["removed"] = change.polarity == BlockPolarity::Dead;
+                    send(notification(id, move(log)));
+                }
+        });
+    }
+    else
+        throw JsonRpcException(
+            Errors::ERROR_RPC_INVALID_PARAMS, "Unsupported subscription type: " + type);
+
+    m_watches[id] = watch;
+    return id;
+}
+
+bool Subscriptions::unsubscribe(Json::Value const& _params)
+{
+    if (!_params.isArray() || _params.empty() || !_params[0].isString())
+        throw JsonRpcException(Errors::ERROR_RPC_INVALID_PARAMS, "Subscription id expected");
+
+    auto const it = m_watches.find(_params[0].asString());
+    if (it == m_watches.end())
+        return false;
+    m_client.uninstallWatch(it->second);
+    m_watches.erase(it);
+    return true;
+}
@@ -0,0 +1,58 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+/// @file
+/// eth_subscribe and eth_unsubscribe for transports able to push messages to the client.
+#pragma once
+
+#include <json/json.h>
+
+#include <functional>
+#include <map>
+#include <string>
+
+namespace dev
+{
+namespace eth
+{
+class Interface;
+}
+
+namespace rpc
+{
+/// Subscriptions of a single connection. Supported subscription types are "newHeads", "logs" and
+/// "newPendingTransactions", also accepted as "pendingTransactions"; notifications are sent as
+/// soon as the client notes the change, no polling is involved. All subscriptions are cancelled when the object is destroyed.
+///
+/// The requests of one connection must be handled one at a time.
+class Subscriptions
+{
+public:
+    /// Writes the notification to the connection, must be thread-safe and must not block.
+    /// It is called after the connection is closed too, and should ignore the message then.
+    using Send = std::function<void(std::string const&)>;
+
+    Subscriptions(eth::Interface& _client, Send _send) : m_client(_client), m_send(std::move(_send))
+    {}
+    ~Subscriptions();
+
+    Subscriptions(Subscriptions const&) = delete;
+    Subscriptions& operator=(Subscriptions const&) = delete;
+
+    /// Handles a single eth_subscribe or eth_unsubscribe request.
+    /// @returns false if the request is for another method, leaving @a o_response unchanged.
+    bool handleRequest(std::string const& _request, std::string& o_response);
+
+private:
+    std::string subscribe(Json::Value const& _params);
+    bool unsubscribe(Json::Value const& _params);
+
+    eth::Interface& m_client;
+    Send const m_send;
+    /// Watch ids by subscription id.
+    std::map<std::string, unsigned> m_watches;
+};
+
+}  // namespace rpc
+}  // namespace dev
@@ -5,129 +5,323 @@
 #if !defined(_WIN32)
 
 #include "UnixSocketServer.h"
-#include <sys/socket.h>
-#include <fcntl.h>
-#include <unistd.h>
-#include <libdevcore/Guards.h>
+#include "JsonFramer.h"
+
 #include <libdevcore/FileSystem.h>
-#include <boost/filesystem/path.hpp>
-
-// "Mac OS X does not support the flag MSG_NOSIGNAL but we have an equivalent."
-// See http://lists.apple.com/archives/macnetworkprog/2002/Dec/msg00091.html
-#if defined(__APPLE__)
-	#if !defined(MSG_NOSIGNAL)
-		#define MSG_NOSIGNAL SO_NOSIGPIPE
-	#endif
-#endif
+#include <libdevcore/Log.h>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/filesystem.hpp>
+
+#include <sys/un.h>
+#include <unistd.h>
+#include <deque>
 
 using namespace std;
-using namespace jsonrpc;
 using namespace dev;
+namespace ba = boost::asio;
 namespace fs = boost::filesystem;
+using stream_protocol = ba::local::stream_protocol;
 
 namespace
 {
 size_t const c_socketPathMaxLength = sizeof(sockaddr_un::sun_path) / sizeof(sockaddr_un::sun_path[0]) - 1;
 
+/// Size of the buffer shared by all connections for reading.
+size_t const c_readBufferSize = 64 * 1024;
+/// Reading from the connection is suspended while it has this many requests waiting for execution
+/// or this many responses not yet written.
+size_t const c_maxQueuedRequests = 64;
+size_t const c_maxQueuedResponses = 64;
+/// Number of reads from a busy connection before other connections get their turn.
+unsigned const c_maxReadsPerWakeUp = 16;
+/// Connections sending a larger incomplete message are closed.
+size_t const c_maxMessageSize = 32 * 1024 * 1024;
+int const c_listenBacklog = 128;
+
 fs::path getIpcPathOrDataDir()
 {
-	// On Unix use datadir as default IPC path.
-	fs::path path = getIpcPath();
-	if (path.empty())
-		return getDataDir();
-	return path;
-}
+    // On Unix use datadir as default IPC path.
+    fs::path path = getIpcPath();
+    if (path.empty())
+        return getDataDir();
+    return path;
 }
+}  // namespace
+
+/// State of one client connection. Except for send(), accessed from the event loop thread only.
+class UnixDomainSocketServer::Connection : public enable_shared_from_this<Connection>
+{
+public:
+    Connection(UnixDomainSocketServer& _server, stream_protocol::socket _socket)
+      : m_server(_server), m_socket(move(_socket))
+    {}
+
+    void start()
+    {
+        boost::system::error_code ec;
+        // reads are attempted until the socket has no more data, without blocking the loop
+        m_socket.non_blocking(true, ec);
+        if (ec)
+            close();
+        else
+            readAvailable();
+    }
+
+    void close()
+    {
+        if (!m_socket.is_open())
+            return;
+        boost::system::error_code ec;
+        m_socket.close(ec);
+        m_server.m_connections.erase(shared_from_this());
+    }
+
+    /// Queues the response for writing. Thread-safe.
+    void send(string _response)
+    {
+        auto self = shared_from_this();
+        ba::post(m_server.m_ioContext, [self, response = move(_response)]() mutable {
+            if (!self->m_socket.is_open())
+                return;
+            self->m_responses.push_back(move(response));
+            if (self->m_responses.size() == 1)
+                self->writeNext();
+        });
+    }
+
+    void onRequestExecuted()
+    {
+        m_executing = false;
+        executeNext();
+        resumeReading();
+    }
+
+private:
+    bool canRead() const
+    {
+        return m_requests.size() < c_maxQueuedRequests && m_responses.size() < c_maxQueuedResponses;
+    }
+
+    void readAvailable()
+    {
+        auto self = shared_from_this();
+        for (unsigned i = 0; i < c_maxReadsPerWakeUp; ++i)
+        {
+            if (!m_socket.is_open())
+                return;
+            if (!canRead())
+            {
+                m_readPaused = true;
+                return;
+            }
 
-UnixDomainSocketServer::UnixDomainSocketServer(string const& _appId):
-	IpcServerBase((getIpcPathOrDataDir() / fs::path(_appId + ".ipc")).string().substr(0, c_socketPathMaxLength))
+            boost::system::error_code ec;
+            size_t const size = m_socket.read_some(ba::buffer(m_server.m_readBuffer), ec);
+            if (ec == ba::error::would_block)
+            {
+                // idle connections only have this wait pending, no buffer is allocated for them
+                m_socket.async_wait(
+                    stream_protocol::socket::wait_read, [self](boost::system::error_code _ec) {
+                        if (_ec)
+                            self->close();
+                        else
+                            self->readAvailable();
+                    });
+                return;
+            }
+            if (ec)
+            {
+                // the client has closed the connection
+                close();
+                return;
+            }
+
+            m_framer.append(m_server.m_readBuffer.data(), size);
+            string request;
+            while (m_framer.next(request))
+                m_requests.push_back(move(request));
+            if (m_framer.bufferedSize() > c_maxMessageSize)
+            {
+                clog(VerbosityWarning, "rpc") << "Closing IPC connection sending a message over "
+                                              << c_maxMessageSize << " bytes";
+                close();
+                return;
+            }
+            executeNext();
+        }
+        ba::post(m_server.m_ioContext, [self]() { self->readAvailable(); });
+    }
+
+    void resumeReading()
+    {
+        if (m_readPaused && canRead())
+        {
+            m_readPaused = false;
+            readAvailable();
+        }
+    }
+
+    /// Starts the execution of the oldest request unless a request is being executed already.
+    void executeNext()
+    {
+        if (m_executing || m_requests.empty() || !m_socket.is_open())
+            return;
+        m_executing = true;
+        m_server.execute(shared_from_this(), move(m_requests.front()));
+        m_requests.pop_front();
+    }
+
+    void writeNext()
+    {
+        auto self = shared_from_this();
+        // the response stays in the queue until written, partial writes are continued in place
+        ba::async_write(m_socket, ba::buffer(m_responses.front()),
+            [self](boost::system::error_code _ec, size_t) {
+                if (_ec)
+                {
+                    self->close();
+                    return;
+                }
+                self->m_responses.pop_front();
+                if (!self->m_responses.empty())
+                    self->writeNext();
+                self->resumeReading();
+            });
+    }
+
+    UnixDomainSocketServer& m_server;
+    stream_protocol::socket m_socket;
+    rpc::JsonFramer m_framer;
+    /// Received requests waiting for the execution of the previous one.
+    deque<string> m_requests;
+    bool m_executing = false;
+    bool m_readPaused = false;
+    /// Responses waiting to be written, the first one is being written.
+    deque<string> m_responses;
+};
+
+UnixDomainSocketServer::UnixDomainSocketServer(string const& _appId, unsigned _workerThreads)
+  : m_path((getIpcPathOrDataDir() / fs::path(_appId + ".ipc"))
+               .string()
+               .substr(0, c_socketPathMaxLength)),
+    m_workerThreads(max(_workerThreads, 1u))
 {
+    clog(VerbosityInfo, "rpc") << "JSON-RPC socket path: " << m_path;
 }
 
 UnixDomainSocketServer::~UnixDomainSocketServer()
 {
-	StopListening();
+    StopListening();
 }
 
 bool UnixDomainSocketServer::StartListening()
 {
-	if (!m_running)
-	{
-		if (access(m_path.c_str(), F_OK) != -1)
-			unlink(m_path.c_str());
-
-		if (access(m_path.c_str(), F_OK) != -1)
-			return false;
-
-		m_socket = socket(PF_UNIX, SOCK_STREAM, 0);
-		memset(&(m_address), 0, sizeof(sockaddr_un));
-		m_address.sun_family = AF_UNIX;
-#ifdef __APPLE__
-		m_address.sun_len = m_path.size() + 1;
-#endif
-		strncpy(m_address.sun_path, m_path.c_str(), c_socketPathMaxLength);
-		::bind(m_socket, reinterpret_cast<sockaddr*>(&m_address), sizeof(sockaddr_un));
-		fs::permissions(m_path, fs::owner_read | fs::owner_write);
-		listen(m_socket, 128);
-	}
-	return IpcServerBase::StartListening();
+    if (m_running.exchange(true))
+        return false;
+
+    if (access(m_path.c_str(), F_OK) != -1)
+        unlink(m_path.c_str());
+
+    m_ioContext.restart();
+    m_workerContext.restart();
+    try
+    {
+        stream_protocol::endpoint const endpoint(m_path);
+        m_acceptor.reset(new stream_protocol::acceptor(m_ioContext));
+        m_acceptor->open(endpoint.protocol());
+        m_acceptor->bind(endpoint);
+        fs::permissions(m_path, fs::owner_read | fs::owner_write);
+        m_acceptor->listen(c_listenBacklog);
+    }
+    catch (std::exception const& _e)
+    {
+        clog(VerbosityError, "rpc") << "Failed to listen on " << m_path << ": " << _e.what();
+        m_acceptor.reset();
+        m_running = false;
+        return false;
+    }
+
+    m_readBuffer.resize(c_readBufferSize);
+    accept();
+
+    m_workerGuard.reset(new ba::executor_work_guard<ba::io_context::executor_type>(
+        m_workerContext.get_executor()));
+    for (unsigned i = 0; i < m_workerThreads; ++i)
+        m_workers.emplace_back([this]() { m_workerContext.run(); });
+    m_ioThread = thread([this]() { m_ioContext.run(); });
+    return true;
 }
 
 bool UnixDomainSocketServer::StopListening()
 {
-	shutdown(m_socket, SHUT_RDWR);
-	close(m_socket);
-	m_socket = -1;
-	if (IpcServerBase::StopListening())
-	{
-		unlink(m_path.c_str());
-		return true;
-	}
-	return false;
-}
+    if (!m_running.exchange(false))
+        return false;
 
-void UnixDomainSocketServer::Listen()
-{
-	socklen_t addressLen = sizeof(m_address);
-	while (m_running)
-	{
-		int connection = accept(m_socket, (sockaddr*) &(m_address), &addressLen);
-		if (connection > 0)
-		{
-			DEV_GUARDED(x_sockets)
-				m_sockets.insert(connection);
-
-			// Handle the request in a new detached thread.
-			std::thread{[this, connection]
-			{
-				GenerateResponse(connection);
-				CloseConnection(connection);
-			}}.detach();
-		}
-	}
+    ba::post(m_ioContext, [this]() {
+        boost::system::error_code ec;
+        m_acceptor->close(ec);
+        auto const connections = move(m_connections);
+        m_connections.clear();
+        for (auto const& connection : connections)
+            connection->close();
+    });
+    // the loop exits once the cancelled operations have completed
+    m_ioThread.join();
+    m_acceptor.reset();
+
+    m_workerGuard.reset();
+    m_workerContext.stop();
+    for (auto& worker : m_workers)
+        worker.join();
+    m_workers.clear();
+
+    unlink(m_path.c_str());
+    return true;
 }
 
-void UnixDomainSocketServer::CloseConnection(int _socket)
+bool UnixDomainSocketServer::SendResponse(string const& _response, void* _addInfo)
 {
-	shutdown(_socket, SHUT_RDWR);
-	close(_socket);
+    // notifications have no response
+    if (_response.empty())
+        return true;
+    clog(VerbosityTrace, "rpc") << _response;
+    static_cast<Connection*>(_addInfo)->send(_response);
+    return true;
 }
 
-
-size_t UnixDomainSocketServer::Write(int _connection, string const& _data)
+void UnixDomainSocketServer::accept()
 {
-	ssize_t r = send(_connection, _data.data(), _data.size(), MSG_NOSIGNAL);
-	if (r < 0)
-		return 0;
-	return static_cast<size_t>(r);
+    m_acceptor->async_accept(
+        [this](boost::system::error_code const& _ec, stream_protocol::socket _socket) {
+            if (_ec == ba::error::operation_aborted || !m_acceptor->is_open())
+                return;
+            if (!_ec)
+            {
+                auto connection = make_shared<Connection>(*this, move(_socket));
+                m_connections.insert(connection);
+                connection->start();
+            }
+            accept();
+        });
 }
 
-size_t UnixDomainSocketServer::Read(int _connection, void* _data, size_t _size)
+void UnixDomainSocketServer::execute(shared_ptr<Connection> const& _connection, string _request)
 {
-	ssize_t r = read(_connection, _data, _size);
-	if (r < 0)
-		return 0;
-	return static_cast<size_t>(r);
+    ba::post(m_workerContext, [this, _connection, request = move(_request)]() {
+        clog(VerbosityTrace, "rpc") << request;
+        try
+        {
+            // the connection is kept alive until the response is sent
+            OnRequest(request, _connection.get());
+        }
+        catch (std::exception const& _e)
+        {
+            clog(VerbosityWarning, "rpc") << "Failed to handle request: " << _e.what();
+        }
+        ba::post(m_ioContext, [_connection]() { _connection->onRequestExecuted(); });
+    });
 }
 
 #endif
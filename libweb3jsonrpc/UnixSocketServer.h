@@ -3,29 +3,60 @@
 // Licensed under the GNU General Public License, Version 3.
 #pragma once
 
-#include "IpcServerBase.h"
+#include <jsonrpccpp/server/abstractserverconnector.h>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 
-#include <sys/un.h>
 #include <atomic>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
 
 namespace dev
 {
-class UnixDomainSocketServer : public IpcServerBase<int>
+/// JSON-RPC connector listening on a Unix domain socket.
+/// All connections are served by a single event loop thread (epoll on Linux, kqueue on macOS)
+/// which reads, frames requests and writes responses without blocking. Requests are executed by
+/// a fixed pool of worker threads; the requests of one connection are executed one by one in the
+/// order they were received. An idle connection costs its socket and a few bytes of state only.
+class UnixDomainSocketServer : public jsonrpc::AbstractServerConnector
 {
 public:
-    explicit UnixDomainSocketServer(std::string const& _appId);
+    /// @param _workerThreads number of threads executing the requests of all connections
+    explicit UnixDomainSocketServer(std::string const& _appId, unsigned _workerThreads = 4);
     ~UnixDomainSocketServer() override;
+
     bool StartListening() override;
     bool StopListening() override;
+    bool SendResponse(std::string const& _response, void* _addInfo = nullptr) override;
+
+private:
+    class Connection;
+
+    void accept();
+    /// Executes the request on the worker pool.
+    void execute(std::shared_ptr<Connection> const& _connection, std::string _request);
+
+    std::string const m_path;
+    unsigned const m_workerThreads;
+    std::atomic<bool> m_running{false};
 
-protected:
-    void Listen() override;
-    void CloseConnection(int _socket) override;
-    size_t Write(int _connection, std::string const& _data) override;
-    size_t Read(int _connection, void* _data, size_t _size) override;
+    /// Event loop of the acceptor and the connections.
+    boost::asio::io_context m_ioContext;
+    std::unique_ptr<boost::asio::local::stream_protocol::acceptor> m_acceptor;
+    std::thread m_ioThread;
+    /// Connections and the read buffer are accessed from the event loop thread only.
+    std::set<std::shared_ptr<Connection>> m_connections;
+    std::vector<char> m_readBuffer;
 
-    sockaddr_un m_address;
-    std::atomic<int> m_socket{0};
+    boost::asio::io_context m_workerContext;
+    std::unique_ptr<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>>
+        m_workerGuard;
+    std::vector<std::thread> m_workers;
 };
 
 }  // namespace dev
@@ -22,10 +22,10 @@ void WindowsPipeServer::CloseConnection(HANDLE _socket)
     ::CloseHandle(_socket);
 }
 
-size_t WindowsPipeServer::Write(HANDLE _connection, std::string const& _data)
+size_t WindowsPipeServer::Write(HANDLE _connection, char const* _data, size_t _size)
 {
     DWORD written = 0;
-    ::WriteFile(_connection, _data.data(), _data.size(), &written, nullptr);
+    ::WriteFile(_connection, _data, _size, &written, nullptr);
     return written;
 }
 
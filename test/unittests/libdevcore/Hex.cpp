@@ -0,0 +1,132 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/CommonJS.h>
+#include <libdevcore/Exceptions.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+using namespace dev;
+using namespace std;
+
+namespace
+{
+string referenceHex(bytes const& _data)
+{
+    ostringstream out;
+    for (byte b : _data)
+        out << "0123456789abcdef"[b >> 4] << "0123456789abcdef"[b & 0xf];
+    return out.str();
+}
+
+bytes randomBytes(size_t _size, mt19937& _engine)
+{
+    uniform_int_distribution<int> byteDistribution(0, 255);
+    bytes ret(_size);
+    for (auto& b : ret)
+        b = static_cast<byte>(byteDistribution(_engine));
+    return ret;
+}
+
+template <class F>
+void benchmark(char const* _name, size_t _iterations, F const& _f)
+{
+    auto const start = chrono::steady_clock::now();
+    for (size_t i = 0; i < _iterations; ++i)
+        _f();
+    auto const elapsed = chrono::steady_clock::now() - start;
+    cout << _name << ": "
+         << chrono::duration_cast<chrono::nanoseconds>(elapsed).count() / _iterations
+         << " ns\n";
+}
+}  // namespace
+
+TEST(Hex, encodeDecodeAllLengths)
+{
+    mt19937 engine;
+    for (size_t size = 0; size < 100; ++size)
+    {
+        bytes const data = randomBytes(size, engine);
+        string const hex = referenceHex(data);
+        EXPECT_EQ(toHex(data), hex);
+        EXPECT_EQ(toHex(bytesConstRef(&data)), hex);
+        EXPECT_EQ(toHexPrefixed(data), "0x" + hex);
+        EXPECT_EQ(fromHex(hex), data);
+        EXPECT_EQ(fromHex("0x" + hex), data);
+
+        string upper = hex;
+        transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        EXPECT_EQ(fromHex(upper), data);
+
+        string appended = "0x";
+        appendHex(appended, &data);
+        EXPECT_EQ(appended, "0x" + hex);
+    }
+}
+
+TEST(Hex, invalidCharacters)
+{
+    string const hex(64, 'a');
+    for (size_t i = 0; i < hex.size(); ++i)
+        for (char c : {'g', 'G', '/', ':', '@', '`', ' ', '\0', '\xff'})
+        {
+            string invalid = hex;
+            invalid[i] = c;
+            EXPECT_EQ(fromHex(invalid), bytes());
+            EXPECT_THROW(fromHex(invalid, WhenError::Throw), BadHexCharacter);
+            EXPECT_FALSE(isHex(invalid));
+        }
+    EXPECT_EQ(fromHex("abc"), bytes({0x0a, 0xbc}));
+    EXPECT_EQ(fromHex("xbc"), bytes());
+}
+
+TEST(Hex, quantities)
+{
+    EXPECT_EQ(toJS(u256(0)), "0x0");
+    EXPECT_EQ(toJS(u256(15)), "0xf");
+    EXPECT_EQ(toJS(u256(16)), "0x10");
+    EXPECT_EQ(toJS(u256("0x10000000000000000")), "0x10000000000000000");
+    EXPECT_EQ(toJS(u256("0x123456789abcdef0123456789")), "0x123456789abcdef0123456789");
+    EXPECT_EQ(toJS(~u256(0)), "0x" + string(64, 'f'));
+    EXPECT_EQ(toJS(0), "0x0");
+    EXPECT_EQ(toJS(-1), "0xffffffff");
+    EXPECT_EQ(toJS(int64_t(-2)), "0xfffffffffffffffe");
+    EXPECT_EQ(toJS(uint64_t(0x1000)), "0x1000");
+
+    EXPECT_EQ(toCompactHexPrefixed(0, 1), "0x00");
+    EXPECT_EQ(toCompactHexPrefixed(0), "0x");
+    EXPECT_EQ(toCompactHexPrefixed(0xabc, 1), "0x0abc");
+    EXPECT_EQ(toCompactHexPrefixed(0xabc, 4), "0x00000abc");
+    EXPECT_EQ(toCompactHex(u256("0x10000000000000000"), 1), "010000000000000000");
+
+    EXPECT_EQ(toJS(bytes{1, 2}, 4), "0x01020000");
+    EXPECT_EQ(jsToFixed<4>("0x0102abCD"), FixedHash<4>(bytes({1, 2, 0xab, 0xcd})));
+    EXPECT_EQ(jsToFixed<4>("0x0102abcd00"), FixedHash<4>(bytes({2, 0xab, 0xcd, 0})));
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST(Hex, DISABLED_benchmark)
+{
+    mt19937 engine;
+    bytes const hash = randomBytes(32, engine);
+    bytes const memory = randomBytes(1024, engine);
+    string const hashHex = toHexPrefixed(hash);
+    string const memoryHex = toHex(memory);
+    u256 const value = u256(0x5208);
+    size_t const iterations = 1000000;
+
+    benchmark("toHex 32 bytes", iterations, [&] { toHex(hash); });
+    benchmark("toHex 1024 bytes", iterations / 10, [&] { toHex(memory); });
+    benchmark("fromHex 32 bytes", iterations, [&] { fromHex(hashHex); });
+    benchmark("fromHex 1024 bytes", iterations / 10, [&] { fromHex(memoryHex); });
+    benchmark("jsToFixed<32>", iterations, [&] { jsToFixed<32>(hashHex); });
+    benchmark("toJS(u256)", iterations, [&] { toJS(value); });
+    benchmark("toJS(unsigned)", iterations, [&] { toJS(21000u); });
+    benchmark("toCompactHexPrefixed", iterations, [&] { toCompactHexPrefixed(value, 1); });
+}
@@ -79,6 +79,25 @@ TEST(LruCache, BasicOperations)
     }
 }
 
+TEST(LruCache, Find)
+{
+    LRU lruCache{c_capacity};
+    VEC testData = Populate(lruCache, lruCache.capacity());
+    int missing = 0;
+    while (lruCache.contains(missing))
+        ++missing;
+    EXPECT_EQ(lruCache.find(missing), nullptr);
+
+    // finding the least recently used element makes it the most recently used
+    PAIR const oldest = testData.back();
+    auto const value = lruCache.find(oldest.first);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(*value, oldest.second);
+    testData.pop_back();
+    testData.insert(testData.begin(), oldest);
+    VerifyEquals(lruCache, testData);
+}
+
 TEST(LruCache, AdvancedOperations)
 {
     LRU lruCache{c_capacity};
@@ -0,0 +1,113 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/Metrics.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace std;
+using namespace dev;
+
+TEST(MetricHistogram, buckets)
+{
+    for (uint64_t v = 0; v < 8; ++v)
+        EXPECT_EQ(MetricHistogram::bucket(v), v);
+    EXPECT_EQ(MetricHistogram::bucket(8), 8);
+    EXPECT_EQ(MetricHistogram::bucket(15), 15);
+    EXPECT_EQ(MetricHistogram::bucket(16), 16);
+    EXPECT_EQ(MetricHistogram::bucket(17), 16);
+    EXPECT_EQ(MetricHistogram::bucket(numeric_limits<uint64_t>::max()), MetricHistogram::c_buckets - 1);
+
+    for (unsigned i = 0; i < MetricHistogram::c_buckets; ++i)
+    {
+        uint64_t const upper = MetricHistogram::bucketUpperBound(i);
+        EXPECT_EQ(MetricHistogram::bucket(upper), i);
+        if (i + 1 < MetricHistogram::c_buckets)
+        {
+            EXPECT_EQ(MetricHistogram::bucket(upper + 1), i + 1);
+        }
+    }
+}
+
+TEST(MetricHistogram, quantiles)
+{
+    MetricHistogram histogram;
+    EXPECT_EQ(histogram.quantileSeconds(0.5), 0);
+
+    for (uint64_t v = 1; v <= 1000; ++v)
+        histogram.record(v * 1000);
+    EXPECT_EQ(histogram.count(), 1000);
+    EXPECT_DOUBLE_EQ(histogram.sumSeconds(), 500.5);
+
+    // the error is bounded by the width of the buckets
+    EXPECT_NEAR(histogram.quantileSeconds(0.5), 0.5, 0.5 / MetricHistogram::c_subBuckets);
+    EXPECT_NEAR(histogram.quantileSeconds(0.99), 0.99, 0.99 / MetricHistogram::c_subBuckets);
+    EXPECT_GE(histogram.quantileSeconds(1), 1);
+}
+
+TEST(MetricHistogram, concurrentRecords)
+{
+    MetricHistogram histogram;
+    vector<thread> threads;
+    for (int t = 0; t < 4; ++t)
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 10000; ++i)
+                histogram.recordSeconds(0.001);
+        });
+    for (auto& t : threads)
+        t.join();
+    EXPECT_EQ(histogram.count(), 40000);
+    EXPECT_NEAR(histogram.sumSeconds(), 40, 1e-9);
+}
+
+TEST(MetricsRegistry, sameMetricForSameNameAndLabels)
+{
+    auto& registry = MetricsRegistry::instance();
+    MetricCounter& a = registry.counter("test_same_total", "Help.", "x=\"1\"");
+    MetricCounter& b = registry.counter("test_same_total", "Help.", "x=\"1\"");
+    MetricCounter& c = registry.counter("test_same_total", "Help.", "x=\"2\"");
+    EXPECT_EQ(&a, &b);
+    EXPECT_NE(&a, &c);
+}
+
+TEST(MetricsRegistry, exposition)
+{
+    auto& registry = MetricsRegistry::instance();
+    registry.counter("test_exposition_total", "Events.").inc(3);
+    registry.histogram("test_exposition_seconds", "Durations.", "stage=\"a\"").record(2000);
+
+    int collected = 0;
+    int const owner = 0;
+    registry.addCollector(&owner, [&]() {
+        registry.gauge("test_exposition_size", "Size.").set(++collected);
+    });
+
+    string const text = registry.exposition();
+    EXPECT_NE(text.find("# HELP test_exposition_total Events.\n"), string::npos);
+    EXPECT_NE(text.find("# TYPE test_exposition_total counter\ntest_exposition_total 3\n"),
+        string::npos);
+    EXPECT_NE(text.find("# TYPE test_exposition_size gauge\ntest_exposition_size 1\n"),
+        string::npos);
+    EXPECT_NE(text.find("# TYPE test_exposition_seconds summary\n"), string::npos);
+    // quantiles are reported as the upper bound of their bucket, 1792..2047 for 2000
+    EXPECT_NE(text.find("test_exposition_seconds{stage=\"a\",quantile=\"0.5\"} 0.002047\n"),
+        string::npos);
+    EXPECT_NE(text.find("test_exposition_seconds_sum{stage=\"a\"} 0.002\n"), string::npos);
+    EXPECT_NE(text.find("test_exposition_seconds_count{stage=\"a\"} 1\n"), string::npos);
+
+    registry.removeCollector(&owner);
+    registry.exposition();
+    EXPECT_EQ(collected, 1);
+
+    bool found = false;
+    for (auto const& v : registry.values())
+        if (v.first == "test_exposition_total")
+        {
+            EXPECT_EQ(v.second, 3);
+            found = true;
+        }
+    EXPECT_TRUE(found);
+}
@@ -0,0 +1,98 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/PerThreadQueue.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace std;
+using namespace dev;
+
+TEST(PerThreadQueue, popsInPushOrderAcrossThreads)
+{
+    PerThreadQueue<int> queue(16);
+    // the threads push one after another, so the sequence numbers order all values
+    thread([&]() {
+        for (int i = 0; i < 4; ++i)
+            EXPECT_TRUE(queue.push(i));
+    }).join();
+    thread([&]() {
+        for (int i = 4; i < 8; ++i)
+            EXPECT_TRUE(queue.push(i));
+    }).join();
+    EXPECT_TRUE(queue.push(8));
+
+    int value = -1;
+    for (int i = 0; i <= 8; ++i)
+    {
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(PerThreadQueue, keepsOrderOfEachProducer)
+{
+    PerThreadQueue<int> queue(64);
+    int const count = 10000;
+    auto const produce = [&](int _first) {
+        for (int i = _first; i < _first + count; ++i)
+            while (!queue.push(i))
+                this_thread::yield();
+    };
+    thread first(produce, 0);
+    thread second(produce, count);
+
+    int nextFirst = 0;
+    int nextSecond = count;
+    int value = -1;
+    while (nextFirst < count || nextSecond < 2 * count)
+    {
+        if (!queue.pop(value))
+            continue;
+        if (value < count)
+            EXPECT_EQ(value, nextFirst++);
+        else
+            EXPECT_EQ(value, nextSecond++);
+    }
+    first.join();
+    second.join();
+    EXPECT_FALSE(queue.pop(value));
+}
+
+TEST(PerThreadQueue, countsDroppedValues)
+{
+    PerThreadQueue<int> queue(4);
+    for (int i = 0; i < 6; ++i)
+        EXPECT_EQ(queue.push(i), i < 4);
+    EXPECT_EQ(queue.dropped(), 2);
+
+    // the buffer of another thread is not full
+    thread([&]() { EXPECT_TRUE(queue.push(6)); }).join();
+    EXPECT_EQ(queue.dropped(), 2);
+
+    int value = -1;
+    for (int expected : {0, 1, 2, 3, 6})
+    {
+        ASSERT_TRUE(queue.pop(value));
+        EXPECT_EQ(value, expected);
+    }
+    EXPECT_TRUE(queue.push(7));
+    EXPECT_EQ(queue.dropped(), 2);
+}
+
+TEST(PerThreadQueue, releasesBuffersOfExitedThreads)
+{
+    PerThreadQueue<int> queue(4);
+    thread([&]() { queue.push(1); }).join();
+    EXPECT_EQ(queue.threadCount(), 1);
+
+    int value = -1;
+    EXPECT_TRUE(queue.pop(value));
+    EXPECT_FALSE(queue.pop(value));
+    EXPECT_EQ(queue.threadCount(), 0);
+}
@@ -0,0 +1,67 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/RingBuffer.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace std;
+using namespace dev;
+
+TEST(SpscRingBuffer, capacityRoundedUp)
+{
+    SpscRingBuffer<int> buffer(5);
+    EXPECT_EQ(buffer.capacity(), 8);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(SpscRingBuffer, pushPop)
+{
+    SpscRingBuffer<int> buffer(4);
+    for (int i = 0; i < 4; ++i)
+        EXPECT_TRUE(buffer.push(i));
+    EXPECT_FALSE(buffer.push(4));
+
+    ASSERT_TRUE(buffer.front());
+    EXPECT_EQ(*buffer.front(), 0);
+
+    int value = -1;
+    EXPECT_TRUE(buffer.pop(value));
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(buffer.push(4));
+
+    for (int i = 1; i <= 4; ++i)
+    {
+        EXPECT_TRUE(buffer.pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(buffer.pop(value));
+    EXPECT_EQ(buffer.front(), nullptr);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(SpscRingBuffer, concurrentProducer)
+{
+    int const count = 100000;
+    SpscRingBuffer<int> buffer(64);
+    thread producer([&]() {
+        for (int i = 0; i < count; ++i)
+            while (!buffer.push(i))
+                this_thread::yield();
+    });
+
+    int expected = 0;
+    while (expected < count)
+    {
+        int value;
+        if (buffer.pop(value))
+            ASSERT_EQ(value, expected++);
+        else
+            this_thread::yield();
+    }
+    producer.join();
+    EXPECT_TRUE(buffer.empty());
+}
@@ -0,0 +1,43 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libethashseal/EpochContextCache.h>
+
+#include <gtest/gtest.h>
+
+using namespace dev;
+using namespace dev::eth;
+
+TEST(EpochContextCache, contextIsBuiltOnce)
+{
+    EpochContextCache cache;
+    auto const context = cache.context(0);
+    ASSERT_NE(context, nullptr);
+    EXPECT_EQ(context->epoch_number, 0);
+    EXPECT_EQ(cache.context(0), context);
+}
+
+TEST(EpochContextCache, leastRecentlyUsedIsEvicted)
+{
+    EpochContextCache cache(1);
+    auto const first = cache.context(0);
+    cache.context(1);
+    EXPECT_FALSE(cache.contains(0));
+    EXPECT_TRUE(cache.contains(1));
+
+    // Contexts in use outlive their eviction.
+    EXPECT_EQ(first->epoch_number, 0);
+}
+
+TEST(EpochContextCache, nextEpochIsPrewarmedNearTheBoundary)
+{
+    EpochContextCache cache;
+    cache.noteBlock(ethash::epoch_length - EpochContextCache::c_prewarmDistance - 1);
+    EXPECT_FALSE(cache.contains(1));
+
+    cache.noteBlock(ethash::epoch_length - EpochContextCache::c_prewarmDistance);
+    EXPECT_TRUE(cache.contains(1));
+    cache.wait();
+    EXPECT_EQ(cache.context(1)->epoch_number, 1);
+}
@@ -7,6 +7,7 @@
 #include <libethereum/Block.h>
 #include <libethereum/BlockChain.h>
 #include <libdevcore/DBFactory.h>
+#include <libdevcore/TrieDB.h>
 #include <test/tools/libtesteth/TestHelper.h>
 #include <test/tools/libtesteth/BlockChainHelper.h>
 #include <libethereum/GenesisInfo.h>
@@ -19,6 +20,41 @@ using namespace dev::eth;
 using namespace dev::test;
 namespace utf = boost::unit_test;
 
+namespace
+{
+/// Reads every node of the trie with the root @a _root, throwing if one is missing, and calls
+/// @a _onLeaf with the value of every leaf.
+void walkTrie(OverlayDB& _db, h256 const& _root,
+    std::function<void(bytesConstRef)> const& _onLeaf = std::function<void(bytesConstRef)>())
+{
+    if (_root == EmptyTrie)
+        return;
+    GenericTrieDB<OverlayDB> trie(&_db, _root);
+    h256Hash unvisited;
+    trie.descendKey(_root, unvisited, false, nullptr);
+    if (_onLeaf)
+        for (auto const& leaf : trie)
+            _onLeaf(leaf.second);
+}
+
+/// Checks that the accounts of the state @a _root, their storage and their code can be read.
+void checkStateReadable(OverlayDB _db, h256 const& _root)
+{
+    walkTrie(_db, _root, [&](bytesConstRef _account) {
+        RLP const account(_account);
+        walkTrie(_db, account[2].toHash<h256>());
+        h256 const codeHash = account[3].toHash<h256>();
+        BOOST_CHECK(codeHash == EmptySHA3 || _db.exists(codeHash));
+    });
+}
+
+RLP accountAt(OverlayDB& _db, h256 const& _root, Address const& _address, string& o_account)
+{
+    o_account = SecureTrieDB<Address, OverlayDB>(&_db, _root).at(_address);
+    return RLP(o_account);
+}
+}  // namespace
+
 BOOST_FIXTURE_TEST_SUITE(BlockChainFrontierSuite, FrontierNoProofTestFixture)
 
 BOOST_AUTO_TEST_CASE(output)
@@ -55,6 +91,146 @@ BOOST_AUTO_TEST_CASE(opendb)
     setDatabaseKind(preDatabaseKind);
 }
 
+BOOST_AUTO_TEST_CASE(rebuildResumesAfterInterruption)
+{
+    TestBlock genesis = TestBlockChain::defaultGenesisBlock();
+    TestBlockChain source(genesis);
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        TestBlock block;
+        block.mine(source);
+        source.addBlock(block);
+    }
+
+    auto const preDatabaseKind = databaseKind();
+    setDatabaseKind(DatabaseKind::LevelDB);
+    {
+        TransientDirectory tempDirBlockchain;
+        ChainParams p(genesisInfo(TestBlockChain::s_sealEngineNetwork), genesis.bytes(),
+            genesis.accountMap());
+        BlockChain bc(p, tempDirBlockchain.path(), WithExisting::Kill);
+        {
+            Block s = bc.genesisBlock(
+                State::openDB(tempDirBlockchain.path(), bc.genesisHash(), WithExisting::Kill));
+            for (unsigned i = 1; i <= 3; ++i)
+                bc.import(source.getInterface().block(source.getInterface().numberHash(i)), s.db());
+        }
+        BOOST_REQUIRE_EQUAL(bc.number(), 3);
+
+        auto const interrupt = [](unsigned _done, unsigned) {
+            if (_done == 2)
+                throw std::runtime_error("interrupted");
+        };
+        BOOST_CHECK_THROW(bc.rebuild(tempDirBlockchain.path(), interrupt), DatabaseRebuildFailed);
+        BOOST_CHECK_EQUAL(bc.number(), 2);
+
+        vector<unsigned> resumed;
+        bc.rebuild(tempDirBlockchain.path(),
+            [&](unsigned _done, unsigned) { resumed.push_back(_done); });
+        BOOST_CHECK(resumed == vector<unsigned>{3});
+        BOOST_CHECK_EQUAL(bc.number(), 3);
+        BOOST_CHECK_EQUAL(bc.currentHash(), source.getInterface().currentHash());
+    }
+    setDatabaseKind(preDatabaseKind);
+}
+
+BOOST_AUTO_TEST_CASE(pruneStateKeepsHistory)
+{
+    // stores the first word of the call data in the slot of the second one, selfdestructs without
+    // call data
+    Address const contract("095e7baea6a6c7c4c2dfeb977efac326af552d87");
+    bytes const code = fromHex("3615600d5760003560203555005b33ff");
+    json_spirit::mObject contractObj;
+    contractObj["balance"] = "0";
+    contractObj["nonce"] = "0";
+    contractObj["code"] = toHexPrefixed(code);
+    json_spirit::mObject storage;
+    for (unsigned slot = 1; slot <= 3; ++slot)
+        storage[toCompactHexPrefixed(slot, 1)] = toCompactHexPrefixed(slot, 1);
+    contractObj["storage"] = storage;
+    json_spirit::mObject senderObj;
+    senderObj["balance"] = "10000000000";
+    senderObj["nonce"] = "1";
+    senderObj["code"] = "";
+    senderObj["storage"] = json_spirit::mObject();
+    json_spirit::mObject accounts;
+    accounts["a94f5374fce5edbc8e2a8697c15331677e6ebf0b"] = senderObj;
+    accounts[contract.hex()] = contractObj;
+    TestBlock const genesis(TestBlockChain::defaultGenesisBlockJson(), accounts);
+    TestBlock const forkGenesis(TestBlockChain::defaultGenesisBlockJson(), accounts);
+
+    // every block changes a slot, the fourth one clears it
+    TestBlockChain source(genesis);
+    vector<TestBlock> blocks;
+    for (unsigned n = 1; n <= 6; ++n)
+    {
+        TestBlock block;
+        block.addTransaction(TestTransaction::defaultTransaction(n, 1, 100000,
+            h256(n == 4 ? 0 : n * 7).asBytes() + h256(n % 3 + 1).asBytes()));
+        block.mine(source);
+        BOOST_REQUIRE(source.addBlock(block));
+        blocks.push_back(block);
+    }
+
+    // a longer fork from block 4 which selfdestructs the contract
+    TestBlockChain fork(forkGenesis);
+    for (unsigned n = 1; n <= 4; ++n)
+        BOOST_REQUIRE(fork.addBlock(blocks[n - 1]));
+    vector<TestBlock> forkBlocks;
+    for (unsigned n = 5; n <= 9; ++n)
+    {
+        TestBlock block;
+        if (n == 5)
+            block.addTransaction(TestTransaction::defaultTransaction(n, 1, 100000));
+        block.mine(fork);
+        BOOST_REQUIRE(fork.addBlock(block));
+        forkBlocks.push_back(block);
+    }
+
+    unsigned const history = 2;
+    setStatePruningHistory(history);
+    {
+        TransientDirectory tempDirBlockchain;
+        ChainParams p(genesisInfo(TestBlockChain::s_sealEngineNetwork), genesis.bytes(),
+            genesis.accountMap());
+        BlockChain bc(p, tempDirBlockchain.path(), WithExisting::Kill);
+        Block s = bc.genesisBlock(
+            State::openDB(tempDirBlockchain.path(), bc.genesisHash(), WithExisting::Kill));
+        OverlayDB db = s.db();
+        BOOST_REQUIRE(db.refCounting());
+
+        auto const import = [&](TestBlock const& _block) {
+            bc.import(_block.bytes(), s.db());
+            for (unsigned n = bc.number() > history ? bc.number() - history : 0; n <= bc.number();
+                 ++n)
+                BOOST_CHECK_NO_THROW(checkStateReadable(db, bc.info(bc.numberHash(n)).stateRoot()));
+        };
+
+        for (auto const& block : blocks)
+            import(block);
+        BOOST_REQUIRE_EQUAL(bc.number(), 6);
+
+        string account;
+        h256 const storageRoot = accountAt(db, bc.info(bc.numberHash(4)).stateRoot(), contract,
+            account)[2].toHash<h256>();
+        BOOST_REQUIRE(db.exists(storageRoot));
+        BOOST_REQUIRE(db.exists(sha3(code)));
+
+        for (auto const& block : forkBlocks)
+            import(block);
+        BOOST_REQUIRE_EQUAL(bc.currentHash(), fork.getInterface().currentHash());
+        BOOST_CHECK(accountAt(db, bc.info().stateRoot(), contract, account).isNull());
+
+        // the storage and code of the contract were only referenced by the pruned states
+        BOOST_CHECK(!db.exists(storageRoot));
+        BOOST_CHECK(!db.exists(sha3(code)));
+
+        BOOST_CHECK_THROW(bc.rewind(bc.number() - history - 1), StateAlreadyPruned);
+        BOOST_CHECK_EQUAL(bc.number(), 9);
+    }
+    setStatePruningHistory(0);
+}
+
 BOOST_AUTO_TEST_CASE(Mining_1_mineBlockWithTransaction)
 {
     TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
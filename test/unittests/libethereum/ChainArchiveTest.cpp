@@ -0,0 +1,83 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/CommonIO.h>
+#include <libdevcore/TransientDirectory.h>
+#include <libethereum/BlockChain.h>
+#include <libethereum/ChainArchive.h>
+#include <test/tools/libtesteth/BlockChainHelper.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+#include <boost/filesystem/operations.hpp>
+
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+class ChainArchiveTestFixture : public FrontierNoProofTestFixture
+{
+public:
+    ChainArchiveTestFixture()
+      : exported(TestBlockChain::defaultGenesisBlock()),
+        imported(TestBlockChain::defaultGenesisBlock())
+    {
+        for (unsigned i = 0; i < 5; ++i)
+        {
+            TestBlock block;
+            block.mine(exported);
+            exported.addBlock(block);
+        }
+    }
+
+    unsigned importArchive(ChainArchive const& _archive)
+    {
+        BlockChain& bc = imported.interfaceUnsafe();
+        OverlayDB const& stateDB = imported.testGenesis().state().db();
+        return _archive.importBlocks(bc, archiveDir.path(),
+            [&](VerifiedBlocks const& _blocks) { return std::get<1>(bc.sync(_blocks, stateDB)); });
+    }
+
+    TestBlockChain exported;
+    TestBlockChain imported;
+    TransientDirectory archiveDir;
+};
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(ChainArchiveSuite, ChainArchiveTestFixture)
+
+BOOST_AUTO_TEST_CASE(ChainArchiveSuite_roundTrip)
+{
+    ChainArchive const archive(2, 2);
+    std::vector<unsigned> progress;
+    archive.exportBlocks(exported.getInterface(), 1, 5, archiveDir.path(),
+        [&](unsigned _done, unsigned) { progress.push_back(_done); });
+    BOOST_CHECK(progress == (std::vector<unsigned>{2, 4, 5}));
+
+    BOOST_CHECK_EQUAL(importArchive(archive), 5);
+    BOOST_CHECK_EQUAL(imported.getInterface().number(), 5);
+    BOOST_CHECK_EQUAL(imported.getInterface().currentHash(), exported.getInterface().currentHash());
+
+    // the blocks are known now
+    BOOST_CHECK_EQUAL(importArchive(archive), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ChainArchiveSuite_corruptedSegment)
+{
+    ChainArchive const archive(2, 2);
+    archive.exportBlocks(exported.getInterface(), 1, 5, archiveDir.path());
+
+    writeFile(archiveDir.path() + "/0000000003.blocks", bytes{1, 2, 3});
+    BOOST_CHECK_THROW(importArchive(archive), ChainArchiveSegmentCorrupted);
+    // the segment before the corrupted one is imported
+    BOOST_CHECK_EQUAL(imported.getInterface().number(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(ChainArchiveSuite_missingIndex)
+{
+    BOOST_CHECK_THROW(importArchive(ChainArchive{}), FailedToReadChainArchiveIndex);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,6 +5,7 @@
 #include <boost/test/unit_test.hpp>
 #include <libdevcore/CommonJS.h>
 #include <libethashseal/Ethash.h>
+#include <test/tools/libtesteth/BlockChainHelper.h>
 #include <test/tools/libtesteth/TestOutputHelper.h>
 #include <test/tools/libtesteth/TestUtils.h>
 #include <test/tools/libtestutils/FixedClient.h>
@@ -205,3 +206,112 @@ BOOST_AUTO_TEST_CASE(blocks)
 }
 
 BOOST_AUTO_TEST_SUITE_END()
+
+namespace
+{
+Address const c_sender("a94f5374fce5edbc8e2a8697c15331677e6ebf0b");
+// clears slot 0
+Address const c_refund{0x100};
+// stores 1 in slot 0
+Address const c_store{0x101};
+// calls c_store with all the gas left, jumps to a bad destination if the call fails
+Address const c_forward{0x102};
+// jumps to a bad destination
+Address const c_fail{0x103};
+
+class EstimateGasFixture : public ByzantiumTestFixture
+{
+public:
+    EstimateGasFixture()
+      : genesis(TestBlockChain::defaultGenesisBlockJson(), accounts()),
+        bc(genesis),
+        client(bc.getInterface(), bc.getInterface().genesisBlock(genesis.state().db()))
+    {}
+
+    /// Estimates the gas of a call of @a _dest, counting the executions of the call in
+    /// o_executions.
+    pair<u256, ExecutionResult> estimate(
+        Address const& _dest, u256 const& _value, int64_t _maxGas, unsigned& o_executions)
+    {
+        o_executions = 0;
+        return client.estimateGas(c_sender, _value, _dest, {}, _maxGas, 1, PendingBlock,
+            [&](GasEstimationProgress const&) { ++o_executions; });
+    }
+
+    TestBlock genesis;
+    TestBlockChain bc;
+    FixedClient client;
+
+private:
+    static json_spirit::mObject accounts()
+    {
+        json_spirit::mObject ret;
+        auto const add = [&](Address const& _address, string const& _code,
+                             json_spirit::mObject const& _storage) {
+            json_spirit::mObject account;
+            account["balance"] = "10000000000";
+            account["nonce"] = "0";
+            account["code"] = _code.empty() ? "" : "0x" + _code;
+            account["storage"] = _storage;
+            ret[_address.hex()] = account;
+        };
+        json_spirit::mObject storage;
+        storage["0x00"] = "0x01";
+        add(c_sender, "", {});
+        add(c_refund, "600060005500", storage);
+        add(c_store, "600160005500", {});
+        add(c_forward, "6000600060006000600073" + c_store.hex() + "5af16027576000565b00", {});
+        add(c_fail, "600056", {});
+        return ret;
+    }
+};
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(ClientBaseEstimateGas, EstimateGasFixture)
+
+BOOST_AUTO_TEST_CASE(transfer)
+{
+    unsigned executions;
+    auto const result = estimate(Address{0x200}, 1, 1000000, executions);
+    BOOST_CHECK_EQUAL(result.first, 21000);
+    BOOST_CHECK(result.second.excepted == TransactionException::None);
+    BOOST_CHECK_LE(executions, 2);
+}
+
+BOOST_AUTO_TEST_CASE(refund)
+{
+    // 21000 + 6 + 5000 are needed, half of which is refunded afterwards
+    unsigned executions;
+    auto const result = estimate(c_refund, 0, 1000000, executions);
+    BOOST_CHECK_EQUAL(result.first, 26006);
+    BOOST_CHECK_EQUAL(result.second.gasUsed, 13003);
+    BOOST_CHECK(result.second.excepted == TransactionException::None);
+    BOOST_CHECK_LE(executions, 3);
+}
+
+BOOST_AUTO_TEST_CASE(callHeadroom)
+{
+    unsigned executions;
+    auto const result = estimate(c_forward, 0, 1000000, executions);
+    BOOST_CHECK(result.second.excepted == TransactionException::None);
+    // more than the peak is needed, as the call gets only 63/64 of the gas left
+    BOOST_CHECK_GT(result.first, result.second.gasUsed);
+    // the window above the peak is searched instead of the range from the intrinsic gas to the cap
+    BOOST_CHECK_LE(executions, 14);
+
+    // the estimate is the least gas which is enough
+    auto const less = estimate(c_forward, 0, static_cast<int64_t>(result.first) - 1, executions);
+    BOOST_CHECK(less.second.excepted == TransactionException::BadJumpDestination);
+    BOOST_CHECK_EQUAL(executions, 1);
+}
+
+BOOST_AUTO_TEST_CASE(failsAtCap)
+{
+    unsigned executions;
+    auto const result = estimate(c_fail, 0, 1000000, executions);
+    BOOST_CHECK_EQUAL(result.first, 1000000);
+    BOOST_CHECK(result.second.excepted == TransactionException::BadJumpDestination);
+    BOOST_CHECK_EQUAL(executions, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
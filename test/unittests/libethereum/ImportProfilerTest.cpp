@@ -0,0 +1,161 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libethereum/ImportPerformanceLogger.h>
+#include <libethereum/ImportProfiler.h>
+#include <test/tools/libtesteth/BlockChainHelper.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+#include <thread>
+
+using namespace std;
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+BOOST_FIXTURE_TEST_SUITE(ImportProfilerSuite, FrontierNoProofTestFixture)
+
+BOOST_AUTO_TEST_CASE(opcodeCategories)
+{
+    BOOST_CHECK(opcodeCategory(Instruction::ADD) == OpcodeCategory::Arithmetic);
+    BOOST_CHECK(opcodeCategory(Instruction::SHR) == OpcodeCategory::Bitwise);
+    BOOST_CHECK(opcodeCategory(Instruction::SHA3) == OpcodeCategory::Hashing);
+    BOOST_CHECK(opcodeCategory(Instruction::CALLER) == OpcodeCategory::Environment);
+    BOOST_CHECK(opcodeCategory(Instruction::GAS) == OpcodeCategory::Environment);
+    BOOST_CHECK(opcodeCategory(Instruction::NUMBER) == OpcodeCategory::Block);
+    BOOST_CHECK(opcodeCategory(Instruction::PUSH1) == OpcodeCategory::Stack);
+    BOOST_CHECK(opcodeCategory(Instruction::SWAP16) == OpcodeCategory::Stack);
+    BOOST_CHECK(opcodeCategory(Instruction::POP) == OpcodeCategory::Stack);
+    BOOST_CHECK(opcodeCategory(Instruction::MSTORE) == OpcodeCategory::Memory);
+    BOOST_CHECK(opcodeCategory(Instruction::SSTORE) == OpcodeCategory::Storage);
+    BOOST_CHECK(opcodeCategory(Instruction::JUMPI) == OpcodeCategory::Flow);
+    BOOST_CHECK(opcodeCategory(Instruction::LOG4) == OpcodeCategory::Logging);
+    BOOST_CHECK(opcodeCategory(Instruction::CALL) == OpcodeCategory::System);
+    BOOST_CHECK_EQUAL(opcodeCategoryName(OpcodeCategory::Storage), string("storage"));
+}
+
+BOOST_AUTO_TEST_CASE(stageNames)
+{
+    BOOST_CHECK_EQUAL(importStageName(ImportStage::Verify), string("verify"));
+    BOOST_CHECK_EQUAL(importStageName(ImportStage::ExtrasWrite), string("extrasWrite"));
+    BOOST_CHECK_EQUAL(importPartName(ImportPart::StateCommit), string("stateCommit"));
+
+    // the histograms are resolved once and shared by the profilers
+    ImportProfiler profiler;
+    BOOST_CHECK_EQUAL(&profiler.stage(ImportStage::Route),
+        &ImportProfiler::instance().stage(ImportStage::Route));
+    BOOST_CHECK_EQUAL(profiler.stages().size(), c_importStages);
+    BOOST_CHECK_EQUAL(profiler.parts().size(), c_importParts);
+}
+
+BOOST_AUTO_TEST_CASE(loggerRecordsStagesAndSpans)
+{
+    ImportPerformanceLogger logger;
+    logger.onStageFinished(ImportStage::Verify);
+    logger.addSpan(ImportPart::Transaction, "transaction 0", logger.elapsed(), 0.25);
+    logger.onStageFinished(ImportStage::Enact);
+
+    BlockHeader header;
+    header.setNumber(7);
+    header.setGasUsed(1000);
+    ImportTrace const trace = logger.trace(header, 1);
+
+    BOOST_CHECK_EQUAL(trace.number, 7u);
+    BOOST_CHECK_EQUAL(trace.transactions, 1u);
+    BOOST_REQUIRE_EQUAL(trace.spans.size(), 3u);
+    BOOST_CHECK_EQUAL(trace.spans[0].stage, "verify");
+    BOOST_CHECK_EQUAL(trace.spans[1].label, "transaction 0");
+    BOOST_CHECK_EQUAL(trace.spans[2].stage, "enact");
+    BOOST_CHECK_LE(trace.spans[2].start + trace.spans[2].duration, trace.duration);
+    BOOST_CHECK_EQUAL(trace.gasPerSecond() > 0, trace.spans[2].duration > 0);
+
+    // the transactions are part of "enact" and not counted as a stage of their own
+    ImportProfiler const& profiler = ImportProfiler::instance();
+    BOOST_CHECK(profiler.stages().count("verify"));
+    BOOST_CHECK(!profiler.stages().count("transaction"));
+    BOOST_REQUIRE(profiler.parts().count("transaction"));
+    BOOST_CHECK_GE(profiler.parts().at("transaction")->count(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(opcodeTimer)
+{
+    ImportProfiler profiler;
+    {
+        OpcodeTimer timer(profiler);
+        OnOpFunc const& onOp = timer.onOp();
+        onOp(0, 0, Instruction::PUSH1, 0, 0, 0, nullptr, nullptr);
+        onOp(1, 2, Instruction::SSTORE, 0, 0, 0, nullptr, nullptr);
+        this_thread::sleep_for(chrono::milliseconds(20));
+        timer.pause();
+        // nothing is charged while paused
+        this_thread::sleep_for(chrono::milliseconds(20));
+        onOp(2, 3, Instruction::ADD, 0, 0, 0, nullptr, nullptr);
+        onOp(3, 4, Instruction::STOP, 0, 0, 0, nullptr, nullptr);
+        BOOST_CHECK_EQUAL(profiler.opcodeTimes()[0].count, 0);
+    }
+
+    // the times are added when the timer is destroyed, charging the last instruction
+    auto const times = profiler.opcodeTimes();
+    auto const time = [&](OpcodeCategory _category) {
+        return times[static_cast<unsigned>(_category)];
+    };
+    BOOST_CHECK_EQUAL(time(OpcodeCategory::Stack).count, 1);
+    BOOST_CHECK_EQUAL(time(OpcodeCategory::Storage).count, 1);
+    BOOST_CHECK_EQUAL(time(OpcodeCategory::Arithmetic).count, 1);
+    BOOST_CHECK_EQUAL(time(OpcodeCategory::Flow).count, 1);
+    BOOST_CHECK_EQUAL(time(OpcodeCategory::Hashing).count, 0);
+    BOOST_CHECK_GE(time(OpcodeCategory::Storage).seconds, 0.02);
+    BOOST_CHECK_LT(time(OpcodeCategory::Arithmetic).seconds, 0.02);
+
+    profiler.clear();
+    BOOST_CHECK_EQUAL(profiler.opcodeTimes()[static_cast<unsigned>(OpcodeCategory::Storage)].count, 0);
+}
+
+BOOST_AUTO_TEST_CASE(chromeTrace)
+{
+    ImportProfiler::instance().clear();
+    ImportTrace trace;
+    trace.number = 3;
+    trace.gasUsed = 21000;
+    trace.start = 100;
+    trace.duration = 1;
+    trace.spans.push_back({"enact", {}, 0.25, 0.5});
+    ImportProfiler::instance().record(trace);
+
+    string const json = ImportProfiler::instance().chromeTrace();
+    BOOST_CHECK_EQUAL(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0);
+    BOOST_CHECK_NE(json.find("\"name\":\"block #3\""), string::npos);
+    BOOST_CHECK_NE(json.find("\"gasPerSecond\":42000"), string::npos);
+    BOOST_CHECK_NE(json.find("\"name\":\"enact\",\"cat\":\"enact\",\"ph\":\"X\",\"pid\":1,"
+                             "\"tid\":1,\"ts\":250100,\"dur\":500000"),
+        string::npos);
+    ImportProfiler::instance().clear();
+}
+
+BOOST_AUTO_TEST_CASE(importIsProfiled)
+{
+    ImportProfiler::instance().clear();
+    TestBlockChain bc(TestBlockChain::defaultGenesisBlock());
+    TestBlock block;
+    block.mine(bc);
+    bc.addBlock(block);
+
+    auto const traces = ImportProfiler::instance().traces();
+    BOOST_REQUIRE(!traces.empty());
+    BOOST_CHECK_EQUAL(traces.back().number, 1u);
+
+    vector<string> stages;
+    for (auto const& span : traces.back().spans)
+        stages.push_back(span.stage);
+    vector<string> const expected{
+        "verify", "stateCommit", "enact", "dbWrite", "collation", "route", "extrasWrite"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(stages.begin(), stages.end(), expected.begin(), expected.end());
+
+    auto const histograms = ImportProfiler::instance().stages();
+    BOOST_REQUIRE(histograms.count("enact"));
+    BOOST_CHECK_GE(histograms.at("enact")->count(), 1u);
+    ImportProfiler::instance().clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
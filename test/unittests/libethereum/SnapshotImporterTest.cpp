@@ -6,6 +6,7 @@
 #include <libethereum/StateImporter.h>
 #include <libethereum/BlockChainImporter.h>
 #include <libethereum/SnapshotStorage.h>
+#include <libdevcore/TransientDirectory.h>
 #include <test/tools/libtesteth/TestHelper.h>
 
 using namespace dev;
@@ -25,12 +26,16 @@ namespace
 	class MockStateImporter: public StateImporterFace
 	{
 	public:
-		void importAccount(h256 const& _addressHash, u256 const& _nonce, u256 const& _balance, std::map<h256, bytes> const& _storage, h256 const& _codeHash) override
+		void importAccount(h256 const& _addressHash, u256 const& _nonce, u256 const& _balance, StorageEntries const& _storage, h256 const& _codeHash) override
 		{
+			std::map<h256, bytes> storage;
+			for (auto const& hashAndValue: _storage)
+				storage.emplace(hashAndValue.first, hashAndValue.second.toBytes());
+
 			if (importedAccounts.count(_addressHash))
-				importedAccounts[_addressHash].storage.insert(_storage.begin(), _storage.end());
+				importedAccounts[_addressHash].storage.insert(storage.begin(), storage.end());
 			else
-				importedAccounts.emplace(std::make_pair(_addressHash, ImportedAccount{_nonce, _balance, _storage,  _codeHash}));
+				importedAccounts.emplace(std::make_pair(_addressHash, ImportedAccount{_nonce, _balance, storage,  _codeHash}));
 		}
 
 		h256 importCode(bytesConstRef _code) override
@@ -41,6 +46,7 @@ namespace
 		void commitStateDatabase() override { ++commitCounter; }
 		bool isAccountImported(h256 const& _addressHash) const override { return importedAccounts.count(_addressHash) != 0; }
 		h256 stateRoot() const override { return h256{}; }
+		void setStateRoot(h256 const& _root) override { resumedFromRoot = _root; ++setStateRootCounter; }
 		std::string lookupCode(h256 const& _hash) const override
 		{ 
 			auto it = std::find_if(importedCodes.begin(), importedCodes.end(), [&_hash](bytes const& _code) { return sha3(_code) == _hash; });
@@ -50,6 +56,8 @@ namespace
 		std::unordered_map<h256, ImportedAccount> importedAccounts;
 		std::vector<bytes> importedCodes;
 		int commitCounter = 0;
+		h256 resumedFromRoot;
+		int setStateRootCounter = 0;
 	};
 
 
@@ -319,6 +327,34 @@ BOOST_AUTO_TEST_CASE(SnapshotImporterSuite_commitStateOnceEveryChunk)
 	BOOST_REQUIRE_EQUAL(stateImporter.commitCounter, 2);
 }
 
+BOOST_AUTO_TEST_CASE(SnapshotImporterSuite_resumeInterruptedImport)
+{
+	h256 stateChunk1 = sha3("123");
+	h256 stateChunk2 = sha3("789");
+	snapshotStorage.manifest = createManifest(2, {stateChunk1, stateChunk2}, {}, h256{}, 0, h256{});
+
+	h256 addressHash1 = sha3("456");
+	snapshotStorage.chunks[stateChunk1] = createStateChunk({{addressHash1, createAccount(2, 10, 0, {0x80}, {})}});
+	// invalid account interrupts the import after the first chunk
+	h256 addressHash2 = sha3("345");
+	snapshotStorage.chunks[stateChunk2] = createStateChunk({{addressHash2, createAccount(2, 10, 3, {0x80}, {})}});
+
+	TransientDirectory tempDir;
+	boost::filesystem::path const progressPath = boost::filesystem::path(tempDir.path()) / "progress";
+
+	BOOST_REQUIRE_THROW(snapshotImporter.import(snapshotStorage, h256{}, progressPath), InvalidStateChunkData);
+	BOOST_REQUIRE_EQUAL(stateImporter.commitCounter, 1);
+	BOOST_REQUIRE(boost::filesystem::exists(progressPath));
+
+	snapshotStorage.chunks[stateChunk2] = createStateChunk({{addressHash2, createAccount(2, 10, 0, {0x80}, {})}});
+	snapshotImporter.import(snapshotStorage, h256{}, progressPath);
+
+	// only the second chunk is imported again
+	BOOST_CHECK_EQUAL(stateImporter.commitCounter, 2);
+	BOOST_CHECK_EQUAL(stateImporter.setStateRootCounter, 1);
+	BOOST_CHECK(stateImporter.importedAccounts.count(addressHash2) > 0);
+	BOOST_CHECK(!boost::filesystem::exists(progressPath));
+}
 
 BOOST_AUTO_TEST_CASE(SnapshotImporterSuite_importEmptyBlock)
 {
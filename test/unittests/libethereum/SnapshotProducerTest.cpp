@@ -0,0 +1,182 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/DBFactory.h>
+#include <libdevcore/TransientDirectory.h>
+#include <libethereum/BlockChainImporter.h>
+#include <libethereum/SnapshotImporter.h>
+#include <libethereum/SnapshotProducer.h>
+#include <libethereum/SnapshotStorage.h>
+#include <libethereum/StateImporter.h>
+#include <test/tools/libtesteth/BlockChainHelper.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+	class NullBlockChainImporter: public BlockChainImporterFace
+	{
+	public:
+		void importBlock(BlockHeader const&, RLP, RLP, RLP, u256 const&) override {}
+		void setChainStartBlockNumber(u256 const&) override {}
+	};
+
+	struct ImportedBlock
+	{
+		h256 hash;
+		bytes receipts;
+		u256 totalDifficulty;
+	};
+
+	class RecordingBlockChainImporter: public BlockChainImporterFace
+	{
+	public:
+		void importBlock(BlockHeader const& _header, RLP, RLP, RLP _receipts, u256 const& _totalDifficulty) override
+		{
+			importedBlocks.push_back({_header.hash(), _receipts.data().toBytes(), _totalDifficulty});
+		}
+		void setChainStartBlockNumber(u256 const& _number) override { chainStartBlockNumber = _number; }
+
+		std::vector<ImportedBlock> importedBlocks;
+		u256 chainStartBlockNumber;
+	};
+
+	class SnapshotProducerTestFixture: public TestOutputHelperFixture
+	{
+	public:
+		SnapshotProducerTestFixture():
+			stateDb(db::DBFactory::create(db::DatabaseKind::MemoryDB)),
+			stateImporter(createStateImporter(stateDb))
+		{}
+
+		void importAccount(h256 const& _addressHash, u256 const& _nonce, u256 const& _balance, std::vector<std::pair<h256, bytes>> const& _storage, bytes const& _code)
+		{
+			StorageEntries storage;
+			for (auto const& keyAndValue: _storage)
+				storage.emplace_back(keyAndValue.first, bytesConstRef(&keyAndValue.second));
+
+			h256 const codeHash = _code.empty() ? EmptySHA3 : stateImporter->importCode(&_code);
+			stateImporter->importAccount(_addressHash, _nonce, _balance, storage, codeHash);
+		}
+
+		/// Writes snapshot of the state into the directory and imports it into empty database.
+		void produceAndImport(size_t _chunkSize)
+		{
+			stateImporter->commitStateDatabase();
+			h256 const stateRoot = stateImporter->stateRoot();
+
+			SnapshotProducer producer(stateDb, 4, _chunkSize);
+			h256s const stateChunks = producer.produceStateChunks(stateRoot, snapshotDir.path());
+			BOOST_REQUIRE(!stateChunks.empty());
+
+			RLPStream manifest(6);
+			manifest << 2 << stateChunks << h256s{} << stateRoot << 0 << h256{};
+			writeSnapshotManifest(snapshotDir.path(), manifest.out());
+
+			OverlayDB importedDb(db::DBFactory::create(db::DatabaseKind::MemoryDB));
+			auto importer = createStateImporter(importedDb);
+			NullBlockChainImporter blockChainImporter;
+			SnapshotImporter snapshotImporter(*importer, blockChainImporter);
+			auto snapshotStorage = createSnapshotStorage(snapshotDir.path());
+			// import throws if reconstructed state root doesn't match the manifest
+			snapshotImporter.import(*snapshotStorage, h256{});
+			BOOST_CHECK_EQUAL(importer->stateRoot(), stateRoot);
+		}
+
+		OverlayDB stateDb;
+		std::unique_ptr<StateImporterFace> stateImporter;
+		TransientDirectory snapshotDir;
+	};
+
+	std::vector<std::pair<h256, bytes>> createStorage(unsigned _size)
+	{
+		std::vector<std::pair<h256, bytes>> storage;
+		for (unsigned i = 1; i <= _size; ++i)
+			storage.emplace_back(sha3(toString(i)), rlp(i));
+		return storage;
+	}
+}
+
+BOOST_FIXTURE_TEST_SUITE(SnapshotProducerSuite, SnapshotProducerTestFixture)
+
+BOOST_AUTO_TEST_CASE(SnapshotProducerSuite_roundTripAccounts)
+{
+	for (unsigned i = 0; i < 100; ++i)
+		importAccount(sha3(toString(i)), i, i * 1000, {}, {});
+
+	produceAndImport(c_snapshotChunkSize);
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotProducerSuite_roundTripSharedCode)
+{
+	bytes const code = {1, 2, 3};
+	for (unsigned i = 0; i < 50; ++i)
+		importAccount(sha3(toString(i)), 1, 10, createStorage(3), code);
+
+	produceAndImport(c_snapshotChunkSize);
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotProducerSuite_roundTripSplitAccounts)
+{
+	bytes const code = {4, 5, 6};
+	importAccount(sha3("123"), 1, 10, createStorage(200), code);
+	importAccount(sha3("456"), 2, 20, createStorage(100), {});
+	importAccount(sha3("789"), 3, 30, {}, {});
+
+	// small chunks make accounts with large storage split between chunks
+	produceAndImport(1024);
+}
+
+BOOST_AUTO_TEST_CASE(SnapshotProducerSuite_roundTripBlocks)
+{
+	NetworkSelector networkSelector(Network::FrontierNoProofTest);
+	TestBlockChain testBlockChain(TestBlockChain::defaultGenesisBlock());
+	for (unsigned i = 1; i <= 5; ++i)
+	{
+		TestBlock block;
+		block.addTransaction(TestTransaction::defaultTransaction(i));
+		block.mine(testBlockChain);
+		testBlockChain.addBlock(block);
+	}
+	BlockChain const& blockChain = testBlockChain.getInterface();
+	BOOST_REQUIRE_EQUAL(blockChain.number(), 5u);
+
+	// the first block of a chunk needs a parent other than genesis, so block 1 is left out;
+	// with chunks of one byte, every block goes into a chunk of its own
+	std::vector<std::pair<size_t, size_t>> const chunkSizesAndCounts{{1, 4}, {c_snapshotChunkSize, 1}};
+	for (auto const& chunkSizeAndCount: chunkSizesAndCounts)
+	{
+		TransientDirectory blocksDir;
+		SnapshotProducer producer(stateDb, 4, chunkSizeAndCount.first);
+		h256s const blockChunks = producer.produceBlockChunks(blockChain, 5, 10, blocksDir.path());
+		BOOST_REQUIRE_EQUAL(blockChunks.size(), chunkSizeAndCount.second);
+
+		OverlayDB importedDb(db::DBFactory::create(db::DatabaseKind::MemoryDB));
+		auto importer = createStateImporter(importedDb);
+		RLPStream manifest(6);
+		manifest << 2 << h256s{} << blockChunks << importer->stateRoot() << 5 << blockChain.numberHash(5);
+		writeSnapshotManifest(blocksDir.path(), manifest.out());
+
+		RecordingBlockChainImporter blockChainImporter;
+		SnapshotImporter snapshotImporter(*importer, blockChainImporter);
+		snapshotImporter.import(*createSnapshotStorage(blocksDir.path()), h256{});
+
+		BOOST_CHECK_EQUAL(blockChainImporter.chainStartBlockNumber, 2);
+		BOOST_REQUIRE_EQUAL(blockChainImporter.importedBlocks.size(), 4u);
+		for (unsigned number = 2; number <= 5; ++number)
+		{
+			ImportedBlock const& imported = blockChainImporter.importedBlocks[number - 2];
+			h256 const hash = blockChain.numberHash(number);
+			// the header is rebuilt from the abridged block, so its hash covers all the fields
+			BOOST_CHECK_EQUAL(imported.hash, hash);
+			BOOST_CHECK(imported.receipts == blockChain.receipts(hash).rlp());
+			BOOST_CHECK_EQUAL(imported.totalDifficulty, blockChain.details(hash).totalDifficulty);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,189 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/DBFactory.h>
+#include <libethereum/BlockChain.h>
+#include <libethereum/State.h>
+#include <libethereum/StateSnapshot.h>
+#include <test/tools/libtesteth/BlockChainHelper.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+#include <chrono>
+#include <thread>
+
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+Address const c_account{"a94f5374fce5edbc8e2a8697c15331677e6ebf0b"};
+Address const c_contract{"095e7baea6a6c7c4c2dfeb977efac326af552d87"};
+
+class StateSnapshotFixture : public FrontierNoProofTestFixture
+{
+public:
+    StateSnapshotFixture()
+      : state(0, OverlayDB(db::DBFactory::create(db::DatabaseKind::MemoryDB)), BaseState::Empty),
+        snapshot(std::make_shared<StateSnapshot>(boost::filesystem::path(), 2))
+    {
+        state.addBalance(c_account, 10);
+        state.createContract(c_contract);
+        state.setStorage(c_contract, 1, 5);
+        state.setStorage(c_contract, 2, 6);
+        genesisRoot = commitBlock();
+
+        snapshot->generate(state.db(), genesisRoot);
+        state.setSnapshot(snapshot);
+        state.setRoot(genesisRoot);
+    }
+
+    h256 commitBlock()
+    {
+        state.commit(State::CommitBehaviour::KeepEmptyAccounts);
+        state.db().commit();
+        state.updateSnapshot();
+        return state.rootHash();
+    }
+
+    u256 snapshotStorage(h256 const& _root, Address const& _address, u256 const& _key)
+    {
+        u256 value;
+        BOOST_REQUIRE(snapshot->storage(_root, sha3(_address), sha3(h256(_key)), value));
+        return value;
+    }
+
+    std::string snapshotAccount(h256 const& _root, Address const& _address)
+    {
+        std::string account;
+        BOOST_REQUIRE(snapshot->account(_root, sha3(_address), account));
+        return account;
+    }
+
+    std::string trieAccount(h256 const& _root, Address const& _address)
+    {
+        SecureTrieDB<Address, OverlayDB> const trie(&state.db(), _root);
+        return trie.at(_address);
+    }
+
+    State state;
+    std::shared_ptr<StateSnapshot> snapshot;
+    h256 genesisRoot;
+};
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(StateSnapshotSuite, StateSnapshotFixture)
+
+BOOST_AUTO_TEST_CASE(StateSnapshotSuite_generate)
+{
+    BOOST_CHECK(snapshot->covers(genesisRoot));
+    BOOST_CHECK_EQUAL(snapshotAccount(genesisRoot, c_account), trieAccount(genesisRoot, c_account));
+    BOOST_CHECK_EQUAL(snapshotStorage(genesisRoot, c_contract, 1), 5);
+    BOOST_CHECK_EQUAL(snapshotStorage(genesisRoot, c_contract, 3), 0);
+    BOOST_CHECK(snapshotAccount(genesisRoot, Address(1)).empty());
+    BOOST_CHECK(!snapshot->covers(h256(1)));
+}
+
+BOOST_AUTO_TEST_CASE(StateSnapshotSuite_diffLayers)
+{
+    state.addBalance(c_account, 5);
+    state.setStorage(c_contract, 1, 0);
+    state.setStorage(c_contract, 3, 7);
+    h256 const root1 = commitBlock();
+
+    // reads within the block see the changes committed so far
+    state.kill(c_contract);
+    state.commit(State::CommitBehaviour::KeepEmptyAccounts);
+    BOOST_CHECK_EQUAL(state.storage(c_contract, 2), 0);
+    h256 const root2 = commitBlock();
+
+    BOOST_CHECK(snapshot->covers(root1));
+    BOOST_CHECK(snapshot->covers(root2));
+    BOOST_CHECK_EQUAL(snapshotAccount(root1, c_account), trieAccount(root1, c_account));
+    BOOST_CHECK_EQUAL(snapshotStorage(root1, c_contract, 1), 0);
+    BOOST_CHECK_EQUAL(snapshotStorage(root1, c_contract, 2), 6);
+    BOOST_CHECK_EQUAL(snapshotStorage(root1, c_contract, 3), 7);
+    BOOST_CHECK(snapshotAccount(root2, c_contract).empty());
+    BOOST_CHECK_EQUAL(snapshotStorage(root2, c_contract, 2), 0);
+    BOOST_CHECK_EQUAL(snapshotStorage(genesisRoot, c_contract, 1), 5);
+
+    State copy(state);
+    copy.setRoot(root1);
+    BOOST_CHECK_EQUAL(copy.balance(c_account), 15);
+    BOOST_CHECK_EQUAL(copy.storage(c_contract, 3), 7);
+}
+
+BOOST_AUTO_TEST_CASE(StateSnapshotSuite_flatten)
+{
+    state.setStorage(c_contract, 3, 7);
+    h256 const root1 = commitBlock();
+    state.kill(c_contract);
+    h256 const root2 = commitBlock();
+    state.createContract(c_contract);
+    state.setStorage(c_contract, 1, 9);
+    h256 const root3 = commitBlock();
+
+    snapshot->cap(root3);
+    BOOST_CHECK(!snapshot->covers(genesisRoot));
+    BOOST_CHECK(snapshot->covers(root1));
+
+    snapshot->flatten(root3);
+    BOOST_CHECK(!snapshot->covers(root2));
+    BOOST_CHECK(snapshot->covers(root3));
+    BOOST_CHECK_EQUAL(snapshotAccount(root3, c_contract), trieAccount(root3, c_contract));
+    BOOST_CHECK_EQUAL(snapshotStorage(root3, c_contract, 1), 9);
+    // the storage of the destroyed contract is gone
+    BOOST_CHECK_EQUAL(snapshotStorage(root3, c_contract, 2), 0);
+    BOOST_CHECK_EQUAL(snapshotStorage(root3, c_contract, 3), 0);
+}
+
+BOOST_AUTO_TEST_CASE(StateSnapshotSuite_dropOtherBranches)
+{
+    state.addBalance(c_account, 1);
+    h256 const root1 = commitBlock();
+
+    state.setRoot(genesisRoot);
+    state.addBalance(c_account, 2);
+    h256 const otherRoot1 = commitBlock();
+    BOOST_CHECK(snapshot->covers(otherRoot1));
+
+    snapshot->flatten(root1);
+    BOOST_CHECK(snapshot->covers(root1));
+    BOOST_CHECK(!snapshot->contains(otherRoot1));
+
+    // a state whose parent is unknown is not added
+    state.addBalance(c_account, 3);
+    h256 const otherRoot2 = commitBlock();
+    BOOST_CHECK(!snapshot->contains(otherRoot2));
+}
+
+BOOST_AUTO_TEST_CASE(StateSnapshotSuite_blockChain)
+{
+    unsigned const layers = db::stateSnapshotLayers();
+    db::setStateSnapshotLayers(2);
+    TestBlockChain chain(TestBlockChain::defaultGenesisBlock());
+    db::setStateSnapshotLayers(layers);
+
+    BlockChain const& bc = chain.getInterface();
+    BOOST_REQUIRE(bc.stateSnapshot());
+    for (unsigned i = 0; i < 5; ++i)
+    {
+        TestBlock block;
+        block.mine(chain);
+        chain.addBlock(block);
+        while (bc.stateSnapshot()->generating())
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    BlockHeader const head = bc.info();
+    std::string account;
+    BOOST_REQUIRE(bc.stateSnapshot()->covers(head.stateRoot()));
+    BOOST_REQUIRE(bc.stateSnapshot()->account(head.stateRoot(), sha3(head.author()), account));
+
+    OverlayDB const& db = chain.testGenesis().state().db();
+    SecureTrieDB<Address, OverlayDB> const trie(const_cast<OverlayDB*>(&db), head.stateRoot());
+    BOOST_CHECK_EQUAL(account, trie.at(head.author()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
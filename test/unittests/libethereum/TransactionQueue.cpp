@@ -4,6 +4,7 @@
 
 /// @file
 /// TransactionQueue test functions.
+#include <libethereum/SenderCache.h>
 #include <libethereum/TransactionQueue.h>
 #include <test/tools/libtesteth/TestHelper.h>
 #include <test/tools/libtesteth/BlockChainHelper.h>
@@ -288,4 +289,29 @@ BOOST_AUTO_TEST_CASE(tqEqueue)
     BOOST_REQUIRE(topTr.size() == 1);
 }
 
+BOOST_AUTO_TEST_CASE(tqSenderCache)
+{
+    TransactionQueue tq;
+    Secret const sec("0x45a915e4d060149eb4365960e6a7a45f334393093061116b197e3240065ff2d8");
+    Address const sender("0xa94f5374fce5edbc8e2a8697c15331677e6ebf0b");
+    Transaction const tx(0, 10 * szabo, 25000, Address(1), bytes(), 42, sec);
+    BOOST_CHECK(!SenderCache::instance().find(tx.sha3()));
+
+    BOOST_REQUIRE(tq.import(tx) == ImportResult::Success);
+    auto const cached = SenderCache::instance().find(tx.sha3());
+    BOOST_REQUIRE(cached);
+    BOOST_CHECK_EQUAL(*cached, sender);
+
+    // a block transaction parsed without the sender gets it from the cache
+    Transaction fromBlock(tx.rlp(), CheckTransaction::Cheap);
+    SenderCache::instance().setSender(fromBlock);
+    BOOST_CHECK_EQUAL(fromBlock.sender(), sender);
+
+    // and is recovered otherwise
+    Transaction const other(0, 10 * szabo, 25000, Address(1), bytes(), 43, sec);
+    Transaction otherFromBlock(other.rlp(), CheckTransaction::Cheap);
+    SenderCache::instance().setSender(otherFromBlock);
+    BOOST_CHECK_EQUAL(otherFromBlock.sender(), sender);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,99 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/DBFactory.h>
+#include <libethereum/State.h>
+#include <libethereum/TriePrefetcher.h>
+#include <test/tools/libtesteth/BlockChainHelper.h>
+#include <test/tools/libtesteth/TestHelper.h>
+
+using namespace dev;
+using namespace dev::eth;
+using namespace dev::test;
+
+namespace
+{
+Secret const c_secret{"45a915e4d060149eb4365960e6a7a45f334393093061116b197e3240065ff2d8"};
+Address const c_contract{"095e7baea6a6c7c4c2dfeb977efac326af552d87"};
+Address const c_author{"8888f1f195afa192cfee860698584c030f4c9db1"};
+
+class TriePrefetcherFixture : public FrontierNoProofTestFixture
+{
+public:
+    TriePrefetcherFixture()
+      : state(0, OverlayDB(db::DBFactory::create(db::DatabaseKind::MemoryDB)), BaseState::Empty),
+        prefetcher(2)
+    {
+        state.addBalance(toAddress(c_secret), 10);
+        state.createContract(c_contract);
+        state.setCode(c_contract, bytes{0x60, 0x01, 0x54}, 0);
+        state.setStorage(c_contract, 1, 5);
+        state.setStorage(c_contract, 2, 6);
+        state.commit(State::CommitBehaviour::KeepEmptyAccounts);
+        state.db().commit();
+    }
+
+    VerifiedBlockRef block() const
+    {
+        VerifiedBlockRef ret;
+        ret.info.setAuthor(c_author);
+        ret.transactions.emplace_back(0, 1, 100000, c_contract, bytes(), 0, c_secret);
+        return ret;
+    }
+
+    State state;
+    TriePrefetcher prefetcher;
+};
+}  // namespace
+
+BOOST_FIXTURE_TEST_SUITE(TriePrefetcherSuite, TriePrefetcherFixture)
+
+BOOST_AUTO_TEST_CASE(TriePrefetcherSuite_prefetch)
+{
+    prefetcher.noteStorageRead(c_contract, 2);
+    prefetcher.prefetch(state.db(), state.rootHash(), block());
+    prefetcher.wait();
+
+    TrieNodeCache& cache = *prefetcher.cache();
+    BOOST_CHECK(cache.contains(state.rootHash()));
+    BOOST_CHECK(cache.contains(state.storageRoot(c_contract)));
+    BOOST_CHECK(cache.contains(state.codeHash(c_contract)));
+
+    prefetcher.clear();
+    BOOST_CHECK_EQUAL(cache.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TriePrefetcherSuite_storageReads)
+{
+    std::shared_ptr<TriePrefetcher> const shared = std::make_shared<TriePrefetcher>(1);
+    State copy(state);
+    copy.setPrefetcher(shared);
+    // only the states of imported blocks report their reads
+    BOOST_CHECK_EQUAL(copy.storage(c_contract, 2), 6);
+    BOOST_CHECK(shared->storageReads(c_contract).empty());
+
+    copy.setReportStorageReads(true);
+    BOOST_CHECK_EQUAL(copy.storage(c_contract, 1), 5);
+    BOOST_CHECK_EQUAL(copy.storage(c_contract, 3), 0);
+    BOOST_CHECK(copy.db().nodeCache() == shared->cache());
+
+    std::vector<u256> const keys = shared->storageReads(c_contract);
+    BOOST_REQUIRE_EQUAL(keys.size(), 2);
+    BOOST_CHECK_EQUAL(keys[0], 1);
+    BOOST_CHECK_EQUAL(keys[1], 3);
+    BOOST_CHECK(shared->storageReads(c_author).empty());
+
+    // reads of the prefetched nodes go through the cache
+    shared->prefetch(state.db(), state.rootHash(), block());
+    shared->wait();
+    State cached(0, OverlayDB(db::DBFactory::create(db::DatabaseKind::MemoryDB)),
+        BaseState::PreExisting);
+    cached.setPrefetcher(shared);
+    cached.setRoot(state.rootHash());
+    BOOST_CHECK_EQUAL(cached.balance(toAddress(c_secret)), 10);
+    BOOST_CHECK_EQUAL(cached.storage(c_contract, 3), 0);
+    BOOST_CHECK_EQUAL(cached.storage(c_contract, 1), 5);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,62 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libp2p/PeerMetrics.h>
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::p2p;
+
+TEST(peerMetrics, trafficIsCountedPerPacketType)
+{
+    PeerMetrics metrics;
+    metrics.noteReceived("eth", 4, 100);
+    metrics.noteReceived("eth", 4, 50);
+    metrics.noteSent("eth", 3, 20);
+    metrics.noteSent("p2p", 2, 10);
+
+    auto const snapshot = metrics.snapshot();
+    EXPECT_EQ(snapshot.bytesIn, 150);
+    EXPECT_EQ(snapshot.bytesOut, 30);
+
+    auto const& headers = snapshot.traffic.at({"eth", 4});
+    EXPECT_EQ(headers.packetsIn, 2);
+    EXPECT_EQ(headers.bytesIn, 150);
+    EXPECT_EQ(headers.packetsOut, 0);
+    EXPECT_EQ(snapshot.traffic.at({"p2p", 2}).bytesOut, 10);
+}
+
+TEST(peerMetrics, latencyHistogram)
+{
+    PeerMetrics metrics;
+    metrics.noteResponseLatency(chrono::milliseconds(10));
+    metrics.noteResponseLatency(chrono::milliseconds(300));
+    metrics.noteResponseLatency(chrono::seconds(10));
+
+    auto const snapshot = metrics.snapshot();
+    EXPECT_EQ(snapshot.latencyHistogram.front(), 1);
+    EXPECT_EQ(snapshot.latencyHistogram[3], 1);
+    EXPECT_EQ(snapshot.latencyHistogram.back(), 1);
+    EXPECT_GT(snapshot.averageLatency, chrono::milliseconds(10));
+}
+
+TEST(peerMetrics, scorePrefersUsefulAndFastPeers)
+{
+    PeerMetrics newPeer;
+    EXPECT_DOUBLE_EQ(newPeer.score(), 0.5);
+
+    PeerMetrics usefulPeer;
+    usefulPeer.noteUsefulItems(10);
+    PeerMetrics duplicatingPeer;
+    duplicatingPeer.noteDuplicateItems(10);
+    EXPECT_GT(usefulPeer.score(), newPeer.score());
+    EXPECT_LT(duplicatingPeer.score(), newPeer.score());
+
+    PeerMetrics fastPeer;
+    fastPeer.noteResponseLatency(chrono::milliseconds(50));
+    PeerMetrics slowPeer;
+    slowPeer.noteResponseLatency(chrono::seconds(2));
+    EXPECT_GT(fastPeer.score(), slowPeer.score());
+}
@@ -111,7 +111,7 @@ struct TestNodeTable: public NodeTable
             {
                 Guard stateGuard(x_state);
                 auto const bucketIndex = distance - 1;
-                if (m_buckets[bucketIndex].nodes.size() >= _bucketSize)
+                if (m_buckets[bucketIndex].size() >= _bucketSize)
                     return bucketIndex;
             }
 
@@ -156,7 +156,7 @@ struct TestNodeTable: public NodeTable
     {
         Guard l(x_state);
         for (auto& n : m_buckets)
-            n.nodes.clear();
+            n.clear();
     }
 
     void onPacketReceived(
@@ -176,19 +176,19 @@ struct TestNodeTable: public NodeTable
     size_t bucketSize(size_t _bucket) const
     {
         Guard l(x_state);
-        return m_buckets[_bucket].nodes.size();
+        return m_buckets[_bucket].size();
     }
 
     shared_ptr<NodeEntry> bucketFirstNode(size_t _bucket)
     {
         Guard l(x_state);
-        return m_buckets[_bucket].nodes.front().lock();
+        return m_buckets[_bucket].front().lock();
     }
 
     shared_ptr<NodeEntry> bucketLastNode(size_t _bucket)
     {
         Guard l(x_state);
-        return m_buckets[_bucket].nodes.back().lock();
+        return m_buckets[_bucket].back().lock();
     }
 
     boost::optional<NodeValidation> nodeValidation(bi::udp::endpoint const& _endpoint)
@@ -497,6 +497,29 @@ BOOST_AUTO_TEST_CASE(udpOnce)
     BOOST_REQUIRE_EQUAL(true, a.success);
 }
 
+BOOST_AUTO_TEST_CASE(udpMany)
+{
+    // more datagrams than fit into one send/receive batch
+    unsigned constexpr datagramCount = 100;
+
+    TestUDPSocketHost receiver;
+    receiver.start();
+    TestUDPSocketHost sender;
+    sender.start();
+
+    bi::udp::endpoint const receiverEndpoint(
+        boost::asio::ip::make_address(c_localhostIp), receiver.port);
+    for (unsigned i = 0; i < datagramCount; ++i)
+        sender.socket->send(UDPDatagram(receiverEndpoint, bytes{static_cast<byte>(i), 1, 2, 3}));
+
+    for (unsigned i = 0; i < datagramCount; ++i)
+    {
+        bytes const received = receiver.packetsReceived.pop(chrono::seconds(5));
+        BOOST_REQUIRE_EQUAL(received.size(), 4);
+        BOOST_CHECK_EQUAL(received[0], static_cast<byte>(i));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(noteActiveNodeAppendsNewNode)
 {
     TestNodeTableHost nodeTableHost(1);
@@ -13,6 +13,7 @@
 #include <cryptopp/sha.h>
 #include <boost/asio.hpp>
 #include <gtest/gtest.h>
+#include <chrono>
 
 using namespace std;
 using namespace dev;
@@ -492,3 +493,106 @@ TEST_F(rlpx, ecies_interop_test_primitives)
     ASSERT_TRUE(s_secp256k1->decryptECIES(kenc.secret(), plainTest3));
     ASSERT_EQ(plainTest3, expectedPlain3);
 }
+
+TEST_F(rlpx, frameCoderRoundTrip)
+{
+    KeyPair const initiator = KeyPair::create();
+    KeyPair const recipient = KeyPair::create();
+    h256 const initiatorNonce = sha3("initiator-nonce");
+    h256 const recipientNonce = sha3("recipient-nonce");
+    bytes const authCipher = asBytes("auth");
+    bytes const ackCipher = asBytes("ack");
+    RLPXFrameCoder egress(true, recipient.pub(), recipientNonce, initiator, initiatorNonce,
+        &ackCipher, &authCipher);
+    RLPXFrameCoder ingress(false, initiator.pub(), initiatorNonce, recipient, recipientNonce,
+        &ackCipher, &authCipher);
+
+    // frames follow one another in the same cipher streams, so a frame whose padding isn't
+    // encrypted along with its payload breaks the frames after it
+    for (size_t const packetSize : {1, 15, 16, 17, 31, 32, 33, 1000, 4096, 4097})
+    {
+        bytes packet(packetSize);
+        for (size_t i = 0; i < packetSize; ++i)
+            packet[i] = static_cast<byte>(i * 7 + packetSize);
+        size_t const padding = (16 - packetSize % 16) % 16;
+
+        // Session frames a packet in the buffer holding it
+        bytes frame = packet;
+        egress.writeSingleFramePacket(&frame, frame);
+        ASSERT_EQ(frame.size(), h256::size + packetSize + padding + h128::size);
+
+        bytesRef frameRef(&frame);
+        ASSERT_TRUE(ingress.authAndDecryptHeader(frameRef.cropped(0, h256::size)));
+        RLPXFrameInfo const info(frameRef.cropped(0, h128::size));
+        EXPECT_EQ(info.length, packetSize);
+        EXPECT_EQ(info.padding, padding);
+        ASSERT_TRUE(ingress.authAndDecryptFrame(frameRef.cropped(h256::size)));
+        EXPECT_EQ(frameRef.cropped(h256::size, packetSize).toBytes(), packet);
+        EXPECT_EQ(frameRef.cropped(h256::size + packetSize, padding).toBytes(), bytes(padding));
+
+        egress.writeFrame(static_cast<uint16_t>(packetSize), 3, 2 * packetSize, &packet, frame);
+        frameRef = bytesRef(&frame);
+        ASSERT_TRUE(ingress.authAndDecryptHeader(frameRef.cropped(0, h256::size)));
+        RLPXFrameInfo const firstFrameInfo(frameRef.cropped(0, h128::size));
+        EXPECT_EQ(firstFrameInfo.length, packetSize);
+        EXPECT_EQ(firstFrameInfo.protocolId, packetSize);
+        EXPECT_TRUE(firstFrameInfo.multiFrame);
+        EXPECT_EQ(firstFrameInfo.sequenceId, 3);
+        EXPECT_EQ(firstFrameInfo.totalLength, 2 * packetSize);
+        ASSERT_TRUE(ingress.authAndDecryptFrame(frameRef.cropped(h256::size)));
+        EXPECT_EQ(frameRef.cropped(h256::size, packetSize).toBytes(), packet);
+    }
+
+    // a frame with a tampered payload is rejected
+    bytes packet(100, 0x42);
+    bytes frame;
+    egress.writeSingleFramePacket(&packet, frame);
+    frame[h256::size + 50] ^= 1;
+    bytesRef frameRef(&frame);
+    ASSERT_TRUE(ingress.authAndDecryptHeader(frameRef.cropped(0, h256::size)));
+    EXPECT_FALSE(ingress.authAndDecryptFrame(frameRef.cropped(h256::size)));
+}
+
+// Run with --gtest_also_run_disabled_tests
+TEST_F(rlpx, DISABLED_frameCoderThroughput)
+{
+    KeyPair const initiator = KeyPair::create();
+    KeyPair const recipient = KeyPair::create();
+    h256 const initiatorNonce = sha3("initiator-nonce");
+    h256 const recipientNonce = sha3("recipient-nonce");
+    bytes const authCipher = asBytes("auth");
+    bytes const ackCipher = asBytes("ack");
+    RLPXFrameCoder egress(true, recipient.pub(), recipientNonce, initiator, initiatorNonce,
+        &ackCipher, &authCipher);
+    RLPXFrameCoder ingress(false, initiator.pub(), initiatorNonce, recipient, recipientNonce,
+        &ackCipher, &authCipher);
+
+    for (size_t const packetSize : {100, 1000, 16 * 1024})
+    {
+        size_t const packetCount = 16 * 1024 * 1024 / packetSize;
+        bytes packet(packetSize);
+        for (size_t i = 0; i < packetSize; ++i)
+            packet[i] = static_cast<byte>(i);
+
+        auto const start = chrono::steady_clock::now();
+        for (size_t i = 0; i < packetCount; ++i)
+        {
+            bytes frame;
+            egress.writeSingleFramePacket(&packet, frame);
+
+            bytesRef frameRef(&frame);
+            ASSERT_TRUE(ingress.authAndDecryptHeader(frameRef.cropped(0, h256::size)));
+            RLPXFrameInfo const info(frameRef.cropped(0, h128::size));
+            ASSERT_EQ(info.length, packetSize);
+            ASSERT_TRUE(ingress.authAndDecryptFrame(frameRef.cropped(h256::size)));
+            ASSERT_EQ(frameRef.cropped(h256::size, packetSize).toBytes(), packet);
+        }
+        auto const elapsed =
+            chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start);
+
+        double const megabytes = static_cast<double>(packetSize * packetCount) / (1024 * 1024);
+        cout << "Packet size " << packetSize << ": " << packetCount
+             << " packets framed and decrypted in " << elapsed.count() / 1000 << " ms, "
+             << megabytes * 1000000 / std::max<int64_t>(elapsed.count(), 1) << " MB/s\n";
+    }
+}
@@ -91,3 +91,138 @@ TEST(OverlayDB, rollback)
     odb.rollback();
     EXPECT_TRUE(!odb.get().size());
 }
+
+TEST(OverlayDB, pruneKilledNodes)
+{
+    OverlayDB odb(DBFactory::create(DatabaseKind::MemoryDB));
+    odb.setRefCounting(true);
+
+    string const value = "\x43";
+    odb.insert(h256(42), &value);
+    odb.commit(1, h256(1));
+
+    odb.kill(h256(42));
+    odb.insert(h256(43), &value);
+    odb.commit(2, h256(2));
+
+    // the node is still referenced by the state of era 1
+    EXPECT_EQ(odb.markCanonical(1, h256(1)), 0);
+    EXPECT_TRUE(odb.exists(h256(42)));
+
+    EXPECT_EQ(odb.markCanonical(2, h256(2)), 1);
+    EXPECT_FALSE(odb.exists(h256(42)));
+    EXPECT_TRUE(odb.exists(h256(43)));
+
+    // the journal is gone
+    EXPECT_EQ(odb.markCanonical(2, h256(2)), 0);
+}
+
+TEST(OverlayDB, pruneSharedNodes)
+{
+    OverlayDB odb(DBFactory::create(DatabaseKind::MemoryDB));
+    odb.setRefCounting(true);
+
+    string const value = "\x43";
+    odb.insert(h256(42), &value);
+    odb.insert(h256(42), &value);
+    odb.commit(1, h256(1));
+
+    odb.kill(h256(42));
+    odb.commit(2, h256(2));
+
+    EXPECT_EQ(odb.markCanonical(2, h256(2)), 0);
+    EXPECT_TRUE(odb.exists(h256(42)));
+}
+
+TEST(OverlayDB, pruneNonCanonical)
+{
+    OverlayDB odb(DBFactory::create(DatabaseKind::MemoryDB));
+    odb.setRefCounting(true);
+
+    string const value = "\x43";
+    odb.insert(h256(42), &value);
+    odb.commit(1, h256(1));
+
+    odb.insert(h256(43), &value);
+    odb.insert(h256(42), &value);
+    odb.commit(1, h256(2));
+
+    EXPECT_EQ(odb.markCanonical(1, h256(1)), 1);
+    EXPECT_TRUE(odb.exists(h256(42)));
+    EXPECT_FALSE(odb.exists(h256(43)));
+}
+
+TEST(OverlayDB, pruneRecommittedId)
+{
+    OverlayDB odb(DBFactory::create(DatabaseKind::MemoryDB));
+    odb.setRefCounting(true);
+
+    string const value = "\x43";
+    odb.insert(h256(42), &value);
+    odb.commit(1, h256(2));
+
+    // the same block committed again adds to its journal
+    odb.insert(h256(43), &value);
+    odb.commit(1, h256(2));
+
+    EXPECT_EQ(odb.markCanonical(1, h256(1)), 2);
+    EXPECT_FALSE(odb.exists(h256(42)));
+    EXPECT_FALSE(odb.exists(h256(43)));
+}
+
+TEST(OverlayDB, pruneWithoutId)
+{
+    OverlayDB odb(DBFactory::create(DatabaseKind::MemoryDB));
+    odb.setRefCounting(true);
+
+    string const value = "\x43";
+    odb.insert(h256(42), &value);
+    odb.insert(h256(43), &value);
+    odb.commit();
+
+    // without a journal the removed references are dropped by the commit
+    odb.kill(h256(42));
+    odb.kill(h256(43));
+    odb.insert(h256(43), &value);
+    odb.commit();
+
+    EXPECT_FALSE(odb.exists(h256(42)));
+    EXPECT_TRUE(odb.exists(h256(43)));
+}
+
+TEST(OverlayDB, refCountingMismatch)
+{
+    OverlayDB odb(DBFactory::create(DatabaseKind::MemoryDB));
+    string const value = "\x43";
+    odb.insert(h256(42), &value);
+    odb.commit();
+    EXPECT_THROW(odb.setRefCounting(true), RefCountingMismatch);
+
+    OverlayDB countedDb(DBFactory::create(DatabaseKind::MemoryDB));
+    countedDb.setRefCounting(true);
+    EXPECT_THROW(countedDb.setRefCounting(false), RefCountingMismatch);
+}
+
+TEST(OverlayDB, nodeCache)
+{
+    OverlayDB odb(DBFactory::create(DatabaseKind::MemoryDB));
+    odb.setRefCounting(true);
+    auto const cache = std::make_shared<TrieNodeCache>();
+    odb.setNodeCache(cache);
+
+    string const value = "\x43";
+    cache->insert(h256(44), value);
+    EXPECT_EQ(odb.lookup(h256(44)), value);
+    OverlayDB const copy = odb;
+    EXPECT_EQ(copy.lookup(h256(44)), value);
+
+    // the nodes deleted by pruning are dropped from the cache
+    odb.insert(h256(42), &value);
+    odb.commit(1, h256(1));
+    cache->insert(h256(42), value);
+    odb.kill(h256(42));
+    odb.commit(2, h256(2));
+    EXPECT_EQ(odb.markCanonical(2, h256(2)), 1);
+    EXPECT_FALSE(cache->contains(h256(42)));
+    EXPECT_TRUE(odb.lookup(h256(42)).empty());
+}
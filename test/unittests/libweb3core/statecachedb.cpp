@@ -109,7 +109,7 @@ TEST(StateCacheDB, purgeAuxMem)
     class AuxStateCacheDB : public StateCacheDB
     {
     public:
-        std::unordered_map<h256, std::pair<bytes, bool>> getAux() { return m_aux; }
+        std::unordered_map<h256, std::pair<bytes, bool>> getAux() { return *m_aux; }
     };
 
     AuxStateCacheDB myDB;
@@ -185,3 +185,28 @@ TEST(StateCacheDB, stream)
         "000000000000000000000000000000000000000000000000000000000000002a: 0x43 "
         "43\n000000000000000000000000000000000000000000000000000000000000002b: 0x43 43\n");
 }
+
+TEST(StateCacheDB, copiesAreIndependent)
+{
+    StateCacheDB myDB;
+    string const value = "\x43";
+    myDB.insert(h256(42), &value);
+
+    StateCacheDB copy(myDB);
+    EXPECT_EQ(copy.lookup(h256(42)), value);
+
+    // modifications of either copy are not visible in the other one
+    copy.insert(h256(43), &value);
+    EXPECT_TRUE(copy.exists(h256(43)));
+    EXPECT_FALSE(myDB.exists(h256(43)));
+
+    EXPECT_TRUE(myDB.kill(h256(42)));
+    myDB.purge();
+    EXPECT_FALSE(myDB.exists(h256(42)));
+    EXPECT_TRUE(copy.exists(h256(42)));
+
+    bytes const auxValue = fromHex("44");
+    myDB.insertAux(h256(44), &auxValue);
+    EXPECT_EQ(myDB.lookupAux(h256(44)), auxValue);
+    EXPECT_TRUE(copy.lookupAux(h256(44)).empty());
+}
@@ -0,0 +1,157 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/MemoryDB.h>
+#include <libdevcore/WriteBehindDB.h>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace dev;
+using namespace dev::db;
+
+namespace
+{
+/// Holds the commits of the GatedDBs until it is opened, and logs them.
+struct Gate
+{
+    void open()
+    {
+        {
+            Guard l(x);
+            isOpen = true;
+        }
+        opened.notify_all();
+    }
+
+    Mutex x;
+    condition_variable opened;
+    bool isOpen = false;
+    vector<string> log;
+};
+
+class GatedDB : public MemoryDB
+{
+public:
+    GatedDB(string const& _name, Gate& _gate, bool _fail = false)
+      : m_name(_name), m_gate(_gate), m_fail(_fail)
+    {}
+
+    void commit(unique_ptr<WriteBatchFace> _batch) override
+    {
+        {
+            UniqueGuard l(m_gate.x);
+            m_gate.opened.wait(l, [&]() { return m_gate.isOpen; });
+            m_gate.log.push_back(m_name);
+        }
+        if (m_fail)
+            BOOST_THROW_EXCEPTION(DatabaseError());
+        MemoryDB::commit(move(_batch));
+    }
+
+private:
+    string const m_name;
+    Gate& m_gate;
+    bool const m_fail;
+};
+
+void insert(DatabaseFace& _db, string const& _key, string const& _value)
+{
+    _db.insert(Slice(_key), Slice(_value));
+}
+}  // namespace
+
+TEST(WriteBehindDB, readsPendingRecordsUntilWritten)
+{
+    Gate gate;
+    auto* gated = new GatedDB("a", gate);
+    gated->MemoryDB::insert(Slice("old"), Slice("value"));
+    auto queue = make_shared<WriteQueue>(4);
+    WriteBehindDB db(unique_ptr<DatabaseFace>(gated), queue);
+
+    auto batch = db.createWriteBatch();
+    batch->insert(Slice("new"), Slice("value"));
+    batch->kill(Slice("old"));
+    db.commit(move(batch));
+
+    EXPECT_EQ(db.lookup(Slice("new")), "value");
+    EXPECT_TRUE(db.exists(Slice("new")));
+    EXPECT_EQ(db.lookup(Slice("old")), "");
+    EXPECT_FALSE(db.exists(Slice("old")));
+    EXPECT_FALSE(gated->exists(Slice("new")));
+    EXPECT_TRUE(gated->exists(Slice("old")));
+
+    gate.open();
+    queue->flush();
+    EXPECT_EQ(gated->lookup(Slice("new")), "value");
+    EXPECT_FALSE(gated->exists(Slice("old")));
+    EXPECT_EQ(db.lookup(Slice("new")), "value");
+    EXPECT_FALSE(db.exists(Slice("old")));
+}
+
+TEST(WriteBehindDB, readsLatestCommitOfRecord)
+{
+    Gate gate;
+    auto queue = make_shared<WriteQueue>(4);
+    WriteBehindDB db(unique_ptr<DatabaseFace>(new GatedDB("a", gate)), queue);
+
+    insert(db, "key", "first");
+    insert(db, "key", "second");
+    EXPECT_EQ(db.lookup(Slice("key")), "second");
+    db.kill(Slice("key"));
+    EXPECT_FALSE(db.exists(Slice("key")));
+    insert(db, "key", "third");
+
+    gate.open();
+    queue->flush();
+    EXPECT_EQ(db.lookup(Slice("key")), "third");
+}
+
+TEST(WriteBehindDB, writesInCommitOrderAcrossDatabases)
+{
+    Gate gate;
+    auto queue = make_shared<WriteQueue>(4);
+    WriteBehindDB first(unique_ptr<DatabaseFace>(new GatedDB("first", gate)), queue);
+    WriteBehindDB second(unique_ptr<DatabaseFace>(new GatedDB("second", gate)), queue);
+
+    insert(first, "a", "1");
+    insert(second, "b", "2");
+    insert(first, "c", "3");
+    insert(second, "d", "4");
+
+    gate.open();
+    queue->flush();
+    EXPECT_EQ(gate.log, (vector<string>{"first", "second", "first", "second"}));
+}
+
+TEST(WriteBehindDB, dropsWritesAfterFailedOne)
+{
+    Gate gate;
+    auto* gated = new GatedDB("second", gate);
+    auto queue = make_shared<WriteQueue>(4);
+    WriteBehindDB first(unique_ptr<DatabaseFace>(new GatedDB("first", gate, true)), queue);
+    WriteBehindDB second(unique_ptr<DatabaseFace>(gated), queue);
+
+    insert(first, "a", "1");
+    insert(second, "b", "2");
+
+    gate.open();
+    EXPECT_THROW(queue->flush(), DatabaseError);
+    EXPECT_EQ(gate.log, vector<string>{"first"});
+    EXPECT_FALSE(gated->exists(Slice("b")));
+    EXPECT_THROW(insert(second, "c", "3"), DatabaseError);
+}
+
+TEST(WriteBehindDB, releaseWaitsForWrites)
+{
+    Gate gate;
+    auto queue = make_shared<WriteQueue>(4);
+    WriteBehindDB db(unique_ptr<DatabaseFace>(new GatedDB("a", gate)), queue);
+    insert(db, "key", "value");
+
+    thread opener([&]() { gate.open(); });
+    unique_ptr<DatabaseFace> released = db.release();
+    opener.join();
+    EXPECT_EQ(released->lookup(Slice("key")), "value");
+}
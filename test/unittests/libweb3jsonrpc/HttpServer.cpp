@@ -0,0 +1,90 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+
+#include <libdevcore/Metrics.h>
+#include <libweb3jsonrpc/HttpServer.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+using namespace std;
+using namespace dev;
+namespace http = boost::beast::http;
+
+namespace
+{
+/// Answers every request with the request.
+class EchoHandler : public jsonrpc::IClientConnectionHandler
+{
+public:
+    void HandleRequest(string const& _request, string& o_response) override
+    {
+        o_response = _request;
+    }
+};
+
+/// @returns the response to the request of @a _target with @a _method to the server on @a _port.
+http::response<http::string_body> request(
+    unsigned short _port, http::verb _method, string const& _target, string const& _body = {})
+{
+    boost::asio::io_context ioContext;
+    boost::beast::tcp_stream stream(ioContext);
+    stream.connect({boost::asio::ip::make_address("127.0.0.1"), _port});
+
+    http::request<http::string_body> request{_method, _target, 11};
+    request.body() = _body;
+    request.prepare_payload();
+    http::write(stream, request);
+
+    boost::beast::flat_buffer buffer;
+    http::response<http::string_body> response;
+    http::read(stream, buffer, response);
+    return response;
+}
+}  // namespace
+
+TEST(HttpServer, scrapeMetrics)
+{
+    MetricsRegistry::instance()
+        .counter("aleth_test_scrapes_total", "Scrapes of the HttpServer test.")
+        .inc(3);
+
+    HttpServer server("127.0.0.1", 0, nullptr, {}, 1);
+    server.enableMetrics(true);
+    ASSERT_TRUE(server.StartListening());
+
+    auto const response = request(server.port(), http::verb::get, "/metrics");
+    EXPECT_EQ(response.result(), http::status::ok);
+    EXPECT_EQ(response[http::field::content_type], "text/plain; version=0.0.4");
+    EXPECT_NE(response.body().find("# TYPE aleth_test_scrapes_total counter\n"), string::npos);
+    EXPECT_NE(response.body().find("\naleth_test_scrapes_total 3\n"), string::npos);
+
+    // the server answers nothing else
+    EXPECT_EQ(request(server.port(), http::verb::get, "/").result(),
+        http::status::method_not_allowed);
+    EXPECT_EQ(request(server.port(), http::verb::post, "/", "{}").result(),
+        http::status::method_not_allowed);
+    EXPECT_TRUE(server.StopListening());
+}
+
+TEST(HttpServer, metricsNextToRpc)
+{
+    EchoHandler handler;
+    HttpServer server("127.0.0.1", 0, nullptr, {}, 1);
+    server.SetHandler(&handler);
+    ASSERT_TRUE(server.StartListening());
+    EXPECT_EQ(request(server.port(), http::verb::get, "/metrics").result(),
+        http::status::method_not_allowed);
+    EXPECT_TRUE(server.StopListening());
+
+    server.enableMetrics();
+    ASSERT_TRUE(server.StartListening());
+    EXPECT_EQ(request(server.port(), http::verb::get, "/metrics").result(), http::status::ok);
+    auto const response = request(server.port(), http::verb::post, "/", R"({"id":1})");
+    EXPECT_EQ(response.result(), http::status::ok);
+    EXPECT_EQ(response.body(), R"({"id":1})");
+    EXPECT_TRUE(server.StopListening());
+}
@@ -0,0 +1,71 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+#include <libweb3jsonrpc/JsonFramer.h>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+using namespace dev::rpc;
+
+namespace
+{
+vector<string> frame(JsonFramer& _framer, string const& _data)
+{
+    _framer.append(_data.data(), _data.size());
+    vector<string> messages;
+    string message;
+    while (_framer.next(message))
+        messages.push_back(message);
+    return messages;
+}
+}  // namespace
+
+TEST(JsonFramer, splitsConcatenatedMessages)
+{
+    JsonFramer framer;
+    auto const messages = frame(framer, "{\"id\":1}\n[{\"id\":2},{\"id\":3}] {\"id\":4}");
+
+    ASSERT_EQ(messages.size(), 3);
+    EXPECT_EQ(messages[0], "{\"id\":1}");
+    EXPECT_EQ(messages[1], "[{\"id\":2},{\"id\":3}]");
+    EXPECT_EQ(messages[2], "{\"id\":4}");
+    EXPECT_EQ(framer.bufferedSize(), 0);
+}
+
+TEST(JsonFramer, ignoresBracketsInStrings)
+{
+    JsonFramer framer;
+    auto const messages = frame(framer, R"({"s":"}]\"{"}{"s":"\\"})");
+
+    ASSERT_EQ(messages.size(), 2);
+    EXPECT_EQ(messages[0], R"({"s":"}]\"{"})");
+    EXPECT_EQ(messages[1], R"({"s":"\\"})");
+}
+
+TEST(JsonFramer, keepsStateBetweenChunks)
+{
+    string const data = R"({"a":"x\"}","b":[1,{"c":2}]})";
+    JsonFramer framer;
+    for (size_t i = 0; i + 1 < data.size(); ++i)
+    {
+        EXPECT_TRUE(frame(framer, data.substr(i, 1)).empty());
+        EXPECT_EQ(framer.bufferedSize(), i + 1);
+    }
+
+    auto const messages = frame(framer, data.substr(data.size() - 1));
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_EQ(messages[0], data);
+}
+
+TEST(JsonFramer, keepsIncompleteMessage)
+{
+    JsonFramer framer;
+    auto messages = frame(framer, "{\"id\":1}{\"id\":");
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_EQ(framer.bufferedSize(), 6);
+
+    messages = frame(framer, "2}");
+    ASSERT_EQ(messages.size(), 1);
+    EXPECT_EQ(messages[0], "{\"id\":2}");
+}
@@ -0,0 +1,98 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+#include <libweb3jsonrpc/StreamingRequestHandler.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+using namespace std;
+using namespace dev;
+using namespace dev::rpc;
+
+namespace
+{
+/// Records the requests passed on to it and answers them with a fixed response.
+class NextHandler : public jsonrpc::IClientConnectionHandler
+{
+public:
+    void HandleRequest(string const& _request, string& o_response) override
+    {
+        requests.push_back(_request);
+        o_response = "next";
+    }
+
+    vector<string> requests;
+};
+
+class StreamingRequestHandlerTest : public testing::Test
+{
+public:
+    StreamingRequestHandlerTest()
+      : handler(next, {{"test_sum",
+                           [](Json::Value const& _params, JsonWriter& o_result) {
+                               uint64_t sum = 0;
+                               for (auto const& param : _params)
+                                   sum += param.asUInt64();
+                               o_result.value(sum);
+                           }},
+                          {"test_fail", [](Json::Value const&, JsonWriter& o_result) {
+                               o_result.beginObject().key("partial");
+                               throw runtime_error("failed");
+                           }}})
+    {}
+
+    string handle(string const& _request)
+    {
+        string response;
+        handler.HandleRequest(_request, response);
+        return response;
+    }
+
+    NextHandler next;
+    StreamingRequestHandler handler;
+};
+}  // namespace
+
+TEST_F(StreamingRequestHandlerTest, callIsAnsweredWithItsId)
+{
+    EXPECT_EQ(handle(R"({"jsonrpc":"2.0","id":7,"method":"test_sum","params":[1,2]})"),
+        "{\"id\":7,\"jsonrpc\":\"2.0\",\"result\":3}\n");
+    EXPECT_EQ(handle(R"({"jsonrpc":"2.0","id":"a","method":"test_sum"})"),
+        "{\"id\":\"a\",\"jsonrpc\":\"2.0\",\"result\":0}\n");
+    EXPECT_TRUE(next.requests.empty());
+}
+
+TEST_F(StreamingRequestHandlerTest, otherRequestsArePassedOn)
+{
+    vector<string> const requests{
+        // another method
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_blockNumber","params":[]})",
+        // the name appears, but not as the method
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_call","params":["test_sum"]})",
+        // notification
+        R"({"jsonrpc":"2.0","method":"test_sum","params":[]})",
+        // batch
+        R"([{"jsonrpc":"2.0","id":1,"method":"test_sum","params":[]}])",
+        // not JSON-RPC 2.0
+        R"({"id":1,"method":"test_sum","params":[]})",
+        // malformed
+        R"({"jsonrpc":"2.0","id":1,"method":"test_sum",)",
+        // invalid id and params
+        R"({"jsonrpc":"2.0","id":{},"method":"test_sum","params":[]})",
+        R"({"jsonrpc":"2.0","id":1,"method":"test_sum","params":1})",
+    };
+    for (auto const& request : requests)
+        EXPECT_EQ(handle(request), "next") << request;
+    EXPECT_EQ(next.requests, requests);
+}
+
+TEST_F(StreamingRequestHandlerTest, failedCallIsPassedOn)
+{
+    string const request = R"({"jsonrpc":"2.0","id":1,"method":"test_fail","params":[]})";
+    // the partial result is dropped, the next handler reports the error
+    EXPECT_EQ(handle(request), "next");
+    ASSERT_EQ(next.requests.size(), 1u);
+    EXPECT_EQ(next.requests[0], request);
+}
@@ -0,0 +1,128 @@
+// Aleth: Ethereum C++ client, tools and libraries.
+// Copyright 2019 Aleth Authors.
+// Licensed under the GNU General Public License, Version 3.
+#if !defined(_WIN32)
+
+#include <libdevcore/FileSystem.h>
+#include <libdevcore/TransientDirectory.h>
+#include <libweb3jsonrpc/JsonFramer.h>
+#include <libweb3jsonrpc/UnixSocketServer.h>
+
+#include <gtest/gtest.h>
+
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/write.hpp>
+
+#include <chrono>
+#include <thread>
+
+using namespace std;
+using namespace dev;
+using namespace dev::rpc;
+namespace ba = boost::asio;
+using stream_protocol = ba::local::stream_protocol;
+
+namespace
+{
+/// Answers the requests having an id with the request wrapped in an array, the others are
+/// notifications without a response.
+class EchoHandler : public jsonrpc::IClientConnectionHandler
+{
+public:
+    void HandleRequest(string const& _request, string& o_response) override
+    {
+        o_response = _request.find("\"id\"") == string::npos ? string() : "[" + _request + "]\n";
+    }
+};
+
+class UnixSocketServerTest : public testing::Test
+{
+public:
+    UnixSocketServerTest() : previousIpcPath(getIpcPath())
+    {
+        setIpcPath(directory.path());
+        server.reset(new UnixDomainSocketServer("test", 2));
+        server->SetHandler(&handler);
+        EXPECT_TRUE(server->StartListening());
+        socket.connect(stream_protocol::endpoint(directory.path() + "/test.ipc"));
+    }
+
+    ~UnixSocketServerTest()
+    {
+        server->StopListening();
+        setIpcPath(previousIpcPath);
+    }
+
+    void send(string const& _data) { ba::write(socket, ba::buffer(_data)); }
+
+    /// @returns the next @a _count responses.
+    vector<string> receive(size_t _count)
+    {
+        vector<string> responses;
+        char buffer[1024];
+        string response;
+        while (responses.size() < _count)
+        {
+            while (responses.size() < _count && framer.next(response))
+                responses.push_back(response);
+            if (responses.size() < _count)
+            {
+                size_t const size = socket.read_some(ba::buffer(buffer));
+                framer.append(buffer, size);
+            }
+        }
+        return responses;
+    }
+
+    boost::filesystem::path const previousIpcPath;
+    TransientDirectory directory;
+    EchoHandler handler;
+    unique_ptr<UnixDomainSocketServer> server;
+    ba::io_context ioContext;
+    stream_protocol::socket socket{ioContext};
+    JsonFramer framer;
+};
+}  // namespace
+
+TEST_F(UnixSocketServerTest, pipelinedRequestsAreAnsweredInOrder)
+{
+    send(R"({"id":1}{"id":2}
+[{"id":3},{"id":4}] {"n":5}{"id":6})");
+
+    auto const responses = receive(4);
+    EXPECT_EQ(responses[0], R"([{"id":1}])");
+    EXPECT_EQ(responses[1], R"([{"id":2}])");
+    EXPECT_EQ(responses[2], R"([[{"id":3},{"id":4}]])");
+    EXPECT_EQ(responses[3], R"([{"id":6}])");
+}
+
+TEST_F(UnixSocketServerTest, splitRequestIsAnsweredWhenComplete)
+{
+    send(R"({"id":1,"s":"}{)");
+    this_thread::sleep_for(chrono::milliseconds(50));
+    send(R"("}{"id")");
+    this_thread::sleep_for(chrono::milliseconds(50));
+    send(R"(:2})");
+
+    auto const responses = receive(2);
+    EXPECT_EQ(responses[0], R"([{"id":1,"s":"}{"}])");
+    EXPECT_EQ(responses[1], R"([{"id":2}])");
+}
+
+TEST_F(UnixSocketServerTest, connectionsAreServedIndependently)
+{
+    stream_protocol::socket other{ioContext};
+    other.connect(stream_protocol::endpoint(directory.path() + "/test.ipc"));
+    // the first connection has an incomplete request
+    send(R"({"id":)");
+    ba::write(other, ba::buffer(string(R"({"id":2})")));
+
+    char buffer[64];
+    size_t const size = other.read_some(ba::buffer(buffer));
+    EXPECT_EQ(string(buffer, size), "[{\"id\":2}]\n");
+
+    send("1}");
+    EXPECT_EQ(receive(1)[0], R"([{"id":1}])");
+}
+
+#endif
@@ -7,6 +7,7 @@
 #include "WebThreeStubClient.h"
 #include <jsonrpccpp/server/abstractserverconnector.h>
 #include <libdevcore/CommonIO.h>
+#include <libdevcore/TransientDirectory.h>
 #include <libethcore/CommonJS.h>
 #include <libethcore/KeyManager.h>
 #include <libweb3jsonrpc/AccountHolder.h>
@@ -14,13 +15,19 @@
 #include <libweb3jsonrpc/AdminNet.h>
 #include <libweb3jsonrpc/Debug.h>
 #include <libweb3jsonrpc/Eth.h>
+#include <libweb3jsonrpc/HttpServer.h>
+#include <libweb3jsonrpc/JsonHelper.h>
 #include <libweb3jsonrpc/ModularServer.h>
 #include <libweb3jsonrpc/Net.h>
+#include <libweb3jsonrpc/Subscriptions.h>
 #include <libweb3jsonrpc/Test.h>
 #include <libweb3jsonrpc/Web3.h>
 #include <libwebthree/WebThree.h>
 #include <test/tools/libtesteth/TestHelper.h>
 #include <test/tools/libtesteth/TestOutputHelper.h>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/websocket.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/test/unit_test.hpp>
 
@@ -72,6 +79,21 @@ static std::string const c_genesisConfigString = R"(
 }
 )";
 
+/// The first block on the chain of c_genesisConfigString.
+static std::string const c_block1Rlp =
+    "0xf90213f9020ea0c92211c9cd49036c37568feedb8e518a24a77e9f6ca959931a19dcf186a8e1e6a01dcc4de8"
+    "dec75d7aab85b567b6ccd41ad312451b948a7413f0a142fd40d49347942adc25665018aa1fe0e6bc666dac8fc2"
+    "697ff9baa04b4b7a0d58a2388c0e6b3b048c3c27edd6febc6f04171167ed15a77ab2e60b16a056e81f171bcc55"
+    "a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421a056e81f171bcc55a6ff8345e692c0f86e5b48e0"
+    "1b996cadc001622fb5e363b421b901000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+    "00008302000001830f460f80845d1ca87c97d68094312e372e302b2b63346336646c696e7578636c61a0000000"
+    "0000000000000000000000000000000000000000000000000000000000880000000000000000c0c0";
+
 
 namespace
 {
@@ -139,7 +161,7 @@ struct JsonRpcFixture : public TestOutputHelperFixture
         rpcServer.reset(
             new FullServer(ethFace, new rpc::Net(*web3), new rpc::Web3(web3->clientVersion()),
                 new rpc::AdminEth(*web3->ethereum(), *gasPricer, keyManager, *sessionManager.get()),
-                new rpc::AdminNet(*web3, *sessionManager), new rpc::Debug(*web3->ethereum()),
+                new rpc::AdminNet(*web3, *sessionManager), new rpc::Debug(*web3->ethereum(), *sessionManager),
                 new rpc::Test(*web3->ethereum())));
         auto ipcServer = new TestIpcServer;
         rpcServer->addConnector(ipcServer);
@@ -175,6 +197,63 @@ struct JsonRpcFixture : public TestOutputHelperFixture
     std::string adminSession;
 };
 
+/// @returns the response to the HTTP POST of @a _body to the HttpServer listening on @a _port.
+boost::beast::http::response<boost::beast::http::string_body> httpPost(
+    unsigned short _port, string const& _body)
+{
+    namespace http = boost::beast::http;
+    boost::asio::io_context ioContext;
+    boost::beast::tcp_stream stream(ioContext);
+    stream.connect({boost::asio::ip::make_address("127.0.0.1"), _port});
+
+    http::request<http::string_body> request{http::verb::post, "/", 11};
+    request.set(http::field::content_type, "application/json");
+    request.body() = _body;
+    request.prepare_payload();
+    http::write(stream, request);
+
+    boost::beast::flat_buffer buffer;
+    http::response<http::string_body> response;
+    http::read(stream, buffer, response);
+    return response;
+}
+
+/// WebSocket client of the HttpServer tests.
+class WebSocketClient
+{
+public:
+    explicit WebSocketClient(unsigned short _port) : m_ws(m_ioContext)
+    {
+        m_ws.next_layer().connect({boost::asio::ip::make_address("127.0.0.1"), _port});
+        m_ws.handshake("127.0.0.1", "/");
+    }
+
+    void send(string const& _message) { m_ws.write(boost::asio::buffer(_message)); }
+
+    /// @returns the next message, or null if none arrives in time.
+    Json::Value read()
+    {
+        boost::beast::flat_buffer buffer;
+        bool received = false;
+        m_ws.async_read(buffer, [&](boost::beast::error_code _ec, size_t) { received = !_ec; });
+        m_ioContext.restart();
+        m_ioContext.run_for(chrono::seconds(10));
+        if (!received)
+        {
+            m_ws.next_layer().close();
+            return Json::Value();
+        }
+        Json::Value message;
+        BOOST_REQUIRE(
+            Json::Reader().parse(boost::beast::buffers_to_string(buffer.data()), message));
+        return message;
+    }
+
+private:
+    boost::asio::io_context m_ioContext;
+    boost::beast::websocket::stream<boost::asio::ip::tcp::socket> m_ws;
+};
+
 string fromAscii(string _s)
 {
     bytes b = asBytes(_s);
@@ -700,6 +779,351 @@ BOOST_AUTO_TEST_CASE(debugTraceTransaction)
     BOOST_REQUIRE_GT(result["structLogs"].size(), 0u);
 }
 
+BOOST_AUTO_TEST_CASE(debugTraceTransactionStreaming)
+{
+    dev::eth::mine(*(web3->ethereum()), 1);
+
+    // stores 7 in slot 0
+    Json::Value tx;
+    tx["code"] =
+        "608060405260076000553415601357600080fd5b60358060206000396000"
+        "f3006080604052600080fd00a165627a7a7230582006db0551577963b544"
+        "3e9501b4b10880e186cff876cd360e9ad6e4181731fcdd0029";
+    tx["from"] = toJS(coinbase.address());
+    string const txHash = rpcClient->eth_sendTransaction(tx);
+    dev::eth::mine(*(web3->ethereum()), 1);
+
+    rpc::Debug debug(*web3->ethereum(), *sessionManager);
+    auto const methods = debug.streamingMethods();
+    auto const trace = [&](Json::Value const& _options) {
+        Json::Value params(Json::arrayValue);
+        params.append(txHash);
+        params.append(_options);
+        string out;
+        rpc::JsonWriter writer(out);
+        methods.at("debug_traceTransaction")(params, writer);
+        Json::Value result;
+        BOOST_REQUIRE(Json::Reader().parse(out, result));
+        return result;
+    };
+
+    Json::Value const expected =
+        rpcClient->debug_traceTransaction(txHash, Json::Value(Json::objectValue));
+    Json::Value const full = trace(Json::Value(Json::objectValue));
+    BOOST_CHECK_EQUAL(full, expected);
+
+    Json::Value options(Json::objectValue);
+    options["limit"] = 3;
+    Json::Value const limited = trace(options);
+    BOOST_CHECK_EQUAL(limited["structLogs"].size(), 3);
+    BOOST_CHECK(limited["truncated"].asBool());
+    BOOST_CHECK_EQUAL(
+        limited, rpcClient->debug_traceTransaction(txHash, options));
+
+    options = Json::Value(Json::objectValue);
+    options["onlyChanges"] = true;
+    Json::Value const changes = trace(options);
+    Json::Value const& steps = changes["structLogs"];
+    BOOST_REQUIRE_EQUAL(steps.size(), full["structLogs"].size());
+    // carrying the memory forward gives the full trace
+    Json::Value memory;
+    unsigned memorySteps = 0;
+    for (unsigned i = 0; i < steps.size(); ++i)
+    {
+        if (steps[i].isMember("memory"))
+        {
+            memory = steps[i]["memory"];
+            ++memorySteps;
+        }
+        BOOST_CHECK_EQUAL(memory, full["structLogs"][i]["memory"]);
+    }
+    BOOST_CHECK_LT(memorySteps, steps.size());
+    // of the storage only the slot written by the SSTORE before
+    unsigned storageSteps = 0;
+    for (unsigned i = 0; i < steps.size(); ++i)
+        if (steps[i].isMember("storage"))
+        {
+            ++storageSteps;
+            BOOST_REQUIRE_GT(i, 0);
+            BOOST_CHECK_EQUAL(steps[i - 1]["op"].asUInt(), unsigned(Instruction::SSTORE));
+            Json::Value written(Json::objectValue);
+            written["0x00"] = "0x07";
+            BOOST_CHECK_EQUAL(steps[i]["storage"], written);
+        }
+    BOOST_CHECK_EQUAL(storageSteps, 1);
+
+    // the default size limit is lifted with 0
+    options = Json::Value(Json::objectValue);
+    options["maxOutputSize"] = 0;
+    BOOST_CHECK_EQUAL(trace(options), full);
+    options["maxOutputSize"] = 1000;
+    Json::Value const small = trace(options);
+    BOOST_CHECK(small["truncated"].asBool());
+    BOOST_CHECK_GT(small["structLogs"].size(), 0);
+    BOOST_CHECK_LT(small["structLogs"].size(), full["structLogs"].size());
+    size_t size = 0;
+    for (auto const& step : small["structLogs"])
+        size += Json::FastWriter().write(step).size() - 1;
+    BOOST_CHECK_LE(size, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(debugTraceChain)
+{
+    dev::eth::mine(*(web3->ethereum()), 1);
+    for (int i = 0; i < 3; ++i)
+    {
+        // stores 7 in slot 0
+        Json::Value tx;
+        tx["code"] =
+            "608060405260076000553415601357600080fd5b60358060206000396000"
+            "f3006080604052600080fd00a165627a7a7230582006db0551577963b544"
+            "3e9501b4b10880e186cff876cd360e9ad6e4181731fcdd0029";
+        tx["from"] = toJS(coinbase.address());
+        rpcClient->eth_sendTransaction(tx);
+        dev::eth::mine(*(web3->ethereum()), 1);
+    }
+    int const last = web3->ethereum()->number();
+    int const first = last - 3;
+
+    Json::Value options(Json::objectValue);
+    options["threads"] = 2;
+    Json::Value const chain = rpcClient->debug_traceChain(first, last, options);
+    BOOST_REQUIRE_EQUAL(chain.size(), 4);
+    for (int number = first; number <= last; ++number)
+    {
+        Json::Value const& trace = chain[number - first];
+        BOOST_CHECK_EQUAL(trace["number"], toJS(number));
+        BOOST_CHECK_EQUAL(trace["hash"], toJS(web3->ethereum()->hashFromNumber(number)));
+        BOOST_CHECK_EQUAL(trace["structLogs"],
+            rpcClient->debug_traceBlockByNumber(number, options)["structLogs"]);
+    }
+
+    rpc::Debug debug(*web3->ethereum(), *sessionManager);
+    Json::Value params(Json::arrayValue);
+    params.append(first);
+    params.append(last);
+    params.append(options);
+    string out;
+    rpc::JsonWriter writer(out);
+    debug.streamingMethods().at("debug_traceChain")(params, writer);
+    Json::Value streamed;
+    BOOST_REQUIRE(Json::Reader().parse(out, streamed));
+    BOOST_CHECK_EQUAL(streamed, chain);
+
+    // the limits apply to the whole response, the first block has no transactions
+    Json::Value const& fullSteps = chain[1]["structLogs"][0];
+    Json::Value limited(Json::objectValue);
+    limited["threads"] = 1;
+    limited["limit"] = fullSteps.size() + 2;
+    Json::Value const limitedChain = rpcClient->debug_traceChain(first, last, limited);
+    BOOST_REQUIRE_EQUAL(limitedChain.size(), 4);
+    BOOST_CHECK(!limitedChain[1].isMember("truncated"));
+    BOOST_CHECK_EQUAL(limitedChain[1]["structLogs"][0], fullSteps);
+    BOOST_CHECK(limitedChain[2]["truncated"].asBool());
+    BOOST_CHECK_EQUAL(limitedChain[2]["structLogs"][0].size(), 2);
+    BOOST_CHECK(limitedChain[3]["truncated"].asBool());
+    BOOST_CHECK_EQUAL(limitedChain[3]["structLogs"][0].size(), 0);
+
+    params[2u] = limited;
+    string limitedOut;
+    rpc::JsonWriter limitedWriter(limitedOut);
+    debug.streamingMethods().at("debug_traceChain")(params, limitedWriter);
+    BOOST_REQUIRE(Json::Reader().parse(limitedOut, streamed));
+    BOOST_CHECK_EQUAL(streamed, limitedChain);
+
+    // so does the size limit
+    size_t firstSize = 0;
+    for (auto const& step : fullSteps)
+        firstSize += Json::FastWriter().write(step).size() - 1;
+    Json::Value sized(Json::objectValue);
+    sized["threads"] = 1;
+    sized["maxOutputSize"] = Json::UInt64(firstSize);
+    Json::Value const sizedChain = rpcClient->debug_traceChain(first, last, sized);
+    BOOST_REQUIRE_EQUAL(sizedChain.size(), 4);
+    BOOST_CHECK(!sizedChain[1].isMember("truncated"));
+    BOOST_CHECK_EQUAL(sizedChain[1]["structLogs"][0], fullSteps);
+    for (int i = 2; i < 4; ++i)
+    {
+        BOOST_CHECK(sizedChain[i]["truncated"].asBool());
+        BOOST_CHECK_EQUAL(sizedChain[i]["structLogs"][0].size(), 0);
+    }
+
+    limited["limit"] = 3;
+    Json::Value const limitedBlock = rpcClient->debug_traceBlockByNumber(first + 1, limited);
+    BOOST_CHECK(limitedBlock["truncated"].asBool());
+    BOOST_CHECK_EQUAL(limitedBlock["structLogs"][0].size(), 3);
+
+    BOOST_CHECK_THROW(rpcClient->debug_traceChain(last, first, options), jsonrpc::JsonRpcException);
+    BOOST_CHECK_THROW(
+        rpcClient->debug_traceChain(first, last + 1, options), jsonrpc::JsonRpcException);
+}
+
+BOOST_AUTO_TEST_CASE(debugTraceTransactionNativeTracers)
+{
+    dev::eth::mine(*(web3->ethereum()), 1);
+
+    // stores 7 in slot 0
+    Json::Value tx;
+    tx["code"] =
+        "608060405260076000553415601357600080fd5b60358060206000396000"
+        "f3006080604052600080fd00a165627a7a7230582006db0551577963b544"
+        "3e9501b4b10880e186cff876cd360e9ad6e4181731fcdd0029";
+    tx["from"] = toJS(coinbase.address());
+    string const txHash = rpcClient->eth_sendTransaction(tx);
+    dev::eth::mine(*(web3->ethereum()), 1);
+    Json::Value const receipt = rpcClient->eth_getTransactionReceipt(txHash);
+    Json::Value const transaction = rpcClient->eth_getTransactionByHash(txHash);
+
+    Json::Value options(Json::objectValue);
+    options["tracer"] = "callTracer";
+    Json::Value const calls = rpcClient->debug_traceTransaction(txHash, options);
+    BOOST_CHECK_EQUAL(calls["type"], "CREATE");
+    BOOST_CHECK_EQUAL(calls["from"], toJS(coinbase.address()));
+    BOOST_CHECK_EQUAL(calls["to"], receipt["contractAddress"]);
+    BOOST_CHECK_EQUAL(calls["gas"], transaction["gas"]);
+    BOOST_CHECK_EQUAL(calls["gasUsed"], receipt["gasUsed"]);
+    BOOST_CHECK(!calls.isMember("error"));
+    BOOST_CHECK(!calls.isMember("calls"));
+
+    options["tracer"] = "prestateTracer";
+    Json::Value const prestate = rpcClient->debug_traceTransaction(txHash, options);
+    // the sender, which is also the author of the block; the created contract didn't exist
+    BOOST_REQUIRE_EQUAL(prestate.size(), 1);
+    Json::Value const& sender = prestate[toJS(coinbase.address())];
+    BOOST_CHECK_EQUAL(toJS(sender["nonce"].asUInt64()), transaction["nonce"].asString());
+    BOOST_CHECK_EQUAL(sender["code"], "0x");
+
+    rpc::Debug debug(*web3->ethereum(), *sessionManager);
+    Json::Value params(Json::arrayValue);
+    params.append(txHash);
+    params.append(options);
+    string out;
+    rpc::JsonWriter writer(out);
+    debug.streamingMethods().at("debug_traceTransaction")(params, writer);
+    Json::Value streamed;
+    BOOST_REQUIRE(Json::Reader().parse(out, streamed));
+    BOOST_CHECK_EQUAL(streamed, prestate);
+
+    options["tracer"] = "noSuchTracer";
+    BOOST_CHECK_THROW(rpcClient->debug_traceTransaction(txHash, options), jsonrpc::JsonRpcException);
+}
+
+BOOST_AUTO_TEST_CASE(debugTraceTransactionNativeTracersNestedCalls)
+{
+    Address const a{0xaa};
+    Address const b{0xbb};
+    Address const c{0xcc};
+    Address const d{0xdd};
+    Address const e{0xee};
+    Address const r{0xff};
+    string const noArgs = "6000600060006000";
+    Json::Value config;
+    Json::Reader().parse(c_genesisConfigString, config);
+    config["genesis"]["extraData"] = toHexPrefixed(h256::random().asBytes());
+    config["params"]["byzantiumForkBlock"] = "0x00";
+    config["params"]["constantinopleForkBlock"] = "0x00";
+    config["params"]["constantinopleFixForkBlock"] = "0x00";
+    Json::Value& accounts = config["accounts"] = Json::Value{Json::objectValue};
+    auto const addAccount = [&](Address const& _address, string const& _code) {
+        Json::Value& account = accounts[toJS(_address)];
+        account["balance"] = _address == coinbase.address() ? "0x0de0b6b3a7640000" : "0x00";
+        account["code"] = "0x" + _code;
+        account["nonce"] = "0x00";
+        account["storage"] = Json::Value{Json::objectValue};
+    };
+    addAccount(coinbase.address(), "");
+    // CALL b with 1 wei, DELEGATECALL c, CALLCODE c, STATICCALL d, CALL r
+    addAccount(a, noArgs + "6001" + "73" + b.hex() + "5af150" + noArgs + "73" + c.hex() +
+                      "5af450" + noArgs + "6000" + "73" + c.hex() + "5af250" + noArgs + "73" +
+                      d.hex() + "5afa50" + noArgs + "6000" + "73" + r.hex() + "5af15000");
+    // stores 1 in slot 0
+    addAccount(b, "600160005500");
+    // stores 2 in slot 1 of the calling contract
+    addAccount(c, "600260015500");
+    // EXTCODEHASH of e, STATICCALL e and CALL e in the static context
+    addAccount(d, "73" + e.hex() + "3f50" + noArgs + "73" + e.hex() + "5afa50" + noArgs + "6000" +
+                      "73" + e.hex() + "5af15000");
+    addAccount(e, "00");
+    // reverts
+    addAccount(r, "60006000fd");
+    rpcClient->test_setChainParams(config);
+
+    Json::Value tx;
+    tx["from"] = toJS(coinbase.address());
+    tx["to"] = toJS(a);
+    tx["value"] = "0x10";
+    tx["gas"] = "0x493e0";
+    string const txHash = rpcClient->eth_sendTransaction(tx);
+    rpcClient->test_mineBlocks(1);
+
+    Json::Value options(Json::objectValue);
+    options["tracer"] = "callTracer";
+    Json::Value const trace = rpcClient->debug_traceTransaction(txHash, options);
+    BOOST_CHECK_EQUAL(trace["type"], "CALL");
+    BOOST_CHECK_EQUAL(trace["from"], toJS(coinbase.address()));
+    BOOST_CHECK_EQUAL(trace["to"], toJS(a));
+    BOOST_CHECK_EQUAL(trace["value"], "0x10");
+    BOOST_CHECK(!trace.isMember("error"));
+    Json::Value const& calls = trace["calls"];
+    BOOST_REQUIRE_EQUAL(calls.size(), 5);
+
+    vector<tuple<string, Address, string>> const expected{{"CALL", b, "0x1"},
+        {"DELEGATECALL", c, "0x0"}, {"CALLCODE", c, "0x0"}, {"STATICCALL", d, "0x0"},
+        {"CALL", r, "0x0"}};
+    for (unsigned i = 0; i < expected.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(calls[i]["type"], get<0>(expected[i]));
+        BOOST_CHECK_EQUAL(calls[i]["from"], toJS(a));
+        BOOST_CHECK_EQUAL(calls[i]["to"], toJS(get<1>(expected[i])));
+        BOOST_CHECK_EQUAL(calls[i]["value"], get<2>(expected[i]));
+        BOOST_CHECK_EQUAL(calls[i].isMember("calls"), i == 3);
+    }
+    for (unsigned i = 0; i < 4; ++i)
+        BOOST_CHECK(!calls[i].isMember("error"));
+    BOOST_CHECK_EQUAL(calls[4]["error"], "RevertInstruction");
+
+    // the calls made in the static context keep their instructions
+    Json::Value const& staticCalls = calls[3]["calls"];
+    BOOST_REQUIRE_EQUAL(staticCalls.size(), 2);
+    BOOST_CHECK_EQUAL(staticCalls[0]["type"], "STATICCALL");
+    BOOST_CHECK_EQUAL(staticCalls[1]["type"], "CALL");
+    for (auto const& call : staticCalls)
+    {
+        BOOST_CHECK_EQUAL(call["from"], toJS(d));
+        BOOST_CHECK_EQUAL(call["to"], toJS(e));
+        BOOST_CHECK(!call.isMember("error"));
+    }
+
+    options["tracer"] = "prestateTracer";
+    Json::Value const prestate = rpcClient->debug_traceTransaction(txHash, options);
+    // the code accounts of DELEGATECALL and CALLCODE and the target of EXTCODEHASH included
+    BOOST_CHECK_EQUAL(prestate.size(), 7);
+    for (auto const& address : {coinbase.address(), a, b, c, d, e, r})
+        BOOST_CHECK(prestate.isMember(toJS(address)));
+    BOOST_CHECK_EQUAL(prestate[toJS(a)]["balance"], "0x0");
+    BOOST_CHECK_EQUAL(prestate[toJS(e)]["code"], "0x00");
+    Json::Value const& storageA = prestate[toJS(a)]["storage"];
+    BOOST_REQUIRE_EQUAL(storageA.size(), 1);
+    BOOST_CHECK_EQUAL(storageA[toJS(h256{1})], toJS(h256{}));
+    Json::Value const& storageB = prestate[toJS(b)]["storage"];
+    BOOST_REQUIRE_EQUAL(storageB.size(), 1);
+    BOOST_CHECK_EQUAL(storageB[toJS(h256{})], toJS(h256{}));
+    BOOST_CHECK(!prestate[toJS(c)].isMember("storage"));
+}
+
+BOOST_AUTO_TEST_CASE(debugWriteImportTrace)
+{
+    TransientDirectory tempDir;
+    string const path = (boost::filesystem::path(tempDir.path()) / "imports.json").string();
+    BOOST_CHECK_THROW(rpcClient->debug_writeImportTrace(path, "bad"), jsonrpc::JsonRpcException);
+    BOOST_CHECK(!boost::filesystem::exists(path));
+
+    BOOST_CHECK(rpcClient->debug_writeImportTrace(path, adminSession));
+    Json::Value trace;
+    BOOST_REQUIRE(Json::Reader().parse(contentsString(path), trace));
+    BOOST_CHECK(trace["traceEvents"].isArray());
+}
+
 BOOST_AUTO_TEST_CASE(adminEthVmTrace)
 {
     // mine to get some balance at coinbase
@@ -741,19 +1165,7 @@ BOOST_AUTO_TEST_CASE(test_importRawBlock)
     Json::Reader().parse(c_genesisConfigString, ret);
     rpcClient->test_setChainParams(ret);
 
-    string blockHash = rpcClient->test_importRawBlock(
-        "0xf90213f9020ea0c92211c9cd49036c37568feedb8e518a24a77e9f6ca959931a19dcf186a8e1e6a01dcc4de8"
-        "dec75d7aab85b567b6ccd41ad312451b948a7413f0a142fd40d49347942adc25665018aa1fe0e6bc666dac8fc2"
-        "697ff9baa04b4b7a0d58a2388c0e6b3b048c3c27edd6febc6f04171167ed15a77ab2e60b16a056e81f171bcc55"
-        "a6ff8345e692c0f86e5b48e01b996cadc001622fb5e363b421a056e81f171bcc55a6ff8345e692c0f86e5b48e0"
-        "1b996cadc001622fb5e363b421b901000000000000000000000000000000000000000000000000000000000000"
-        "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
-        "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
-        "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
-        "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
-        "000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
-        "00008302000001830f460f80845d1ca87c97d68094312e372e302b2b63346336646c696e7578636c61a0000000"
-        "0000000000000000000000000000000000000000000000000000000000880000000000000000c0c0");
+    string blockHash = rpcClient->test_importRawBlock(c_block1Rlp);
     BOOST_CHECK_EQUAL(
         blockHash, "0x0ef84365e15a50e7440286de7e9c1ca47f17af98b2c8d3d97503045d8f5a128b");
 
@@ -879,4 +1291,314 @@ BOOST_AUTO_TEST_CASE(call_from_parameter)
         responseString, "0x000000000000000000000000112233445566778899aabbccddeeff0011223344");
 }
 
+BOOST_AUTO_TEST_CASE(jsonrpc_parallelBatch)
+{
+    rpcServer->enableParallelBatches(4, 3);
+
+    Json::Value batch = Json::arrayValue;
+    for (unsigned i = 0; i < 20; ++i)
+    {
+        Json::Value call;
+        call["jsonrpc"] = "2.0";
+        call["id"] = i;
+        // a call changing the state in the middle splits the batch
+        call["method"] = i == 10 ? "eth_flush" : (i % 2 ? "eth_blockNumber" : "eth_gasPrice");
+        call["params"] = Json::arrayValue;
+        batch.append(call);
+    }
+
+    string response;
+    client->SendRPCMessage(Json::FastWriter().write(batch), response);
+
+    Json::Value responses;
+    BOOST_REQUIRE(Json::Reader().parse(response, responses));
+    BOOST_REQUIRE(responses.isArray());
+    BOOST_REQUIRE_EQUAL(responses.size(), batch.size());
+    for (unsigned i = 0; i < responses.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL(responses[i]["id"].asUInt(), i);
+        if (i == 10)
+            BOOST_CHECK(responses[i]["result"].asBool());
+        else if (i % 2)
+            BOOST_CHECK_EQUAL(responses[i]["result"].asString(), rpcClient->eth_blockNumber());
+        else
+            BOOST_CHECK_EQUAL(responses[i]["result"].asString(), toJS(20 * dev::eth::shannon));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(jsonrpc_parallelBatchPinnedHead)
+{
+    Json::Value config;
+    Json::Reader().parse(c_genesisConfigString, config);
+    rpcClient->test_setChainParams(config);
+    rpcServer->enableParallelBatches(
+        4, 3, rpc::BatchRequestHandler::clientHead(*web3->ethereum()));
+
+    auto const call = [](unsigned _id, string const& _method, Json::Value const& _params) {
+        Json::Value call;
+        call["jsonrpc"] = "2.0";
+        call["id"] = _id;
+        call["method"] = _method;
+        call["params"] = _params;
+        return call;
+    };
+    Json::Value latest = Json::arrayValue;
+    latest.append("latest");
+    latest.append(false);
+    Json::Value pending = Json::arrayValue;
+    pending.append("pending");
+    pending.append(false);
+    Json::Value block = Json::arrayValue;
+    block.append(c_block1Rlp);
+
+    // the calls after the import still read the head the batch arrived at
+    Json::Value batch = Json::arrayValue;
+    batch.append(call(0, "eth_blockNumber", Json::arrayValue));
+    batch.append(call(1, "eth_getBlockByNumber", latest));
+    batch.append(call(2, "eth_getBlockByNumber", pending));
+    batch.append(call(3, "test_importRawBlock", block));
+    batch.append(call(4, "eth_blockNumber", Json::arrayValue));
+    batch.append(call(5, "eth_getBlockByNumber", latest));
+    batch.append(call(6, "eth_getBlockByNumber", pending));
+
+    string response;
+    client->SendRPCMessage(Json::FastWriter().write(batch), response);
+
+    Json::Value responses;
+    BOOST_REQUIRE(Json::Reader().parse(response, responses));
+    BOOST_REQUIRE_EQUAL(responses.size(), batch.size());
+    BOOST_REQUIRE(responses[3]["result"].isString());
+    BOOST_CHECK_EQUAL(responses[0]["result"], "0x0");
+    BOOST_CHECK_EQUAL(responses[4]["result"], "0x0");
+    BOOST_CHECK_EQUAL(responses[1]["result"]["number"], "0x0");
+    BOOST_CHECK_EQUAL(responses[5]["result"], responses[1]["result"]);
+    BOOST_CHECK_EQUAL(responses[6]["result"]["number"], responses[2]["result"]["number"]);
+    BOOST_CHECK_EQUAL(
+        responses[6]["result"]["parentHash"], responses[2]["result"]["parentHash"]);
+
+    // the next batch reads the new head
+    Json::Value const importedHash = responses[3]["result"];
+    BOOST_CHECK_EQUAL(web3->ethereum()->number(), 1);
+    batch.resize(2);
+    client->SendRPCMessage(Json::FastWriter().write(batch), response);
+    BOOST_REQUIRE(Json::Reader().parse(response, responses));
+    BOOST_CHECK_EQUAL(responses[0]["result"], "0x1");
+    BOOST_CHECK_EQUAL(responses[1]["result"]["hash"], importedHash);
+}
+
+BOOST_AUTO_TEST_CASE(jsonrpc_streamingMethods)
+{
+    dev::eth::mine(*(web3->ethereum()), 1);
+    Json::Value t;
+    t["from"] = toJS(coinbase.address());
+    t["to"] = toJS(KeyPair::create().address());
+    t["value"] = "0x1000";
+    string const txHash = rpcClient->eth_sendTransaction(t);
+    dev::eth::mine(*(web3->ethereum()), 1);
+
+    rpc::Eth eth(*web3->ethereum(), *accountHolder);
+    auto const methods = eth.streamingMethods();
+    auto const stream = [&](string const& _method, Json::Value const& _params) {
+        string out;
+        rpc::JsonWriter writer(out);
+        methods.at(_method)(_params, writer);
+        Json::Value result;
+        BOOST_REQUIRE(Json::Reader().parse(out, result));
+        return result;
+    };
+    auto const params = [](Json::Value _first, Json::Value _second = Json::Value()) {
+        Json::Value result(Json::arrayValue);
+        result.append(_first);
+        if (!_second.isNull())
+            result.append(_second);
+        return result;
+    };
+
+    Json::Value const block = rpcClient->eth_getBlockByNumber("latest", true);
+    BOOST_REQUIRE_EQUAL(block["transactions"].size(), 1);
+    BOOST_CHECK_EQUAL(stream("eth_getBlockByNumber", params("latest", true)), block);
+    BOOST_CHECK_EQUAL(stream("eth_getBlockByHash", params(block["hash"], false)),
+        rpcClient->eth_getBlockByHash(block["hash"].asString(), false));
+    BOOST_CHECK_EQUAL(stream("eth_getTransactionByHash", params(txHash)),
+        rpcClient->eth_getTransactionByHash(txHash));
+    BOOST_CHECK_EQUAL(stream("eth_getTransactionReceipt", params(txHash)),
+        rpcClient->eth_getTransactionReceipt(txHash));
+    BOOST_CHECK(stream("eth_getTransactionReceipt", params(toJS(h256::random()))).isNull());
+
+    Json::Value filter;
+    filter["fromBlock"] = "earliest";
+    BOOST_CHECK_EQUAL(stream("eth_getLogs", params(filter)), rpcClient->eth_getLogs(filter));
+
+    // malformed parameters are left to the registered methods
+    BOOST_CHECK_THROW(stream("eth_getBlockByNumber", params("latest")), jsonrpc::JsonRpcException);
+}
+
+BOOST_AUTO_TEST_CASE(jsonrpc_writeJsonMatchesToJson)
+{
+    dev::eth::mine(*(web3->ethereum()), 1);
+    // the contract logs LOG1 on creation
+    Json::Value t;
+    t["from"] = toJS(coinbase.address());
+    t["data"] = "0x602a600052602a60206000a1";
+    t["gas"] = "0x100000";
+    h256 const txHash = jsToFixed<32>(rpcClient->eth_sendTransaction(t));
+    dev::eth::mine(*(web3->ethereum()), 1);
+
+    auto const& client = *web3->ethereum();
+    auto const written = [](function<void(rpc::JsonWriter&)> const& _write) {
+        string out;
+        rpc::JsonWriter writer(out);
+        _write(writer);
+        Json::Value parsed;
+        BOOST_REQUIRE(Json::Reader().parse(out, parsed));
+        return parsed;
+    };
+
+    h256 const blockHash = client.hashFromNumber(LatestBlock);
+    BlockHeader const header = client.blockInfo(blockHash);
+    BlockDetails const details = client.blockDetails(blockHash);
+    UncleHashes const uncles = client.uncleHashes(blockHash);
+    Transactions const transactions = client.transactions(blockHash);
+    TransactionHashes const transactionHashes = client.transactionHashes(blockHash);
+    BOOST_REQUIRE_EQUAL(transactions.size(), 1);
+
+    BOOST_CHECK_EQUAL(
+        written([&](rpc::JsonWriter& _w) { writeJson(_w, header, client.sealEngine()); }),
+        toJson(header, client.sealEngine()));
+    BOOST_CHECK_EQUAL(written([&](rpc::JsonWriter& _w) {
+        writeJson(_w, header, details, uncles, transactions, client.sealEngine());
+    }),
+        toJson(header, details, uncles, transactions, client.sealEngine()));
+    BOOST_CHECK_EQUAL(written([&](rpc::JsonWriter& _w) {
+        writeJson(_w, header, details, uncles, transactionHashes, client.sealEngine());
+    }),
+        toJson(header, details, uncles, transactionHashes, client.sealEngine()));
+
+    LocalisedTransaction const transaction = client.localisedTransaction(txHash);
+    BOOST_CHECK_EQUAL(written([&](rpc::JsonWriter& _w) { writeJson(_w, transaction); }),
+        toJson(transaction));
+
+    LocalisedTransactionReceipt const receipt = client.localisedTransactionReceipt(txHash);
+    BOOST_REQUIRE_EQUAL(receipt.localisedLogs().size(), 1);
+    BOOST_CHECK_EQUAL(
+        written([&](rpc::JsonWriter& _w) { writeJson(_w, receipt); }), toJson(receipt));
+
+    LocalisedLogEntries const logs = client.logs(LogFilter());
+    BOOST_REQUIRE_EQUAL(logs.size(), 1);
+    BOOST_CHECK_EQUAL(
+        written([&](rpc::JsonWriter& _w) { writeJson(_w, logs[0]); }), toJson(logs[0]));
+    BOOST_CHECK_EQUAL(written([&](rpc::JsonWriter& _w) { writeJson(_w, logs); }), toJson(logs));
+}
+
+BOOST_AUTO_TEST_CASE(jsonrpc_subscribeNewHeads)
+{
+    vector<Json::Value> notifications;
+    rpc::Subscriptions subscriptions(*web3->ethereum(), [&](string const& _message) {
+        Json::Value notification;
+        BOOST_REQUIRE(Json::Reader().parse(_message, notification));
+        notifications.push_back(notification);
+    });
+
+    string response;
+    BOOST_REQUIRE(subscriptions.handleRequest(
+        R"({"jsonrpc":"2.0","id":1,"method":"eth_subscribe","params":["newHeads"]})", response));
+    Json::Value parsed;
+    BOOST_REQUIRE(Json::Reader().parse(response, parsed));
+    string const subscription = parsed["result"].asString();
+    BOOST_REQUIRE(!subscription.empty());
+
+    // the changes are pushed before the block import is reported to mine()
+    dev::eth::mine(*(web3->ethereum()), 1);
+    BOOST_REQUIRE_EQUAL(notifications.size(), 1);
+    BOOST_CHECK_EQUAL(notifications[0]["method"].asString(), "eth_subscription");
+    BOOST_CHECK_EQUAL(notifications[0]["params"]["subscription"].asString(), subscription);
+    BOOST_CHECK_EQUAL(notifications[0]["params"]["result"]["hash"].asString(),
+        toJS(web3->ethereum()->hashFromNumber(LatestBlock)));
+
+    string const unsubscribe =
+        R"({"jsonrpc":"2.0","id":2,"method":"eth_unsubscribe","params":[")" + subscription +
+        R"("]})";
+    BOOST_REQUIRE(subscriptions.handleRequest(unsubscribe, response));
+    BOOST_REQUIRE(Json::Reader().parse(response, parsed));
+    BOOST_CHECK(parsed["result"].asBool());
+
+    dev::eth::mine(*(web3->ethereum()), 1);
+    BOOST_CHECK_EQUAL(notifications.size(), 1);
+
+    BOOST_CHECK(!subscriptions.handleRequest(
+        R"({"jsonrpc":"2.0","id":3,"method":"eth_blockNumber","params":[]})", response));
+}
+
+BOOST_AUTO_TEST_CASE(httpServerPost)
+{
+    auto httpServer = new HttpServer("127.0.0.1", 0, web3->ethereum());
+    rpcServer->addConnector(httpServer);
+    BOOST_REQUIRE(httpServer->StartListening());
+    BOOST_REQUIRE_NE(httpServer->port(), 0);
+
+    auto const response = httpPost(
+        httpServer->port(), R"({"jsonrpc":"2.0","id":1,"method":"eth_blockNumber","params":[]})");
+    BOOST_CHECK_EQUAL(response.result_int(), 200);
+    Json::Value parsed;
+    BOOST_REQUIRE(Json::Reader().parse(response.body(), parsed));
+    BOOST_CHECK_EQUAL(parsed["id"].asInt(), 1);
+    BOOST_CHECK_EQUAL(parsed["result"].asString(), rpcClient->eth_blockNumber());
+
+    // a notification has no response
+    auto const notification =
+        httpPost(httpServer->port(), R"({"jsonrpc":"2.0","method":"eth_blockNumber","params":[]})");
+    BOOST_CHECK_EQUAL(notification.result_int(), 204);
+    BOOST_CHECK(notification.body().empty());
+}
+
+BOOST_AUTO_TEST_CASE(httpServerWebSocketSubscriptions)
+{
+    auto httpServer = new HttpServer("127.0.0.1", 0, web3->ethereum());
+    rpcServer->addConnector(httpServer);
+    BOOST_REQUIRE(httpServer->StartListening());
+    dev::eth::mine(*(web3->ethereum()), 1);
+
+    WebSocketClient ws(httpServer->port());
+    ws.send(R"({"jsonrpc":"2.0","id":1,"method":"eth_blockNumber","params":[]})");
+    Json::Value const blockNumber = ws.read();
+    BOOST_CHECK_EQUAL(blockNumber["result"].asString(), rpcClient->eth_blockNumber());
+
+    map<string, string> kinds;
+    unsigned id = 2;
+    for (string const kind : {"newHeads", "logs", "newPendingTransactions"})
+    {
+        ws.send(R"({"jsonrpc":"2.0","id":)" + toString(id++) +
+                R"(,"method":"eth_subscribe","params":[")" + kind + R"("]})");
+        Json::Value const subscribed = ws.read();
+        BOOST_REQUIRE(subscribed["result"].isString());
+        kinds[subscribed["result"].asString()] = kind;
+    }
+
+    // the contract logs LOG0 on creation
+    Json::Value t;
+    t["from"] = toJS(coinbase.address());
+    t["data"] = "0x60006000a0";
+    t["gas"] = "0x100000";
+    string const txHash = rpcClient->eth_sendTransaction(t);
+    dev::eth::mine(*(web3->ethereum()), 1);
+    string const blockHash = toJS(web3->ethereum()->hashFromNumber(LatestBlock));
+
+    map<string, Json::Value> notifications;
+    while (notifications.size() < kinds.size())
+    {
+        Json::Value const message = ws.read();
+        BOOST_REQUIRE(!message.isNull());
+        BOOST_REQUIRE_EQUAL(message["method"].asString(), "eth_subscription");
+        string const subscription = message["params"]["subscription"].asString();
+        BOOST_REQUIRE(kinds.count(subscription));
+        // only the first notification of each kind is checked
+        notifications.emplace(kinds[subscription], message["params"]["result"]);
+    }
+    BOOST_CHECK_EQUAL(notifications["newPendingTransactions"].asString(), txHash);
+    BOOST_CHECK_EQUAL(notifications["newHeads"]["hash"].asString(), blockHash);
+    BOOST_CHECK_EQUAL(notifications["logs"]["transactionHash"].asString(), txHash);
+    BOOST_CHECK_EQUAL(notifications["logs"]["blockHash"].asString(), blockHash);
+    BOOST_CHECK(!notifications["logs"]["removed"].asBool());
+}
+
 BOOST_AUTO_TEST_SUITE_END()